@@ -0,0 +1,134 @@
+// Compares the virtual double dispatch of ast_node::accept() against the switch based
+// static_visitor on a large synthetic AST.
+//
+// usage: ast_visitor_bench [declarations] [chain depth] [iterations]
+
+#include "compiler/parser/visitor.hpp"
+#include "compiler/parser/static_visitor.hpp"
+#include "compiler/parser/prod/assignment.hpp"
+#include "compiler/parser/prod/assignment_stmt.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace compiler;
+
+// Counts the nodes by going through accept(), two indirect calls per node.
+class dynamic_counter : public ast_visitor {
+public:
+    std::uint64_t count{0};
+
+    visitor_result visit_assignment(assignment& node) override {
+        count += node.assignee().size();
+        if (node.has_expression()) {
+            node.expression().value()->accept(*this);
+        }
+    }
+    visitor_result visit_assignment_declaration(assignment_declaration& node) override {
+        count += 1;
+        if (node.has_expr()) {
+            node.expr()->accept(*this);
+        }
+    }
+
+    // the synthetic tree only has assignments, nothing else is ever reached.
+    visitor_result visit_integer_literal(integer_literal&) override {}
+    visitor_result visit_string_literal(string_literal&) override {}
+    visitor_result visit_name_expression(name_expression&) override {}
+    visitor_result visit_binary_expression(binary_expression&) override {}
+    visitor_result visit_unary_expression(unary_expression&) override {}
+    visitor_result visit_call_expression(call_expression&) override {}
+    visitor_result visit_subscript_expression(subscript_expression&) override {}
+    visitor_result visit_compound_statement(compound_statement&) override {}
+    visitor_result visit_expression_statement(expression_statement&) override {}
+    visitor_result visit_return_statement(return_statement&) override {}
+    visitor_result visit_if_statement(if_statement&) override {}
+    visitor_result visit_while_statement(while_statement&) override {}
+    visitor_result visit_for_statement(for_statement&) override {}
+    visitor_result visit_jump_statement(jump_statement&) override {}
+    visitor_result visit_function_declaration(function_declaration&) override {}
+};
+
+// Does exactly the same thing, but through static_visitor.
+class static_counter : public static_visitor<static_counter> {
+public:
+    std::uint64_t count{0};
+
+    void visit_assignment(assignment& node) {
+        count += node.assignee().size();
+        if (node.has_expression()) {
+            visit(*node.expression().value());
+        }
+    }
+    void visit_assignment_declaration(assignment_declaration& node) {
+        count += 1;
+        if (node.has_expr()) {
+            visit(*node.expr());
+        }
+    }
+};
+
+static std::unique_ptr<expression> make_chain(std::size_t depth, std::size_t seed) {
+    std::optional<std::unique_ptr<expression>> inner = std::nullopt;
+    for (std::size_t i = 0; i < depth; ++i) {
+        auto name = identifier(1 + ((seed + i) % 7), 'x');
+        inner = std::make_unique<assignment>(name, source_location::invalid(), std::move(inner));
+    }
+    return std::move(inner.value());
+}
+
+template<class Fn>
+static double time_ms(std::size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    const std::size_t decls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200'000;
+    const std::size_t depth = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8;
+    const std::size_t iterations = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10;
+
+    std::vector<std::unique_ptr<ast_node>> tree;
+    tree.reserve(decls);
+    for (std::size_t i = 0; i < decls; ++i) {
+        tree.push_back(std::make_unique<assignment_declaration>(
+            type_information::new_integral("int", mod_int),
+            "decl",
+            source_location::invalid(),
+            make_chain(1 + (i % depth), i)
+        ));
+    }
+
+    dynamic_counter dyn{};
+    static_counter stat{};
+
+    const double dyn_ms = time_ms(iterations, [&] {
+        for (auto& node : tree) {
+            node->accept(dyn);
+        }
+    });
+    const double stat_ms = time_ms(iterations, [&] {
+        for (auto& node : tree) {
+            stat.visit(*node);
+        }
+    });
+
+    if (dyn.count != stat.count) {
+        eprintln("visitors disagree! ({} vs {})", dyn.count, stat.count);
+        return 1;
+    }
+
+    const auto nodes = static_cast<double>(decls) * (1 + (depth + 1) / 2.0) * iterations;
+    println("nodes visited:   {:.0f}", nodes);
+    println("ast_visitor:     {:.2f}ms ({:.2f}ns/node)", dyn_ms, dyn_ms * 1e6 / nodes);
+    println("static_visitor:  {:.2f}ms ({:.2f}ns/node)", stat_ms, stat_ms * 1e6 / nodes);
+    println("speedup:         {:.2f}x", dyn_ms / stat_ms);
+    return 0;
+}
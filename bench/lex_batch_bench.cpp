@@ -0,0 +1,45 @@
+// Lexes a list of files with compiler::lex_files() and reports the throughput, the same
+// way an indexer would run the lexer over a whole repository.
+//
+// usage: lex_batch_bench [threads] < paths
+//   e.g. find . -name '*.c' | lex_batch_bench 8
+
+#include "compiler/lexing/batch.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace compiler;
+
+int main(int argc, char** argv) {
+    const std::size_t threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 0;
+
+    std::vector<std::string> paths;
+    for (std::string line; std::getline(std::cin, line);) {
+        if (!line.empty()) {
+            paths.push_back(std::move(line));
+        }
+    }
+
+    auto pool = thread_pool{ threads };
+    std::atomic<std::uint64_t> identifiers{ 0 };
+    const auto stats = lex_files(paths, pool, [&](const lexed_file& file, std::size_t) {
+        if (file.failure) {
+            eprintln("{}: {}", file.path, file.failure->what());
+            return;
+        }
+        std::uint64_t count = 0;
+        for (const auto& tok : file.tokens) {
+            count += tok.type() == token_type::IDENTIFIER;
+        }
+        identifiers.fetch_add(count, std::memory_order_relaxed);
+    });
+
+    println("{}", stats.to_string());
+    println("identifiers:     {}", identifiers.load());
+    println("threads:         {}", pool.size());
+    return stats.failed == 0 ? 0 : 1;
+}
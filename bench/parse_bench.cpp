@@ -0,0 +1,59 @@
+// Parses a token dump (compiler --dump-tokens=bin) over and over and reports the time the
+// parser alone takes, lexing isn't part of it.
+//
+// usage: parse_bench <file.tokens> [iterations]
+
+#include "compiler/lexing/token_stream.hpp"
+#include "compiler/parser/parser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+using namespace compiler;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        eprintln("usage: parse_bench <file.tokens> [iterations]");
+        return 1;
+    }
+    const std::size_t iterations = argc > 2 ? std::max<std::size_t>(1, std::strtoull(argv[2], nullptr, 10)) : 10;
+
+    string_pool strings;
+    auto loaded = read_tokens(argv[1], strings);
+    if (loaded.is_err()) {
+        eprintln("{}", loaded.get_err()->what());
+        return 1;
+    }
+    const auto stream = std::move(loaded).value();
+    // no source, diagnostics don't quote any lines.
+    const std::vector<std::string> lines{};
+
+    double best_ms = 0.0;
+    double total_ms = 0.0;
+    std::size_t nodes = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        // the parser takes the tokens, each run gets a copy made outside of the timing.
+        auto tokens = stream.tokens;
+        const auto start = std::chrono::steady_clock::now();
+        auto p = parser{ std::move(tokens) };
+        p.parse(lines);
+        const auto tree = p.release_ast();
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (p.has_errors()) {
+            eprintln("{} doesn't parse.", stream.file);
+            return 1;
+        }
+        nodes = tree.size();
+        best_ms = i == 0 ? ms : std::min(best_ms, ms);
+        total_ms += ms;
+    }
+
+    const auto count = static_cast<double>(stream.tokens.size());
+    println("tokens:          {}", stream.tokens.size());
+    println("declarations:    {}", nodes);
+    println("best:            {:.2f}ms ({:.2f}ns/token)", best_ms, best_ms * 1e6 / count);
+    println("mean:            {:.2f}ms ({:.2f}ns/token)", total_ms / iterations, total_ms * 1e6 / iterations / count);
+    return 0;
+}
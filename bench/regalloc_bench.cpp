@@ -0,0 +1,124 @@
+// Runs the register allocator on generated functions of growing size and reports the time it
+// takes per value. The time per value stays flat if allocation scales linearly.
+//
+// usage: regalloc_bench [values] [iterations]
+//   the functions have values/8, values/4, values/2 and values values (40000 by default).
+
+#include "compiler/codegen/regalloc.hpp"
+#include "compiler/ir/builder.hpp"
+#include "common/io.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+using namespace compiler;
+using namespace compiler::ir;
+
+namespace {
+
+// How far back each value reaches for its second operand, so this many values of each kind
+// are live everywhere. It's more than there are registers of either kind, there are spills
+// and splits all the way through.
+constexpr std::size_t window = 24;
+
+// The same registers the x86-64 backend hands out: 10 integer registers (the first 5 caller
+// saved) and 14 vector registers, all of them caller saved.
+codegen::register_info bench_registers() {
+    codegen::register_info regs{};
+    for (const std::uint8_t r : { 6, 7, 8, 9, 10, 3, 12, 13, 14, 15 }) {
+        regs.allocatable.push_back(r);
+    }
+    for (const std::uint8_t r : { 0, 1, 2, 6, 7, 8, 9, 10, 11 }) {
+        regs.caller_saved |= 1u << r;
+    }
+    for (std::uint8_t r = 0; r < 14; ++r) {
+        regs.vector_allocatable.push_back(static_cast<std::uint8_t>(16 + r));
+    }
+    for (std::uint8_t r = 0; r < 16; ++r) {
+        regs.caller_saved |= 1u << (16 + r);
+    }
+    regs.count = 32;
+    return regs;
+}
+
+// A function like a huge generated one with tens of thousands of locals: a long chain of
+// integer and vector arithmetic, a call every 32 values and an if/else (with a phi) every
+// 64 values.
+function make_function(std::size_t values) {
+    auto fn = function{ "f", 0, value_type::i64, { value_type::i64, value_type::i32 }, linkage::external };
+    auto b = builder{ fn };
+    b.set_insert_point(fn.create_block());
+
+    std::vector<value_id> ints{ b.param(value_type::i64, 0) };
+    std::vector<value_id> vectors{ b.emit(opcode::broadcast, value_type::v4i32, { b.param(value_type::i32, 1) }) };
+    const auto zero = b.iconst(value_type::i64, 0);
+    for (std::size_t k = 1; k < values; ++k) {
+        if (k % 64 == 0) {
+            const auto then_block = fn.create_block();
+            const auto else_block = fn.create_block();
+            const auto join = fn.create_block();
+            b.cond_br(b.icmp(cmp_pred::slt, ints.back(), zero), then_block, else_block);
+            b.set_insert_point(then_block);
+            const auto then_value = b.binary(opcode::add, value_type::i64, ints.back(), ints[ints.size() - window / 3]);
+            b.br(join);
+            b.set_insert_point(else_block);
+            const auto else_value = b.binary(opcode::sub, value_type::i64, ints.back(), ints[ints.size() - window / 4]);
+            b.br(join);
+            b.set_insert_point(join);
+            const auto phi = b.phi(value_type::i64, 2);
+            fn.set_phi_incoming(phi, 0, then_value, then_block);
+            fn.set_phi_incoming(phi, 1, else_value, else_block);
+            ints.push_back(phi);
+            continue;
+        }
+        if (k % 32 == 0) {
+            const value_id args[] = { ints.back(), ints[ints.size() - window / 2] };
+            ints.push_back(b.call(value_type::i64, 1, args));
+            continue;
+        }
+        if (k % 4 == 0) {
+            const auto far = vectors[vectors.size() > window ? vectors.size() - window : 0];
+            vectors.push_back(b.binary(opcode::add, value_type::v4i32, vectors.back(), far));
+            continue;
+        }
+        const auto far = ints[ints.size() > window ? ints.size() - window : 0];
+        ints.push_back(b.binary(k % 3 == 0 ? opcode::xor_ : opcode::add, value_type::i64, ints.back(), far));
+    }
+    // everything stays live until here.
+    auto result = ints.back();
+    for (std::size_t i = ints.size() - std::min(ints.size(), window); i + 1 < ints.size(); ++i) {
+        result = b.binary(opcode::add, value_type::i64, result, ints[i]);
+    }
+    const auto lanes = b.emit(opcode::reduce, value_type::i32, { vectors.back() }, static_cast<std::int64_t>(opcode::add));
+    result = b.binary(opcode::add, value_type::i64, result, b.cast(opcode::sext, value_type::i64, lanes));
+    b.ret(result);
+    return fn;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t values = argc > 1 ? std::max<std::size_t>(64, std::strtoull(argv[1], nullptr, 10)) : 40000;
+    const std::size_t iterations = argc > 2 ? std::max<std::size_t>(1, std::strtoull(argv[2], nullptr, 10)) : 5;
+    const auto regs = bench_registers();
+
+    println("{:>10} {:>10} {:>12} {:>12} {:>8}", "values", "blocks", "best", "per value", "slots");
+    for (std::size_t size = values / 8; size <= values; size *= 2) {
+        const auto fn = make_function(size);
+        double best_ms = 0.0;
+        std::int32_t slots = 0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            const auto graph = cfg{ fn };
+            auto alloc = codegen::linear_scan{ fn, graph, regs };
+            alloc.run();
+            const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best_ms = i == 0 ? ms : std::min(best_ms, ms);
+            slots = alloc.spill_slot_count();
+        }
+        println("{:>10} {:>10} {:>10.2f}ms {:>10.1f}ns {:>8}", fn.value_count(), fn.block_count(), best_ms, best_ms * 1e6 / fn.value_count(), slots);
+    }
+    return 0;
+}
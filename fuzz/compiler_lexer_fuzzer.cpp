@@ -0,0 +1,19 @@
+// libFuzzer target for compiler::lexer, see fuzz.hpp.
+
+#include "fuzz.hpp"
+
+#include "compiler/lexing/lexer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    const auto input = std::string_view{ reinterpret_cast<const char*>(data), size };
+    fuzz::run(input, [](std::string_view source) {
+        auto lexer = compiler::lexer{ compiler::source_info{ "fuzz.c", std::string{ source } } };
+        DISCARD(lexer.lex_tokens());
+    });
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Shared by the fuzz targets in this directory. Every input runs under a watchdog, and big
+// enough inputs are also checked for superlinear running time, so the fuzzer reports both
+// hangs and slow paths as crashes (with the input saved) instead of just stalling.
+
+#ifndef _FUZZ_FUZZ_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace fuzz {
+
+using clock = std::chrono::steady_clock;
+
+// An input of n bytes has to be done within base_budget + n * byte_budget.
+inline constexpr auto base_budget = std::chrono::milliseconds(250);
+inline constexpr auto byte_budget = std::chrono::microseconds(20);
+
+// Inputs at least this big are also run twice back to back. Linear work takes about twice
+// as long on that, more than scaling_limit times as long (and scaling_slack more than
+// double, which keeps timer noise on small inputs out) counts as superlinear.
+inline constexpr std::size_t scaling_min_size = 1024;
+inline constexpr double scaling_limit = 3.0;
+inline constexpr auto scaling_slack = std::chrono::milliseconds(2);
+
+namespace detail {
+
+// the deadline of the input being processed, in clock ticks. 0 when idle.
+inline std::atomic<std::int64_t> deadline{ 0 };
+inline std::atomic<std::size_t> deadline_size{ 0 };
+
+inline void start_watchdog() {
+    static const bool started = [] {
+        std::thread([] {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                const auto until = deadline.load(std::memory_order_acquire);
+                if (until != 0 && clock::now().time_since_epoch().count() > until) {
+                    std::fprintf(stderr, "fuzz: timeout, an input of %zu bytes took longer than its budget\n",
+                        deadline_size.load());
+                    // libFuzzer treats this as a crash and saves the input.
+                    std::abort();
+                }
+            }
+        }).detach();
+        return true;
+    }();
+    (void)started;
+}
+
+template<class F>
+clock::duration timed(std::string_view input, F& process) {
+    const auto budget = base_budget + byte_budget * input.size();
+    const auto start = clock::now();
+    deadline_size.store(input.size());
+    deadline.store((start + std::chrono::duration_cast<clock::duration>(budget)).time_since_epoch().count(), std::memory_order_release);
+    process(input);
+    deadline.store(0, std::memory_order_release);
+    return clock::now() - start;
+}
+
+template<class F>
+clock::duration best_of(int runs, std::string_view input, F& process) {
+    auto best = clock::duration::max();
+    for (int i = 0; i < runs; ++i) {
+        best = std::min(best, timed(input, process));
+    }
+    return best;
+}
+
+} // namespace detail
+
+// Run "process" (callable with a std::string_view) on "input" under the watchdog, and
+// check that it scales linearly. Call this from LLVMFuzzerTestOneInput.
+template<class F>
+void run(std::string_view input, F&& process) {
+    detail::start_watchdog();
+    if (input.size() < scaling_min_size) {
+        (void)detail::timed(input, process);
+        return;
+    }
+
+    std::string twice;
+    twice.reserve(input.size() * 2 + 1);
+    twice.append(input);
+    twice.push_back('\n');
+    twice.append(input);
+
+    const auto once_time = detail::best_of(3, input, process);
+    const auto twice_time = detail::best_of(3, twice, process);
+    if (twice_time > once_time * scaling_limit && twice_time - once_time * 2 > scaling_slack) {
+        using us = std::chrono::microseconds;
+        std::fprintf(stderr, "fuzz: superlinear, %zu bytes took %lldus but twice that took %lldus\n",
+            input.size(),
+            static_cast<long long>(std::chrono::duration_cast<us>(once_time).count()),
+            static_cast<long long>(std::chrono::duration_cast<us>(twice_time).count()));
+        std::abort();
+    }
+}
+
+} // namespace fuzz
+
+#define _FUZZ_FUZZ_HPP
+#endif // !_FUZZ_FUZZ_HPP
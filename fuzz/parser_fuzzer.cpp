@@ -0,0 +1,27 @@
+// libFuzzer target for compiler::parser, see fuzz.hpp. Inputs the lexer rejects never get
+// to the parser, the lexer has its own target.
+
+#include "fuzz.hpp"
+
+#include "compiler/lexing/lexer.hpp"
+#include "compiler/parser/parser.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    const auto input = std::string_view{ reinterpret_cast<const char*>(data), size };
+    fuzz::run(input, [](std::string_view source) {
+        auto lexer = compiler::lexer{ compiler::source_info{ "fuzz.c", std::string{ source } } };
+        if (lexer.lex_tokens().is_err()) {
+            return;
+        }
+        // json diagnostics don't need the source lines.
+        auto parser = compiler::parser{ lexer.release_tokens() };
+        parser.parse({}, compiler::diag_format::json);
+    });
+    return 0;
+}
@@ -0,0 +1,28 @@
+// libFuzzer target for preprocessor::lexer, see fuzz.hpp. The input is lexed a line at a
+// time, the same way preprocess() reads a file.
+
+#include "fuzz.hpp"
+
+#include "preprocessor/lexing/lexer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    const auto input = std::string_view{ reinterpret_cast<const char*>(data), size };
+    fuzz::run(input, [](std::string_view source) {
+        auto lexer = preprocessor::lexer{};
+        std::size_t begin = 0;
+        while (begin <= source.size()) {
+            auto end = source.find('\n', begin);
+            if (end == std::string_view::npos) {
+                end = source.size();
+            }
+            DISCARD(lexer.lex_tokens(std::string{ source.substr(begin, end - begin) }));
+            begin = end + 1;
+        }
+    });
+    return 0;
+}
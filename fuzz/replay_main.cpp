@@ -0,0 +1,27 @@
+// A main() for compilers without libFuzzer: runs every file given on the command line
+// through the target once, so crashes and corpora can be replayed anywhere.
+//
+// usage: <target> file...
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        auto file = std::ifstream{ argv[i], std::ios::binary };
+        if (!file) {
+            std::fprintf(stderr, "failed to open `%s`\n", argv[i]);
+            return 1;
+        }
+        const std::string input{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+        std::fprintf(stderr, "%s: ok\n", argv[i]);
+    }
+    return 0;
+}
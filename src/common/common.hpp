@@ -1,6 +1,8 @@
 
 #ifndef COMPILER_COMMON_HPP
 
+#include "io.hpp"
+
 #include <cstdlib>
 #include <iostream>
 
@@ -14,7 +16,7 @@
 #define NODISCARD [[nodiscard]]
 #define DISCARD(expr) ((void)expr)
 
-#define TODO(msg) std::cerr << "TODO: " msg << '\n'; std::exit(-1)
+#define TODO(msg) eprintln("TODO: {}", msg); std::exit(-1)
 
 #define COMPILER_COMMON_HPP
 #endif // !COMPILER_COMMON_HPP
\ No newline at end of file
@@ -0,0 +1,400 @@
+#include "file_loader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// the headers of 5.7 and later, older ones don't have all of the opcodes used here.
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(IORING_FEAT_FAST_POLL)
+#define _FILE_LOADER_IO_URING 1
+#else
+#define _FILE_LOADER_IO_URING 0
+#endif
+
+namespace {
+
+// how many files are read at once.
+constexpr unsigned ring_entries = 64;
+constexpr std::size_t reader_threads = 4;
+
+} // namespace
+
+#if _FILE_LOADER_IO_URING
+
+/*
+  A bare io_uring, set up with the raw syscalls so there's nothing to link. Only one thread
+  (the loader's driver) ever touches it, the atomics are for the kernel's side of the rings.
+*/
+class file_loader::ring {
+private:
+    int m_fd{ -1 };
+    void* m_rings{ MAP_FAILED };
+    std::size_t m_rings_size{ 0 };
+    io_uring_sqe* m_sqes{ static_cast<io_uring_sqe*>(MAP_FAILED) };
+    std::size_t m_sqes_size{ 0 };
+
+    unsigned* m_sq_tail{ nullptr };
+    unsigned* m_sq_mask{ nullptr };
+    unsigned* m_sq_array{ nullptr };
+    unsigned* m_cq_head{ nullptr };
+    unsigned* m_cq_tail{ nullptr };
+    unsigned* m_cq_mask{ nullptr };
+    io_uring_cqe* m_cqes{ nullptr };
+    // entries written to the submission queue since the last enter().
+    unsigned m_unsubmitted{ 0 };
+public:
+    ring() = default;
+    ring(const ring&) = delete;
+    ring& operator=(const ring&) = delete;
+
+    inline ~ring() {
+        if (m_sqes != MAP_FAILED) {
+            ::munmap(m_sqes, m_sqes_size);
+        }
+        if (m_rings != MAP_FAILED) {
+            ::munmap(m_rings, m_rings_size);
+        }
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    // nullptr when the kernel has no io_uring, or won't let this process use it.
+    static std::unique_ptr<ring> create(unsigned entries) noexcept {
+        auto params = io_uring_params{};
+        auto result = std::make_unique<ring>();
+        result->m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        // one mapping for both rings is all that's supported here, that's every kernel
+        // since 5.4 (and the opcodes used need 5.6 anyway).
+        if (result->m_fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+            return nullptr;
+        }
+        auto& r = *result;
+        r.m_rings_size = std::max<std::size_t>(
+            params.sq_off.array + params.sq_entries * sizeof(unsigned),
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        r.m_rings = ::mmap(nullptr, r.m_rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.m_fd, IORING_OFF_SQ_RING);
+        if (r.m_rings == MAP_FAILED) {
+            return nullptr;
+        }
+        r.m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        r.m_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, r.m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.m_fd, IORING_OFF_SQES));
+        if (r.m_sqes == MAP_FAILED) {
+            return nullptr;
+        }
+
+        auto* base = static_cast<std::uint8_t*>(r.m_rings);
+        r.m_sq_tail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        r.m_sq_mask = reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        r.m_sq_array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        r.m_cq_head = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        r.m_cq_tail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        r.m_cq_mask = reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        r.m_cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+        return result;
+    }
+
+    // The next entry to fill in, it's submitted by the next enter(). The caller never has
+    // more operations in flight than the ring has entries, so there's always one free.
+    inline io_uring_sqe& next() noexcept {
+        const auto tail = *m_sq_tail;
+        const auto index = tail & *m_sq_mask;
+        auto& sqe = m_sqes[index];
+        sqe = io_uring_sqe{};
+        m_sq_array[index] = index;
+        std::atomic_ref{ *m_sq_tail }.store(tail + 1, std::memory_order_release);
+        m_unsubmitted++;
+        return sqe;
+    }
+
+    // Submit what next() filled in, and wait until at least "wait_for" operations are done.
+    // False when the kernel refuses, the ring can't be relied on after that.
+    NODISCARD inline bool enter(unsigned wait_for) noexcept {
+        while (m_unsubmitted != 0 || wait_for != 0) {
+            const auto submitted = ::syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, wait_for, wait_for != 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            m_unsubmitted -= static_cast<unsigned>(submitted);
+            break;
+        }
+        return true;
+    }
+
+    // Call fn(user_data, result) for every finished operation.
+    template<class Fn>
+    void reap(Fn&& fn) {
+        auto head = *m_cq_head;
+        while (head != std::atomic_ref{ *m_cq_tail }.load(std::memory_order_acquire)) {
+            const auto& cqe = m_cqes[head & *m_cq_mask];
+            const auto user_data = cqe.user_data;
+            const auto res = cqe.res;
+            head++;
+            std::atomic_ref{ *m_cq_head }.store(head, std::memory_order_release);
+            fn(user_data, res);
+        }
+    }
+};
+
+#else
+
+class file_loader::ring {
+public:
+    static std::unique_ptr<ring> create(unsigned) noexcept { return nullptr; }
+};
+
+#endif
+
+file_loader::file_loader(backend kind) noexcept
+    : m_backend(kind)
+{}
+
+file_loader::~file_loader() {
+    {
+        std::lock_guard lock{ m_mutex };
+        m_stop = true;
+    }
+    m_queued.notify_all();
+    for (auto& reader : m_readers) {
+        reader.join();
+    }
+}
+
+void file_loader::prefetch(const std::string& path) {
+    {
+        std::lock_guard lock{ m_mutex };
+        if (m_requests.contains(path)) {
+            return;
+        }
+        if (m_readers.empty()) {
+            start();
+        }
+        auto req = std::make_shared<request>(request{ path });
+        m_requests.emplace(path, req);
+        m_queue.push_back(std::move(req));
+    }
+    m_queued.notify_one();
+}
+
+result<std::string, error> file_loader::take(const std::string& path) {
+    std::unique_lock lock{ m_mutex };
+    auto it = m_requests.find(path);
+    if (it == m_requests.end()) {
+        lock.unlock();
+        return read(path);
+    }
+    auto req = std::move(it->second);
+    m_requests.erase(it);
+    if (!req->started) {
+        // nobody got to it yet, reading it here beats waiting in line. The readers skip it.
+        req->started = true;
+        lock.unlock();
+        return read(path);
+    }
+    m_done.wait(lock, [&] { return req->done; });
+    if (req->failure) {
+        return std::move(*req->failure);
+    }
+    return std::move(req->contents);
+}
+
+bool file_loader::uses_io_uring() const noexcept {
+    return m_ring != nullptr;
+}
+
+void file_loader::start() {
+    if (m_backend == backend::automatic) {
+        m_ring = ring::create(ring_entries);
+    }
+    if (m_ring != nullptr) {
+        m_readers.emplace_back([this] { drive_ring(); });
+        return;
+    }
+    for (std::size_t i = 0; i < reader_threads; ++i) {
+        m_readers.emplace_back([this] { read_queued(); });
+    }
+}
+
+void file_loader::finish(request& req, result<std::string, error> contents) {
+    {
+        std::lock_guard lock{ m_mutex };
+        if (contents.is_err()) {
+            req.failure = std::move(contents).err();
+        }
+        else {
+            req.contents = std::move(contents).value();
+        }
+        req.done = true;
+    }
+    m_done.notify_all();
+}
+
+void file_loader::read_queued() {
+    for (;;) {
+        std::shared_ptr<request> req;
+        {
+            std::unique_lock lock{ m_mutex };
+            m_queued.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            req = std::move(m_queue.front());
+            m_queue.pop_front();
+            if (req->started) {
+                continue;
+            }
+            req->started = true;
+        }
+        finish(*req, read(req->path));
+    }
+}
+
+#if _FILE_LOADER_IO_URING
+
+namespace {
+
+// A file being read through the ring, it goes open -> read (as often as it takes).
+struct transfer {
+    int fd{ -1 };
+    std::size_t offset{ 0 };
+    std::string contents{};
+};
+
+} // namespace
+
+void file_loader::drive_ring() {
+    // slots are indexed by the operations' user_data, one operation is in flight per slot.
+    auto& ring = *m_ring;
+    std::vector<std::shared_ptr<request>> slots(ring_entries);
+    std::vector<transfer> transfers(ring_entries);
+    std::vector<std::uint64_t> free_slots{};
+    for (std::uint64_t i = ring_entries; i-- > 0;) {
+        free_slots.push_back(i);
+    }
+
+    const auto submit_read = [&](std::uint64_t slot) {
+        auto& t = transfers[slot];
+        auto& sqe = ring.next();
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = t.fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(t.contents.data() + t.offset);
+        sqe.len = static_cast<std::uint32_t>(std::min<std::size_t>(t.contents.size() - t.offset, 1u << 30));
+        sqe.off = t.offset;
+        sqe.user_data = slot;
+    };
+    const auto complete = [&](std::uint64_t slot, result<std::string, error> contents) {
+        auto& t = transfers[slot];
+        if (t.fd >= 0) {
+            ::close(t.fd);
+            t.fd = -1;
+        }
+        finish(*slots[slot], std::move(contents));
+        slots[slot].reset();
+        free_slots.push_back(slot);
+    };
+
+    for (;;) {
+        {
+            std::unique_lock lock{ m_mutex };
+            if (free_slots.size() == ring_entries) {
+                m_queued.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            }
+            if (m_stop && free_slots.size() == ring_entries) {
+                return;
+            }
+            while (!m_queue.empty() && !free_slots.empty()) {
+                auto req = std::move(m_queue.front());
+                m_queue.pop_front();
+                if (req->started) {
+                    continue;
+                }
+                req->started = true;
+                const auto slot = free_slots.back();
+                free_slots.pop_back();
+
+                auto& sqe = ring.next();
+                sqe.opcode = IORING_OP_OPENAT;
+                sqe.fd = AT_FDCWD;
+                sqe.addr = reinterpret_cast<std::uint64_t>(req->path.c_str());
+                sqe.open_flags = O_RDONLY | O_CLOEXEC | O_NONBLOCK;
+                sqe.user_data = slot;
+                transfers[slot].fd = -1;
+                transfers[slot].offset = 0;
+                slots[slot] = std::move(req);
+            }
+        }
+        if (free_slots.size() == ring_entries) {
+            continue;
+        }
+
+        if (!ring.enter(1)) {
+            // out of memory, a sandbox that lets the ring be set up but not entered, ... The
+            // files in flight are read here instead and this thread carries on as a plain
+            // reader. "transfers" stays alive until it returns, an operation the kernel
+            // already has may still write into it.
+            for (std::uint64_t slot = 0; slot < ring_entries; ++slot) {
+                if (slots[slot] != nullptr) {
+                    complete(slot, read(slots[slot]->path));
+                }
+            }
+            read_queued();
+            return;
+        }
+        ring.reap([&](std::uint64_t slot, std::int32_t res) {
+            auto& t = transfers[slot];
+            if (t.fd < 0) {
+                // the open finished.
+                struct stat info {};
+                if (res < 0 || ::fstat(res, &info) != 0 || !S_ISREG(info.st_mode)) {
+                    if (res >= 0) {
+                        ::close(res);
+                    }
+                    // read() again for the error, this also covers a kernel without the
+                    // opcode, which fails every open with EINVAL.
+                    complete(slot, read(slots[slot]->path));
+                    return;
+                }
+                t.fd = res;
+                t.contents.assign(static_cast<std::size_t>(info.st_size), '\0');
+                if (t.contents.empty()) {
+                    complete(slot, std::string{});
+                    return;
+                }
+                submit_read(slot);
+                return;
+            }
+
+            if (res == -EINTR || res == -EAGAIN) {
+                submit_read(slot);
+                return;
+            }
+            if (res < 0) {
+                complete(slot, error("failed to read `{}`.", slots[slot]->path));
+                return;
+            }
+            t.offset += static_cast<std::size_t>(res);
+            if (res == 0 || t.offset == t.contents.size()) {
+                // short of the fstat() size when the file shrunk in between.
+                t.contents.resize(t.offset);
+                complete(slot, std::move(t.contents));
+                return;
+            }
+            submit_read(slot);
+        });
+    }
+}
+
+#else
+
+void file_loader::drive_ring() {}
+
+#endif
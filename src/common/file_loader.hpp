@@ -0,0 +1,146 @@
+#ifndef _FILE_LOADER_HPP
+
+#include "common.hpp"
+#include "result.hpp"
+#include "error.hpp"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define _FILE_LOADER_POSIX 1
+#else
+#define _FILE_LOADER_POSIX 0
+#endif
+
+// COMPILER_API_BEGIN
+
+/*
+  Reads whole files in the background. prefetch() queues a file as soon as its name is
+  known (the preprocessor does it for every #include it finds), take() hands over its
+  contents later, by then they're usually in memory already. Many small headers read one
+  after another each wait on the disk in turn, here the reads overlap.
+
+  On Linux the reads go through io_uring, one thread keeps the ring full. Where that isn't
+  available (old kernels, seccomp sandboxes) a few threads read with plain read() instead.
+  A ring that starts failing later on reads what it had in flight with read(), and its
+  thread goes on as one of those readers.
+  Nothing is started until the first prefetch(), a loader that's only ever asked for files
+  through take() costs nothing more than reading them directly.
+
+  Only regular files are read, opening a path like /dev/stdin or a fifo fails instead of
+  blocking.
+*/
+class file_loader {
+public:
+    enum class backend {
+        // io_uring if the kernel allows it, threads otherwise.
+        automatic,
+        threads,
+    };
+private:
+    // one requested file, shared by whoever requested it and whoever reads it.
+    struct request {
+        std::string path;
+        std::string contents{};
+        std::optional<error> failure{};
+        bool started{ false };
+        bool done{ false };
+    };
+    class ring;
+
+    backend m_backend;
+    std::mutex m_mutex{};
+    // signalled when a request is done, and when one is queued or the loader stops.
+    std::condition_variable m_done{};
+    std::condition_variable m_queued{};
+    std::unordered_map<std::string, std::shared_ptr<request>> m_requests{};
+    // requests no reader has started yet.
+    std::deque<std::shared_ptr<request>> m_queue{};
+    std::vector<std::thread> m_readers{};
+    std::unique_ptr<ring> m_ring{};
+    bool m_stop{ false };
+public:
+    explicit file_loader(backend kind = backend::automatic) noexcept;
+    file_loader(const file_loader&) = delete;
+    file_loader& operator=(const file_loader&) = delete;
+    ~file_loader();
+
+    // Start reading "path" in the background. Nothing happens if it's been requested already.
+    void prefetch(const std::string& path);
+
+    // The contents of "path", the loader forgets the file after this. Waits for a read that's
+    // in flight, one that's only queued (or was never requested) is done right here.
+    NODISCARD result<std::string, error> take(const std::string& path);
+
+    // Whether the reads go through io_uring, only known once something was prefetched.
+    NODISCARD bool uses_io_uring() const noexcept;
+
+    // Read all of "path" now, on the calling thread.
+    NODISCARD static inline result<std::string, error> read(const std::string& path) noexcept {
+#if _FILE_LOADER_POSIX
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+        if (fd < 0) {
+            return error("failed to open `{}`.", path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            ::close(fd);
+            return error("`{}` is not a regular file.", path);
+        }
+        std::string contents(static_cast<std::size_t>(info.st_size), '\0');
+        std::size_t offset = 0;
+        while (offset < contents.size()) {
+            const auto count = ::read(fd, contents.data() + offset, contents.size() - offset);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ::close(fd);
+                return error("failed to read `{}`.", path);
+            }
+            if (count == 0) {
+                // the file shrunk since the fstat().
+                contents.resize(offset);
+                break;
+            }
+            offset += static_cast<std::size_t>(count);
+        }
+        ::close(fd);
+        return contents;
+#else
+        auto stream = std::ifstream{ path, std::ios::binary };
+        if (!stream) {
+            return error("failed to open `{}`.", path);
+        }
+        return std::string{ std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} };
+#endif
+    }
+private:
+    // start the backend, with m_mutex held.
+    void start();
+    // what the reader threads run, and what the one thread of the io_uring backend runs.
+    void read_queued();
+    void drive_ring();
+    // mark "req" done and wake whoever waits on it.
+    void finish(request& req, result<std::string, error> contents);
+};
+
+// COMPILER_API_END
+
+#define _FILE_LOADER_HPP
+#endif // !_FILE_LOADER_HPP
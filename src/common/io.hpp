@@ -1,34 +1,147 @@
-
-#include <iostream>
 #ifndef _COMMON_IO_HPP
 
+#include <cstddef>
+#include <cstdio>
 #include <format>
+#include <iterator>
+#include <mutex>
 #include <string>
-#include <iostream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <unistd.h>
+#define _COMMON_IO_POSIX 1
+#else
+#define _COMMON_IO_POSIX 0
+#endif
+
+/*
+  Buffered output to stdout or stderr, one sink per stream and thread. Everything is
+  formatted straight into the sink's buffer with format_to (no temporary string, no
+  iostreams). stdout goes out in large writes: once it's past flush_threshold, on flush()
+  and when the thread exits. stderr goes out at the end of every message, after what the
+  thread has buffered for stdout, so a diagnostic isn't lost on a crash or an exit that
+  skips the destructors and stays in order with the output around it.
+
+  One print call always lands in the buffer whole and a buffer is only ever written whole,
+  under a lock every thread's sink for that stream shares. A diagnostic printed with one
+  call never interleaves with what other threads print.
+*/
+class output_sink {
+public:
+    static constexpr std::size_t flush_threshold = 64 * 1024;
+private:
+    int m_fd;
+    std::string m_buffer{};
+
+    // shared by every thread's sink for the stream.
+    static inline std::mutex& lock_of(int fd) noexcept {
+        static std::mutex locks[2];
+        return locks[fd == 2];
+    }
+
+    inline void write_all(const char* data, std::size_t size) noexcept {
+#if _COMMON_IO_POSIX
+        while (size != 0) {
+            const auto written = ::write(m_fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+#else
+        auto* stream = m_fd == 2 ? stderr : stdout;
+        std::fwrite(data, 1, size, stream);
+        std::fflush(stream);
+#endif
+    }
+public:
+    inline explicit output_sink(int fd) noexcept
+        : m_fd(fd)
+    {}
+    output_sink(const output_sink&) = delete;
+    output_sink& operator=(const output_sink&) = delete;
+    inline ~output_sink() { flush(); }
+
+    // The calling thread's sinks.
+    static inline output_sink& out() noexcept {
+        thread_local output_sink sink{ 1 };
+        return sink;
+    }
+    static inline output_sink& err() noexcept {
+        thread_local output_sink sink{ 2 };
+        return sink;
+    }
+
+    template<typename... Ts>
+    inline void write(const std::format_string<Ts...> fmt, Ts&&... args) noexcept {
+        std::format_to(std::back_inserter(m_buffer), fmt, std::forward<Ts>(args)...);
+        end_message();
+    }
+
+    template<typename... Ts>
+    inline void write_line(const std::format_string<Ts...> fmt, Ts&&... args) noexcept {
+        std::format_to(std::back_inserter(m_buffer), fmt, std::forward<Ts>(args)...);
+        m_buffer.push_back('\n');
+        end_message();
+    }
+
+    // For writers that produce a message piecewise: append to buffer() directly and call
+    // end_message() once the whole message is in, the buffer is only flushed there.
+    inline std::string& buffer() noexcept { return m_buffer; }
+    inline void end_message() noexcept {
+        if (m_fd == 2) {
+            out().flush();
+            flush();
+        }
+        else if (m_buffer.size() >= flush_threshold) {
+            flush();
+        }
+    }
+
+    inline void flush() noexcept {
+        if (m_buffer.empty()) {
+            return;
+        }
+        {
+            const auto guard = std::lock_guard{ lock_of(m_fd) };
+            write_all(m_buffer.data(), m_buffer.size());
+        }
+        m_buffer.clear();
+    }
+};
 
 template<typename... Ts>
 inline void print(const std::format_string<Ts...> fmt, Ts&&... args) noexcept {
-    const auto _Fmtd = std::format(fmt, std::forward<Ts>(args)...);
-    std::cout << _Fmtd;
+    output_sink::out().write(fmt, std::forward<Ts>(args)...);
 }
 
 template<typename... Ts>
 inline void println(const std::format_string<Ts...> fmt, Ts&&... args) noexcept {
-    const auto _Fmtd = std::format(fmt, std::forward<Ts>(args)...);
-    std::cout << _Fmtd << '\n';
+    output_sink::out().write_line(fmt, std::forward<Ts>(args)...);
 }
 
 template<typename... Ts>
 inline void eprint(const std::format_string<Ts...> fmt, Ts&&... args) noexcept {
-    const auto _Fmtd = std::format(fmt, std::forward<Ts>(args)...);
-    std::cerr << _Fmtd;
+    output_sink::err().write(fmt, std::forward<Ts>(args)...);
 }
 
 template<typename... Ts>
 inline void eprintln(const std::format_string<Ts...> fmt, Ts&&... args) noexcept {
-    const auto _Fmtd = std::format(fmt, std::forward<Ts>(args)...);
-    std::cerr << _Fmtd << '\n';
+    output_sink::err().write_line(fmt, std::forward<Ts>(args)...);
+}
+
+// Write out what the calling thread has printed so far. Anything that writes to stdout or
+// stderr without the sinks has to call this first to keep the order.
+inline void flush_output() noexcept {
+    output_sink::out().flush();
+    output_sink::err().flush();
 }
 
 #define _COMMON_IO_HPP
-#endif // !_COMMON_IO_HPP
\ No newline at end of file
+#endif // !_COMMON_IO_HPP
@@ -0,0 +1,135 @@
+#ifndef _MAPPED_FILE_HPP
+
+#include "common.hpp"
+#include "result.hpp"
+#include "error.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define _MAPPED_FILE_MMAP 1
+#else
+#define _MAPPED_FILE_MMAP 0
+#endif
+
+// COMPILER_API_BEGIN
+
+/*
+  A whole file mapped read-only into memory. Pages are only read from disk when they're
+  touched, so opening a big file costs next to nothing until its contents are used. Where
+  there's no mmap the file is read into a buffer instead, the interface is the same.
+*/
+class mapped_file {
+private:
+    const std::uint8_t* m_data{ nullptr };
+    std::size_t m_size{ 0 };
+    // the fallback, when the file couldn't be mapped.
+    std::vector<std::uint8_t> m_buffer{};
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    inline mapped_file(mapped_file&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_buffer(std::move(other.m_buffer))
+    {}
+    inline mapped_file& operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_buffer = std::move(other.m_buffer);
+        }
+        return *this;
+    }
+    inline ~mapped_file() { unmap(); }
+
+    static inline result<mapped_file, error> open(const std::string& path) noexcept {
+        mapped_file file{};
+#if _MAPPED_FILE_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return error("failed to open `{}`.", path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return error("failed to stat `{}`.", path);
+        }
+        file.m_size = static_cast<std::size_t>(info.st_size);
+        if (file.m_size != 0) {
+            void* data = ::mmap(nullptr, file.m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                file.m_data = static_cast<const std::uint8_t*>(data);
+            }
+        }
+        ::close(fd);
+        if (file.m_data != nullptr || file.m_size == 0) {
+            return file;
+        }
+#endif
+        auto stream = std::ifstream{ path, std::ios::binary };
+        if (!stream) {
+            return error("failed to open `{}`.", path);
+        }
+        file.m_buffer.assign(std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{});
+        file.m_size = file.m_buffer.size();
+        return file;
+    }
+
+    // Ask the OS to start reading the whole file in now, in the background. Without this the
+    // pages come in on demand, a few at a time, as they're first touched.
+    inline void will_need() const noexcept {
+#if _MAPPED_FILE_MMAP
+        if (m_data != nullptr) {
+            ::madvise(const_cast<std::uint8_t*>(m_data), m_size, MADV_WILLNEED);
+        }
+#endif
+    }
+
+    // will_need() for a file that isn't open yet, it gets read into the page cache while
+    // the caller does something else. Used to read ahead through a list of files.
+    static inline void prefetch(const std::string& path) noexcept {
+#if _MAPPED_FILE_MMAP && defined(__linux__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            ::close(fd);
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    inline const std::uint8_t* data() const noexcept { return m_data != nullptr ? m_data : m_buffer.data(); }
+    inline std::size_t size() const noexcept { return m_size; }
+    inline std::span<const std::uint8_t> bytes() const noexcept { return { data(), m_size }; }
+private:
+    inline void unmap() noexcept {
+#if _MAPPED_FILE_MMAP
+        if (m_data != nullptr) {
+            ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+};
+
+// COMPILER_API_END
+
+#define _MAPPED_FILE_HPP
+#endif // !_MAPPED_FILE_HPP
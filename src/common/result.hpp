@@ -2,41 +2,139 @@
 
 #include "common.hpp"
 
-#include <variant>
+#include <functional>
 #include <type_traits>
+#include <utility>
+#include <variant>
 
 // COMPILER_API_BEGIN
 
+template<class T, class E>
+class result;
+
+namespace result_detail {
+
+template<class R>
+struct is_result : std::false_type {};
+template<class T, class E>
+struct is_result<result<T, E>> : std::true_type {};
+
+// The result "map" returns, "f" returned a U.
+template<class U, class E>
+using mapped = result<std::remove_cvref_t<U>, E>;
+
+} // namespace result_detail
+
+/*
+  Either a value or an error, the same idea as std::expected. Both live inline in the
+  variant, nothing is allocated, and a result can only be moved so nothing is copied by
+  accident either.
+
+  Taking the value (or error) out moves it, a result is usually a temporary anyway:
+
+    auto tok = std::move(r).value();
+    return std::move(r).err();
+
+  get() and get_err() are for looking without taking, they are null for the other case.
+  and_then(), map() and or_else() chain steps without unpacking in between, an error goes
+  straight through to the end:
+
+    parse_typename().map([](type_information&& type) { return type.pointer_depth(); });
+
+  RESULT_TRY below is the early return for code that reads better as statements.
+*/
 template<class T, class E>
 class result {
 private:
   std::variant<T, E> m_variant;
 public:
-  static_assert(std::is_move_assignable<T>::value, "result<T>: value must be move assignable.");
-  static_assert(std::is_move_assignable<E>::value, "result<E>: error must be move assignable.");
-  
+  static_assert(std::is_move_constructible<T>::value, "result<T>: value must be move constructible.");
+  static_assert(std::is_move_constructible<E>::value, "result<E>: error must be move constructible.");
+
+  using value_type = T;
+  using error_type = E;
+
   result() = delete;
-  inline result(T&& ok)
-    : m_variant(std::move(ok))
+  result(const result&) = delete;
+  result& operator=(const result&) = delete;
+  result(result&&) = default;
+  result& operator=(result&&) = default;
+  inline result(T&& ok) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : m_variant(std::in_place_index<0>, std::move(ok))
   {}
-  inline result(E&& err)
-    : m_variant(std::move(err))
+  inline result(E&& err) noexcept(std::is_nothrow_move_constructible_v<E>)
+    : m_variant(std::in_place_index<1>, std::move(err))
   {}
 
   inline bool is_err() const noexcept {
-    return std::get_if<1>(&m_variant) != nullptr;  
+    return m_variant.index() == 1;
   }
 
   inline bool is_okay() const noexcept {
-    return is_err() == false;  
+    return m_variant.index() == 0;
   }
 
-  inline T* get() const noexcept {
-    return (T*)std::get_if<0>(&m_variant); 
+  inline T* get() noexcept { return std::get_if<0>(&m_variant); }
+  inline const T* get() const noexcept { return std::get_if<0>(&m_variant); }
+
+  inline E* get_err() noexcept { return std::get_if<1>(&m_variant); }
+  inline const E* get_err() const noexcept { return std::get_if<1>(&m_variant); }
+
+  // The value, only call these when is_okay().
+  inline T& value() & noexcept { return *get(); }
+  inline const T& value() const& noexcept { return *get(); }
+  inline T&& value() && noexcept { return std::move(*get()); }
+
+  // The error, only call these when is_err().
+  inline E& err() & noexcept { return *get_err(); }
+  inline const E& err() const& noexcept { return *get_err(); }
+  inline E&& err() && noexcept { return std::move(*get_err()); }
+
+  // "f" takes the value and returns another result (with the same error type).
+  template<class F>
+  inline auto and_then(F&& f) && {
+    using R = std::remove_cvref_t<std::invoke_result_t<F, T&&>>;
+    static_assert(result_detail::is_result<R>::value, "and_then: the function must return a result.");
+    if (is_err()) {
+      return R(std::move(*this).err());
+    }
+    return std::invoke(std::forward<F>(f), std::move(*this).value());
+  }
+  template<class F>
+  inline auto and_then(F&& f) & {
+    using R = std::remove_cvref_t<std::invoke_result_t<F, T&>>;
+    static_assert(result_detail::is_result<R>::value, "and_then: the function must return a result.");
+    if (is_err()) {
+      return R(E{ err() });
+    }
+    return std::invoke(std::forward<F>(f), value());
   }
 
-  inline E* get_err() const noexcept {
-    return (E*)std::get_if<1>(&m_variant);
+  // "f" takes the value and returns a plain value (or nothing), that's the new value.
+  template<class F>
+  inline auto map(F&& f) && {
+    using U = std::invoke_result_t<F, T&&>;
+    using R = result_detail::mapped<U, E>;
+    if (is_err()) {
+      return R(std::move(*this).err());
+    }
+    if constexpr (std::is_void_v<U>) {
+      std::invoke(std::forward<F>(f), std::move(*this).value());
+      return R();
+    }
+    else {
+      return R(std::invoke(std::forward<F>(f), std::move(*this).value()));
+    }
+  }
+
+  // "f" takes the error and returns a result of the same type, it can recover or replace
+  // the error.
+  template<class F>
+  inline result or_else(F&& f) && {
+    if (is_okay()) {
+      return std::move(*this);
+    }
+    return std::invoke(std::forward<F>(f), std::move(*this).err());
   }
 };
 
@@ -45,31 +143,94 @@ public:
 template<class E>
 class result<void, E> {
 private:
-  std::variant<std::nullptr_t, E> m_variant;
+  std::variant<std::monostate, E> m_variant;
 public:
-  static_assert(std::is_move_assignable<E>::value, "result<void, E>: E must be move assignable.");
-  inline result()
-    : m_variant{nullptr}
+  static_assert(std::is_move_constructible<E>::value, "result<void, E>: E must be move constructible.");
+
+  using value_type = void;
+  using error_type = E;
+
+  inline result() noexcept
+    : m_variant{}
   {}
-  inline result(E&& err) noexcept 
-    : m_variant{std::move(err)}
+  result(const result&) = delete;
+  result& operator=(const result&) = delete;
+  result(result&&) = default;
+  result& operator=(result&&) = default;
+  inline result(E&& err) noexcept(std::is_nothrow_move_constructible_v<E>)
+    : m_variant(std::in_place_index<1>, std::move(err))
   {}
 
   inline bool is_err() const noexcept {
-    return std::get_if<1>(&m_variant) != nullptr;
+    return m_variant.index() == 1;
   }
 
   inline bool is_okay() const noexcept {
-    return is_err() == false;
+    return m_variant.index() == 0;
   }
 
   // dont add get(), you cannot "get" void.
 
-  inline E* get_err() const noexcept {
-    return (E*)std::get_if<1>(&m_variant);
+  inline E* get_err() noexcept { return std::get_if<1>(&m_variant); }
+  inline const E* get_err() const noexcept { return std::get_if<1>(&m_variant); }
+
+  inline E& err() & noexcept { return *get_err(); }
+  inline const E& err() const& noexcept { return *get_err(); }
+  inline E&& err() && noexcept { return std::move(*get_err()); }
+
+  template<class F>
+  inline auto and_then(F&& f) && {
+    using R = std::remove_cvref_t<std::invoke_result_t<F>>;
+    static_assert(result_detail::is_result<R>::value, "and_then: the function must return a result.");
+    if (is_err()) {
+      return R(std::move(*this).err());
+    }
+    return std::invoke(std::forward<F>(f));
+  }
+
+  template<class F>
+  inline auto map(F&& f) && {
+    using U = std::invoke_result_t<F>;
+    using R = result_detail::mapped<U, E>;
+    if (is_err()) {
+      return R(std::move(*this).err());
+    }
+    if constexpr (std::is_void_v<U>) {
+      std::invoke(std::forward<F>(f));
+      return R();
+    }
+    else {
+      return R(std::invoke(std::forward<F>(f)));
+    }
+  }
+
+  template<class F>
+  inline result or_else(F&& f) && {
+    if (is_okay()) {
+      return std::move(*this);
+    }
+    return std::invoke(std::forward<F>(f), std::move(*this).err());
   }
 };
 
+// Evaluate "expr" (a result). If it failed, return its error from the enclosing function
+// (which has to return a result with the same error type), otherwise move the value into
+// a new variable "var".
+#define RESULT_TRY(var, expr)                        \
+  auto var##_result = (expr);                        \
+  if (var##_result.is_err()) {                       \
+    return std::move(var##_result).err();            \
+  }                                                  \
+  auto var = std::move(var##_result).value()
+
+// The same for a result<void, E>, there is nothing to keep.
+#define RESULT_CHECK(expr)                           \
+  do {                                               \
+    if (auto _check_result = (expr); _check_result.is_err()) { \
+      return std::move(_check_result).err();         \
+    }                                                \
+  } while (false)
+
 // COMPILER_API_END
 
 #define _RESULT_HPP
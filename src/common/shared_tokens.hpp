@@ -0,0 +1,15 @@
+#ifndef _SHARED_TOKENS_HPP
+
+/*
+  The tokens both lexers have, as X(name, spelling). The compiler lexes "if" and "else" as
+  keywords and the preprocessor as directive names, each lexer's token list expands this
+  where it wants them, so they're spelled in one place. What only one of the lexers knows
+  stays in its own list: "#" and the comment delimiters are the preprocessor's, the compiler
+  is never handed either.
+*/
+#define SHARED_TOKEN_TYPES(X)                           \
+    X(IF, "if")                                         \
+    X(ELSE, "else")
+
+#define _SHARED_TOKENS_HPP
+#endif // !_SHARED_TOKENS_HPP
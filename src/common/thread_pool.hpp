@@ -0,0 +1,137 @@
+#ifndef _THREAD_POOL_HPP
+
+#include "common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// COMPILER_API_BEGIN
+
+/*
+  A fixed set of threads that run one job at a time: for_each_index() hands out the indices
+  of a job to whichever thread is free, the calling thread included, and returns once every
+  index is done. There's no queue and no futures, every parallel part of the compiler is a
+  loop over functions (or files) whose results go into a vector slot of their own.
+
+  Jobs can't be nested, calling for_each_index() from inside of a job deadlocks.
+*/
+class thread_pool {
+private:
+    std::vector<std::thread> m_workers{};
+    std::mutex m_mutex{};
+    std::condition_variable m_wake{};
+    std::condition_variable m_done{};
+
+    // the current job, type erased so the workers don't need to know what it is.
+    void* m_job{ nullptr };
+    void (*m_call)(void* job, std::size_t index, std::size_t worker){ nullptr };
+    std::size_t m_count{ 0 };
+    std::atomic<std::size_t> m_next{ 0 };
+    // workers that haven't finished the current job yet.
+    std::size_t m_busy{ 0 };
+    // bumped for every job, that's how a worker tells a new job from the one it just did.
+    std::uint64_t m_generation{ 0 };
+    bool m_stop{ false };
+public:
+    // "threads" counts the calling thread, 0 is one per core. A pool of 1 runs everything
+    // on the calling thread.
+    inline explicit thread_pool(std::size_t threads = 0) {
+        if (threads == 0) {
+            threads = default_threads();
+        }
+        m_workers.reserve(threads - 1);
+        for (std::size_t i = 1; i < threads; ++i) {
+            m_workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    inline ~thread_pool() {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    static inline std::size_t default_threads() noexcept {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // How many threads run a job, workers are numbered [0, size()), 0 is the caller.
+    inline std::size_t size() const noexcept { return m_workers.size() + 1; }
+
+    // Call fn(index, worker) for every index in [0, count) and wait for all of them. "worker"
+    // is the thread running it, for per-thread scratch buffers. The order is unspecified.
+    template<class Fn>
+    void for_each_index(std::size_t count, Fn&& fn) {
+        if (m_workers.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                fn(i, std::size_t{ 0 });
+            }
+            return;
+        }
+
+        {
+            std::lock_guard lock{ m_mutex };
+            m_job = &fn;
+            m_call = [](void* job, std::size_t index, std::size_t worker) {
+                (*static_cast<std::remove_reference_t<Fn>*>(job))(index, worker);
+            };
+            m_count = count;
+            m_next.store(0, std::memory_order_relaxed);
+            m_busy = m_workers.size();
+            m_generation++;
+        }
+        m_wake.notify_all();
+        run_job(0);
+
+        std::unique_lock lock{ m_mutex };
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_job = nullptr;
+    }
+private:
+    inline void run_job(std::size_t worker) {
+        for (auto i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count;
+             i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+            m_call(m_job, i, worker);
+        }
+    }
+
+    inline void work(std::size_t worker) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock lock{ m_mutex };
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop) {
+                    return;
+                }
+                seen = m_generation;
+            }
+            run_job(worker);
+
+            std::lock_guard lock{ m_mutex };
+            if (--m_busy == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+};
+
+// COMPILER_API_END
+
+#define _THREAD_POOL_HPP
+#endif // !_THREAD_POOL_HPP
@@ -0,0 +1,156 @@
+#ifndef _TOKEN_TABLES_HPP
+
+#include "common.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// COMPILER_API_BEGIN
+
+// A token type and how it's spelled in the source, what the tables below are built from.
+template<class Type>
+struct token_spelling {
+    std::string_view text;
+    Type type;
+};
+
+/*
+  Finds the token a word is spelled as (a keyword, a directive name) with one hash and one
+  comparison. The table is built while compiling: the constructor tries seeds until every
+  spelling lands in a slot of its own, a set of spellings that doesn't fit fails the build.
+
+  Spellings are short, hashing all of their characters costs less than picking some out
+  would save, and the predefined macros (__DATE__, __TIME__, ...) only differ in the middle.
+*/
+template<class Type, std::size_t Count, std::size_t Slots = 256>
+class spelling_table {
+    static_assert(Count < Slots && Slots <= 256 && (Slots & (Slots - 1)) == 0);
+private:
+    std::array<token_spelling<Type>, Count> m_entries;
+    // the entry in each slot plus one, 0 for an empty slot.
+    std::array<std::uint8_t, Slots> m_slots{};
+    std::uint32_t m_seed{ 0 };
+public:
+    consteval spelling_table(const std::array<token_spelling<Type>, Count>& entries)
+        : m_entries(entries)
+    {
+        for (std::uint32_t seed = 1; seed < 100000; ++seed) {
+            m_slots = {};
+            bool perfect = true;
+            for (std::size_t i = 0; i < Count && perfect; ++i) {
+                auto& slot = m_slots[hash(entries[i].text, seed)];
+                perfect = slot == 0;
+                slot = static_cast<std::uint8_t>(i + 1);
+            }
+            if (perfect) {
+                m_seed = seed;
+                return;
+            }
+        }
+        throw "no perfect hash for these spellings, add more slots";
+    }
+
+    NODISCARD constexpr std::optional<Type> find(std::string_view text) const noexcept {
+        if (text.empty()) {
+            return std::nullopt;
+        }
+        const auto slot = m_slots[hash(text, m_seed)];
+        if (slot == 0 || m_entries[slot - 1].text != text) {
+            return std::nullopt;
+        }
+        return m_entries[slot - 1].type;
+    }
+
+    NODISCARD constexpr bool contains(std::string_view text) const noexcept {
+        return find(text).has_value();
+    }
+private:
+    static constexpr std::size_t hash(std::string_view text, std::uint32_t seed) noexcept {
+        std::uint32_t h = seed ^ 0x811c9dc5u;
+        for (const char c : text) {
+            h = (h ^ static_cast<unsigned char>(c)) * 0x01000193u;
+        }
+        return (h ^ (h >> 15)) & (Slots - 1);
+    }
+};
+
+// The number of nodes a punctuator_trie of "entries" needs: the root and one for every
+// distinct prefix of a spelling.
+template<class Type, std::size_t Count>
+consteval std::size_t punctuator_trie_size(const std::array<token_spelling<Type>, Count>& entries) {
+    std::size_t nodes = 1;
+    for (std::size_t i = 0; i < Count; ++i) {
+        for (std::size_t length = 1; length <= entries[i].text.size(); ++length) {
+            bool seen = false;
+            for (std::size_t j = 0; j < i && !seen; ++j) {
+                seen = entries[j].text.size() >= length && entries[j].text.substr(0, length) == entries[i].text.substr(0, length);
+            }
+            nodes += !seen;
+        }
+    }
+    return nodes;
+}
+
+/*
+  Matches the longest punctuator at the start of some text, one array index per character.
+  Built while compiling from the spellings of the punctuators, only ASCII is allowed in them.
+*/
+template<class Type, std::size_t Nodes>
+class punctuator_trie {
+    static_assert(Nodes <= 256);
+public:
+    struct match {
+        Type type;
+        std::size_t length;
+    };
+private:
+    // the node after each character, 0 if there's none (the root is nobody's child).
+    std::array<std::array<std::uint8_t, 128>, Nodes> m_next{};
+    std::array<Type, Nodes> m_type{};
+    // whether the characters up to a node spell a punctuator, and not only start one.
+    std::array<bool, Nodes> m_complete{};
+public:
+    template<std::size_t Count>
+    consteval punctuator_trie(const std::array<token_spelling<Type>, Count>& entries) {
+        std::size_t used = 1;
+        for (const auto& entry : entries) {
+            std::size_t node = 0;
+            for (const char c : entry.text) {
+                if (static_cast<unsigned char>(c) >= 128) {
+                    throw "punctuators have to be ASCII";
+                }
+                auto& next = m_next[node][static_cast<unsigned char>(c)];
+                if (next == 0) {
+                    next = static_cast<std::uint8_t>(used++);
+                }
+                node = next;
+            }
+            m_type[node] = entry.type;
+            m_complete[node] = true;
+        }
+    }
+
+    NODISCARD constexpr std::optional<match> longest(std::string_view text) const noexcept {
+        std::optional<match> found{};
+        std::size_t node = 0;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 128 || m_next[node][c] == 0) {
+                break;
+            }
+            node = m_next[node][c];
+            if (m_complete[node]) {
+                found = match{ m_type[node], i + 1 };
+            }
+        }
+        return found;
+    }
+};
+
+// COMPILER_API_END
+
+#define _TOKEN_TABLES_HPP
+#endif // !_TOKEN_TABLES_HPP
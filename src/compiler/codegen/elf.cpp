@@ -0,0 +1,346 @@
+#include "elf.hpp"
+
+#include <cstring>
+#include <fstream>
+
+using namespace compiler;
+using namespace compiler::codegen;
+
+// NOTE: these mirror <elf.h>, it isn't available everywhere we build.
+namespace {
+
+struct elf64_header {
+    std::uint8_t ident[16];
+    std::uint16_t type;
+    std::uint16_t machine;
+    std::uint32_t version;
+    std::uint64_t entry;
+    std::uint64_t phoff;
+    std::uint64_t shoff;
+    std::uint32_t flags;
+    std::uint16_t ehsize;
+    std::uint16_t phentsize;
+    std::uint16_t phnum;
+    std::uint16_t shentsize;
+    std::uint16_t shnum;
+    std::uint16_t shstrndx;
+};
+
+struct elf64_section_header {
+    std::uint32_t name;
+    std::uint32_t type;
+    std::uint64_t flags;
+    std::uint64_t addr;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t link;
+    std::uint32_t info;
+    std::uint64_t addralign;
+    std::uint64_t entsize;
+};
+
+struct elf64_symbol {
+    std::uint32_t name;
+    std::uint8_t info;
+    std::uint8_t other;
+    std::uint16_t shndx;
+    std::uint64_t value;
+    std::uint64_t size;
+};
+
+struct elf64_rela {
+    std::uint64_t offset;
+    std::uint64_t info;
+    std::int64_t addend;
+};
+
+static_assert(sizeof(elf64_header) == 64);
+static_assert(sizeof(elf64_section_header) == 64);
+static_assert(sizeof(elf64_symbol) == 24);
+static_assert(sizeof(elf64_rela) == 24);
+
+constexpr std::uint16_t et_rel = 1;
+constexpr std::uint16_t em_x86_64 = 62;
+
+constexpr std::uint32_t sht_progbits = 1;
+constexpr std::uint32_t sht_symtab = 2;
+constexpr std::uint32_t sht_strtab = 3;
+constexpr std::uint32_t sht_rela = 4;
+constexpr std::uint32_t sht_nobits = 8;
+
+constexpr std::uint64_t shf_write = 0x1;
+constexpr std::uint64_t shf_alloc = 0x2;
+constexpr std::uint64_t shf_execinstr = 0x4;
+constexpr std::uint64_t shf_merge = 0x10;
+constexpr std::uint64_t shf_strings = 0x20;
+constexpr std::uint64_t shf_info_link = 0x40;
+
+constexpr std::uint8_t stb_local = 0;
+constexpr std::uint8_t stb_global = 1;
+constexpr std::uint8_t stt_notype = 0;
+constexpr std::uint8_t stt_object = 1;
+constexpr std::uint8_t stt_func = 2;
+constexpr std::uint8_t stt_section = 3;
+
+constexpr std::uint32_t r_x86_64_64 = 1;
+constexpr std::uint32_t r_x86_64_pc32 = 2;
+constexpr std::uint32_t r_x86_64_plt32 = 4;
+
+// A string table being built, offset 0 is always the empty string.
+class string_table {
+private:
+    std::vector<std::uint8_t> m_data{ 0 };
+public:
+    inline std::uint32_t add(const std::string& str) noexcept {
+        if (str.empty()) {
+            return 0;
+        }
+        const auto offset = static_cast<std::uint32_t>(m_data.size());
+        m_data.insert(m_data.end(), str.begin(), str.end());
+        m_data.push_back(0);
+        return offset;
+    }
+    inline const std::vector<std::uint8_t>& data() const noexcept { return m_data; }
+};
+
+template<class T>
+void append_pod(std::vector<std::uint8_t>& out, const T& value) noexcept {
+    const auto offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void align_to(std::vector<std::uint8_t>& out, std::uint64_t alignment) noexcept {
+    if (alignment > 1) {
+        out.resize((out.size() + alignment - 1) & ~(alignment - 1), 0);
+    }
+}
+
+std::uint32_t relocation_type(relocation_kind kind) noexcept {
+    switch (kind) {
+    case relocation_kind::abs64: return r_x86_64_64;
+    case relocation_kind::pc32: return r_x86_64_pc32;
+    case relocation_kind::plt32: return r_x86_64_plt32;
+    }
+    return 0;
+}
+
+} // namespace
+
+std::vector<std::uint8_t> codegen::build_elf(const object_file& object) noexcept {
+    const auto& sections = object.sections();
+    const auto& symbols = object.symbols();
+
+    // section header indices: 0 is null, then every section, then the relocation sections
+    // and finally the symbol table and friends.
+    const auto section_index = [](section_id id) { return static_cast<std::uint16_t>(id + 1); };
+
+    string_table strtab{};
+    string_table shstrtab{};
+
+    // the symbol table, every local has to come before the first global.
+    std::vector<elf64_symbol> symtab{};
+    symtab.push_back(elf64_symbol{});
+    for (section_id i = 0; i < sections.size(); ++i) {
+        elf64_symbol sym{};
+        sym.info = (stb_local << 4) | stt_section;
+        sym.shndx = section_index(i);
+        symtab.push_back(sym);
+    }
+
+    std::vector<std::uint32_t> symbol_index(symbols.size(), 0);
+    const auto add_symbols = [&](bool globals) {
+        for (object_symbol_id i = 0; i < symbols.size(); ++i) {
+            const auto& s = symbols[i];
+            // anything undefined has to be resolved by the linker, so it's always global.
+            const bool is_global = s.is_global || s.section == undefined_section;
+            if (is_global != globals) {
+                continue;
+            }
+            elf64_symbol sym{};
+            sym.name = strtab.add(s.name);
+            std::uint8_t type = stt_notype;
+            if (s.section != undefined_section) {
+                type = s.is_function ? stt_func : stt_object;
+            }
+            sym.info = static_cast<std::uint8_t>(((is_global ? stb_global : stb_local) << 4) | type);
+            sym.shndx = s.section == undefined_section ? 0 : section_index(s.section);
+            sym.value = s.offset;
+            sym.size = s.size;
+            symbol_index[i] = static_cast<std::uint32_t>(symtab.size());
+            symtab.push_back(sym);
+        }
+    };
+    add_symbols(false);
+    const auto first_global = static_cast<std::uint32_t>(symtab.size());
+    add_symbols(true);
+
+    std::vector<elf64_section_header> headers{};
+    headers.push_back(elf64_section_header{});
+
+    std::vector<std::uint8_t> out(sizeof(elf64_header), 0);
+
+    for (const auto& sec : sections) {
+        elf64_section_header header{};
+        header.name = shstrtab.add(sec.name);
+        header.addralign = sec.alignment;
+        switch (sec.kind) {
+        case section_kind::text:
+            header.type = sht_progbits;
+            header.flags = shf_alloc | shf_execinstr;
+            break;
+        case section_kind::data:
+            header.type = sht_progbits;
+            header.flags = shf_alloc | shf_write;
+            break;
+        case section_kind::rodata:
+            header.type = sht_progbits;
+            header.flags = shf_alloc;
+            if (sec.is_strings) {
+                header.flags |= shf_merge | shf_strings;
+                header.entsize = 1;
+            }
+            break;
+        case section_kind::bss:
+            header.type = sht_nobits;
+            header.flags = shf_alloc | shf_write;
+            break;
+        }
+
+        if (sec.kind != section_kind::bss) {
+            align_to(out, sec.alignment);
+            header.offset = out.size();
+            out.insert(out.end(), sec.data.begin(), sec.data.end());
+        }
+        else {
+            header.offset = out.size();
+        }
+        header.size = sec.size();
+        headers.push_back(header);
+    }
+
+    // the symbol table comes after all of the relocation sections.
+    std::uint32_t relocation_sections = 0;
+    for (const auto& sec : sections) {
+        relocation_sections += sec.relocations.empty() ? 0 : 1;
+    }
+    const auto symtab_index = static_cast<std::uint32_t>(headers.size() + relocation_sections);
+
+    for (section_id i = 0; i < sections.size(); ++i) {
+        const auto& sec = sections[i];
+        if (sec.relocations.empty()) {
+            continue;
+        }
+        align_to(out, 8);
+        elf64_section_header header{};
+        header.name = shstrtab.add(".rela" + sec.name);
+        header.type = sht_rela;
+        header.flags = shf_info_link;
+        header.offset = out.size();
+        header.size = sec.relocations.size() * sizeof(elf64_rela);
+        header.link = symtab_index;
+        header.info = section_index(i);
+        header.addralign = 8;
+        header.entsize = sizeof(elf64_rela);
+        for (const auto& reloc : sec.relocations) {
+            elf64_rela rela{};
+            rela.offset = reloc.offset;
+            rela.info = (static_cast<std::uint64_t>(symbol_index[reloc.symbol]) << 32) | relocation_type(reloc.kind);
+            rela.addend = reloc.addend;
+            append_pod(out, rela);
+        }
+        headers.push_back(header);
+    }
+
+    {
+        align_to(out, 8);
+        elf64_section_header header{};
+        header.name = shstrtab.add(".symtab");
+        header.type = sht_symtab;
+        header.offset = out.size();
+        header.size = symtab.size() * sizeof(elf64_symbol);
+        // the string table is always right after the symbol table.
+        header.link = symtab_index + 1;
+        header.info = first_global;
+        header.addralign = 8;
+        header.entsize = sizeof(elf64_symbol);
+        for (const auto& sym : symtab) {
+            append_pod(out, sym);
+        }
+        headers.push_back(header);
+    }
+    {
+        elf64_section_header header{};
+        header.name = shstrtab.add(".strtab");
+        header.type = sht_strtab;
+        header.offset = out.size();
+        header.size = strtab.data().size();
+        header.addralign = 1;
+        out.insert(out.end(), strtab.data().begin(), strtab.data().end());
+        headers.push_back(header);
+    }
+    {
+        // we never need an executable stack.
+        elf64_section_header header{};
+        header.name = shstrtab.add(".note.GNU-stack");
+        header.type = sht_progbits;
+        header.offset = out.size();
+        header.addralign = 1;
+        headers.push_back(header);
+    }
+
+    const auto shstrtab_index = static_cast<std::uint16_t>(headers.size());
+    {
+        elf64_section_header header{};
+        header.name = shstrtab.add(".shstrtab");
+        header.type = sht_strtab;
+        header.offset = out.size();
+        header.size = shstrtab.data().size();
+        header.addralign = 1;
+        out.insert(out.end(), shstrtab.data().begin(), shstrtab.data().end());
+        headers.push_back(header);
+    }
+
+    align_to(out, 8);
+    const auto section_headers_offset = out.size();
+    for (const auto& header : headers) {
+        append_pod(out, header);
+    }
+
+    elf64_header header{};
+    const std::uint8_t ident[] = {
+        0x7F, 'E', 'L', 'F',
+        2, // 64-bit
+        1, // little endian
+        1, // version
+        0, // System V ABI
+    };
+    std::memcpy(header.ident, ident, sizeof(ident));
+    header.type = et_rel;
+    header.machine = em_x86_64;
+    header.version = 1;
+    header.shoff = section_headers_offset;
+    header.ehsize = sizeof(elf64_header);
+    header.shentsize = sizeof(elf64_section_header);
+    header.shnum = static_cast<std::uint16_t>(headers.size());
+    header.shstrndx = shstrtab_index;
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    return out;
+}
+
+result<void, error> codegen::write_elf(const object_file& object, const std::string& path) noexcept {
+    return write_object(build_elf(object), path);
+}
+
+result<void, error> codegen::write_object(const std::vector<std::uint8_t>& bytes, const std::string& path) noexcept {
+    auto file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+    if (!file) {
+        return error("failed to open `{}` for writing.", path);
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        return error("failed to write `{}`.", path);
+    }
+    return {};
+}
@@ -0,0 +1,28 @@
+#ifndef _COMPILER_CODEGEN_ELF_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/result.hpp"
+#include "../../common/error.hpp"
+
+#include "object.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace codegen {
+
+// Serialize "object" as a relocatable ELF64 (x86-64) object file.
+NODISCARD std::vector<std::uint8_t> build_elf(const object_file& object) noexcept;
+
+// build_elf() and write the result to "path".
+NODISCARD result<void, error> write_elf(const object_file& object, const std::string& path) noexcept;
+// Write an object that has already been built to "path".
+NODISCARD result<void, error> write_object(const std::vector<std::uint8_t>& bytes, const std::string& path) noexcept;
+
+} // namespace codegen
+COMPILER_API_END
+
+#define _COMPILER_CODEGEN_ELF_HPP
+#endif // !_COMPILER_CODEGEN_ELF_HPP
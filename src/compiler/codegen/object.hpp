@@ -0,0 +1,139 @@
+#ifndef _COMPILER_CODEGEN_OBJECT_HPP
+
+#include "../../common/common.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace codegen {
+
+using section_id = std::uint32_t;
+using object_symbol_id = std::uint32_t;
+
+inline constexpr section_id undefined_section = ~std::uint32_t{ 0 };
+
+enum class section_kind : std::uint8_t {
+    // code, read + execute.
+    text,
+    // initialized data, read + write.
+    data,
+    // read only data.
+    rodata,
+    // zero initialized data, it takes up no space in the file.
+    bss,
+};
+
+// The relocations we emit, these map 1:1 onto the x86-64 ELF relocation types.
+enum class relocation_kind : std::uint8_t {
+    // S + A, 64-bit absolute address.
+    abs64,
+    // S + A - P, 32-bit pc relative.
+    pc32,
+    // L + A - P, a call through the PLT (or straight to the symbol if it's local).
+    plt32,
+};
+
+struct relocation {
+    // offset inside of the section being patched.
+    std::uint64_t offset;
+    object_symbol_id symbol;
+    relocation_kind kind;
+    std::int64_t addend;
+};
+
+struct section {
+    std::string name;
+    section_kind kind;
+    std::uint64_t alignment{ 1 };
+    std::vector<std::uint8_t> data{};
+    // only used by bss sections, everything else is the size of data.
+    std::uint64_t bss_size{ 0 };
+    std::vector<relocation> relocations{};
+
+    // merge-able null terminated strings, the linker deduplicates these across objects.
+    bool is_strings{ false };
+
+    inline std::uint64_t size() const noexcept {
+        return kind == section_kind::bss ? bss_size : data.size();
+    }
+};
+
+struct object_symbol {
+    std::string name;
+    // undefined_section if it's defined in another object.
+    section_id section{ undefined_section };
+    std::uint64_t offset{ 0 };
+    std::uint64_t size{ 0 };
+    bool is_global{ true };
+    bool is_function{ false };
+};
+
+/*
+  A relocatable object in memory, independent of the file format. The backend fills this
+  in, then it's written out with write_elf().
+*/
+class object_file {
+private:
+    std::vector<section> m_sections{};
+    std::vector<object_symbol> m_symbols{};
+    std::unordered_map<std::string, object_symbol_id> m_symbol_lookup{};
+public:
+    inline section_id add_section(const std::string& name, section_kind kind, std::uint64_t alignment) noexcept {
+        m_sections.push_back(section{ name, kind, alignment });
+        return static_cast<section_id>(m_sections.size() - 1);
+    }
+
+    // Find a section by name, undefined_section if it doesn't exist.
+    inline section_id find_section(const std::string& name) const noexcept {
+        for (section_id i = 0; i < m_sections.size(); ++i) {
+            if (m_sections[i].name == name) {
+                return i;
+            }
+        }
+        return undefined_section;
+    }
+
+    inline section& get_section(section_id id) noexcept { return m_sections[id]; }
+    inline const section& get_section(section_id id) const noexcept { return m_sections[id]; }
+    inline const std::vector<section>& sections() const noexcept { return m_sections; }
+
+    // Get the symbol named "name", it starts out undefined.
+    inline object_symbol_id intern_symbol(const std::string& name) noexcept {
+        if (auto it = m_symbol_lookup.find(name); it != m_symbol_lookup.end()) {
+            return it->second;
+        }
+        m_symbols.push_back(object_symbol{ name });
+        const auto id = static_cast<object_symbol_id>(m_symbols.size() - 1);
+        m_symbol_lookup.emplace(name, id);
+        return id;
+    }
+
+    inline object_symbol& get_symbol(object_symbol_id id) noexcept { return m_symbols[id]; }
+    inline const object_symbol& get_symbol(object_symbol_id id) const noexcept { return m_symbols[id]; }
+    inline const std::vector<object_symbol>& symbols() const noexcept { return m_symbols; }
+
+    // Pad "section" up to "alignment" and return the new end.
+    inline std::uint64_t align_section(section_id id, std::uint64_t alignment) noexcept {
+        auto& sec = m_sections[id];
+        if (alignment > sec.alignment) {
+            sec.alignment = alignment;
+        }
+        if (sec.kind == section_kind::bss) {
+            sec.bss_size = (sec.bss_size + alignment - 1) & ~(alignment - 1);
+            return sec.bss_size;
+        }
+        const auto aligned = (sec.data.size() + alignment - 1) & ~(alignment - 1);
+        // pad code with int3, so a bad jump traps instead of sliding.
+        sec.data.resize(aligned, sec.kind == section_kind::text ? 0xCC : 0x00);
+        return aligned;
+    }
+};
+
+} // namespace codegen
+COMPILER_API_END
+
+#define _COMPILER_CODEGEN_OBJECT_HPP
+#endif // !_COMPILER_CODEGEN_OBJECT_HPP
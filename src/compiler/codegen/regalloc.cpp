@@ -0,0 +1,556 @@
+#include "regalloc.hpp"
+
+#include "../ir/use_lists.hpp"
+
+#include <algorithm>
+
+using namespace compiler;
+using namespace compiler::codegen;
+using namespace compiler::ir;
+
+linear_scan::linear_scan(const function& fn, const cfg& cfg, const register_info& regs) noexcept
+    : m_fn(fn)
+    , m_cfg(cfg)
+    , m_regs(regs)
+{}
+
+bool linear_scan::needs_location(const instruction& inst) noexcept {
+    switch (inst.op) {
+    case opcode::iconst:
+    case opcode::alloca:
+    case opcode::global_addr:
+    case opcode::undef:
+    case opcode::nop:
+        return false;
+    default:
+        return inst.type != value_type::void_;
+    }
+}
+
+void linear_scan::run() noexcept {
+    number_instructions();
+    build_intervals();
+    allocate();
+    collect_split_moves();
+}
+
+void linear_scan::number_instructions() noexcept {
+    const auto values = m_fn.value_count();
+    const auto blocks = m_fn.block_count();
+    m_position.assign(values, max_position);
+    m_block_from.assign(blocks, max_position);
+    m_block_to.assign(blocks, max_position);
+    m_is_block_start.clear();
+
+    // position 0 and 1 are before the first instruction, parameters are defined at 1.
+    std::uint32_t index = 1;
+    m_is_block_start.push_back(false);
+    for (const auto block : m_cfg.rpo()) {
+        m_block_from[block] = index * 2;
+        bool first = true;
+        m_fn.for_each_inst(block, [&](value_id id) {
+            m_position[id] = index * 2;
+            m_is_block_start.push_back(first);
+            first = false;
+            if (m_fn.inst(id).op == opcode::call) {
+                m_call_clobbers.push_back(index * 2 + 1);
+            }
+            ++index;
+        });
+        m_block_to[block] = index * 2;
+    }
+}
+
+void linear_scan::build_intervals() noexcept {
+    const auto values = m_fn.value_count();
+    const auto blocks = m_fn.block_count();
+    const use_lists uses{ m_fn };
+
+    m_first_interval.assign(values, invalid_id);
+    m_spill_slot.assign(values, -1);
+    m_live_in.assign(blocks, {});
+
+    m_hint.assign(values, invalid_id);
+    for (const auto block : m_cfg.rpo()) {
+        m_fn.for_each_inst(block, [&](value_id id) {
+            const auto& inst = m_fn.inst(id);
+            if (inst.op != opcode::phi) {
+                return;
+            }
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                auto& hint = m_hint[m_fn.operand(id, i)];
+                hint = hint == invalid_id ? id : hint;
+            }
+        });
+    }
+
+    // the last value that marked a block as live-out/live-in, so each is only visited once.
+    std::vector<value_id> live_out_stamp(blocks, invalid_id);
+    std::vector<value_id> live_in_stamp(blocks, invalid_id);
+    std::vector<block_id> worklist;
+
+    for (const auto def_block : m_cfg.rpo()) {
+        m_fn.for_each_inst(def_block, [&](value_id id) {
+            const auto& inst = m_fn.inst(id);
+            if (!needs_location(inst)) {
+                return;
+            }
+
+            position def;
+            switch (inst.op) {
+            case opcode::param: def = 1; break;
+            // phis are written on the incoming edges, before anything in the block runs.
+            case opcode::phi: def = m_block_from[def_block]; break;
+            default: def = m_position[id] + 1; break;
+            }
+
+            const auto ranges_begin = static_cast<std::uint32_t>(m_ranges.size());
+            const auto uses_begin = static_cast<std::uint32_t>(m_uses.size());
+
+            const auto mark_live_in = [&](block_id block) {
+                if (live_in_stamp[block] == id) {
+                    return;
+                }
+                live_in_stamp[block] = id;
+                m_live_in[block].push_back(id);
+                for (const auto pred : m_cfg.preds(block)) {
+                    if (m_cfg.is_reachable(pred)) {
+                        worklist.push_back(pred);
+                    }
+                }
+            };
+
+            for (const auto& use : uses.uses(id)) {
+                const auto& user = m_fn.inst(use.user);
+                if (user.block == invalid_id || !m_cfg.is_reachable(user.block)) {
+                    continue;
+                }
+                // a phi reads its operand at the end of the incoming block.
+                if (user.op == opcode::phi) {
+                    const auto pred = m_fn.target(use.user, use.index);
+                    if (m_cfg.is_reachable(pred)) {
+                        m_uses.push_back(m_block_to[pred] - 2);
+                        worklist.push_back(pred);
+                    }
+                    continue;
+                }
+
+                const auto pos = m_position[use.user];
+                m_uses.push_back(pos);
+                if (user.block == def_block) {
+                    m_ranges.push_back(live_range{ def, pos + 1 });
+                }
+                else {
+                    m_ranges.push_back(live_range{ m_block_from[user.block], pos + 1 });
+                    mark_live_in(user.block);
+                }
+            }
+
+            // walk back up to the definition, every block on the way is live-out.
+            while (!worklist.empty()) {
+                const auto block = worklist.back();
+                worklist.pop_back();
+                if (live_out_stamp[block] == id) {
+                    continue;
+                }
+                live_out_stamp[block] = id;
+                if (block == def_block) {
+                    m_ranges.push_back(live_range{ def, m_block_to[block] });
+                    continue;
+                }
+                m_ranges.push_back(live_range{ m_block_from[block], m_block_to[block] });
+                mark_live_in(block);
+            }
+
+            if (m_ranges.size() == ranges_begin) {
+                // never used, it doesn't need a location.
+                m_uses.resize(uses_begin);
+                return;
+            }
+
+            // sort and merge the ranges.
+            const auto first = m_ranges.begin() + ranges_begin;
+            std::sort(first, m_ranges.end(), [](const live_range& a, const live_range& b) { return a.from < b.from; });
+            auto out = ranges_begin;
+            for (auto i = ranges_begin + 1; i < m_ranges.size(); ++i) {
+                if (m_ranges[i].from <= m_ranges[out].to) {
+                    m_ranges[out].to = std::max(m_ranges[out].to, m_ranges[i].to);
+                }
+                else {
+                    m_ranges[++out] = m_ranges[i];
+                }
+            }
+            m_ranges.resize(out + 1);
+            std::sort(m_uses.begin() + uses_begin, m_uses.end());
+
+            interval it{};
+            it.value = id;
+            it.ranges_begin = ranges_begin;
+            it.ranges_end = static_cast<std::uint32_t>(m_ranges.size());
+            it.lo = m_ranges[ranges_begin].from;
+            it.hi = m_ranges.back().to;
+            it.uses_begin = uses_begin;
+            it.uses_end = static_cast<std::uint32_t>(m_uses.size());
+            m_first_interval[id] = static_cast<std::uint32_t>(m_intervals.size());
+            m_intervals.push_back(it);
+        });
+    }
+}
+
+bool linear_scan::covers(std::uint32_t it, position pos) const noexcept {
+    const auto& iv = m_intervals[it];
+    if (pos < iv.lo || pos >= iv.hi) {
+        return false;
+    }
+    // the last range that starts at or before "pos".
+    const auto begin = m_ranges.begin() + iv.ranges_begin;
+    const auto end = m_ranges.begin() + iv.ranges_end;
+    auto found = std::upper_bound(begin, end, pos, [](position p, const live_range& r) { return p < r.from; });
+    if (found == begin) {
+        return false;
+    }
+    return pos < (found - 1)->to;
+}
+
+position linear_scan::first_intersection(std::uint32_t a, std::uint32_t b) const noexcept {
+    const auto& x = m_intervals[a];
+    const auto& y = m_intervals[b];
+    const auto lo = std::max(x.lo, y.lo);
+    const auto hi = std::min(x.hi, y.hi);
+    if (lo >= hi) {
+        return max_position;
+    }
+
+    // skip the ranges that end before both intervals exist.
+    const auto skip = [&](const interval& iv) {
+        const auto begin = m_ranges.begin() + iv.ranges_begin;
+        const auto end = m_ranges.begin() + iv.ranges_end;
+        return static_cast<std::uint32_t>(std::upper_bound(begin, end, lo, [](position p, const live_range& r) { return p < r.to; }) - m_ranges.begin());
+    };
+    auto i = skip(x);
+    auto j = skip(y);
+    while (i < x.ranges_end && j < y.ranges_end) {
+        const auto from = std::max({ m_ranges[i].from, m_ranges[j].from, lo });
+        const auto to = std::min({ m_ranges[i].to, m_ranges[j].to, hi });
+        if (from >= hi) {
+            break;
+        }
+        if (from < to) {
+            return from;
+        }
+        if (m_ranges[i].to < m_ranges[j].to) {
+            ++i;
+        }
+        else {
+            ++j;
+        }
+    }
+    return max_position;
+}
+
+position linear_scan::next_use(std::uint32_t it, position pos) const noexcept {
+    const auto& iv = m_intervals[it];
+    const auto begin = m_uses.begin() + iv.uses_begin;
+    const auto end = m_uses.begin() + iv.uses_end;
+    const auto found = std::lower_bound(begin, end, pos);
+    return found == end ? max_position : *found;
+}
+
+position linear_scan::next_clobber(position pos) const noexcept {
+    const auto found = std::upper_bound(m_call_clobbers.begin(), m_call_clobbers.end(), pos);
+    return found == m_call_clobbers.end() ? max_position : *found;
+}
+
+std::uint32_t linear_scan::split(std::uint32_t it, position pos) noexcept {
+    auto child = m_intervals[it];
+    auto& parent = m_intervals[it];
+
+    // the first range that ends after "pos", if "pos" is inside of it both halves share it
+    // and their bounds (lo/hi) cut it in two.
+    const auto begin = m_ranges.begin() + parent.ranges_begin;
+    const auto end = m_ranges.begin() + parent.ranges_end;
+    const auto k = static_cast<std::uint32_t>(std::upper_bound(begin, end, pos, [](position p, const live_range& r) { return p < r.to; }) - m_ranges.begin());
+
+    child.ranges_begin = k;
+    child.lo = pos;
+    parent.ranges_end = m_ranges[k].from < pos ? k + 1 : k;
+    parent.hi = pos;
+
+    const auto ubegin = m_uses.begin() + parent.uses_begin;
+    const auto uend = m_uses.begin() + parent.uses_end;
+    const auto u = static_cast<std::uint32_t>(std::lower_bound(ubegin, uend, pos) - m_uses.begin());
+    child.uses_begin = u;
+    parent.uses_end = u;
+
+    child.loc = location{};
+    child.next_sibling = parent.next_sibling;
+    const auto id = static_cast<std::uint32_t>(m_intervals.size());
+    parent.next_sibling = id;
+    m_intervals.push_back(child);
+    return id;
+}
+
+std::int32_t linear_scan::spill_slot(value_id value) noexcept {
+    if (m_spill_slot[value] < 0) {
+        const auto size = static_cast<std::int32_t>(size_of(m_fn.inst(value).type));
+        m_spill_slot[value] = m_slot_count;
+        m_slot_count += std::max((size + 7) / 8, 1);
+    }
+    return m_spill_slot[value];
+}
+
+void linear_scan::push_unhandled(std::vector<std::uint32_t>& unhandled, std::uint32_t it) const noexcept {
+    unhandled.push_back(it);
+    std::push_heap(unhandled.begin(), unhandled.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return start_of(a) > start_of(b);
+    });
+}
+
+void linear_scan::spill_from(std::uint32_t it, position pos, std::vector<std::uint32_t>& unhandled) noexcept {
+    const auto child = pos <= start_of(it) ? it : split(it, pos);
+    m_intervals[child].loc = location::in_slot(spill_slot(m_intervals[child].value));
+
+    // stay on the stack until the next use, then try for a register again.
+    const auto start = start_of(child);
+    const auto use = next_use(child, start + 1);
+    if (use == max_position) {
+        return;
+    }
+    const auto at = use & ~position{ 1 };
+    if (at > start && at < end_of(child)) {
+        push_unhandled(unhandled, split(child, at));
+    }
+}
+
+bool linear_scan::try_allocate_free(
+    std::uint32_t it,
+    const std::vector<std::uint32_t>& active,
+    const std::vector<std::uint32_t>& inactive,
+    std::vector<std::uint32_t>& unhandled
+) noexcept {
+    const auto start = start_of(it);
+    const auto end = end_of(it);
+
+    const auto& regs = candidates(it);
+    position free_until[32];
+    std::fill(std::begin(free_until), std::end(free_until), 0);
+    const auto clobber = next_clobber(start);
+    for (const auto r : regs) {
+        free_until[r] = m_regs.is_caller_saved(r) ? clobber : max_position;
+    }
+    for (const auto other : active) {
+        free_until[m_intervals[other].loc.reg] = 0;
+    }
+    for (const auto other : inactive) {
+        const auto at = first_intersection(other, it);
+        auto& until = free_until[m_intervals[other].loc.reg];
+        until = std::min(until, at);
+    }
+
+    // the register of the phi we flow into, then the first one (in order of preference)
+    // that fits entirely.
+    const auto hint = m_hint[m_intervals[it].value];
+    if (hint != invalid_id) {
+        const auto loc = definition_of(hint);
+        if (loc.is_reg() && free_until[loc.reg] >= end && std::find(regs.begin(), regs.end(), loc.reg) != regs.end()) {
+            m_intervals[it].loc = loc;
+            m_used_registers |= 1u << loc.reg;
+            return true;
+        }
+    }
+    std::uint8_t best = regs.front();
+    for (const auto r : regs) {
+        if (free_until[r] >= end) {
+            m_intervals[it].loc = location::in_reg(r);
+            m_used_registers |= 1u << r;
+            return true;
+        }
+        if (free_until[r] > free_until[best]) {
+            best = r;
+        }
+    }
+
+    // otherwise use the one that's free for the longest, if that covers the next use.
+    const auto split_at = free_until[best] & ~position{ 1 };
+    if (split_at <= start || next_use(it, start) >= split_at) {
+        return false;
+    }
+    m_intervals[it].loc = location::in_reg(best);
+    m_used_registers |= 1u << best;
+    push_unhandled(unhandled, split(it, split_at));
+    return true;
+}
+
+void linear_scan::allocate_blocked(
+    std::uint32_t it,
+    std::vector<std::uint32_t>& active,
+    std::vector<std::uint32_t>& inactive,
+    std::vector<std::uint32_t>& unhandled
+) noexcept {
+    const auto start = start_of(it);
+    const auto end = end_of(it);
+
+    const auto& regs = candidates(it);
+    position use_pos[32];
+    position block_pos[32];
+    std::fill(std::begin(use_pos), std::end(use_pos), 0);
+    std::fill(std::begin(block_pos), std::end(block_pos), 0);
+    const auto clobber = next_clobber(start);
+    for (const auto r : regs) {
+        use_pos[r] = block_pos[r] = m_regs.is_caller_saved(r) ? clobber : max_position;
+    }
+    for (const auto other : active) {
+        auto& pos = use_pos[m_intervals[other].loc.reg];
+        pos = std::min(pos, next_use(other, start));
+    }
+    for (const auto other : inactive) {
+        if (first_intersection(other, it) == max_position) {
+            continue;
+        }
+        auto& pos = use_pos[m_intervals[other].loc.reg];
+        pos = std::min(pos, next_use(other, start));
+    }
+
+    std::uint8_t best = regs.front();
+    for (const auto r : regs) {
+        if (use_pos[r] > use_pos[best]) {
+            best = r;
+        }
+    }
+
+    // every register is needed before we need one, so we're the one that waits.
+    const auto first_use = next_use(it, start);
+    if (first_use == max_position || use_pos[best] < first_use) {
+        spill_from(it, start, unhandled);
+        return;
+    }
+
+    // take the register from whoever has it, they wait on the stack until their next use.
+    m_intervals[it].loc = location::in_reg(best);
+    m_used_registers |= 1u << best;
+    const auto evict_at = start & ~position{ 1 };
+    for (std::size_t i = 0; i < active.size();) {
+        const auto other = active[i];
+        if (m_intervals[other].loc.is_reg() && m_intervals[other].loc.reg == best) {
+            spill_from(other, evict_at, unhandled);
+            active[i] = active.back();
+            active.pop_back();
+            continue;
+        }
+        ++i;
+    }
+    for (std::size_t i = 0; i < inactive.size();) {
+        const auto other = inactive[i];
+        if (m_intervals[other].loc.is_reg() && m_intervals[other].loc.reg == best) {
+            const auto at = first_intersection(other, it);
+            if (at != max_position) {
+                spill_from(other, at & ~position{ 1 }, unhandled);
+                inactive[i] = inactive.back();
+                inactive.pop_back();
+                continue;
+            }
+        }
+        ++i;
+    }
+
+    // a call clobbers the register before we're done with it.
+    if (block_pos[best] < end) {
+        const auto split_at = block_pos[best] & ~position{ 1 };
+        if (split_at > start) {
+            push_unhandled(unhandled, split(it, split_at));
+        }
+        else {
+            spill_from(it, start, unhandled);
+        }
+    }
+}
+
+void linear_scan::allocate() noexcept {
+    std::vector<std::uint32_t> unhandled;
+    std::vector<std::uint32_t> active;
+    std::vector<std::uint32_t> inactive;
+
+    unhandled.reserve(m_intervals.size());
+    for (std::uint32_t i = 0; i < m_intervals.size(); ++i) {
+        unhandled.push_back(i);
+    }
+    const auto later = [&](std::uint32_t a, std::uint32_t b) { return start_of(a) > start_of(b); };
+    std::make_heap(unhandled.begin(), unhandled.end(), later);
+
+    while (!unhandled.empty()) {
+        std::pop_heap(unhandled.begin(), unhandled.end(), later);
+        const auto current = unhandled.back();
+        unhandled.pop_back();
+        const auto pos = start_of(current);
+
+        for (std::size_t i = 0; i < active.size();) {
+            const auto it = active[i];
+            if (end_of(it) <= pos || !covers(it, pos)) {
+                if (end_of(it) > pos) {
+                    inactive.push_back(it);
+                }
+                active[i] = active.back();
+                active.pop_back();
+                continue;
+            }
+            ++i;
+        }
+        for (std::size_t i = 0; i < inactive.size();) {
+            const auto it = inactive[i];
+            if (end_of(it) <= pos || covers(it, pos)) {
+                if (end_of(it) > pos) {
+                    active.push_back(it);
+                }
+                inactive[i] = inactive.back();
+                inactive.pop_back();
+                continue;
+            }
+            ++i;
+        }
+
+        if (!try_allocate_free(current, active, inactive, unhandled)) {
+            allocate_blocked(current, active, inactive, unhandled);
+        }
+        if (m_intervals[current].loc.is_reg()) {
+            active.push_back(current);
+        }
+    }
+}
+
+void linear_scan::collect_split_moves() noexcept {
+    for (value_id value = 0; value < m_first_interval.size(); ++value) {
+        auto prev = m_first_interval[value];
+        if (prev == invalid_id) {
+            continue;
+        }
+        for (auto next = m_intervals[prev].next_sibling; next != invalid_id; prev = next, next = m_intervals[next].next_sibling) {
+            const auto at = start_of(next);
+            // a gap between the two is a lifetime hole, and block boundaries are handled
+            // on the edges by the backend.
+            if (end_of(prev) != at || m_is_block_start[at / 2]) {
+                continue;
+            }
+            if (m_intervals[prev].loc == m_intervals[next].loc) {
+                continue;
+            }
+            m_moves.push_back(split_move{ at, value, m_intervals[prev].loc, m_intervals[next].loc });
+        }
+    }
+    std::stable_sort(m_moves.begin(), m_moves.end(), [](const split_move& a, const split_move& b) { return a.at < b.at; });
+}
+
+location linear_scan::location_at(value_id value, position pos) const noexcept {
+    auto it = m_first_interval[value];
+    if (it == invalid_id) {
+        return location{};
+    }
+    for (auto next = m_intervals[it].next_sibling; next != invalid_id && start_of(next) <= pos; next = m_intervals[next].next_sibling) {
+        it = next;
+    }
+    return m_intervals[it].loc;
+}
+
+location linear_scan::definition_of(value_id value) const noexcept {
+    const auto it = m_first_interval[value];
+    return it == invalid_id ? location{} : m_intervals[it].loc;
+}
@@ -0,0 +1,210 @@
+#ifndef _COMPILER_CODEGEN_REGALLOC_HPP
+
+#include "../../common/common.hpp"
+
+#include "../ir/ir.hpp"
+#include "../ir/cfg.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace codegen {
+
+// A point in the linearized function. Instruction "i" (in block layout order) reads its
+// operands at 2i and writes its result at 2i + 1.
+using position = std::uint32_t;
+inline constexpr position max_position = ~std::uint32_t{ 0 };
+
+// [from, to)
+struct live_range {
+    position from;
+    position to;
+};
+
+// Where a value lives.
+struct location {
+    enum class kind : std::uint8_t {
+        // dead, or rematerialized at every use.
+        none,
+        reg,
+        // a spill slot, "index" is the slot number.
+        stack,
+        // a fixed frame offset, only used by the backend for incoming arguments.
+        frame,
+    };
+
+    kind type{ kind::none };
+    std::uint8_t reg{ 0 };
+    std::int32_t index{ 0 };
+
+    static inline location in_reg(std::uint8_t r) noexcept { return location{ kind::reg, r, 0 }; }
+    static inline location in_slot(std::int32_t slot) noexcept { return location{ kind::stack, 0, slot }; }
+    static inline location in_frame(std::int32_t offset) noexcept { return location{ kind::frame, 0, offset }; }
+
+    inline bool is_none() const noexcept { return type == kind::none; }
+    inline bool is_reg() const noexcept { return type == kind::reg; }
+    inline bool operator==(const location& other) const noexcept {
+        return type == other.type && (type == kind::reg ? reg == other.reg : index == other.index);
+    }
+};
+
+// The registers the allocator can hand out, this is what makes it target independent.
+struct register_info {
+    // in order of preference.
+    std::vector<std::uint8_t> allocatable{};
+    // the registers for vector values, in order of preference. They're numbered after the
+    // integer registers.
+    std::vector<std::uint8_t> vector_allocatable{};
+    // bit "r" is set if register "r" is clobbered by a call.
+    std::uint32_t caller_saved{ 0 };
+    // the amount of registers in the target, registers are numbered below this.
+    std::uint8_t count{ 0 };
+
+    inline bool is_caller_saved(std::uint8_t r) const noexcept { return (caller_saved >> r) & 1; }
+};
+
+// A value moving from one location to another between two pieces of a split interval.
+struct split_move {
+    position at;
+    ir::value_id value;
+    location from;
+    location to;
+};
+
+/*
+  Linear scan register allocation on SSA form.
+
+  Liveness is computed per value by walking backwards from each use to the definition,
+  so it's proportional to the size of the live ranges, there are no bitsets and no
+  iteration to a fixed point. The intervals have lifetime holes, and the allocator splits
+  them instead of spilling a value everywhere: a value that loses its register goes to
+  the stack until its next use, and then gets another chance at a register.
+
+  Calls clobber the caller saved registers, so intervals that are live across a call end
+  up in callee saved registers (or are split around the call).
+
+  Vector values are allocated from their own registers, but they're all in the same pass.
+  A value that flows into a phi tries the phi's register first, so a loop's back edge
+  doesn't have to move anything.
+
+  The allocator only decides where values live. The backend reads the locations back,
+  emits the moves between split pieces (split_moves()) and resolves the moves needed on
+  control flow edges and for phis, which is just comparing locations at the end of the
+  predecessor and the start of the successor.
+*/
+class linear_scan {
+private:
+    struct interval {
+        ir::value_id value;
+        // m_ranges[ranges_begin, ranges_end), sorted and non-overlapping.
+        std::uint32_t ranges_begin;
+        std::uint32_t ranges_end;
+        // [lo, hi) clips the ranges, splitting inside of a range leaves it shared by both
+        // halves instead of copying everything after it.
+        position lo;
+        position hi;
+        // m_uses[uses_begin, uses_end), sorted.
+        std::uint32_t uses_begin;
+        std::uint32_t uses_end;
+        location loc{};
+        // the piece that was split off of the end of this one.
+        std::uint32_t next_sibling{ ir::invalid_id };
+    };
+
+    const ir::function& m_fn;
+    const ir::cfg& m_cfg;
+    const register_info& m_regs;
+
+    std::vector<position> m_position{};
+    std::vector<position> m_block_from{};
+    std::vector<position> m_block_to{};
+    // bit per instruction index, set if that instruction starts a block.
+    std::vector<bool> m_is_block_start{};
+    std::vector<position> m_call_clobbers{};
+
+    std::vector<live_range> m_ranges{};
+    std::vector<position> m_uses{};
+    std::vector<interval> m_intervals{};
+    // value -> its first interval, invalid_id if it doesn't need one.
+    std::vector<std::uint32_t> m_first_interval{};
+    std::vector<std::vector<ir::value_id>> m_live_in{};
+
+    // value -> a phi it flows into, invalid_id if there isn't one.
+    std::vector<ir::value_id> m_hint{};
+
+    std::vector<std::int32_t> m_spill_slot{};
+    std::int32_t m_slot_count{ 0 };
+    std::uint32_t m_used_registers{ 0 };
+
+    std::vector<split_move> m_moves{};
+public:
+    linear_scan(const ir::function& fn, const ir::cfg& cfg, const register_info& regs) noexcept;
+
+    void run() noexcept;
+
+    // Does this value get a location at all? Constants, allocas, global addresses and undef
+    // are rematerialized where they're used instead.
+    static bool needs_location(const ir::instruction& inst) noexcept;
+
+    inline position position_of(ir::value_id id) const noexcept { return m_position[id]; }
+    inline position block_from(ir::block_id block) const noexcept { return m_block_from[block]; }
+    inline position block_to(ir::block_id block) const noexcept { return m_block_to[block]; }
+
+    // Where "value" is at "pos".
+    location location_at(ir::value_id value, position pos) const noexcept;
+    // Where "value" is when it's defined.
+    location definition_of(ir::value_id value) const noexcept;
+
+    // Values that are live when "block" starts (not counting its phis).
+    inline const std::vector<ir::value_id>& live_in(ir::block_id block) const noexcept { return m_live_in[block]; }
+    // Sorted by position, these go right before the instruction at that position.
+    inline const std::vector<split_move>& split_moves() const noexcept { return m_moves; }
+
+    // Spill slots are 8 bytes, vectors take as many consecutive slots as they need.
+    inline std::int32_t spill_slot_count() const noexcept { return m_slot_count; }
+    // bit "r" is set if register "r" was handed out at least once.
+    inline std::uint32_t used_registers() const noexcept { return m_used_registers; }
+private:
+    void number_instructions() noexcept;
+    void build_intervals() noexcept;
+    void allocate() noexcept;
+    void collect_split_moves() noexcept;
+
+    inline position start_of(std::uint32_t it) const noexcept {
+        const auto& iv = m_intervals[it];
+        return std::max(m_ranges[iv.ranges_begin].from, iv.lo);
+    }
+    inline position end_of(std::uint32_t it) const noexcept {
+        const auto& iv = m_intervals[it];
+        return std::min(m_ranges[iv.ranges_end - 1].to, iv.hi);
+    }
+    // The registers "it" can go in.
+    inline const std::vector<std::uint8_t>& candidates(std::uint32_t it) const noexcept {
+        return ir::is_vector(m_fn.inst(m_intervals[it].value).type) ? m_regs.vector_allocatable : m_regs.allocatable;
+    }
+    bool covers(std::uint32_t it, position pos) const noexcept;
+    // The first position both intervals are live at, max_position if they never are.
+    position first_intersection(std::uint32_t a, std::uint32_t b) const noexcept;
+    // The first use at or after "pos", max_position if there isn't one.
+    position next_use(std::uint32_t it, position pos) const noexcept;
+    // The first call after "pos" that clobbers the caller saved registers.
+    position next_clobber(position pos) const noexcept;
+
+    // Split "it" at "pos", the new interval (starting at "pos") is returned.
+    std::uint32_t split(std::uint32_t it, position pos) noexcept;
+    // "it" loses its register from "pos" on, it waits on the stack until its next use.
+    void spill_from(std::uint32_t it, position pos, std::vector<std::uint32_t>& unhandled) noexcept;
+    std::int32_t spill_slot(ir::value_id value) noexcept;
+
+    bool try_allocate_free(std::uint32_t it, const std::vector<std::uint32_t>& active, const std::vector<std::uint32_t>& inactive, std::vector<std::uint32_t>& unhandled) noexcept;
+    void allocate_blocked(std::uint32_t it, std::vector<std::uint32_t>& active, std::vector<std::uint32_t>& inactive, std::vector<std::uint32_t>& unhandled) noexcept;
+    void push_unhandled(std::vector<std::uint32_t>& unhandled, std::uint32_t it) const noexcept;
+};
+
+} // namespace codegen
+COMPILER_API_END
+
+#define _COMPILER_CODEGEN_REGALLOC_HPP
+#endif // !_COMPILER_CODEGEN_REGALLOC_HPP
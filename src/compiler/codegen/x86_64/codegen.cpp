@@ -0,0 +1,1315 @@
+#include "codegen.hpp"
+#include "encoder.hpp"
+
+#include "../regalloc.hpp"
+#include "../../ir/cfg.hpp"
+
+#include <bit>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+using namespace compiler;
+using namespace compiler::codegen;
+using namespace compiler::codegen::x86_64;
+using namespace compiler::ir;
+
+namespace {
+
+// SysV: the first six integer arguments are passed in these.
+constexpr reg argument_registers[] = { reg::rdi, reg::rsi, reg::rdx, reg::rcx, reg::r8, reg::r9 };
+
+// The width arithmetic on "type" is done at, anything smaller than 32 bits is done at 32 bits.
+width op_width(value_type type) noexcept {
+    return (type == value_type::i64 || type == value_type::ptr) ? width::b64 : width::b32;
+}
+
+// The width of "type" in memory.
+width mem_width(value_type type) noexcept {
+    switch (type) {
+    case value_type::i1:
+    case value_type::i8: return width::b8;
+    case value_type::i16: return width::b16;
+    case value_type::i32: return width::b32;
+    default: return width::b64;
+    }
+}
+
+// The vector registers come after the integer ones in register_info.
+constexpr std::uint8_t first_vector = reg_count;
+
+inline bool is_vector_register(const location& loc) noexcept { return loc.is_reg() && loc.reg >= first_vector; }
+inline xmm vector_register(const location& loc) noexcept { return static_cast<xmm>(loc.reg - first_vector); }
+inline location in_vector_register(xmm r) noexcept { return location::in_reg(static_cast<std::uint8_t>(first_vector + encoding(r))); }
+
+inline vec_width vector_width(value_type type) noexcept {
+    return size_of(type) == 32 ? vec_width::v256 : vec_width::v128;
+}
+
+bool is_small(value_type type) noexcept {
+    return type == value_type::i1 || type == value_type::i8 || type == value_type::i16;
+}
+
+cond condition_of(cmp_pred pred) noexcept {
+    switch (pred) {
+    case cmp_pred::eq: return cond::e;
+    case cmp_pred::ne: return cond::ne;
+    case cmp_pred::slt: return cond::l;
+    case cmp_pred::sle: return cond::le;
+    case cmp_pred::sgt: return cond::g;
+    case cmp_pred::sge: return cond::ge;
+    case cmp_pred::ult: return cond::b;
+    case cmp_pred::ule: return cond::be;
+    case cmp_pred::ugt: return cond::a;
+    case cmp_pred::uge: return cond::ae;
+    }
+    return cond::e;
+}
+
+bool is_signed(cmp_pred pred) noexcept {
+    return pred == cmp_pred::slt || pred == cmp_pred::sle || pred == cmp_pred::sgt || pred == cmp_pred::sge;
+}
+
+// rax, rcx and rdx are scratch registers for instructions that need fixed registers (division,
+// shifts) and for loading operands that aren't in a register. r11 breaks cycles in parallel
+// moves. Caller saved registers come first, so values that don't live across a call don't
+// have to be saved in the prologue.
+// Vectors get xmm0-13, xmm14 and xmm15 are their scratch registers and xmm15 breaks their
+// cycles. All of them are caller saved.
+const register_info& target_registers() noexcept {
+    static const register_info info = [] {
+        register_info out{};
+        for (const auto r : { reg::rsi, reg::rdi, reg::r8, reg::r9, reg::r10, reg::rbx, reg::r12, reg::r13, reg::r14, reg::r15 }) {
+            out.allocatable.push_back(encoding(r));
+        }
+        for (const auto r : { reg::rax, reg::rcx, reg::rdx, reg::rsi, reg::rdi, reg::r8, reg::r9, reg::r10, reg::r11 }) {
+            out.caller_saved |= 1u << encoding(r);
+        }
+        for (std::uint8_t r = 0; r < 14; ++r) {
+            out.vector_allocatable.push_back(static_cast<std::uint8_t>(first_vector + r));
+        }
+        for (std::uint8_t r = 0; r < 16; ++r) {
+            out.caller_saved |= 1u << (first_vector + r);
+        }
+        out.count = reg_count + 16;
+        return out;
+    }();
+    return info;
+}
+
+/*
+  Compiles one function. Values live where the register allocator put them, instructions
+  use their operands straight from registers (or from their spill slot as a memory operand)
+  and write their result into its register. Constants, allocas and global addresses are
+  rematerialized at each use instead.
+
+  Moving values between locations is always done as a parallel move: at block boundaries
+  (including phis), between the pieces of a split value, for the arguments of a call and
+  for the parameters in the prologue.
+
+  Vector values are in the xmm registers. If the function has 256-bit vectors everything
+  is encoded as AVX, with a vzeroupper before calls and returns.
+*/
+class function_compiler {
+private:
+    // A single copy of a parallel move. Without a "from" location the value is
+    // rematerialized. "value" is what's moving, it's only missing for the arguments and
+    // parameters (which are never vectors).
+    struct move {
+        location to;
+        location from;
+        value_id value{ invalid_id };
+    };
+
+    // A critical edge that needs moves, they're emitted out of line after the function.
+    struct edge_stub {
+        label at;
+        block_id from;
+        block_id to;
+    };
+
+    const module& m_module;
+    const function& m_fn;
+    const std::vector<object_symbol_id>& m_symbols;
+    cfg m_cfg;
+    linear_scan m_alloc;
+    encoder m_enc{};
+
+    std::vector<std::int32_t> m_alloca_offsets{};
+    std::int32_t m_spill_base{ 0 };
+    std::vector<std::pair<reg, std::int32_t>> m_saved{};
+    std::vector<label> m_labels{};
+    std::vector<edge_stub> m_stubs{};
+    std::int32_t m_frame_size{ 0 };
+
+    // the position of the instruction being compiled, and the next split move to emit.
+    position m_pos{ 0 };
+    std::size_t m_next_split{ 0 };
+
+    // The icmp whose result is still in the flags, a cond_br on it can jump on them directly.
+    value_id m_flags_value{ invalid_id };
+    cond m_flags_cond{ cond::e };
+
+    // how much of a vector register a move between two of them copies.
+    vec_width m_vector_width{ vec_width::v128 };
+public:
+    function_compiler(const module& mod, const function& fn, const std::vector<object_symbol_id>& symbols) noexcept
+        : m_module(mod)
+        , m_fn(fn)
+        , m_symbols(symbols)
+        , m_cfg(fn)
+        , m_alloc(fn, m_cfg, target_registers())
+    {}
+
+    compiled_function compile() noexcept {
+        m_alloc.run();
+        layout_frame();
+
+        for (value_id id = 0; id < m_fn.value_count(); ++id) {
+            if (m_fn.inst(id).block != invalid_id && vector_width(m_fn.inst(id).type) == vec_width::v256) {
+                m_vector_width = vec_width::v256;
+                m_enc.set_vex(true);
+                break;
+            }
+        }
+
+        m_labels.resize(m_fn.block_count());
+        for (auto& l : m_labels) {
+            l = m_enc.new_label();
+        }
+
+        emit_prologue();
+        const auto& order = m_cfg.rpo();
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const auto next = i + 1 < order.size() ? order[i + 1] : invalid_id;
+            emit_block(order[i], next);
+        }
+        emit_stubs();
+        m_enc.finalize();
+
+        compiled_function out{};
+        out.code = std::move(m_enc.code());
+        out.relocations = m_enc.relocations();
+        return out;
+    }
+private:
+    std::int32_t allocate(std::int32_t size, std::int32_t alignment) noexcept {
+        m_frame_size = (m_frame_size + size + alignment - 1) & ~(alignment - 1);
+        return -m_frame_size;
+    }
+
+    void layout_frame() noexcept {
+        m_alloca_offsets.assign(m_fn.value_count(), 0);
+        for (const auto block : m_cfg.rpo()) {
+            m_fn.for_each_inst(block, [&](value_id id) {
+                const auto& inst = m_fn.inst(id);
+                if (inst.op != opcode::alloca) {
+                    return;
+                }
+                const auto size = static_cast<std::int32_t>(inst.imm > 0 ? inst.imm : 1);
+                const auto alignment = static_cast<std::int32_t>(std::min<std::uint64_t>(std::bit_ceil(static_cast<std::uint64_t>(size)), 16));
+                m_alloca_offsets[id] = allocate(size, alignment);
+            });
+        }
+
+        // spill slots, slot "i" is at m_spill_base + 8 * i.
+        const auto slots = m_alloc.spill_slot_count();
+        if (slots != 0) {
+            m_spill_base = allocate(slots * 8, 8);
+        }
+
+        // and the callee saved registers we use.
+        const auto& regs = target_registers();
+        for (const auto r : regs.allocatable) {
+            if (!regs.is_caller_saved(r) && ((m_alloc.used_registers() >> r) & 1)) {
+                m_saved.push_back({ static_cast<reg>(r), allocate(8, 8) });
+            }
+        }
+        m_frame_size = (m_frame_size + 15) & ~15;
+    }
+
+    inline mem memory_of(const location& loc) const noexcept {
+        if (loc.type == location::kind::frame) {
+            return mem::at(reg::rbp, loc.index);
+        }
+        return mem::at(reg::rbp, m_spill_base + loc.index * 8);
+    }
+
+    inline bool is_constant(value_id id, std::int64_t& value) const noexcept {
+        const auto& inst = m_fn.inst(id);
+        if (inst.op != opcode::iconst) {
+            return false;
+        }
+        value = inst.imm;
+        return true;
+    }
+
+    // Where "id" is while the current instruction reads its operands.
+    inline location operand_location(value_id id) const noexcept {
+        return m_alloc.location_at(id, m_pos);
+    }
+
+    // The register "id" is in right now, if it is in one.
+    inline bool in_register(value_id id, reg& out) const noexcept {
+        if (!linear_scan::needs_location(m_fn.inst(id))) {
+            return false;
+        }
+        const auto loc = operand_location(id);
+        if (!loc.is_reg()) {
+            return false;
+        }
+        out = static_cast<reg>(loc.reg);
+        return true;
+    }
+
+    // The register the current instruction should compute its result in. That's the
+    // register it was allocated, unless one of "avoid" is in there (and still needed).
+    reg result_register(value_id id, std::initializer_list<value_id> avoid = {}) const noexcept {
+        const auto loc = m_alloc.location_at(id, m_pos + 1);
+        if (!loc.is_reg()) {
+            return reg::rax;
+        }
+        for (const auto other : avoid) {
+            reg r;
+            if (in_register(other, r) && encoding(r) == loc.reg) {
+                return reg::rax;
+            }
+        }
+        return static_cast<reg>(loc.reg);
+    }
+
+    void emit_prologue() noexcept {
+        m_enc.push(reg::rbp);
+        m_enc.mov(width::b64, reg::rbp, reg::rsp);
+        if (m_frame_size != 0) {
+            m_enc.alu_imm(alu_op::sub, width::b64, reg::rsp, m_frame_size);
+        }
+        for (const auto& [r, offset] : m_saved) {
+            m_enc.mov(width::b64, mem::at(reg::rbp, offset), r);
+        }
+
+        // the parameters go from the argument registers (or the stack above the return
+        // address, from the 7th one onwards) to wherever they were allocated.
+        std::vector<move> moves;
+        m_fn.for_each_inst(m_fn.entry(), [&](value_id id) {
+            const auto& inst = m_fn.inst(id);
+            if (inst.op != opcode::param) {
+                return;
+            }
+            const auto to = m_alloc.definition_of(id);
+            if (to.is_none()) {
+                return;
+            }
+            const auto from = inst.imm < 6
+                ? location::in_reg(encoding(argument_registers[inst.imm]))
+                : location::in_frame(static_cast<std::int32_t>(16 + (inst.imm - 6) * 8));
+            moves.push_back(move{ to, from });
+        });
+        emit_parallel_moves(moves);
+    }
+
+    void emit_epilogue() noexcept {
+        for (const auto& [r, offset] : m_saved) {
+            m_enc.mov(width::b64, r, mem::at(reg::rbp, offset));
+        }
+        if (m_vector_width == vec_width::v256) {
+            m_enc.vzeroupper();
+        }
+        m_enc.leave();
+        m_enc.ret();
+    }
+
+    // Constants, allocas, global addresses and undef.
+    void rematerialize(reg dst, value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        switch (inst.op) {
+        case opcode::iconst:
+            m_enc.mov_imm(op_width(inst.type), dst, inst.type == value_type::i64 || inst.type == value_type::ptr
+                ? inst.imm
+                : static_cast<std::uint32_t>(inst.imm));
+            break;
+        case opcode::alloca:
+            m_enc.lea(dst, mem::at(reg::rbp, m_alloca_offsets[id]));
+            break;
+        case opcode::global_addr:
+            m_enc.lea(dst, m_symbols[static_cast<symbol_id>(inst.imm)]);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Load "id" into "dst".
+    void load_value(reg dst, value_id id) noexcept {
+        if (!linear_scan::needs_location(m_fn.inst(id))) {
+            rematerialize(dst, id);
+            return;
+        }
+        const auto loc = operand_location(id);
+        if (loc.is_reg()) {
+            if (loc.reg != encoding(dst)) {
+                m_enc.mov(width::b64, dst, static_cast<reg>(loc.reg));
+            }
+        }
+        else if (!loc.is_none()) {
+            m_enc.mov(width::b64, dst, memory_of(loc));
+        }
+    }
+
+    // The register "id" is in, or "scratch" after loading it there.
+    reg use_value(value_id id, reg scratch) noexcept {
+        reg r;
+        if (in_register(id, r)) {
+            return r;
+        }
+        load_value(scratch, id);
+        return scratch;
+    }
+
+    // Move the result of the current instruction from "src" to where it lives.
+    void store_result(value_id id, reg src) noexcept {
+        const auto loc = m_alloc.location_at(id, m_pos + 1);
+        if (loc.is_reg()) {
+            if (loc.reg != encoding(src)) {
+                m_enc.mov(width::b64, static_cast<reg>(loc.reg), src);
+            }
+        }
+        else if (!loc.is_none()) {
+            m_enc.mov(width::b64, memory_of(loc), src);
+        }
+    }
+
+    // Load the vector "id" into "dst".
+    void load_vector(xmm dst, value_id id) noexcept {
+        const auto loc = operand_location(id);
+        if (is_vector_register(loc)) {
+            if (vector_register(loc) != dst) {
+                m_enc.vmov(m_vector_width, dst, vector_register(loc));
+            }
+        }
+        else if (!loc.is_none()) {
+            m_enc.vmovdqu(vector_width(m_fn.inst(id).type), dst, memory_of(loc));
+        }
+    }
+
+    xmm use_vector(value_id id, xmm scratch) noexcept {
+        const auto loc = operand_location(id);
+        if (is_vector_register(loc)) {
+            return vector_register(loc);
+        }
+        load_vector(scratch, id);
+        return scratch;
+    }
+
+    // result_register() for vectors, xmm14 if the result isn't in a register.
+    xmm vector_result(value_id id, std::initializer_list<value_id> avoid = {}) const noexcept {
+        const auto loc = m_alloc.location_at(id, m_pos + 1);
+        if (!is_vector_register(loc)) {
+            return xmm::xmm14;
+        }
+        for (const auto other : avoid) {
+            if (operand_location(other) == loc) {
+                return xmm::xmm14;
+            }
+        }
+        return vector_register(loc);
+    }
+
+    void store_vector(value_id id, xmm src) noexcept {
+        const auto loc = m_alloc.location_at(id, m_pos + 1);
+        if (is_vector_register(loc)) {
+            if (vector_register(loc) != src) {
+                m_enc.vmov(m_vector_width, vector_register(loc), src);
+            }
+        }
+        else if (!loc.is_none()) {
+            m_enc.vmovdqu(vector_width(m_fn.inst(id).type), memory_of(loc), src);
+        }
+    }
+
+    // The memory operand for the address "id", "scratch" is used if it has to be loaded.
+    mem address_of(value_id id, reg scratch) noexcept {
+        if (m_fn.inst(id).op == opcode::alloca) {
+            return mem::at(reg::rbp, m_alloca_offsets[id]);
+        }
+        return mem::at(use_value(id, scratch));
+    }
+
+    // Extend the small integer in "r" to 32 bits.
+    void extend(reg r, value_type type, bool is_signed) noexcept {
+        if (!is_small(type)) {
+            return;
+        }
+        const auto from = type == value_type::i16 ? width::b16 : width::b8;
+        if (is_signed && type != value_type::i1) {
+            m_enc.movsx(width::b32, r, from, r);
+        }
+        else {
+            m_enc.movzx(r, from, r);
+        }
+    }
+
+    void emit_vector_move(const move& m) noexcept {
+        const auto w = vector_width(m_fn.inst(m.value).type);
+        if (m.to.is_reg() && m.from.is_reg()) {
+            m_enc.vmov(m_vector_width, vector_register(m.to), vector_register(m.from));
+        }
+        else if (m.to.is_reg()) {
+            m_enc.vmovdqu(w, vector_register(m.to), memory_of(m.from));
+        }
+        else if (m.from.is_reg()) {
+            m_enc.vmovdqu(w, memory_of(m.to), vector_register(m.from));
+        }
+        else {
+            m_enc.vmovdqu(w, xmm::xmm14, memory_of(m.from));
+            m_enc.vmovdqu(w, memory_of(m.to), xmm::xmm14);
+        }
+    }
+
+    void emit_move(const move& m) noexcept {
+        if (m.value != invalid_id && is_vector(m_fn.inst(m.value).type)) {
+            emit_vector_move(m);
+            return;
+        }
+        if (m.from.is_none()) {
+            std::int64_t constant = 0;
+            if (m.to.is_reg()) {
+                rematerialize(static_cast<reg>(m.to.reg), m.value);
+            }
+            else if (is_constant(m.value, constant) && constant >= INT32_MIN && constant <= INT32_MAX) {
+                m_enc.mov_imm(width::b64, memory_of(m.to), static_cast<std::int32_t>(constant));
+            }
+            else {
+                rematerialize(reg::rax, m.value);
+                m_enc.mov(width::b64, memory_of(m.to), reg::rax);
+            }
+            return;
+        }
+        if (m.to.is_reg()) {
+            if (m.from.is_reg()) {
+                m_enc.mov(width::b64, static_cast<reg>(m.to.reg), static_cast<reg>(m.from.reg));
+            }
+            else {
+                m_enc.mov(width::b64, static_cast<reg>(m.to.reg), memory_of(m.from));
+            }
+            return;
+        }
+        if (m.from.is_reg()) {
+            m_enc.mov(width::b64, memory_of(m.to), static_cast<reg>(m.from.reg));
+        }
+        else {
+            m_enc.mov(width::b64, reg::rax, memory_of(m.from));
+            m_enc.mov(width::b64, memory_of(m.to), reg::rax);
+        }
+    }
+
+    // Emit "moves" as if they all happen at the same time. A move can go as soon as nothing
+    // else still reads its destination, what's left after that are cycles, which are
+    // broken by saving one destination in r11 (or xmm15) first.
+    // NOTE: these are all movs and leas, so the flags survive.
+    void emit_parallel_moves(std::vector<move>& moves) noexcept {
+        std::erase_if(moves, [](const move& m) {
+            return m.from.is_none() ? m.value == invalid_id : m.from == m.to;
+        });
+
+        const auto is_read = [&](const location& loc, std::size_t except) {
+            for (std::size_t i = 0; i < moves.size(); ++i) {
+                if (i != except && !moves[i].from.is_none() && moves[i].from == loc) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        while (!moves.empty()) {
+            bool progress = false;
+            for (std::size_t i = 0; i < moves.size();) {
+                if (is_read(moves[i].to, i)) {
+                    ++i;
+                    continue;
+                }
+                emit_move(moves[i]);
+                moves[i] = moves.back();
+                moves.pop_back();
+                progress = true;
+            }
+            if (progress) {
+                continue;
+            }
+
+            // a cycle only goes through registers, and all of them are of the same kind.
+            const auto saved = moves.front().to;
+            const auto temp = is_vector_register(saved) ? in_vector_register(xmm::xmm15) : location::in_reg(encoding(reg::r11));
+            emit_move(move{ temp, saved, moves.front().value });
+            for (auto& m : moves) {
+                if (!m.from.is_none() && m.from == saved) {
+                    m.from = temp;
+                }
+            }
+        }
+    }
+
+    // The moves between the pieces of split values that go right before the current
+    // instruction.
+    void emit_split_moves() noexcept {
+        const auto& splits = m_alloc.split_moves();
+        std::vector<move> moves;
+        for (; m_next_split < splits.size() && splits[m_next_split].at <= m_pos; ++m_next_split) {
+            const auto& split = splits[m_next_split];
+            moves.push_back(move{ split.to, split.from, split.value });
+        }
+        if (!moves.empty()) {
+            emit_parallel_moves(moves);
+        }
+    }
+
+    // Everything that has to move on the edge "from" -> "to": values that are live into
+    // "to" but aren't in the same place anymore, and the phis of "to".
+    std::vector<move> edge_moves(block_id from, block_id to) const noexcept {
+        const auto end = m_alloc.block_to(from) - 1;
+        const auto start = m_alloc.block_from(to);
+
+        std::vector<move> moves;
+        for (const auto value : m_alloc.live_in(to)) {
+            const auto src = m_alloc.location_at(value, end);
+            const auto dst = m_alloc.location_at(value, start);
+            if (!(src == dst)) {
+                moves.push_back(move{ dst, src, value });
+            }
+        }
+        m_fn.for_each_inst(to, [&](value_id phi) {
+            const auto& inst = m_fn.inst(phi);
+            if (inst.op != opcode::phi) {
+                return;
+            }
+            const auto dst = m_alloc.location_at(phi, start);
+            if (dst.is_none()) {
+                return;
+            }
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                if (m_fn.target(phi, i) != from) {
+                    continue;
+                }
+                const auto value = m_fn.operand(phi, i);
+                const auto& incoming = m_fn.inst(value);
+                if (linear_scan::needs_location(incoming)) {
+                    moves.push_back(move{ dst, m_alloc.location_at(value, end), value });
+                }
+                else if (incoming.op != opcode::undef) {
+                    moves.push_back(move{ dst, location{}, value });
+                }
+                break;
+            }
+        });
+        return moves;
+    }
+
+    // Jump to "to" from the end of "from", which has another successor too. The moves go
+    // at the start of "to" if this is its only predecessor, otherwise the edge is critical
+    // and they go into a stub.
+    label edge_target(block_id from, block_id to) noexcept {
+        if (m_cfg.preds(to).size() == 1) {
+            return m_labels[to];
+        }
+        auto moves = edge_moves(from, to);
+        std::erase_if(moves, [](const move& m) {
+            return m.from.is_none() ? m.value == invalid_id : m.from == m.to;
+        });
+        if (moves.empty()) {
+            return m_labels[to];
+        }
+        const auto stub = m_enc.new_label();
+        m_stubs.push_back(edge_stub{ stub, from, to });
+        return stub;
+    }
+
+    void emit_stubs() noexcept {
+        for (const auto& stub : m_stubs) {
+            m_enc.bind(stub.at);
+            auto moves = edge_moves(stub.from, stub.to);
+            emit_parallel_moves(moves);
+            m_enc.jmp(m_labels[stub.to]);
+        }
+    }
+
+    void emit_block(block_id block, block_id next) noexcept {
+        m_enc.bind(m_labels[block]);
+        m_flags_value = invalid_id;
+
+        // the only predecessor branched here conditionally, so its moves happen here.
+        const auto preds = m_cfg.preds(block);
+        if (preds.size() == 1) {
+            const auto term = m_fn.terminator(preds[0]);
+            if (m_fn.inst(term).op == opcode::cond_br) {
+                auto moves = edge_moves(preds[0], block);
+                emit_parallel_moves(moves);
+            }
+        }
+
+        m_fn.for_each_inst(block, [&](value_id id) {
+            m_pos = m_alloc.position_of(id);
+            emit_split_moves();
+            emit_instruction(id, block, next);
+        });
+    }
+
+    void emit_binary(value_id id, const instruction& inst) noexcept {
+        const auto w = op_width(inst.type);
+        const auto lhs = m_fn.operand(id, 0);
+        const auto rhs = m_fn.operand(id, 1);
+        std::int64_t constant = 0;
+        const bool rhs_is_imm = is_constant(rhs, constant) && constant >= INT32_MIN && constant <= INT32_MAX;
+        const auto rhs_loc = operand_location(rhs);
+        const bool rhs_is_value = linear_scan::needs_location(m_fn.inst(rhs));
+
+        switch (inst.op) {
+        case opcode::add:
+        case opcode::sub:
+        case opcode::and_:
+        case opcode::or_:
+        case opcode::xor_: {
+            alu_op op = alu_op::add;
+            switch (inst.op) {
+            case opcode::sub: op = alu_op::sub; break;
+            case opcode::and_: op = alu_op::and_; break;
+            case opcode::or_: op = alu_op::or_; break;
+            case opcode::xor_: op = alu_op::xor_; break;
+            default: break;
+            }
+            const auto dst = lhs == rhs ? result_register(id) : result_register(id, { rhs });
+            load_value(dst, lhs);
+            if (rhs_is_imm) {
+                m_enc.alu_imm(op, w, dst, static_cast<std::int32_t>(constant));
+            }
+            else if (rhs_is_value && rhs_loc.is_reg()) {
+                m_enc.alu(op, w, dst, static_cast<reg>(rhs_loc.reg));
+            }
+            else if (rhs_is_value && !rhs_loc.is_none()) {
+                m_enc.alu(op, w, dst, memory_of(rhs_loc));
+            }
+            else {
+                load_value(reg::rcx, rhs);
+                m_enc.alu(op, w, dst, reg::rcx);
+            }
+            store_result(id, dst);
+            break;
+        }
+        case opcode::mul: {
+            const auto dst = lhs == rhs ? result_register(id) : result_register(id, { rhs });
+            if (rhs_is_imm) {
+                m_enc.imul_imm(w, dst, use_value(lhs, dst), static_cast<std::int32_t>(constant));
+            }
+            else {
+                load_value(dst, lhs);
+                m_enc.imul(w, dst, use_value(rhs, reg::rcx));
+            }
+            store_result(id, dst);
+            break;
+        }
+        case opcode::sdiv:
+        case opcode::srem:
+        case opcode::udiv:
+        case opcode::urem: {
+            const bool is_signed = inst.op == opcode::sdiv || inst.op == opcode::srem;
+            load_value(reg::rax, lhs);
+            load_value(reg::rcx, rhs);
+            extend(reg::rax, inst.type, is_signed);
+            extend(reg::rcx, inst.type, is_signed);
+            if (is_signed) {
+                m_enc.sign_extend_ax(w);
+                m_enc.unary(unary_op::idiv, w, reg::rcx);
+            }
+            else {
+                m_enc.alu(alu_op::xor_, width::b32, reg::rdx, reg::rdx);
+                m_enc.unary(unary_op::div, w, reg::rcx);
+            }
+            store_result(id, inst.op == opcode::srem || inst.op == opcode::urem ? reg::rdx : reg::rax);
+            break;
+        }
+        case opcode::shl:
+        case opcode::ashr:
+        case opcode::lshr: {
+            shift_op op = shift_op::shl;
+            if (inst.op == opcode::ashr) {
+                op = shift_op::sar;
+            }
+            else if (inst.op == opcode::lshr) {
+                op = shift_op::shr;
+            }
+            // the amount goes into cl first, so the result can go anywhere.
+            if (!rhs_is_imm) {
+                load_value(reg::rcx, rhs);
+            }
+            const auto dst = result_register(id);
+            load_value(dst, lhs);
+            extend(dst, inst.type, inst.op == opcode::ashr);
+            if (rhs_is_imm) {
+                m_enc.shift_imm(op, w, dst, static_cast<std::uint8_t>(constant & (w == width::b64 ? 63 : 31)));
+            }
+            else {
+                m_enc.shift(op, w, dst);
+            }
+            store_result(id, dst);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // dst = dst op src, for the ops the vectorizer can widen (except shifts).
+    void emit_vector_op(opcode op, value_type type, xmm dst, xmm src) noexcept {
+        const auto w = vector_width(type);
+        const auto lane = mem_width(element_of(type));
+        vec_op code = vec_op::pxor;
+        switch (op) {
+        case opcode::add:
+            code = lane == width::b8 ? vec_op::paddb : lane == width::b16 ? vec_op::paddw : lane == width::b32 ? vec_op::paddd : vec_op::paddq;
+            break;
+        case opcode::sub:
+            code = lane == width::b8 ? vec_op::psubb : lane == width::b16 ? vec_op::psubw : lane == width::b32 ? vec_op::psubd : vec_op::psubq;
+            break;
+        case opcode::mul:
+            if (lane == width::b32) {
+                m_enc.pmulld(w, dst, src);
+                return;
+            }
+            code = vec_op::pmullw;
+            break;
+        case opcode::and_: code = vec_op::pand; break;
+        case opcode::or_: code = vec_op::por; break;
+        default: break;
+        }
+        m_enc.vec(code, w, dst, src);
+    }
+
+    void emit_vector_binary(value_id id, const instruction& inst) noexcept {
+        const auto w = vector_width(inst.type);
+        const auto lhs = m_fn.operand(id, 0);
+        const auto rhs = m_fn.operand(id, 1);
+
+        if (inst.op == opcode::shl || inst.op == opcode::lshr || inst.op == opcode::ashr) {
+            const auto op = inst.op == opcode::shl ? vec_shift::sll : inst.op == opcode::lshr ? vec_shift::srl : vec_shift::sra;
+            const auto lane = mem_width(element_of(inst.type));
+            // the amount is a scalar, counts past the lane size give 0 (or the sign).
+            const auto dst = vector_result(id);
+            load_vector(dst, lhs);
+            std::int64_t constant = 0;
+            if (is_constant(rhs, constant)) {
+                m_enc.vec_shift_imm(op, lane, w, dst, static_cast<std::uint8_t>(constant & 63));
+            }
+            else {
+                m_enc.movd(width::b64, xmm::xmm15, use_value(rhs, reg::rax));
+                m_enc.vec_shift_by(op, lane, w, dst, xmm::xmm15);
+            }
+            store_vector(id, dst);
+            return;
+        }
+
+        const auto dst = lhs == rhs ? vector_result(id) : vector_result(id, { rhs });
+        load_vector(dst, lhs);
+        emit_vector_op(inst.op, inst.type, dst, use_vector(rhs, xmm::xmm15));
+        store_vector(id, dst);
+    }
+
+    // Instructions with a vector result.
+    void emit_vector(value_id id, const instruction& inst) noexcept {
+        const auto w = vector_width(inst.type);
+        switch (inst.op) {
+        case opcode::load: {
+            const auto address = address_of(m_fn.operand(id, 0), reg::rcx);
+            const auto dst = vector_result(id);
+            m_enc.vmovdqu(w, dst, address);
+            store_vector(id, dst);
+            break;
+        }
+        case opcode::broadcast: {
+            const auto lane = mem_width(element_of(inst.type));
+            const auto dst = vector_result(id);
+            m_enc.movd(lane == width::b64 ? width::b64 : width::b32, dst, use_value(m_fn.operand(id, 0), reg::rax));
+            if (w == vec_width::v256) {
+                m_enc.vpbroadcast(lane, dst, dst);
+            }
+            else if (lane == width::b64) {
+                m_enc.vec(vec_op::punpcklqdq, w, dst, dst);
+            }
+            else {
+                // widen the low lane to 32 bits by unpacking it with itself, then copy that.
+                if (lane == width::b8) {
+                    m_enc.vec(vec_op::punpcklbw, w, dst, dst);
+                }
+                if (lane != width::b32) {
+                    m_enc.vec(vec_op::punpcklwd, w, dst, dst);
+                }
+                m_enc.pshufd(dst, dst, 0);
+            }
+            store_vector(id, dst);
+            break;
+        }
+        case opcode::neg: {
+            const auto value = m_fn.operand(id, 0);
+            const auto dst = vector_result(id, { value });
+            m_enc.vec(vec_op::pxor, w, dst, dst);
+            emit_vector_op(opcode::sub, inst.type, dst, use_vector(value, xmm::xmm15));
+            store_vector(id, dst);
+            break;
+        }
+        case opcode::not_: {
+            const auto dst = vector_result(id);
+            load_vector(dst, m_fn.operand(id, 0));
+            m_enc.vec(vec_op::pcmpeqd, w, xmm::xmm15, xmm::xmm15);
+            m_enc.vec(vec_op::pxor, w, dst, xmm::xmm15);
+            store_vector(id, dst);
+            break;
+        }
+        default:
+            if (is_binary(inst.op)) {
+                emit_vector_binary(id, inst);
+            }
+            break;
+        }
+    }
+
+    // Combine the lanes by halving: the upper 128 bits onto the lower ones, then shifting
+    // down by 8, 4, ... bytes until a single lane is left.
+    void emit_reduce(value_id id, const instruction& inst) noexcept {
+        const auto value = m_fn.operand(id, 0);
+        const auto type = m_fn.inst(value).type;
+        const auto half = vector_of(element_of(type), 16);
+        const auto op = static_cast<opcode>(inst.imm);
+
+        load_vector(xmm::xmm14, value);
+        if (vector_width(type) == vec_width::v256) {
+            m_enc.vextracti128(xmm::xmm15, xmm::xmm14, 1);
+            emit_vector_op(op, half, xmm::xmm14, xmm::xmm15);
+        }
+        for (auto bytes = 8u; bytes >= size_of(element_of(type)); bytes /= 2) {
+            m_enc.vmov(vec_width::v128, xmm::xmm15, xmm::xmm14);
+            m_enc.psrldq(xmm::xmm15, static_cast<std::uint8_t>(bytes));
+            emit_vector_op(op, half, xmm::xmm14, xmm::xmm15);
+        }
+        const auto dst = result_register(id);
+        m_enc.movd(inst.type == value_type::i64 ? width::b64 : width::b32, dst, xmm::xmm14);
+        store_result(id, dst);
+    }
+
+    void emit_icmp(value_id id, const instruction& inst) noexcept {
+        const auto lhs = m_fn.operand(id, 0);
+        const auto rhs = m_fn.operand(id, 1);
+        const auto type = m_fn.inst(lhs).type;
+        const auto pred = static_cast<cmp_pred>(inst.imm);
+        const auto w = op_width(type);
+
+        reg left = reg::rax;
+        if (is_small(type)) {
+            load_value(reg::rax, lhs);
+            extend(reg::rax, type, is_signed(pred));
+        }
+        else {
+            left = use_value(lhs, reg::rax);
+        }
+
+        std::int64_t constant = 0;
+        const auto rhs_loc = operand_location(rhs);
+        const bool rhs_is_value = linear_scan::needs_location(m_fn.inst(rhs));
+        if (!is_small(type) && is_constant(rhs, constant) && constant >= INT32_MIN && constant <= INT32_MAX) {
+            m_enc.alu_imm(alu_op::cmp, w, left, static_cast<std::int32_t>(constant));
+        }
+        else if (!is_small(type) && rhs_is_value && rhs_loc.is_reg()) {
+            m_enc.alu(alu_op::cmp, w, left, static_cast<reg>(rhs_loc.reg));
+        }
+        else if (!is_small(type) && rhs_is_value && !rhs_loc.is_none()) {
+            m_enc.alu(alu_op::cmp, w, left, memory_of(rhs_loc));
+        }
+        else {
+            load_value(reg::rcx, rhs);
+            extend(reg::rcx, type, is_signed(pred));
+            m_enc.alu(alu_op::cmp, w, left, reg::rcx);
+        }
+
+        const auto c = condition_of(pred);
+        const auto dst = result_register(id);
+        m_enc.setcc(c, dst);
+        m_enc.movzx(dst, width::b8, dst);
+        store_result(id, dst);
+
+        m_flags_value = id;
+        m_flags_cond = c;
+    }
+
+    void emit_cast(value_id id, const instruction& inst) noexcept {
+        const auto value = m_fn.operand(id, 0);
+        const auto from = m_fn.inst(value).type;
+        const auto dst = result_register(id);
+        const auto loc = operand_location(value);
+        const bool in_memory = linear_scan::needs_location(m_fn.inst(value)) && !loc.is_reg() && !loc.is_none();
+
+        switch (inst.op) {
+        case opcode::sext:
+            if (from == value_type::i1) {
+                load_value(dst, value);
+                m_enc.movzx(dst, width::b8, dst);
+                m_enc.unary(unary_op::neg, op_width(inst.type), dst);
+            }
+            else if (mem_width(from) != op_width(inst.type)) {
+                if (in_memory) {
+                    m_enc.movsx(op_width(inst.type), dst, mem_width(from), memory_of(loc));
+                }
+                else {
+                    m_enc.movsx(op_width(inst.type), dst, mem_width(from), use_value(value, dst));
+                }
+            }
+            else {
+                load_value(dst, value);
+            }
+            break;
+        case opcode::zext: {
+            const auto w = mem_width(from) == width::b64 ? width::b32 : mem_width(from);
+            if (in_memory) {
+                m_enc.movzx(dst, w, memory_of(loc));
+            }
+            else {
+                m_enc.movzx(dst, w, use_value(value, dst));
+            }
+            break;
+        }
+        default:
+            // trunc and bitcast don't change any bits, the upper bits of a small value
+            // are never looked at.
+            load_value(dst, value);
+            break;
+        }
+        store_result(id, dst);
+    }
+
+    void emit_call(value_id id, const instruction& inst) noexcept {
+        const auto count = inst.operand_count;
+        const auto stack_args = count > 6 ? count - 6u : 0u;
+        // the stack has to be 16 byte aligned at the call.
+        const auto padding = (stack_args % 2) != 0 ? 8 : 0;
+
+        if (padding != 0) {
+            m_enc.alu_imm(alu_op::sub, width::b64, reg::rsp, padding);
+        }
+        for (std::uint32_t i = count; i > 6; --i) {
+            load_value(reg::rax, m_fn.operand(id, i - 1));
+            m_enc.push(reg::rax);
+        }
+
+        // the register arguments may be in each others registers.
+        std::vector<move> moves;
+        for (std::uint32_t i = 0; i < count && i < 6; ++i) {
+            const auto value = m_fn.operand(id, i);
+            const auto to = location::in_reg(encoding(argument_registers[i]));
+            if (linear_scan::needs_location(m_fn.inst(value))) {
+                moves.push_back(move{ to, operand_location(value) });
+            }
+            else {
+                moves.push_back(move{ to, location{}, value });
+            }
+        }
+        emit_parallel_moves(moves);
+
+        if (m_vector_width == vec_width::v256) {
+            m_enc.vzeroupper();
+        }
+        // al holds the amount of vector registers used, in case the callee is variadic.
+        m_enc.alu(alu_op::xor_, width::b32, reg::rax, reg::rax);
+        m_enc.call(m_symbols[static_cast<symbol_id>(inst.imm)]);
+
+        const auto cleanup = static_cast<std::int32_t>(stack_args * 8 + padding);
+        if (cleanup != 0) {
+            m_enc.alu_imm(alu_op::add, width::b64, reg::rsp, cleanup);
+        }
+        if (inst.type != value_type::void_) {
+            store_result(id, reg::rax);
+        }
+    }
+
+    void emit_instruction(value_id id, block_id block, block_id next) noexcept {
+        const auto& inst = m_fn.inst(id);
+        const auto flags_value = m_flags_value;
+        m_flags_value = invalid_id;
+
+        if (is_vector(inst.type) && inst.op != opcode::phi) {
+            emit_vector(id, inst);
+            return;
+        }
+        if (is_binary(inst.op)) {
+            emit_binary(id, inst);
+            return;
+        }
+        if (is_cast(inst.op)) {
+            emit_cast(id, inst);
+            // only sext of an i1 (neg) touches the flags, "zext(icmp)" can still be fused.
+            if (inst.op != opcode::sext || m_fn.inst(m_fn.operand(id, 0)).type != value_type::i1) {
+                m_flags_value = flags_value;
+            }
+            return;
+        }
+
+        switch (inst.op) {
+        case opcode::nop:
+        case opcode::param:
+        case opcode::phi:
+        case opcode::iconst:
+        case opcode::undef:
+        case opcode::alloca:
+        case opcode::global_addr:
+            // params are moved by the prologue, phis on the edges into the block, the rest
+            // are rematerialized at each use.
+            m_flags_value = flags_value;
+            break;
+        case opcode::neg:
+        case opcode::not_: {
+            const auto dst = result_register(id);
+            load_value(dst, m_fn.operand(id, 0));
+            m_enc.unary(inst.op == opcode::neg ? unary_op::neg : unary_op::not_, op_width(inst.type), dst);
+            store_result(id, dst);
+            break;
+        }
+        case opcode::icmp:
+            emit_icmp(id, inst);
+            break;
+        case opcode::load: {
+            const auto address = address_of(m_fn.operand(id, 0), reg::rcx);
+            const auto dst = result_register(id);
+            switch (mem_width(inst.type)) {
+            case width::b8: m_enc.movzx(dst, width::b8, address); break;
+            case width::b16: m_enc.movzx(dst, width::b16, address); break;
+            case width::b32: m_enc.mov(width::b32, dst, address); break;
+            default: m_enc.mov(width::b64, dst, address); break;
+            }
+            store_result(id, dst);
+            break;
+        }
+        case opcode::store: {
+            const auto value = m_fn.operand(id, 1);
+            const auto type = m_fn.inst(value).type;
+            const auto address = address_of(m_fn.operand(id, 0), reg::rcx);
+            if (is_vector(type)) {
+                m_enc.vmovdqu(vector_width(type), address, use_vector(value, xmm::xmm14));
+                break;
+            }
+            const auto w = mem_width(type);
+            std::int64_t constant = 0;
+            if (is_constant(value, constant) && constant >= INT32_MIN && constant <= INT32_MAX) {
+                m_enc.mov_imm(w, address, static_cast<std::int32_t>(constant));
+            }
+            else {
+                m_enc.mov(w, address, use_value(value, reg::rax));
+            }
+            break;
+        }
+        case opcode::ptr_add: {
+            const auto scale = inst.imm;
+            const auto base = m_fn.operand(id, 0);
+            const auto index = m_fn.operand(id, 1);
+            std::int64_t constant = 0;
+            if (is_constant(index, constant) && constant * scale >= INT32_MIN && constant * scale <= INT32_MAX) {
+                const auto dst = result_register(id);
+                load_value(dst, base);
+                if (constant != 0) {
+                    m_enc.alu_imm(alu_op::add, width::b64, dst, static_cast<std::int32_t>(constant * scale));
+                }
+                store_result(id, dst);
+                break;
+            }
+
+            const auto dst = result_register(id, { index });
+            if (scale == 1 || scale == 2 || scale == 4 || scale == 8) {
+                const auto scaled = use_value(index, reg::rcx);
+                load_value(dst, base);
+                m_enc.lea(dst, mem::indexed(dst, scaled, static_cast<std::uint8_t>(scale)));
+            }
+            else {
+                load_value(reg::rcx, index);
+                m_enc.imul_imm(width::b64, reg::rcx, reg::rcx, static_cast<std::int32_t>(scale));
+                load_value(dst, base);
+                m_enc.alu(alu_op::add, width::b64, dst, reg::rcx);
+            }
+            store_result(id, dst);
+            break;
+        }
+        case opcode::call:
+            emit_call(id, inst);
+            break;
+        case opcode::reduce:
+            emit_reduce(id, inst);
+            break;
+        case opcode::br: {
+            const auto target = m_fn.target(id, 0);
+            auto moves = edge_moves(block, target);
+            emit_parallel_moves(moves);
+            if (target != next) {
+                m_enc.jmp(m_labels[target]);
+            }
+            break;
+        }
+        case opcode::cond_br: {
+            const auto condition = m_fn.operand(id, 0);
+            const auto if_true = m_fn.target(id, 0);
+            const auto if_false = m_fn.target(id, 1);
+
+            if (if_true == if_false) {
+                auto moves = edge_moves(block, if_true);
+                emit_parallel_moves(moves);
+                if (if_true != next) {
+                    m_enc.jmp(m_labels[if_true]);
+                }
+                break;
+            }
+
+            cond c = cond::ne;
+            if (condition == flags_value) {
+                c = m_flags_cond;
+            }
+            else {
+                const auto r = use_value(condition, reg::rax);
+                m_enc.test(width::b32, r, r);
+            }
+
+            const auto true_target = edge_target(block, if_true);
+            const auto false_target = edge_target(block, if_false);
+            if (if_true == next && true_target == m_labels[if_true]) {
+                m_enc.jcc(negate(c), false_target);
+            }
+            else {
+                m_enc.jcc(c, true_target);
+                if (if_false != next || false_target != m_labels[if_false]) {
+                    m_enc.jmp(false_target);
+                }
+            }
+            break;
+        }
+        case opcode::ret:
+            if (inst.operand_count != 0) {
+                load_value(reg::rax, m_fn.operand(id, 0));
+            }
+            emit_epilogue();
+            break;
+        case opcode::unreachable:
+            m_enc.int3();
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+} // namespace
+
+compiled_function x86_64::compile_function(
+    const module& mod,
+    const function& fn,
+    const std::vector<object_symbol_id>& symbols
+) noexcept {
+    return function_compiler{ mod, fn, symbols }.compile();
+}
+
+result<void, error> x86_64::generate(const module& mod, object_file& object, thread_pool& pool) noexcept {
+    const auto text = object.add_section(".text", section_kind::text, 16);
+    const auto data = object.add_section(".data", section_kind::data, 1);
+    const auto bss = object.add_section(".bss", section_kind::bss, 1);
+
+    std::vector<object_symbol_id> symbols;
+    symbols.reserve(mod.symbols().size());
+    for (const auto& sym : mod.symbols()) {
+        const auto id = object.intern_symbol(sym.name);
+        auto& out = object.get_symbol(id);
+        out.is_global = sym.link == linkage::external;
+        out.is_function = sym.kind == symbol_kind::function;
+        symbols.push_back(id);
+    }
+
+    for (const auto& g : mod.globals()) {
+        const auto size = static_cast<std::uint64_t>(size_of(g.type));
+        const auto section = g.init == 0 ? bss : data;
+        const auto offset = object.align_section(section, size);
+
+        if (section == data) {
+            auto& bytes = object.get_section(data).data;
+            for (std::uint64_t i = 0; i < size; ++i) {
+                bytes.push_back(static_cast<std::uint8_t>(static_cast<std::uint64_t>(g.init) >> (i * 8)));
+            }
+        }
+        else {
+            object.get_section(bss).bss_size += size;
+        }
+
+        auto& sym = object.get_symbol(symbols[g.symbol]);
+        sym.section = section;
+        sym.offset = offset;
+        sym.size = size;
+    }
+
+    // string literals. Each one the module uses is emitted once, they go into a mergeable
+    // string section so the linker also folds the copies in other objects. A literal with
+    // a NUL inside would be split up by that, those go into plain .rodata.
+    auto literals = undefined_section, rodata = undefined_section;
+    for (const auto& constant : mod.string_constants()) {
+        const auto& bytes = mod.strings().get(constant.string);
+        const bool has_nul = bytes.find('\0') != std::string::npos;
+        auto& section = has_nul ? rodata : literals;
+        if (section == undefined_section) {
+            section = has_nul
+                ? object.add_section(".rodata", section_kind::rodata, 1)
+                : object.add_section(".rodata.str1.1", section_kind::rodata, 1);
+            object.get_section(section).is_strings = !has_nul;
+        }
+
+        auto& data = object.get_section(section).data;
+        const auto offset = data.size();
+        data.insert(data.end(), bytes.begin(), bytes.end());
+        data.push_back(0);
+
+        auto& sym = object.get_symbol(symbols[constant.symbol]);
+        sym.section = section;
+        sym.offset = offset;
+        sym.size = bytes.size() + 1;
+    }
+
+    // every function is compiled into buffers of its own, then copied into .text in order.
+    const auto& functions = mod.functions();
+    std::vector<compiled_function> compiled_functions(functions.size());
+    pool.for_each_index(functions.size(), [&](std::size_t i, std::size_t) {
+        if (functions[i]->is_definition()) {
+            compiled_functions[i] = compile_function(mod, *functions[i], symbols);
+        }
+    });
+
+    // the code plus the worst case of alignment padding in front of it.
+    std::size_t text_size = 0;
+    for (const auto& compiled : compiled_functions) {
+        text_size += compiled.code.size() + 15;
+    }
+    object.get_section(text).data.reserve(text_size);
+    for (std::size_t i = 0; i < functions.size(); ++i) {
+        const auto& fn = functions[i];
+        if (!fn->is_definition()) {
+            continue;
+        }
+        auto& compiled = compiled_functions[i];
+
+        const auto offset = object.align_section(text, 16);
+        auto& sec = object.get_section(text);
+        sec.data.insert(sec.data.end(), compiled.code.begin(), compiled.code.end());
+        for (auto reloc : compiled.relocations) {
+            reloc.offset += offset;
+            sec.relocations.push_back(reloc);
+        }
+
+        auto& sym = object.get_symbol(symbols[fn->symbol()]);
+        sym.section = text;
+        sym.offset = offset;
+        sym.size = compiled.code.size();
+    }
+
+    for (std::size_t i = 0; i < mod.symbols().size(); ++i) {
+        const auto& sym = mod.symbols()[i];
+        if (sym.link == linkage::internal && object.get_symbol(symbols[i]).section == undefined_section) {
+            return error("`{}` is declared static but never defined", sym.name);
+        }
+    }
+    return {};
+}
@@ -0,0 +1,47 @@
+#ifndef _COMPILER_CODEGEN_X86_64_CODEGEN_HPP
+
+#include "../../../common/common.hpp"
+#include "../../../common/result.hpp"
+#include "../../../common/error.hpp"
+#include "../../../common/thread_pool.hpp"
+
+#include "../../ir/ir.hpp"
+#include "../object.hpp"
+
+#include <cstdint>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace codegen {
+namespace x86_64 {
+
+// The machine code of a single function, its relocations are relative to the start of
+// "code".
+struct compiled_function {
+    std::vector<std::uint8_t> code{};
+    std::vector<relocation> relocations{};
+};
+
+/*
+  Compile one function to machine code. "symbols" maps every ir::symbol_id of the module to
+  its symbol in the object file.
+
+  This only reads the module, so different functions can be compiled at the same time.
+*/
+NODISCARD compiled_function compile_function(
+    const ir::module& mod,
+    const ir::function& fn,
+    const std::vector<object_symbol_id>& symbols
+) noexcept;
+
+// Compile the whole module into "object", functions go into .text and globals into .data
+// and .bss. The functions are compiled on "pool" and laid out in module order, the object
+// is the same no matter how many threads there are.
+NODISCARD result<void, error> generate(const ir::module& mod, object_file& object, thread_pool& pool) noexcept;
+
+} // namespace x86_64
+} // namespace codegen
+COMPILER_API_END
+
+#define _COMPILER_CODEGEN_X86_64_CODEGEN_HPP
+#endif // !_COMPILER_CODEGEN_X86_64_CODEGEN_HPP
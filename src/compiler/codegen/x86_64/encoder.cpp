@@ -0,0 +1,492 @@
+#include "encoder.hpp"
+
+#include <cstring>
+
+using namespace compiler::codegen;
+using namespace compiler::codegen::x86_64;
+
+namespace {
+
+constexpr std::uint32_t unbound = ~std::uint32_t{ 0 };
+// there is no index register, see the SIB byte.
+constexpr std::uint8_t no_index = 4;
+
+inline bool fits_i8(std::int64_t v) noexcept { return v >= -128 && v <= 127; }
+inline bool fits_i32(std::int64_t v) noexcept { return v >= INT32_MIN && v <= INT32_MAX; }
+inline bool fits_u32(std::int64_t v) noexcept { return v >= 0 && v <= static_cast<std::int64_t>(UINT32_MAX); }
+
+// spl, bpl, sil and dil can only be encoded with a REX prefix.
+inline bool needs_rex_for_byte(std::uint8_t r) noexcept { return r >= 4 && r <= 7; }
+
+inline std::uint8_t scale_bits(std::uint8_t scale) noexcept {
+    switch (scale) {
+    case 2: return 1;
+    case 4: return 2;
+    case 8: return 3;
+    default: return 0;
+    }
+}
+
+} // namespace
+
+label encoder::new_label() noexcept {
+    m_labels.push_back(unbound);
+    return static_cast<label>(m_labels.size() - 1);
+}
+
+void encoder::bind(label l) noexcept {
+    m_labels[l] = size();
+}
+
+void encoder::finalize() noexcept {
+    for (const auto& fix : m_fixups) {
+        const auto target = m_labels[fix.target];
+        const auto rel = static_cast<std::int32_t>(target - (fix.position + 4));
+        std::memcpy(m_code.data() + fix.position, &rel, sizeof(rel));
+    }
+    m_fixups.clear();
+}
+
+void encoder::emit32(std::uint32_t v) noexcept {
+    for (int i = 0; i < 4; ++i) {
+        emit8(static_cast<std::uint8_t>(v >> (i * 8)));
+    }
+}
+
+void encoder::emit64(std::uint64_t v) noexcept {
+    for (int i = 0; i < 8; ++i) {
+        emit8(static_cast<std::uint8_t>(v >> (i * 8)));
+    }
+}
+
+void encoder::emit_opcode(std::initializer_list<std::uint8_t> opcode) noexcept {
+    for (auto b : opcode) {
+        emit8(b);
+    }
+}
+
+void encoder::emit_prefix(width w, std::uint8_t reg_field, std::uint8_t index, std::uint8_t base, bool byte_regs) noexcept {
+    if (w == width::b16) {
+        emit8(0x66);
+    }
+    std::uint8_t rex = 0;
+    if (w == width::b64) rex |= 0x08;
+    if (reg_field & 8) rex |= 0x04;
+    if (index & 8) rex |= 0x02;
+    if (base & 8) rex |= 0x01;
+    if (rex != 0 || byte_regs) {
+        emit8(0x40 | rex);
+    }
+}
+
+void encoder::emit_modrm_reg(std::uint8_t reg_field, reg rm) noexcept {
+    emit8(static_cast<std::uint8_t>(0xC0 | ((reg_field & 7) << 3) | (encoding(rm) & 7)));
+}
+
+void encoder::emit_modrm_mem(std::uint8_t reg_field, const mem& rm) noexcept {
+    const auto base = encoding(rm.base) & 7;
+    const auto r = static_cast<std::uint8_t>((reg_field & 7) << 3);
+
+    std::uint8_t mod;
+    // [rbp] and [r13] have no mod=00 form, that encoding means rip relative (or disp32).
+    if (rm.disp == 0 && base != 5) {
+        mod = 0x00;
+    }
+    else if (fits_i8(rm.disp)) {
+        mod = 0x40;
+    }
+    else {
+        mod = 0x80;
+    }
+
+    // rsp and r12 as a base always need a SIB byte.
+    if (rm.has_index || base == 4) {
+        emit8(mod | r | 4);
+        const auto index = rm.has_index ? (encoding(rm.index) & 7) : no_index;
+        emit8(static_cast<std::uint8_t>((scale_bits(rm.scale) << 6) | (index << 3) | base));
+    }
+    else {
+        emit8(mod | r | base);
+    }
+
+    if (mod == 0x40) {
+        emit8(static_cast<std::uint8_t>(rm.disp));
+    }
+    else if (mod == 0x80) {
+        emit32(static_cast<std::uint32_t>(rm.disp));
+    }
+}
+
+void encoder::emit_rr(width w, std::initializer_list<std::uint8_t> opcode, std::uint8_t reg_field, reg rm, bool reg_field_is_reg) noexcept {
+    const bool byte_regs = w == width::b8
+        && ((reg_field_is_reg && needs_rex_for_byte(reg_field)) || needs_rex_for_byte(encoding(rm)));
+    emit_prefix(w, reg_field_is_reg ? reg_field : 0, 0, encoding(rm), byte_regs);
+    emit_opcode(opcode);
+    emit_modrm_reg(reg_field, rm);
+}
+
+void encoder::emit_rm(width w, std::initializer_list<std::uint8_t> opcode, std::uint8_t reg_field, const mem& rm, bool reg_field_is_reg) noexcept {
+    const bool byte_regs = w == width::b8 && reg_field_is_reg && needs_rex_for_byte(reg_field);
+    emit_prefix(w, reg_field_is_reg ? reg_field : 0, rm.has_index ? encoding(rm.index) : 0, encoding(rm.base), byte_regs);
+    emit_opcode(opcode);
+    emit_modrm_mem(reg_field, rm);
+}
+
+void encoder::emit_vec_prefix(std::uint8_t prefix, std::uint8_t map, bool w64, vec_width w, std::uint8_t reg_field, std::uint8_t vvvv, std::uint8_t index, std::uint8_t base) noexcept {
+    if (!m_vex && w == vec_width::v128) {
+        if (prefix != 0) {
+            emit8(prefix);
+        }
+        emit_prefix(w64 ? width::b64 : width::b32, reg_field, index, base, false);
+        emit8(0x0F);
+        if (map == 2) {
+            emit8(0x38);
+        }
+        else if (map == 3) {
+            emit8(0x3A);
+        }
+        return;
+    }
+
+    // VEX stores R, X, B and vvvv inverted.
+    const std::uint8_t pp = prefix == 0x66 ? 1 : prefix == 0xF3 ? 2 : prefix == 0xF2 ? 3 : 0;
+    const std::uint8_t r = (reg_field & 8) ? 0 : 0x80;
+    const std::uint8_t x = (index & 8) ? 0 : 0x40;
+    const std::uint8_t b = (base & 8) ? 0 : 0x20;
+    const auto tail = static_cast<std::uint8_t>(((~vvvv & 15) << 3) | (w == vec_width::v256 ? 4 : 0) | pp);
+    // the two byte form implies 0F, W0 and no X or B.
+    if (map == 1 && !w64 && x && b) {
+        emit8(0xC5);
+        emit8(static_cast<std::uint8_t>(r | tail));
+        return;
+    }
+    emit8(0xC4);
+    emit8(static_cast<std::uint8_t>(r | x | b | map));
+    emit8(static_cast<std::uint8_t>((w64 ? 0x80 : 0) | tail));
+}
+
+void encoder::emit_vec_rr(std::uint8_t prefix, std::uint8_t map, std::uint8_t op, bool w64, vec_width w, std::uint8_t reg_field, std::uint8_t vvvv, std::uint8_t rm) noexcept {
+    emit_vec_prefix(prefix, map, w64, w, reg_field, vvvv, 0, rm);
+    emit8(op);
+    emit_modrm_reg(reg_field, static_cast<reg>(rm));
+}
+
+void encoder::emit_vec_rm(std::uint8_t prefix, std::uint8_t map, std::uint8_t op, bool w64, vec_width w, std::uint8_t reg_field, std::uint8_t vvvv, const mem& rm) noexcept {
+    emit_vec_prefix(prefix, map, w64, w, reg_field, vvvv, rm.has_index ? encoding(rm.index) : 0, encoding(rm.base));
+    emit8(op);
+    emit_modrm_mem(reg_field, rm);
+}
+
+void encoder::emit_rip(width w, std::initializer_list<std::uint8_t> opcode, std::uint8_t reg_field, object_symbol_id symbol, std::int64_t addend) noexcept {
+    emit_prefix(w, reg_field, 0, 0, false);
+    emit_opcode(opcode);
+    emit8(static_cast<std::uint8_t>(((reg_field & 7) << 3) | 5));
+    // the displacement is relative to the end of the instruction, which is right after it.
+    m_relocations.push_back(relocation{ size(), symbol, relocation_kind::pc32, addend - 4 });
+    emit32(0);
+}
+
+void encoder::mov(width w, reg dst, reg src) noexcept {
+    emit_rr(w, { static_cast<std::uint8_t>(w == width::b8 ? 0x88 : 0x89) }, encoding(src), dst);
+}
+
+void encoder::mov(width w, reg dst, const mem& src) noexcept {
+    emit_rm(w, { static_cast<std::uint8_t>(w == width::b8 ? 0x8A : 0x8B) }, encoding(dst), src);
+}
+
+void encoder::mov(width w, const mem& dst, reg src) noexcept {
+    emit_rm(w, { static_cast<std::uint8_t>(w == width::b8 ? 0x88 : 0x89) }, encoding(src), dst);
+}
+
+void encoder::mov_imm(width w, reg dst, std::int64_t imm) noexcept {
+    // writing a 32-bit register clears the upper half, so this is the shortest form.
+    if (w != width::b64 || fits_u32(imm)) {
+        if (w == width::b64) {
+            w = width::b32;
+        }
+        const bool byte_regs = w == width::b8 && needs_rex_for_byte(encoding(dst));
+        emit_prefix(w, 0, 0, encoding(dst), byte_regs);
+        emit8(static_cast<std::uint8_t>((w == width::b8 ? 0xB0 : 0xB8) + (encoding(dst) & 7)));
+        switch (w) {
+        case width::b8: emit8(static_cast<std::uint8_t>(imm)); break;
+        case width::b16: emit8(static_cast<std::uint8_t>(imm)); emit8(static_cast<std::uint8_t>(imm >> 8)); break;
+        default: emit32(static_cast<std::uint32_t>(imm)); break;
+        }
+        return;
+    }
+    if (fits_i32(imm)) {
+        // sign extended imm32.
+        emit_rr(width::b64, { 0xC7 }, 0, dst, false);
+        emit32(static_cast<std::uint32_t>(imm));
+        return;
+    }
+    emit_prefix(width::b64, 0, 0, encoding(dst), false);
+    emit8(static_cast<std::uint8_t>(0xB8 + (encoding(dst) & 7)));
+    emit64(static_cast<std::uint64_t>(imm));
+}
+
+void encoder::mov_imm(width w, const mem& dst, std::int32_t imm) noexcept {
+    emit_rm(w, { static_cast<std::uint8_t>(w == width::b8 ? 0xC6 : 0xC7) }, 0, dst, false);
+    switch (w) {
+    case width::b8: emit8(static_cast<std::uint8_t>(imm)); break;
+    case width::b16: emit8(static_cast<std::uint8_t>(imm)); emit8(static_cast<std::uint8_t>(imm >> 8)); break;
+    default: emit32(static_cast<std::uint32_t>(imm)); break;
+    }
+}
+
+void encoder::movzx(reg dst, width from, reg src) noexcept {
+    if (from == width::b32) {
+        // a 32-bit move already zero extends.
+        mov(width::b32, dst, src);
+        return;
+    }
+    const bool byte_regs = from == width::b8 && needs_rex_for_byte(encoding(src));
+    emit_prefix(width::b32, encoding(dst), 0, encoding(src), byte_regs);
+    emit_opcode({ 0x0F, static_cast<std::uint8_t>(from == width::b8 ? 0xB6 : 0xB7) });
+    emit_modrm_reg(encoding(dst), src);
+}
+
+void encoder::movzx(reg dst, width from, const mem& src) noexcept {
+    if (from == width::b32) {
+        mov(width::b32, dst, src);
+        return;
+    }
+    emit_prefix(width::b32, encoding(dst), src.has_index ? encoding(src.index) : 0, encoding(src.base), false);
+    emit_opcode({ 0x0F, static_cast<std::uint8_t>(from == width::b8 ? 0xB6 : 0xB7) });
+    emit_modrm_mem(encoding(dst), src);
+}
+
+void encoder::movsx(width to, reg dst, width from, reg src) noexcept {
+    if (from == width::b32) {
+        // movsxd
+        emit_rr(width::b64, { 0x63 }, encoding(dst), src);
+        return;
+    }
+    const bool byte_regs = from == width::b8 && needs_rex_for_byte(encoding(src));
+    emit_prefix(to, encoding(dst), 0, encoding(src), byte_regs);
+    emit_opcode({ 0x0F, static_cast<std::uint8_t>(from == width::b8 ? 0xBE : 0xBF) });
+    emit_modrm_reg(encoding(dst), src);
+}
+
+void encoder::movsx(width to, reg dst, width from, const mem& src) noexcept {
+    if (from == width::b32) {
+        emit_rm(width::b64, { 0x63 }, encoding(dst), src);
+        return;
+    }
+    emit_prefix(to, encoding(dst), src.has_index ? encoding(src.index) : 0, encoding(src.base), false);
+    emit_opcode({ 0x0F, static_cast<std::uint8_t>(from == width::b8 ? 0xBE : 0xBF) });
+    emit_modrm_mem(encoding(dst), src);
+}
+
+void encoder::lea(reg dst, const mem& src) noexcept {
+    emit_rm(width::b64, { 0x8D }, encoding(dst), src);
+}
+
+void encoder::lea(reg dst, object_symbol_id symbol, std::int64_t addend) noexcept {
+    emit_rip(width::b64, { 0x8D }, encoding(dst), symbol, addend);
+}
+
+void encoder::alu(alu_op op, width w, reg dst, reg src) noexcept {
+    const auto base = static_cast<std::uint8_t>(static_cast<std::uint8_t>(op) << 3);
+    emit_rr(w, { static_cast<std::uint8_t>(base | (w == width::b8 ? 0x00 : 0x01)) }, encoding(src), dst);
+}
+
+void encoder::alu(alu_op op, width w, reg dst, const mem& src) noexcept {
+    const auto base = static_cast<std::uint8_t>(static_cast<std::uint8_t>(op) << 3);
+    emit_rm(w, { static_cast<std::uint8_t>(base | (w == width::b8 ? 0x02 : 0x03)) }, encoding(dst), src);
+}
+
+void encoder::alu_imm(alu_op op, width w, reg dst, std::int32_t imm) noexcept {
+    const auto digit = static_cast<std::uint8_t>(op);
+    if (w == width::b8) {
+        emit_rr(w, { 0x80 }, digit, dst, false);
+        emit8(static_cast<std::uint8_t>(imm));
+        return;
+    }
+    if (fits_i8(imm)) {
+        emit_rr(w, { 0x83 }, digit, dst, false);
+        emit8(static_cast<std::uint8_t>(imm));
+        return;
+    }
+    emit_rr(w, { 0x81 }, digit, dst, false);
+    if (w == width::b16) {
+        emit8(static_cast<std::uint8_t>(imm));
+        emit8(static_cast<std::uint8_t>(imm >> 8));
+    }
+    else {
+        emit32(static_cast<std::uint32_t>(imm));
+    }
+}
+
+void encoder::test(width w, reg lhs, reg rhs) noexcept {
+    emit_rr(w, { static_cast<std::uint8_t>(w == width::b8 ? 0x84 : 0x85) }, encoding(rhs), lhs);
+}
+
+void encoder::imul(width w, reg dst, reg src) noexcept {
+    emit_rr(w, { 0x0F, 0xAF }, encoding(dst), src);
+}
+
+void encoder::imul_imm(width w, reg dst, reg src, std::int32_t imm) noexcept {
+    if (fits_i8(imm)) {
+        emit_rr(w, { 0x6B }, encoding(dst), src);
+        emit8(static_cast<std::uint8_t>(imm));
+        return;
+    }
+    emit_rr(w, { 0x69 }, encoding(dst), src);
+    emit32(static_cast<std::uint32_t>(imm));
+}
+
+void encoder::unary(unary_op op, width w, reg r) noexcept {
+    emit_rr(w, { static_cast<std::uint8_t>(w == width::b8 ? 0xF6 : 0xF7) }, static_cast<std::uint8_t>(op), r, false);
+}
+
+void encoder::shift(shift_op op, width w, reg r) noexcept {
+    emit_rr(w, { static_cast<std::uint8_t>(w == width::b8 ? 0xD2 : 0xD3) }, static_cast<std::uint8_t>(op), r, false);
+}
+
+void encoder::shift_imm(shift_op op, width w, reg r, std::uint8_t amount) noexcept {
+    emit_rr(w, { static_cast<std::uint8_t>(w == width::b8 ? 0xC0 : 0xC1) }, static_cast<std::uint8_t>(op), r, false);
+    emit8(amount);
+}
+
+void encoder::sign_extend_ax(width w) noexcept {
+    if (w == width::b64) {
+        emit8(0x48);
+    }
+    emit8(0x99);
+}
+
+void encoder::setcc(cond c, reg dst) noexcept {
+    emit_rr(width::b8, { 0x0F, static_cast<std::uint8_t>(0x90 | static_cast<std::uint8_t>(c)) }, 0, dst, false);
+}
+
+void encoder::vmovdqu(vec_width w, xmm dst, const mem& src) noexcept {
+    emit_vec_rm(0xF3, 1, 0x6F, false, w, encoding(dst), 0, src);
+}
+
+void encoder::vmovdqu(vec_width w, const mem& dst, xmm src) noexcept {
+    emit_vec_rm(0xF3, 1, 0x7F, false, w, encoding(src), 0, dst);
+}
+
+void encoder::vmov(vec_width w, xmm dst, xmm src) noexcept {
+    emit_vec_rr(0x66, 1, 0x6F, false, w, encoding(dst), 0, encoding(src));
+}
+
+void encoder::vec(vec_op op, vec_width w, xmm dst, xmm src) noexcept {
+    emit_vec_rr(0x66, 1, static_cast<std::uint8_t>(op), false, w, encoding(dst), encoding(dst), encoding(src));
+}
+
+void encoder::pmulld(vec_width w, xmm dst, xmm src) noexcept {
+    emit_vec_rr(0x66, 2, 0x40, false, w, encoding(dst), encoding(dst), encoding(src));
+}
+
+void encoder::vec_shift_imm(vec_shift op, width lane, vec_width w, xmm r, std::uint8_t amount) noexcept {
+    const std::uint8_t opcode = lane == width::b16 ? 0x71 : lane == width::b32 ? 0x72 : 0x73;
+    // the VEX form writes vvvv and reads the modrm register.
+    emit_vec_rr(0x66, 1, opcode, false, w, static_cast<std::uint8_t>(op), encoding(r), encoding(r));
+    emit8(amount);
+}
+
+void encoder::vec_shift_by(vec_shift op, width lane, vec_width w, xmm r, xmm amount) noexcept {
+    const std::uint8_t row = op == vec_shift::sll ? 0xF0 : op == vec_shift::srl ? 0xD0 : 0xE0;
+    const std::uint8_t column = lane == width::b16 ? 1 : lane == width::b32 ? 2 : 3;
+    emit_vec_rr(0x66, 1, static_cast<std::uint8_t>(row | column), false, w, encoding(r), encoding(r), encoding(amount));
+}
+
+void encoder::psrldq(xmm r, std::uint8_t bytes) noexcept {
+    emit_vec_rr(0x66, 1, 0x73, false, vec_width::v128, 3, encoding(r), encoding(r));
+    emit8(bytes);
+}
+
+void encoder::pshufd(xmm dst, xmm src, std::uint8_t order) noexcept {
+    emit_vec_rr(0x66, 1, 0x70, false, vec_width::v128, encoding(dst), 0, encoding(src));
+    emit8(order);
+}
+
+void encoder::movd(width w, xmm dst, reg src) noexcept {
+    emit_vec_rr(0x66, 1, 0x6E, w == width::b64, vec_width::v128, encoding(dst), 0, encoding(src));
+}
+
+void encoder::movd(width w, reg dst, xmm src) noexcept {
+    emit_vec_rr(0x66, 1, 0x7E, w == width::b64, vec_width::v128, encoding(src), 0, encoding(dst));
+}
+
+void encoder::vpbroadcast(width lane, xmm dst, xmm src) noexcept {
+    std::uint8_t opcode = 0x59;
+    switch (lane) {
+    case width::b8: opcode = 0x78; break;
+    case width::b16: opcode = 0x79; break;
+    case width::b32: opcode = 0x58; break;
+    default: break;
+    }
+    emit_vec_rr(0x66, 2, opcode, false, vec_width::v256, encoding(dst), 0, encoding(src));
+}
+
+void encoder::vextracti128(xmm dst, xmm src, std::uint8_t half) noexcept {
+    emit_vec_rr(0x66, 3, 0x39, false, vec_width::v256, encoding(src), 0, encoding(dst));
+    emit8(half);
+}
+
+void encoder::vzeroupper() noexcept {
+    emit_opcode({ 0xC5, 0xF8, 0x77 });
+}
+
+void encoder::push(reg r) noexcept {
+    if (encoding(r) & 8) {
+        emit8(0x41);
+    }
+    emit8(static_cast<std::uint8_t>(0x50 + (encoding(r) & 7)));
+}
+
+void encoder::pop(reg r) noexcept {
+    if (encoding(r) & 8) {
+        emit8(0x41);
+    }
+    emit8(static_cast<std::uint8_t>(0x58 + (encoding(r) & 7)));
+}
+
+void encoder::ret() noexcept {
+    emit8(0xC3);
+}
+
+void encoder::leave() noexcept {
+    emit8(0xC9);
+}
+
+void encoder::int3() noexcept {
+    emit8(0xCC);
+}
+
+void encoder::call(object_symbol_id symbol) noexcept {
+    emit8(0xE8);
+    m_relocations.push_back(relocation{ size(), symbol, relocation_kind::plt32, -4 });
+    emit32(0);
+}
+
+void encoder::jmp(label target) noexcept {
+    if (is_bound(target)) {
+        const auto rel = static_cast<std::int64_t>(m_labels[target]) - (static_cast<std::int64_t>(size()) + 2);
+        if (fits_i8(rel)) {
+            emit8(0xEB);
+            emit8(static_cast<std::uint8_t>(rel));
+            return;
+        }
+    }
+    emit8(0xE9);
+    m_fixups.push_back(fixup{ size(), target });
+    emit32(0);
+}
+
+void encoder::jcc(cond c, label target) noexcept {
+    if (is_bound(target)) {
+        const auto rel = static_cast<std::int64_t>(m_labels[target]) - (static_cast<std::int64_t>(size()) + 2);
+        if (fits_i8(rel)) {
+            emit8(static_cast<std::uint8_t>(0x70 | static_cast<std::uint8_t>(c)));
+            emit8(static_cast<std::uint8_t>(rel));
+            return;
+        }
+    }
+    emit_opcode({ 0x0F, static_cast<std::uint8_t>(0x80 | static_cast<std::uint8_t>(c)) });
+    m_fixups.push_back(fixup{ size(), target });
+    emit32(0);
+}
@@ -0,0 +1,259 @@
+#ifndef _COMPILER_CODEGEN_X86_64_ENCODER_HPP
+
+#include "../../../common/common.hpp"
+
+#include "../object.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace codegen {
+namespace x86_64 {
+
+// The general purpose registers, in encoding order.
+enum class reg : std::uint8_t {
+    rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi,
+    r8, r9, r10, r11, r12, r13, r14, r15,
+};
+
+inline constexpr std::uint8_t reg_count = 16;
+inline constexpr std::uint8_t encoding(reg r) noexcept { return static_cast<std::uint8_t>(r); }
+
+// Operand size of an instruction.
+enum class width : std::uint8_t {
+    b8 = 1,
+    b16 = 2,
+    b32 = 4,
+    b64 = 8,
+};
+
+// Condition codes, the low nibble of jcc/setcc/cmovcc.
+enum class cond : std::uint8_t {
+    o, no, b, ae, e, ne, be, a,
+    s, ns, p, np, l, ge, le, g,
+};
+
+// The inverse of a condition, "a < b" -> "a >= b".
+inline constexpr cond negate(cond c) noexcept {
+    return static_cast<cond>(static_cast<std::uint8_t>(c) ^ 1);
+}
+
+// A memory operand, [base + index * scale + disp].
+struct mem {
+    reg base;
+    std::int32_t disp{ 0 };
+    bool has_index{ false };
+    reg index{ reg::rax };
+    std::uint8_t scale{ 1 };
+
+    static inline mem at(reg base, std::int32_t disp = 0) noexcept {
+        return mem{ base, disp };
+    }
+    static inline mem indexed(reg base, reg index, std::uint8_t scale, std::int32_t disp = 0) noexcept {
+        return mem{ base, disp, true, index, scale };
+    }
+};
+
+// The instructions that share the "op r/m, r" and "op r/m, imm" encodings.
+enum class alu_op : std::uint8_t {
+    add = 0,
+    or_ = 1,
+    and_ = 4,
+    sub = 5,
+    xor_ = 6,
+    cmp = 7,
+};
+
+// Group 3, "op r/m" with the operation in the reg field.
+enum class unary_op : std::uint8_t {
+    not_ = 2,
+    neg = 3,
+    mul = 4,
+    imul = 5,
+    div = 6,
+    idiv = 7,
+};
+
+enum class shift_op : std::uint8_t {
+    shl = 4,
+    shr = 5,
+    sar = 7,
+};
+
+// The vector registers, 128-bit instructions use them as xmm0-15 and 256-bit ones as ymm0-15.
+enum class xmm : std::uint8_t {
+    xmm0, xmm1, xmm2, xmm3, xmm4, xmm5, xmm6, xmm7,
+    xmm8, xmm9, xmm10, xmm11, xmm12, xmm13, xmm14, xmm15,
+};
+
+inline constexpr std::uint8_t encoding(xmm r) noexcept { return static_cast<std::uint8_t>(r); }
+
+// The size of a vector instruction, 256 bits needs AVX (AVX2 for integers).
+enum class vec_width : std::uint8_t {
+    v128,
+    v256,
+};
+
+// Packed integer instructions of the form "66 0F op /r", dst = dst op src.
+enum class vec_op : std::uint8_t {
+    paddb = 0xFC,
+    paddw = 0xFD,
+    paddd = 0xFE,
+    paddq = 0xD4,
+    psubb = 0xF8,
+    psubw = 0xF9,
+    psubd = 0xFA,
+    psubq = 0xFB,
+    pmullw = 0xD5,
+    pand = 0xDB,
+    por = 0xEB,
+    pxor = 0xEF,
+    pcmpeqd = 0x76,
+    punpcklbw = 0x60,
+    punpcklwd = 0x61,
+    punpcklqdq = 0x6C,
+};
+
+// Lane by lane shifts, the values are the reg field of their immediate forms.
+enum class vec_shift : std::uint8_t {
+    srl = 2,
+    sra = 4,
+    sll = 6,
+};
+
+using label = std::uint32_t;
+
+/*
+  Encodes x86-64 machine code straight into a byte buffer, no assembler involved.
+
+  Vector instructions use the legacy SSE encoding unless set_vex() is on, then they're
+  encoded with VEX prefixes (their AVX forms). 256-bit instructions only exist as VEX, and a
+  function that uses them should encode everything that way, switching between the two
+  encodings with dirty upper halves is slow.
+
+  Jumps go to labels, which can be bound before or after the jump. Backward jumps that are
+  close enough use the short rel8 form, forward jumps always use rel32 and are patched by
+  finalize(). References to symbols are recorded as relocations with offsets relative to
+  the start of this buffer.
+*/
+class encoder {
+private:
+    struct fixup {
+        std::uint32_t position;
+        label target;
+    };
+
+    std::vector<std::uint8_t> m_code{};
+    std::vector<relocation> m_relocations{};
+    std::vector<std::uint32_t> m_labels{};
+    std::vector<fixup> m_fixups{};
+    bool m_vex{ false };
+public:
+    inline const std::vector<std::uint8_t>& code() const noexcept { return m_code; }
+    inline std::vector<std::uint8_t>& code() noexcept { return m_code; }
+    inline const std::vector<relocation>& relocations() const noexcept { return m_relocations; }
+    inline std::uint32_t size() const noexcept { return static_cast<std::uint32_t>(m_code.size()); }
+
+    label new_label() noexcept;
+    void bind(label l) noexcept;
+    inline bool is_bound(label l) const noexcept { return m_labels[l] != ~std::uint32_t{ 0 }; }
+    // Patch every forward jump, call this once all labels are bound.
+    void finalize() noexcept;
+
+    // mov
+    void mov(width w, reg dst, reg src) noexcept;
+    void mov(width w, reg dst, const mem& src) noexcept;
+    void mov(width w, const mem& dst, reg src) noexcept;
+    void mov_imm(width w, reg dst, std::int64_t imm) noexcept;
+    void mov_imm(width w, const mem& dst, std::int32_t imm) noexcept;
+    // zero/sign extend "from" bits into a 32-bit (movzx) or "to" bits (movsx) register.
+    void movzx(reg dst, width from, reg src) noexcept;
+    void movzx(reg dst, width from, const mem& src) noexcept;
+    void movsx(width to, reg dst, width from, reg src) noexcept;
+    void movsx(width to, reg dst, width from, const mem& src) noexcept;
+    void lea(reg dst, const mem& src) noexcept;
+    // lea dst, [rip + symbol + addend]
+    void lea(reg dst, object_symbol_id symbol, std::int64_t addend = 0) noexcept;
+
+    // arithmetic
+    void alu(alu_op op, width w, reg dst, reg src) noexcept;
+    void alu(alu_op op, width w, reg dst, const mem& src) noexcept;
+    void alu_imm(alu_op op, width w, reg dst, std::int32_t imm) noexcept;
+    void test(width w, reg lhs, reg rhs) noexcept;
+    void imul(width w, reg dst, reg src) noexcept;
+    void imul_imm(width w, reg dst, reg src, std::int32_t imm) noexcept;
+    void unary(unary_op op, width w, reg r) noexcept;
+    // shift "r" by cl.
+    void shift(shift_op op, width w, reg r) noexcept;
+    void shift_imm(shift_op op, width w, reg r, std::uint8_t amount) noexcept;
+    // sign extend rax into rdx, cdq for 32-bit and cqo for 64-bit.
+    void sign_extend_ax(width w) noexcept;
+    void setcc(cond c, reg dst) noexcept;
+
+    // vectors
+    inline void set_vex(bool vex) noexcept { m_vex = vex; }
+    // movdqu, unaligned loads and stores.
+    void vmovdqu(vec_width w, xmm dst, const mem& src) noexcept;
+    void vmovdqu(vec_width w, const mem& dst, xmm src) noexcept;
+    // movdqa between registers.
+    void vmov(vec_width w, xmm dst, xmm src) noexcept;
+    void vec(vec_op op, vec_width w, xmm dst, xmm src) noexcept;
+    // pmulld is SSE4.1.
+    void pmulld(vec_width w, xmm dst, xmm src) noexcept;
+    // shift the "lane" sized lanes of "r" by "amount", or by the low 64 bits of "amount".
+    void vec_shift_imm(vec_shift op, width lane, vec_width w, xmm r, std::uint8_t amount) noexcept;
+    void vec_shift_by(vec_shift op, width lane, vec_width w, xmm r, xmm amount) noexcept;
+    // shift the low 128 bits right by "bytes" bytes.
+    void psrldq(xmm r, std::uint8_t bytes) noexcept;
+    void pshufd(xmm dst, xmm src, std::uint8_t order) noexcept;
+    // movd/movq between an integer register and the low lane.
+    void movd(width w, xmm dst, reg src) noexcept;
+    void movd(width w, reg dst, xmm src) noexcept;
+    // AVX2: copy the low "lane" of "src" into every lane of the 256-bit "dst".
+    void vpbroadcast(width lane, xmm dst, xmm src) noexcept;
+    // AVX2: the 128-bit half "half" of "src".
+    void vextracti128(xmm dst, xmm src, std::uint8_t half) noexcept;
+    // clear the upper halves of the ymm registers, before calls and returns.
+    void vzeroupper() noexcept;
+
+    // stack and control flow
+    void push(reg r) noexcept;
+    void pop(reg r) noexcept;
+    void ret() noexcept;
+    void leave() noexcept;
+    void call(object_symbol_id symbol) noexcept;
+    void jmp(label target) noexcept;
+    void jcc(cond c, label target) noexcept;
+    void int3() noexcept;
+private:
+    inline void emit8(std::uint8_t b) noexcept { m_code.push_back(b); }
+    void emit32(std::uint32_t v) noexcept;
+    void emit64(std::uint64_t v) noexcept;
+    void emit_opcode(std::initializer_list<std::uint8_t> opcode) noexcept;
+
+    // Prefixes (operand size, REX) for an instruction with the given register fields.
+    void emit_prefix(width w, std::uint8_t reg_field, std::uint8_t index, std::uint8_t base, bool byte_regs) noexcept;
+    void emit_modrm_reg(std::uint8_t reg_field, reg rm) noexcept;
+    void emit_modrm_mem(std::uint8_t reg_field, const mem& rm) noexcept;
+
+    // op reg_field, r/m where r/m is a register.
+    void emit_rr(width w, std::initializer_list<std::uint8_t> opcode, std::uint8_t reg_field, reg rm, bool reg_field_is_reg = true) noexcept;
+    // op reg_field, r/m where r/m is memory.
+    void emit_rm(width w, std::initializer_list<std::uint8_t> opcode, std::uint8_t reg_field, const mem& rm, bool reg_field_is_reg = true) noexcept;
+    // A vector instruction: "prefix" is the mandatory prefix (0x66, 0xF3 or 0), "map" the
+    // opcode map (1 = 0F, 2 = 0F38, 3 = 0F3A), "vvvv" the extra source of the VEX form.
+    void emit_vec_prefix(std::uint8_t prefix, std::uint8_t map, bool w64, vec_width w, std::uint8_t reg_field, std::uint8_t vvvv, std::uint8_t index, std::uint8_t base) noexcept;
+    void emit_vec_rr(std::uint8_t prefix, std::uint8_t map, std::uint8_t op, bool w64, vec_width w, std::uint8_t reg_field, std::uint8_t vvvv, std::uint8_t rm) noexcept;
+    void emit_vec_rm(std::uint8_t prefix, std::uint8_t map, std::uint8_t op, bool w64, vec_width w, std::uint8_t reg_field, std::uint8_t vvvv, const mem& rm) noexcept;
+    // a rip relative operand with a relocation against "symbol".
+    void emit_rip(width w, std::initializer_list<std::uint8_t> opcode, std::uint8_t reg_field, object_symbol_id symbol, std::int64_t addend) noexcept;
+};
+
+} // namespace x86_64
+} // namespace codegen
+COMPILER_API_END
+
+#define _COMPILER_CODEGEN_X86_64_ENCODER_HPP
+#endif // !_COMPILER_CODEGEN_X86_64_ENCODER_HPP
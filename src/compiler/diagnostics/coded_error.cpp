@@ -0,0 +1,39 @@
+#include "coded_error.hpp"
+
+#include <format>
+
+namespace {
+
+constexpr std::string_view formats[] = {
+#define X(code, format) format,
+    COMPILER_ERROR_CODES(X)
+#undef X
+};
+
+} // namespace
+
+std::string compiler::coded_error::message() const noexcept {
+    std::array<std::string, max_args> args{};
+    for (std::size_t i = 0; i < m_arg_count; ++i) {
+        switch (m_kinds[i]) {
+        case arg_kind::integer:
+            args[i] = std::to_string(m_args[i]);
+            break;
+        case arg_kind::character: {
+            // a control byte (a NUL would even cut the message short) is written as an escape.
+            const auto c = static_cast<unsigned char>(m_args[i]);
+            args[i] = c >= 0x20 && c < 0x7f ? std::string(1, static_cast<char>(c)) : std::format("\\x{:02x}", c);
+            break;
+        }
+        case arg_kind::token:
+            args[i] = token_type_to_string(static_cast<token_type>(m_args[i]));
+            break;
+        }
+    }
+    static_assert(max_args == 2, "coded_error::message() passes max_args arguments to vformat.");
+    return std::vformat(formats[static_cast<std::size_t>(m_code)], std::make_format_args(args[0], args[1]));
+}
+
+error compiler::coded_error::to_error(std::string_view file) const noexcept {
+    return error("{} at ({}:{}:{})", message(), file, line(), column());
+}
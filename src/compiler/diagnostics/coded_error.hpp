@@ -0,0 +1,103 @@
+#ifndef _COMPILER_DIAGNOSTICS_CODED_ERROR_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/error.hpp"
+
+#include "../types.hpp"
+#include "../lexing/token_type.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+COMPILER_API_BEGIN
+
+// Every error the lexer and parser can fail with, as X(code, format). The format gets the
+// error's arguments in order.
+#define COMPILER_ERROR_CODES(X)                                                                          \
+    X(unexpected_character, "unexpected character ({})")                                                \
+    X(invalid_number_start, "invalid character for the start of an integral literal ({})")              \
+    X(multiple_decimal_points, "invalid numeric literal. floating point numbers can only contain one \".\"") \
+    X(float_suffix, "invalid suffix, cannot use \"{}\" suffix on a floating point number")               \
+    X(invalid_suffix, "invalid suffix, cannot use \"{}\" suffix on an integer")                            \
+    X(invalid_digit, "invalid digit ({}) in a base {} literal")                                          \
+    X(missing_digits, "invalid numeric literal, it has no digits")                                       \
+    X(missing_exponent_digits, "invalid numeric literal, the exponent has no digits")                    \
+    X(hex_float_exponent, "invalid numeric literal, hexadecimal floating point numbers need a \"p\" exponent") \
+    X(integer_too_large, "integer literal is too large for any integer type")                            \
+    X(invalid_identifier_start, "invalid character for the start of an identifier ({}) (A-z+_ is supported)") \
+    X(expected_double_quote, "expected double quote")                                                    \
+    X(unterminated_string, "unexpected end of file while lexing string literal")                         \
+    X(expected_single_quote, "expected single quote")                                                    \
+    X(expected_escape, "expected escape character after backslash")                                      \
+    X(unknown_escape, "unrecognized escape character ({})")                                              \
+    X(escape_out_of_range, "escape sequence out of range, it doesn't fit in a char")                     \
+    X(newline_in_string, "missing terminating double quote before the end of the line")                 \
+    X(syntax_error, "invalid syntax, the diagnostic has the details")
+
+enum class error_code : std::uint8_t {
+#define X(code, format) code,
+    COMPILER_ERROR_CODES(X)
+#undef X
+};
+
+/*
+  An error that costs as much as a couple of integers: a code, where it happened and up to
+  max_args small arguments (integers, characters or token types). Nothing is allocated or
+  formatted when it's created, message() does that, and only a failure that actually gets
+  reported ever calls it. The lexer and parser fail a lot on bad input (and the parser
+  recovers from most of it), so they use this instead of error.
+*/
+class coded_error {
+public:
+    static constexpr std::size_t max_args = 2;
+private:
+    enum class arg_kind : std::uint8_t { integer, character, token };
+
+    error_code m_code;
+    std::uint8_t m_arg_count{ 0 };
+    std::array<arg_kind, max_args> m_kinds{};
+    // line in the high 32 bits, column in the low 32.
+    std::uint64_t m_location{ 0 };
+    std::array<std::uint64_t, max_args> m_args{};
+
+    inline void push(char c) noexcept { push(arg_kind::character, static_cast<unsigned char>(c)); }
+    inline void push(token_type type) noexcept { push(arg_kind::token, static_cast<std::uint64_t>(type)); }
+    template<class T> requires std::is_integral_v<T>
+    inline void push(T value) noexcept { push(arg_kind::integer, static_cast<std::uint64_t>(value)); }
+    inline void push(arg_kind kind, std::uint64_t value) noexcept {
+        m_kinds[m_arg_count] = kind;
+        m_args[m_arg_count++] = value;
+    }
+public:
+    template<class... Args>
+    inline coded_error(error_code code, std::size_t line, std::size_t column, Args... args) noexcept
+        : m_code(code)
+        , m_location(static_cast<std::uint64_t>(line) << 32 | static_cast<std::uint32_t>(column))
+    {
+        static_assert(sizeof...(Args) <= max_args, "coded_error: too many arguments.");
+        (push(args), ...);
+    }
+
+    template<class... Args>
+    static inline coded_error at(error_code code, const source_location& location, Args... args) noexcept {
+        return coded_error(code, location.line(), location.column(), args...);
+    }
+
+    inline error_code code() const noexcept { return m_code; }
+    inline std::size_t line() const noexcept { return static_cast<std::size_t>(m_location >> 32); }
+    inline std::size_t column() const noexcept { return static_cast<std::size_t>(m_location & 0xFFFFFFFFu); }
+
+    // The formatted message, without the location.
+    COMPILER_API std::string message() const noexcept;
+    // The message with "file"'s location of this error, for code that deals in error.
+    COMPILER_API error to_error(std::string_view file) const noexcept;
+};
+
+COMPILER_API_END
+
+#define _COMPILER_DIAGNOSTICS_CODED_ERROR_HPP
+#endif // !_COMPILER_DIAGNOSTICS_CODED_ERROR_HPP
@@ -3,11 +3,13 @@
 #include "../../common/io.hpp"
 
 #include <format>
+#include <iterator>
+#include <string_view>
 
 constexpr static inline auto FAILED_TO_BUILD = "(failed to build diagnostic)";
 
 compiler::diagnostic::diagnostic(const std::string& message, const source_location& location, diag_level level, std::optional<std::vector<std::string>> notes) noexcept
-    : m_location(location), m_message(message), m_level(level) 
+    : m_message(message), m_location(location), m_level(level)
 {
     if (notes.has_value()) {
         m_notes = std::move(notes.value());
@@ -20,14 +22,25 @@ std::string compiler::diagnostic::build_into_message(const std::vector<std::stri
     // Get the source location as a string.
     const auto source_info = m_location.to_string();
 
-    if (m_location.line() > src.size()) {
+    const auto prefix = m_level == diag_level::error ? "ERROR" : "WARNING";
+
+    // no source at all (tokens loaded with --load-tokens), there's no line to quote.
+    if (src.empty()) {
+        auto message = std::format("[{}]: {}\n  --> ({})\n", prefix, m_message, source_info);
+        for (const auto& note : m_notes) {
+            message += std::format(" = note: {}", note);
+        }
+        return message;
+    }
+
+    // lines are counted from 1.
+    if (m_location.line() == 0 || m_location.line() > src.size()) {
         eprintln("failed to build diagnostic into string!");
         eprintln("the source information's line is larger than the source itself.");
         return FAILED_TO_BUILD;
     }
 
-    const std::string& line_of_diag = src.at(m_location.line());
-    const auto prefix = m_level == diag_level::error ? "ERROR" : "WARNING";
+    const std::string& line_of_diag = src.at(m_location.line() - 1);
 
     // Returns something like:
     /*
@@ -50,4 +63,70 @@ std::string compiler::diagnostic::build_into_message(const std::vector<std::stri
     }
 
     return baseline_message;
-}
\ No newline at end of file
+}
+void compiler::write_json_string(std::string& out, std::string_view text) noexcept {
+    out.push_back('"');
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+            }
+            else {
+                out.push_back(c);
+            }
+            break;
+        }
+    }
+    out.push_back('"');
+}
+
+void compiler::diagnostic::write_to(std::string& out, const std::vector<std::string>& src, diag_format format) const noexcept {
+    if (format == diag_format::text) {
+        out += build_into_message(src);
+        out.push_back('\n');
+        return;
+    }
+
+    out += R"({"level":)";
+    out += m_level == diag_level::error ? R"("error")" : R"("warning")";
+    out += R"(,"message":)";
+    write_json_string(out, m_message);
+    out += R"(,"file":)";
+    write_json_string(out, m_location.source_file());
+    std::format_to(std::back_inserter(out), R"(,"line":{},"column":{},"notes":[)", m_location.line(), m_location.column());
+    for (std::size_t i = 0; i < m_notes.size(); ++i) {
+        if (i != 0) {
+            out.push_back(',');
+        }
+        write_json_string(out, m_notes[i]);
+    }
+    out += "]}\n";
+}
+
+void compiler::diagnostic_writer::write(const diagnostic& diag) const noexcept {
+    auto& sink = output_sink::err();
+    const auto start = sink.buffer().size();
+    static const std::vector<std::string> no_lines{};
+    const bool has_lines = m_file.empty() || diag.location().source_file() == m_file;
+    diag.write_to(sink.buffer(), has_lines ? *m_src : no_lines, m_format);
+    if (m_record != nullptr) {
+        m_record->append(sink.buffer(), start);
+    }
+    sink.end_message();
+}
@@ -4,7 +4,9 @@
 #include "../../common/common.hpp"
 #include "../types.hpp"
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 COMPILER_API_BEGIN
@@ -13,6 +15,18 @@ enum class diag_level {
     warning, error  
 };
 
+// How diagnostics are written, see diagnostic::write_to().
+enum class diag_format {
+    // build_into_message(), for people.
+    text,
+    // one JSON object per line, for tools:
+    //   {"level":"error","message":"...","file":"a.c","line":1,"column":5,"notes":["..."]}
+    json
+};
+
+// Append "text" to "out" as a JSON string, quotes included.
+COMPILER_API void write_json_string(std::string& out, std::string_view text) noexcept;
+
 class diagnostic {
 private:
     std::string m_message;
@@ -36,6 +50,34 @@ public:
 
     COMPILER_API inline void push_note(const std::string& note) noexcept { m_notes.push_back(note); }
     COMPILER_API std::string build_into_message(const std::vector<std::string>& src) const noexcept;
+    // Append this diagnostic in "format" to "out", ending with a newline. JSON is escaped
+    // straight into "out", nothing else is allocated.
+    COMPILER_API void write_to(std::string& out, const std::vector<std::string>& src, diag_format format) const noexcept;
+};
+
+/*
+  Writes diagnostics to stderr as they are produced, instead of collecting them until a
+  phase is done. Each diagnostic is a single message on the sink, so a tool reading the
+  JSON lines sees it as soon as it's known. "src" has to outlive the writer.
+
+  "file" is the file "src" holds the lines of, a diagnostic located in any other file (a
+  declaration from a precompiled header) is written without quoting a line. Empty if every
+  diagnostic comes from "src".
+*/
+class diagnostic_writer {
+private:
+    const std::vector<std::string>* m_src;
+    diag_format m_format;
+    // everything written is also appended here, if it's set. (what the compile cache keeps)
+    std::string* m_record;
+    std::string m_file;
+public:
+    COMPILER_API inline diagnostic_writer(const std::vector<std::string>& src, diag_format format, std::string* record = nullptr, std::string file = {}) noexcept
+        : m_src(&src), m_format(format), m_record(record), m_file(std::move(file))
+    {}
+
+    COMPILER_API inline diag_format format() const noexcept { return m_format; }
+    COMPILER_API void write(const diagnostic& diag) const noexcept;
 };
 
 class diagnostic_builder {
@@ -72,6 +114,15 @@ public:
     COMPILER_API inline diagnostic build() const noexcept {
         return diagnostic(m_message, m_location, m_level, std::optional(m_notes));
     }
+
+    // build() and write the diagnostic out right away with "writer", if there is one.
+    COMPILER_API inline diagnostic emit(const std::optional<diagnostic_writer>& writer) const noexcept {
+        auto diag = build();
+        if (writer) {
+            writer->write(diag);
+        }
+        return diag;
+    }
 };
 
 COMPILER_API inline diagnostic_builder make_diag_builder() noexcept {
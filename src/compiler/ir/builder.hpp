@@ -0,0 +1,112 @@
+#ifndef _COMPILER_IR_BUILDER_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+// Helper to append instructions to the end of a block.
+class builder {
+private:
+    function& m_function;
+    block_id m_block{ invalid_id };
+public:
+    inline explicit builder(function& fn) noexcept
+        : m_function(fn)
+    {}
+
+    inline function& fn() noexcept { return m_function; }
+
+    inline void set_insert_point(block_id block) noexcept { m_block = block; }
+    inline block_id insert_point() const noexcept { return m_block; }
+
+    // Has the current block already been terminated? Nothing can be added after a terminator.
+    inline bool is_terminated() const noexcept {
+        return m_block == invalid_id || m_function.terminator(m_block) != invalid_id;
+    }
+
+    inline value_id emit(
+        opcode op,
+        value_type type,
+        std::initializer_list<value_id> operands = {},
+        std::int64_t imm = 0,
+        std::initializer_list<block_id> targets = {}
+    ) noexcept {
+        const auto id = m_function.create(op, type,
+            std::span<const value_id>(operands.begin(), operands.size()), imm,
+            std::span<const block_id>(targets.begin(), targets.size()));
+        m_function.append(m_block, id);
+        return id;
+    }
+
+    inline value_id param(value_type type, std::uint32_t index) noexcept {
+        return emit(opcode::param, type, {}, index);
+    }
+    inline value_id iconst(value_type type, std::int64_t value) noexcept {
+        return emit(opcode::iconst, type, {}, value);
+    }
+    inline value_id binary(opcode op, value_type type, value_id lhs, value_id rhs) noexcept {
+        return emit(op, type, { lhs, rhs });
+    }
+    inline value_id unary(opcode op, value_type type, value_id value) noexcept {
+        return emit(op, type, { value });
+    }
+    inline value_id icmp(cmp_pred pred, value_id lhs, value_id rhs) noexcept {
+        return emit(opcode::icmp, value_type::i1, { lhs, rhs }, static_cast<std::int64_t>(pred));
+    }
+    inline value_id cast(opcode op, value_type to, value_id value) noexcept {
+        return emit(op, to, { value });
+    }
+    inline value_id alloca_(std::int64_t size) noexcept {
+        return emit(opcode::alloca, value_type::ptr, {}, size);
+    }
+    inline value_id load(value_type type, value_id address) noexcept {
+        return emit(opcode::load, type, { address });
+    }
+    inline value_id store(value_id address, value_id value) noexcept {
+        return emit(opcode::store, value_type::void_, { address, value });
+    }
+    inline value_id ptr_add(value_id base, value_id index, std::int64_t scale) noexcept {
+        return emit(opcode::ptr_add, value_type::ptr, { base, index }, scale);
+    }
+    inline value_id global_addr(symbol_id symbol) noexcept {
+        return emit(opcode::global_addr, value_type::ptr, {}, symbol);
+    }
+    inline value_id call(value_type type, symbol_id callee, std::span<const value_id> args) noexcept {
+        const auto id = m_function.create(opcode::call, type, args, callee);
+        m_function.append(m_block, id);
+        return id;
+    }
+    // Create a phi with room for "count" incoming values, fill them with set_phi_incoming().
+    inline value_id phi(value_type type, std::uint32_t count) noexcept {
+        std::vector<value_id> operands(count, invalid_id);
+        std::vector<block_id> targets(count, invalid_id);
+        const auto id = m_function.create(opcode::phi, type, operands, 0, targets);
+        m_function.append(m_block, id);
+        return id;
+    }
+    inline value_id br(block_id target) noexcept {
+        return emit(opcode::br, value_type::void_, {}, 0, { target });
+    }
+    inline value_id cond_br(value_id condition, block_id if_true, block_id if_false) noexcept {
+        return emit(opcode::cond_br, value_type::void_, { condition }, 0, { if_true, if_false });
+    }
+    inline value_id ret() noexcept {
+        return emit(opcode::ret, value_type::void_);
+    }
+    inline value_id ret(value_id value) noexcept {
+        return emit(opcode::ret, value_type::void_, { value });
+    }
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_BUILDER_HPP
+#endif // !_COMPILER_IR_BUILDER_HPP
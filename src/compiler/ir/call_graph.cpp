@@ -0,0 +1,116 @@
+#include "call_graph.hpp"
+
+#include <algorithm>
+
+using namespace compiler::ir;
+
+call_graph::call_graph(const module& mod) noexcept {
+    const auto& functions = mod.functions();
+    const auto count = static_cast<std::uint32_t>(functions.size());
+    m_function_of.assign(mod.symbols().size(), invalid_id);
+    for (std::uint32_t f = 0; f < count; ++f) {
+        if (functions[f]->is_definition()) {
+            m_function_of[functions[f]->symbol()] = f;
+        }
+    }
+
+    // "seen" is the last caller that added an edge to each function, so edges are unique.
+    m_call_sites.assign(count, 0);
+    m_callees_begin.reserve(count + 1);
+    std::vector<std::uint32_t> seen(count, invalid_id);
+    for (std::uint32_t f = 0; f < count; ++f) {
+        m_callees_begin.push_back(static_cast<std::uint32_t>(m_callees.size()));
+        const auto& fn = *functions[f];
+        for (block_id b = 0; b < fn.block_count(); ++b) {
+            if (fn.block(b).removed) {
+                continue;
+            }
+            m_size += fn.block(b).size;
+            fn.for_each_inst(b, [&](value_id id) {
+                const auto& inst = fn.inst(id);
+                if (inst.op != opcode::call) {
+                    return;
+                }
+                const auto callee = function_of(static_cast<symbol_id>(inst.imm));
+                if (callee == invalid_id) {
+                    return;
+                }
+                m_call_sites[callee]++;
+                if (seen[callee] != f) {
+                    seen[callee] = f;
+                    m_callees.push_back(callee);
+                }
+            });
+        }
+    }
+    m_callees_begin.push_back(static_cast<std::uint32_t>(m_callees.size()));
+
+    // Tarjan's algorithm, with an explicit stack so deep call chains can't overflow ours.
+    // A function's component is finished once everything it reaches is, that's callees first.
+    struct frame {
+        std::uint32_t fn;
+        std::uint32_t next_edge;
+    };
+    std::vector<std::uint32_t> index(count, invalid_id);
+    std::vector<std::uint32_t> low(count, 0);
+    std::vector<bool> on_stack(count, false);
+    std::vector<std::uint32_t> stack;
+    std::vector<frame> frames;
+    std::uint32_t counter = 0;
+
+    m_scc_of.assign(count, invalid_id);
+    m_scc_begin.push_back(0);
+    const auto enter = [&](std::uint32_t fn) {
+        index[fn] = low[fn] = counter++;
+        stack.push_back(fn);
+        on_stack[fn] = true;
+        frames.push_back(frame{ fn, 0 });
+    };
+    for (std::uint32_t root = 0; root < count; ++root) {
+        if (index[root] != invalid_id) {
+            continue;
+        }
+        enter(root);
+        while (!frames.empty()) {
+            const auto fn = frames.back().fn;
+            const auto edges = callees(fn);
+            if (frames.back().next_edge < edges.size()) {
+                const auto callee = edges[frames.back().next_edge++];
+                if (index[callee] == invalid_id) {
+                    enter(callee);
+                }
+                else if (on_stack[callee]) {
+                    low[fn] = std::min(low[fn], index[callee]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                const auto caller = frames.back().fn;
+                low[caller] = std::min(low[caller], low[fn]);
+            }
+            if (low[fn] != index[fn]) {
+                continue;
+            }
+            const auto id = scc_count();
+            std::uint32_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                on_stack[member] = false;
+                m_scc_of[member] = id;
+                m_members.push_back(member);
+            } while (member != fn);
+            m_scc_begin.push_back(static_cast<std::uint32_t>(m_members.size()));
+        }
+    }
+}
+
+bool call_graph::is_recursive(std::uint32_t fn) const noexcept {
+    if (scc(m_scc_of[fn]).size() > 1) {
+        return true;
+    }
+    const auto edges = callees(fn);
+    return std::find(edges.begin(), edges.end(), fn) != edges.end();
+}
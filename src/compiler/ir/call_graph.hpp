@@ -0,0 +1,66 @@
+#ifndef _COMPILER_IR_CALL_GRAPH_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+
+#include <span>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+/*
+  Who calls whom inside of a module. Functions are identified by their index in
+  module::functions(), calls to functions that aren't defined in the module aren't edges.
+
+  The strongly connected components are found with Tarjan's algorithm, which finds them
+  callees first: everything a component calls is in that component or in one before it.
+  Walking the components in order is the bottom-up order an inliner wants, a function is
+  done before anything that calls it is looked at.
+*/
+class call_graph {
+private:
+    // symbol -> the function that defines it, invalid_id if it isn't defined here.
+    std::vector<std::uint32_t> m_function_of{};
+    // the callees of function "f" are m_callees[m_callees_begin[f], m_callees_begin[f + 1]),
+    // each one only once.
+    std::vector<std::uint32_t> m_callees_begin{};
+    std::vector<std::uint32_t> m_callees{};
+    // how many calls of each function there are in the module.
+    std::vector<std::uint32_t> m_call_sites{};
+    // the functions of component "c" are m_members[m_scc_begin[c], m_scc_begin[c + 1]).
+    std::vector<std::uint32_t> m_scc_begin{};
+    std::vector<std::uint32_t> m_members{};
+    std::vector<std::uint32_t> m_scc_of{};
+    // the amount of instructions in the module.
+    std::uint32_t m_size{ 0 };
+public:
+    explicit call_graph(const module& mod) noexcept;
+
+    // The function defining "symbol", invalid_id if it's defined somewhere else.
+    inline std::uint32_t function_of(symbol_id symbol) const noexcept {
+        return symbol < m_function_of.size() ? m_function_of[symbol] : invalid_id;
+    }
+    inline std::span<const std::uint32_t> callees(std::uint32_t fn) const noexcept {
+        return { m_callees.data() + m_callees_begin[fn], m_callees_begin[fn + 1] - m_callees_begin[fn] };
+    }
+    inline std::uint32_t call_sites(std::uint32_t fn) const noexcept { return m_call_sites[fn]; }
+
+    // The components, callees first.
+    inline std::uint32_t scc_count() const noexcept { return static_cast<std::uint32_t>(m_scc_begin.size() - 1); }
+    inline std::span<const std::uint32_t> scc(std::uint32_t id) const noexcept {
+        return { m_members.data() + m_scc_begin[id], m_scc_begin[id + 1] - m_scc_begin[id] };
+    }
+    inline std::uint32_t scc_of(std::uint32_t fn) const noexcept { return m_scc_of[fn]; }
+    // Can "fn" end up calling itself?
+    bool is_recursive(std::uint32_t fn) const noexcept;
+
+    inline std::uint32_t module_size() const noexcept { return m_size; }
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_CALL_GRAPH_HPP
+#endif // !_COMPILER_IR_CALL_GRAPH_HPP
@@ -0,0 +1,104 @@
+#ifndef _COMPILER_IR_CFG_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+
+#include <span>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+/*
+  Predecessors and successors of every block, plus a reverse post-order of the blocks that
+  are reachable from the entry. Stored in compressed sparse row form like use_lists.
+
+  Successors come straight from the terminators, this just makes the reverse direction
+  (and the ordering) cheap to query. It's a snapshot of the function.
+*/
+class cfg {
+private:
+    std::vector<std::uint32_t> m_pred_offsets{};
+    std::vector<block_id> m_preds{};
+    std::vector<block_id> m_rpo{};
+    // block -> its index inside of m_rpo, invalid_id if the block is unreachable.
+    std::vector<std::uint32_t> m_rpo_index{};
+public:
+    inline explicit cfg(const function& fn) noexcept {
+        const auto count = fn.block_count();
+        m_pred_offsets.assign(count + 1, 0);
+        for (block_id b = 0; b < count; ++b) {
+            if (fn.block(b).removed) {
+                continue;
+            }
+            fn.for_each_successor(b, [&](block_id succ) { m_pred_offsets[succ + 1]++; });
+        }
+        for (std::uint32_t i = 0; i < count; ++i) {
+            m_pred_offsets[i + 1] += m_pred_offsets[i];
+        }
+        m_preds.resize(m_pred_offsets[count]);
+        auto cursor = std::vector<std::uint32_t>(m_pred_offsets.begin(), m_pred_offsets.end() - 1);
+        for (block_id b = 0; b < count; ++b) {
+            if (fn.block(b).removed) {
+                continue;
+            }
+            fn.for_each_successor(b, [&](block_id succ) { m_preds[cursor[succ]++] = b; });
+        }
+
+        compute_rpo(fn);
+    }
+
+    inline std::span<const block_id> preds(block_id block) const noexcept {
+        return { m_preds.data() + m_pred_offsets[block], m_pred_offsets[block + 1] - m_pred_offsets[block] };
+    }
+
+    // The reachable blocks, in reverse post-order. The entry is always first.
+    inline const std::vector<block_id>& rpo() const noexcept { return m_rpo; }
+    inline std::uint32_t rpo_index(block_id block) const noexcept { return m_rpo_index[block]; }
+    inline bool is_reachable(block_id block) const noexcept { return m_rpo_index[block] != invalid_id; }
+
+private:
+    inline void compute_rpo(const function& fn) {
+        const auto count = fn.block_count();
+        m_rpo_index.assign(count, invalid_id);
+        if (count == 0) {
+            return;
+        }
+
+        // iterative DFS, "next" is how many successors of the block have been visited.
+        std::vector<std::uint8_t> visited(count, 0);
+        std::vector<std::pair<block_id, std::uint32_t>> stack;
+        std::vector<block_id> post_order;
+        post_order.reserve(count);
+
+        stack.push_back({ fn.entry(), 0 });
+        visited[fn.entry()] = 1;
+        while (!stack.empty()) {
+            auto& [block, next] = stack.back();
+            const auto term = fn.terminator(block);
+            const auto succs = term == invalid_id ? 0u : fn.inst(term).target_count();
+            if (next < succs) {
+                const auto succ = fn.target(term, next++);
+                if (!visited[succ]) {
+                    visited[succ] = 1;
+                    stack.push_back({ succ, 0 });
+                }
+                continue;
+            }
+            post_order.push_back(block);
+            stack.pop_back();
+        }
+
+        m_rpo.assign(post_order.rbegin(), post_order.rend());
+        for (std::uint32_t i = 0; i < m_rpo.size(); ++i) {
+            m_rpo_index[m_rpo[i]] = i;
+        }
+    }
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_CFG_HPP
+#endif // !_COMPILER_IR_CFG_HPP
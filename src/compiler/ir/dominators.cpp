@@ -0,0 +1,111 @@
+#include "dominators.hpp"
+
+using namespace compiler::ir;
+
+dominator_tree::dominator_tree(const function& fn, const cfg& graph) noexcept {
+    const auto count = fn.block_count();
+    const auto& rpo = graph.rpo();
+    m_idom.assign(count, invalid_id);
+    m_pre.assign(count, invalid_id);
+    m_post.assign(count, 0);
+    if (rpo.empty()) {
+        m_child_offsets.assign(count + 1, 0);
+        return;
+    }
+
+    // walk up from both blocks until they meet, rpo indices shrink towards the entry.
+    const auto intersect = [&](block_id a, block_id b) {
+        while (a != b) {
+            while (graph.rpo_index(a) > graph.rpo_index(b)) {
+                a = m_idom[a];
+            }
+            while (graph.rpo_index(b) > graph.rpo_index(a)) {
+                b = m_idom[b];
+            }
+        }
+        return a;
+    };
+
+    const auto entry = rpo.front();
+    m_idom[entry] = entry;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 1; i < rpo.size(); ++i) {
+            const auto block = rpo[i];
+            auto idom = invalid_id;
+            for (const auto pred : graph.preds(block)) {
+                if (m_idom[pred] == invalid_id) {
+                    continue;
+                }
+                idom = idom == invalid_id ? pred : intersect(pred, idom);
+            }
+            if (idom != m_idom[block]) {
+                m_idom[block] = idom;
+                changed = true;
+            }
+        }
+    }
+    m_idom[entry] = invalid_id;
+
+    // children, in rpo order.
+    m_child_offsets.assign(count + 1, 0);
+    for (const auto block : rpo) {
+        if (m_idom[block] != invalid_id) {
+            m_child_offsets[m_idom[block] + 1]++;
+        }
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+        m_child_offsets[i + 1] += m_child_offsets[i];
+    }
+    m_children.resize(m_child_offsets[count]);
+    auto cursor = std::vector<std::uint32_t>(m_child_offsets.begin(), m_child_offsets.end() - 1);
+    for (const auto block : rpo) {
+        if (m_idom[block] != invalid_id) {
+            m_children[cursor[m_idom[block]]++] = block;
+        }
+    }
+
+    // number the tree, "next" is how many children of the block have been visited.
+    m_preorder.reserve(rpo.size());
+    std::uint32_t pre = 0;
+    std::uint32_t post = 0;
+    std::vector<std::pair<block_id, std::uint32_t>> stack;
+    stack.push_back({ entry, 0 });
+    m_pre[entry] = pre++;
+    m_preorder.push_back(entry);
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        const auto kids = children(block);
+        if (next < kids.size()) {
+            const auto child = kids[next++];
+            m_pre[child] = pre++;
+            m_preorder.push_back(child);
+            stack.push_back({ child, 0 });
+            continue;
+        }
+        m_post[block] = post++;
+        stack.pop_back();
+    }
+}
+
+std::vector<std::vector<block_id>> dominator_tree::frontiers(const cfg& graph) const noexcept {
+    std::vector<std::vector<block_id>> out(m_idom.size());
+    for (const auto block : graph.rpo()) {
+        const auto preds = graph.preds(block);
+        if (preds.size() < 2) {
+            continue;
+        }
+        for (const auto pred : preds) {
+            if (!graph.is_reachable(pred)) {
+                continue;
+            }
+            for (auto runner = pred; runner != invalid_id && runner != m_idom[block]; runner = m_idom[runner]) {
+                auto& frontier = out[runner];
+                if (frontier.empty() || frontier.back() != block) {
+                    frontier.push_back(block);
+                }
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,58 @@
+#ifndef _COMPILER_IR_DOMINATORS_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+#include "cfg.hpp"
+
+#include <span>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+/*
+  The dominator tree of the reachable blocks, built with the iterative algorithm from
+  Cooper, Harvey and Kennedy on top of the cfg's reverse post-order. For the CFGs a C
+  function produces that converges in two or three passes, and it needs nothing but the
+  idom array.
+
+  Every block also gets a pre-order and post-order number in the tree, so dominates() is
+  two comparisons. Dominance frontiers are only computed when asked for (mem2reg is the only
+  user).
+*/
+class dominator_tree {
+private:
+    // block -> its immediate dominator, invalid_id for the entry and unreachable blocks.
+    std::vector<block_id> m_idom{};
+    // the children of every block, in compressed sparse row form.
+    std::vector<std::uint32_t> m_child_offsets{};
+    std::vector<block_id> m_children{};
+    std::vector<std::uint32_t> m_pre{};
+    std::vector<std::uint32_t> m_post{};
+    // blocks in pre-order of the tree.
+    std::vector<block_id> m_preorder{};
+public:
+    dominator_tree(const function& fn, const cfg& graph) noexcept;
+
+    inline block_id idom(block_id block) const noexcept { return m_idom[block]; }
+    inline std::span<const block_id> children(block_id block) const noexcept {
+        return { m_children.data() + m_child_offsets[block], m_child_offsets[block + 1] - m_child_offsets[block] };
+    }
+    // Reachable blocks only, parents before their children.
+    inline const std::vector<block_id>& preorder() const noexcept { return m_preorder; }
+
+    // Does "a" dominate "b"? Every block dominates itself.
+    inline bool dominates(block_id a, block_id b) const noexcept {
+        return m_pre[a] <= m_pre[b] && m_post[b] <= m_post[a];
+    }
+
+    // The dominance frontier of every block, indexed by block.
+    std::vector<std::vector<block_id>> frontiers(const cfg& graph) const noexcept;
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_DOMINATORS_HPP
+#endif // !_COMPILER_IR_DOMINATORS_HPP
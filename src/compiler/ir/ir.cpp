@@ -0,0 +1,220 @@
+#include "ir.hpp"
+
+#include <format>
+
+using namespace compiler::ir;
+
+function::function(
+    const std::string& name,
+    symbol_id symbol,
+    value_type return_type,
+    std::vector<value_type> params,
+    linkage link
+) noexcept
+    : m_name(name)
+    , m_symbol(symbol)
+    , m_return_type(return_type)
+    , m_params(std::move(params))
+    , m_linkage(link)
+{}
+
+auto function::create_block() noexcept -> block_id {
+    m_blocks.push_back(basic_block{});
+    return static_cast<block_id>(m_blocks.size() - 1);
+}
+
+auto function::remove_block(block_id block) noexcept -> void {
+    auto& bb = m_blocks[block];
+    for (auto id = bb.first; id != invalid_id;) {
+        auto next = m_insts[id].next;
+        remove(id);
+        id = next;
+    }
+    bb.removed = true;
+}
+
+auto function::create(
+    opcode op,
+    value_type type,
+    std::span<const value_id> operands,
+    std::int64_t imm,
+    std::span<const block_id> targets
+) noexcept -> value_id {
+    instruction inst{};
+    inst.op = op;
+    inst.type = type;
+    inst.imm = imm;
+    inst.operand_count = static_cast<std::uint16_t>(operands.size());
+    inst.operands = static_cast<std::uint32_t>(m_operands.size());
+    inst.targets = static_cast<std::uint32_t>(m_targets.size());
+
+    m_operands.insert(m_operands.end(), operands.begin(), operands.end());
+    m_targets.insert(m_targets.end(), targets.begin(), targets.end());
+
+    m_insts.push_back(inst);
+    if (!m_aliases.empty()) {
+        m_aliases.push_back(invalid_id);
+    }
+    return static_cast<value_id>(m_insts.size() - 1);
+}
+
+auto function::append(block_id block, value_id id) noexcept -> void {
+    auto& bb = m_blocks[block];
+    auto& inst = m_insts[id];
+    inst.block = block;
+    inst.prev = bb.last;
+    inst.next = invalid_id;
+    if (bb.last != invalid_id) {
+        m_insts[bb.last].next = id;
+    }
+    else {
+        bb.first = id;
+    }
+    bb.last = id;
+    bb.size++;
+}
+
+auto function::insert_before(value_id before, value_id id) noexcept -> void {
+    auto& pos = m_insts[before];
+    auto& bb = m_blocks[pos.block];
+    auto& inst = m_insts[id];
+    inst.block = pos.block;
+    inst.next = before;
+    inst.prev = pos.prev;
+    if (pos.prev != invalid_id) {
+        m_insts[pos.prev].next = id;
+    }
+    else {
+        bb.first = id;
+    }
+    pos.prev = id;
+    bb.size++;
+}
+
+auto function::insert_after(value_id after, value_id id) noexcept -> void {
+    const auto next = m_insts[after].next;
+    if (next == invalid_id) {
+        append(m_insts[after].block, id);
+        return;
+    }
+    insert_before(next, id);
+}
+
+auto function::unlink(value_id id) noexcept -> void {
+    auto& inst = m_insts[id];
+    if (inst.block == invalid_id) {
+        return;
+    }
+    auto& bb = m_blocks[inst.block];
+    if (inst.prev != invalid_id) {
+        m_insts[inst.prev].next = inst.next;
+    }
+    else {
+        bb.first = inst.next;
+    }
+    if (inst.next != invalid_id) {
+        m_insts[inst.next].prev = inst.prev;
+    }
+    else {
+        bb.last = inst.prev;
+    }
+    bb.size--;
+    inst.block = invalid_id;
+    inst.prev = inst.next = invalid_id;
+}
+
+auto function::remove(value_id id) noexcept -> void {
+    unlink(id);
+    auto& inst = m_insts[id];
+    inst.op = opcode::nop;
+    inst.type = value_type::void_;
+    inst.operand_count = 0;
+}
+
+auto function::replace_all_uses_with(value_id from, value_id to) noexcept -> void {
+    to = resolve(to);
+    if (from == to) {
+        return;
+    }
+    if (m_aliases.empty()) {
+        m_aliases.assign(m_insts.size(), invalid_id);
+    }
+    m_aliases[from] = to;
+}
+
+auto function::compact_aliases() noexcept -> void {
+    if (m_aliases.empty()) {
+        return;
+    }
+    for (auto& operand : m_operands) {
+        operand = resolve(operand);
+    }
+    m_aliases.clear();
+}
+
+auto function::remove_phi_incoming(value_id phi, block_id from) noexcept -> void {
+    auto& inst = m_insts[phi];
+    for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+        if (target(phi, i) != from) {
+            continue;
+        }
+        // move the last incoming value into this slot.
+        const auto last = inst.operand_count - 1u;
+        m_operands[inst.operands + i] = m_operands[inst.operands + last];
+        m_targets[inst.targets + i] = m_targets[inst.targets + last];
+        inst.operand_count--;
+        return;
+    }
+}
+
+auto function::terminator(block_id block) const noexcept -> value_id {
+    const auto last = m_blocks[block].last;
+    if (last == invalid_id || !is_terminator(m_insts[last].op)) {
+        return invalid_id;
+    }
+    return last;
+}
+
+auto function::memory_usage() const noexcept -> std::size_t {
+    return m_insts.capacity() * sizeof(instruction)
+        + m_operands.capacity() * sizeof(value_id)
+        + m_targets.capacity() * sizeof(block_id)
+        + m_blocks.capacity() * sizeof(basic_block)
+        + m_aliases.capacity() * sizeof(value_id);
+}
+
+auto module::intern_symbol(const std::string& name, symbol_kind kind, linkage link) noexcept -> symbol_id {
+    if (auto it = m_symbol_lookup.find(name); it != m_symbol_lookup.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<symbol_id>(m_symbols.size());
+    m_symbols.push_back(symbol{ name, kind, link, false });
+    m_symbol_lookup.emplace(name, id);
+    return id;
+}
+
+auto module::find_symbol(const std::string& name) const noexcept -> symbol_id {
+    if (auto it = m_symbol_lookup.find(name); it != m_symbol_lookup.end()) {
+        return it->second;
+    }
+    return invalid_id;
+}
+
+auto module::string_symbol(string_id id) noexcept -> symbol_id {
+    if (id >= m_string_symbols.size()) {
+        m_string_symbols.resize(id + 1, invalid_id);
+    }
+    if (m_string_symbols[id] == invalid_id) {
+        // ".L" names are local to the object, and no C identifier starts with a dot.
+        const auto symbol = intern_symbol(std::format(".L.str.{}", m_string_constants.size()), symbol_kind::global, linkage::internal);
+        m_symbols[symbol].defined = true;
+        m_string_symbols[id] = symbol;
+        m_string_constants.push_back(string_constant{ symbol, id });
+    }
+    return m_string_symbols[id];
+}
+
+auto module::add_function(std::unique_ptr<function> fn) noexcept -> function& {
+    m_functions.push_back(std::move(fn));
+    return *m_functions.back();
+}
@@ -0,0 +1,565 @@
+#ifndef _COMPILER_IR_IR_HPP
+
+#include "../../common/common.hpp"
+#include "../lexing/string_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+/*
+  The SSA intermediate representation.
+
+  Everything in a function is numbered densely from zero. A value_id is the index of the
+  instruction that defines it, inside of its functions instruction arena, so per-value side
+  tables (liveness, register assignment, lattice values...) are just vectors indexed by id.
+
+  Each function owns its own arenas:
+    - instructions, one contiguous vector. Blocks link their instructions together with an
+      intrusive prev/next list of ids, so inserting and removing never moves anything.
+    - operands, one contiguous pool of value_ids. An instruction refers to a [begin, count)
+      range of it.
+    - targets, the same thing but for block references (branch targets, phi predecessors).
+
+  Nothing holds a pointer into the arenas, only ids, so they are free to grow. Memory is
+  linear in the size of the function and walking a block touches memory in allocation order.
+
+  Use-lists are not kept up to date on every mutation, see use_lists.hpp for the compact,
+  on-demand version passes use. Replacing a value is done with an alias table instead,
+  see function::replace_all_uses_with().
+*/
+
+using value_id = std::uint32_t;
+using block_id = std::uint32_t;
+using symbol_id = std::uint32_t;
+
+inline constexpr std::uint32_t invalid_id = ~std::uint32_t{ 0 };
+
+enum class value_type : std::uint8_t {
+    void_,
+    // the result of a comparison.
+    i1,
+    i8,
+    i16,
+    i32,
+    i64,
+    ptr,
+    // vectors of integers, only created by the vectorizer. 128 bits (SSE2) and 256 bits (AVX2).
+    v16i8,
+    v8i16,
+    v4i32,
+    v2i64,
+    v32i8,
+    v16i16,
+    v8i32,
+    v4i64,
+};
+
+constexpr bool is_vector(value_type type) noexcept {
+    return type >= value_type::v16i8;
+}
+
+// The size of a value of "type" in bytes, i1 is stored as a byte.
+constexpr std::size_t size_of(value_type type) noexcept {
+    switch (type) {
+    case value_type::void_: return 0;
+    case value_type::i1: return 1;
+    case value_type::i8: return 1;
+    case value_type::i16: return 2;
+    case value_type::i32: return 4;
+    case value_type::i64: return 8;
+    case value_type::ptr: return 8;
+    case value_type::v16i8:
+    case value_type::v8i16:
+    case value_type::v4i32:
+    case value_type::v2i64: return 16;
+    case value_type::v32i8:
+    case value_type::v16i16:
+    case value_type::v8i32:
+    case value_type::v4i64: return 32;
+    }
+    return 0;
+}
+
+// The type of one lane of a vector.
+constexpr value_type element_of(value_type type) noexcept {
+    switch (type) {
+    case value_type::v16i8:
+    case value_type::v32i8: return value_type::i8;
+    case value_type::v8i16:
+    case value_type::v16i16: return value_type::i16;
+    case value_type::v4i32:
+    case value_type::v8i32: return value_type::i32;
+    case value_type::v2i64:
+    case value_type::v4i64: return value_type::i64;
+    default: return type;
+    }
+}
+
+constexpr std::size_t lane_count(value_type type) noexcept {
+    return is_vector(type) ? size_of(type) / size_of(element_of(type)) : 1;
+}
+
+// The vector of "bytes" bytes with "element" lanes, void if there isn't one.
+constexpr value_type vector_of(value_type element, std::size_t bytes) noexcept {
+    constexpr value_type narrow[] = { value_type::v16i8, value_type::v8i16, value_type::v4i32, value_type::v2i64 };
+    constexpr value_type wide[] = { value_type::v32i8, value_type::v16i16, value_type::v8i32, value_type::v4i64 };
+    const auto index = static_cast<std::size_t>(element) - static_cast<std::size_t>(value_type::i8);
+    if (element < value_type::i8 || element > value_type::i64 || (bytes != 16 && bytes != 32)) {
+        return value_type::void_;
+    }
+    return bytes == 16 ? narrow[index] : wide[index];
+}
+
+inline const char* value_type_to_string(value_type type) noexcept {
+    switch (type) {
+    case value_type::void_: return "void";
+    case value_type::i1: return "i1";
+    case value_type::i8: return "i8";
+    case value_type::i16: return "i16";
+    case value_type::i32: return "i32";
+    case value_type::i64: return "i64";
+    case value_type::ptr: return "ptr";
+    case value_type::v16i8: return "v16i8";
+    case value_type::v8i16: return "v8i16";
+    case value_type::v4i32: return "v4i32";
+    case value_type::v2i64: return "v2i64";
+    case value_type::v32i8: return "v32i8";
+    case value_type::v16i16: return "v16i16";
+    case value_type::v8i32: return "v8i32";
+    case value_type::v4i64: return "v4i64";
+    }
+    return "?";
+}
+
+enum opcode_flags : std::uint8_t {
+    op_none = 0,
+    // ends a block.
+    op_terminator = 1 << 0,
+    // must not be removed even if the result is unused.
+    op_side_effects = 1 << 1,
+    // "a op b" == "b op a"
+    op_commutative = 1 << 2,
+    // reads memory, can't be moved across a store or call.
+    op_reads_memory = 1 << 3,
+};
+
+// Every instruction, as X(name, flags).
+//
+// operands and imm for each:
+//   param           imm = parameter index
+//   iconst          imm = the value (sign extended to 64 bits)
+//   undef           an unspecified value of "type"
+//   binary ops      (lhs, rhs), on vectors they work lane by lane. A vector shift takes a
+//                   scalar amount, every lane is shifted by the same amount.
+//   neg, not_       (value)
+//   icmp            (lhs, rhs), imm = cmp_pred, always i1
+//   casts           (value), the result type is the instructions type
+//   alloca          imm = size in bytes, (alignment is the size rounded to a power of two, max 16)
+//   load            (address)
+//   store           (address, value)
+//   ptr_add         (base, index), imm = scale. result = base + index * scale
+//   global_addr     imm = symbol
+//   call            (args...), imm = the callees symbol
+//   broadcast       (value), every lane of the vector "type" is value truncated to the lane
+//   reduce          (vector), imm = the opcode (add, and_, or_, xor_) that combines its lanes
+//   phi             (values...), targets hold the incoming block for each value
+//   br              targets = { destination }
+//   cond_br         (condition), targets = { if_true, if_false }
+//   ret             () or (value)
+#define COMPILER_IR_OPCODES(X)                                  \
+    X(nop,         op_none)                                     \
+    X(param,       op_none)                                     \
+    X(iconst,      op_none)                                     \
+    X(undef,       op_none)                                     \
+    X(add,         op_commutative)                              \
+    X(sub,         op_none)                                     \
+    X(mul,         op_commutative)                              \
+    X(sdiv,        op_none)                                     \
+    X(udiv,        op_none)                                     \
+    X(srem,        op_none)                                     \
+    X(urem,        op_none)                                     \
+    X(and_,        op_commutative)                              \
+    X(or_,         op_commutative)                              \
+    X(xor_,        op_commutative)                              \
+    X(shl,         op_none)                                     \
+    X(ashr,        op_none)                                     \
+    X(lshr,        op_none)                                     \
+    X(neg,         op_none)                                     \
+    X(not_,        op_none)                                     \
+    X(icmp,        op_none)                                     \
+    X(sext,        op_none)                                     \
+    X(zext,        op_none)                                     \
+    X(trunc,       op_none)                                     \
+    X(bitcast,     op_none)                                     \
+    X(alloca,      op_none)                                     \
+    X(load,        op_reads_memory)                             \
+    X(store,       op_side_effects)                             \
+    X(ptr_add,     op_none)                                     \
+    X(global_addr, op_none)                                     \
+    X(call,        op_side_effects | op_reads_memory)           \
+    X(broadcast,   op_none)                                     \
+    X(reduce,      op_none)                                     \
+    X(phi,         op_none)                                     \
+    X(br,          op_terminator | op_side_effects)             \
+    X(cond_br,     op_terminator | op_side_effects)             \
+    X(ret,         op_terminator | op_side_effects)             \
+    X(unreachable, op_terminator | op_side_effects)
+
+enum class opcode : std::uint8_t {
+#define _IR_OPCODE_ENUM(name, flags) name,
+    COMPILER_IR_OPCODES(_IR_OPCODE_ENUM)
+#undef _IR_OPCODE_ENUM
+};
+
+inline constexpr std::uint8_t opcode_flag_table[] = {
+#define _IR_OPCODE_FLAGS(name, flags) static_cast<std::uint8_t>(flags),
+    COMPILER_IR_OPCODES(_IR_OPCODE_FLAGS)
+#undef _IR_OPCODE_FLAGS
+};
+
+inline std::string_view opcode_to_string(opcode op) noexcept {
+    static constexpr const char* names[] = {
+#define _IR_OPCODE_NAME(name, flags) #name,
+        COMPILER_IR_OPCODES(_IR_OPCODE_NAME)
+#undef _IR_OPCODE_NAME
+    };
+    // the trailing underscore of "and_" is only there to dodge the keyword.
+    std::string_view name = names[static_cast<std::size_t>(op)];
+    if (name.ends_with('_')) {
+        name.remove_suffix(1);
+    }
+    return name;
+}
+
+constexpr bool has_flag(opcode op, opcode_flags flag) noexcept {
+    return (opcode_flag_table[static_cast<std::size_t>(op)] & flag) != 0;
+}
+constexpr bool is_terminator(opcode op) noexcept { return has_flag(op, op_terminator); }
+constexpr bool has_side_effects(opcode op) noexcept { return has_flag(op, op_side_effects); }
+constexpr bool is_commutative(opcode op) noexcept { return has_flag(op, op_commutative); }
+constexpr bool reads_memory(opcode op) noexcept { return has_flag(op, op_reads_memory); }
+
+constexpr bool is_binary(opcode op) noexcept {
+    return op >= opcode::add && op <= opcode::lshr;
+}
+constexpr bool is_cast(opcode op) noexcept {
+    return op >= opcode::sext && op <= opcode::bitcast;
+}
+
+// The predicate of an icmp, stored in its imm.
+enum class cmp_pred : std::uint8_t {
+    eq, ne,
+    slt, sle, sgt, sge,
+    ult, ule, ugt, uge,
+};
+
+// "a < b" -> "a >= b"
+constexpr cmp_pred inverse(cmp_pred pred) noexcept {
+    switch (pred) {
+    case cmp_pred::eq: return cmp_pred::ne;
+    case cmp_pred::ne: return cmp_pred::eq;
+    case cmp_pred::slt: return cmp_pred::sge;
+    case cmp_pred::sle: return cmp_pred::sgt;
+    case cmp_pred::sgt: return cmp_pred::sle;
+    case cmp_pred::sge: return cmp_pred::slt;
+    case cmp_pred::ult: return cmp_pred::uge;
+    case cmp_pred::ule: return cmp_pred::ugt;
+    case cmp_pred::ugt: return cmp_pred::ule;
+    case cmp_pred::uge: return cmp_pred::ult;
+    }
+    return pred;
+}
+
+// "a < b" -> "b > a"
+constexpr cmp_pred swapped(cmp_pred pred) noexcept {
+    switch (pred) {
+    case cmp_pred::slt: return cmp_pred::sgt;
+    case cmp_pred::sle: return cmp_pred::sge;
+    case cmp_pred::sgt: return cmp_pred::slt;
+    case cmp_pred::sge: return cmp_pred::sle;
+    case cmp_pred::ult: return cmp_pred::ugt;
+    case cmp_pred::ule: return cmp_pred::uge;
+    case cmp_pred::ugt: return cmp_pred::ult;
+    case cmp_pred::uge: return cmp_pred::ule;
+    default: return pred;
+    }
+}
+
+inline const char* cmp_pred_to_string(cmp_pred pred) noexcept {
+    static constexpr const char* names[] = {
+        "eq", "ne", "slt", "sle", "sgt", "sge", "ult", "ule", "ugt", "uge"
+    };
+    return names[static_cast<std::size_t>(pred)];
+}
+
+// A single instruction, exactly 32 bytes.
+struct instruction {
+    opcode op{ opcode::nop };
+    value_type type{ value_type::void_ };
+    std::uint16_t operand_count{ 0 };
+    // the block this instruction is in, invalid_id once removed.
+    block_id block{ invalid_id };
+    // the intrusive list inside of the block.
+    value_id prev{ invalid_id }, next{ invalid_id };
+    // index of the first operand inside of the functions operand pool.
+    std::uint32_t operands{ 0 };
+    // index of the first block reference inside of the functions target pool.
+    std::uint32_t targets{ 0 };
+    std::int64_t imm{ 0 };
+
+    // how many block references this instruction has.
+    inline std::uint32_t target_count() const noexcept {
+        switch (op) {
+        case opcode::br: return 1;
+        case opcode::cond_br: return 2;
+        case opcode::phi: return operand_count;
+        default: return 0;
+        }
+    }
+};
+static_assert(sizeof(instruction) == 32, "ir::instruction should stay small, it's stored by value in the arena.");
+
+struct basic_block {
+    value_id first{ invalid_id }, last{ invalid_id };
+    std::uint32_t size{ 0 };
+    bool removed{ false };
+
+    inline bool empty() const noexcept { return first == invalid_id; }
+};
+
+enum class linkage : std::uint8_t {
+    // visible to other object files.
+    external,
+    // "static", only visible inside of this module.
+    internal,
+};
+
+// A function in the IR. It owns all of the arenas for its instructions.
+class function {
+private:
+    std::string m_name;
+    symbol_id m_symbol;
+    value_type m_return_type;
+    std::vector<value_type> m_params;
+    linkage m_linkage;
+    // declared "inline", the inliner gives these a bigger budget.
+    bool m_inline_hint{ false };
+
+    std::vector<instruction> m_insts{};
+    std::vector<value_id> m_operands{};
+    std::vector<block_id> m_targets{};
+    std::vector<basic_block> m_blocks{};
+    // value -> the value that replaced it, see replace_all_uses_with(). Empty until the
+    // first replacement.
+    std::vector<value_id> m_aliases{};
+public:
+    function(
+        const std::string& name,
+        symbol_id symbol,
+        value_type return_type,
+        std::vector<value_type> params,
+        linkage link
+    ) noexcept;
+
+    inline const std::string& name() const noexcept { return m_name; }
+    inline symbol_id symbol() const noexcept { return m_symbol; }
+    inline value_type return_type() const noexcept { return m_return_type; }
+    inline const std::vector<value_type>& params() const noexcept { return m_params; }
+    inline linkage link() const noexcept { return m_linkage; }
+    inline bool inline_hint() const noexcept { return m_inline_hint; }
+    inline void set_inline_hint(bool hint) noexcept { m_inline_hint = hint; }
+
+    // Does this function have a body? Functions that are only declared have no blocks.
+    inline bool is_definition() const noexcept { return !m_blocks.empty(); }
+
+    // The amount of values (and instructions), value ids are always less than this.
+    inline std::uint32_t value_count() const noexcept { return static_cast<std::uint32_t>(m_insts.size()); }
+    inline std::uint32_t block_count() const noexcept { return static_cast<std::uint32_t>(m_blocks.size()); }
+    inline block_id entry() const noexcept { return 0; }
+
+    inline instruction& inst(value_id id) noexcept { return m_insts[id]; }
+    inline const instruction& inst(value_id id) const noexcept { return m_insts[id]; }
+    inline basic_block& block(block_id id) noexcept { return m_blocks[id]; }
+    inline const basic_block& block(block_id id) const noexcept { return m_blocks[id]; }
+
+    // Operand "index" of "id", aliases are resolved.
+    inline value_id operand(value_id id, std::uint32_t index) const noexcept {
+        return resolve(m_operands[m_insts[id].operands + index]);
+    }
+    inline void set_operand(value_id id, std::uint32_t index, value_id value) noexcept {
+        m_operands[m_insts[id].operands + index] = value;
+    }
+    // The raw operand range of "id", these may still contain aliased values.
+    inline std::span<const value_id> raw_operands(value_id id) const noexcept {
+        const auto& i = m_insts[id];
+        return { m_operands.data() + i.operands, i.operand_count };
+    }
+
+    inline block_id target(value_id id, std::uint32_t index) const noexcept {
+        return m_targets[m_insts[id].targets + index];
+    }
+    inline void set_target(value_id id, std::uint32_t index, block_id block) noexcept {
+        m_targets[m_insts[id].targets + index] = block;
+    }
+
+    // Follow the alias chain of "value" to the value that currently stands for it.
+    inline value_id resolve(value_id value) const noexcept {
+        if (m_aliases.empty() || value == invalid_id) {
+            return value;
+        }
+        while (m_aliases[value] != invalid_id) {
+            value = m_aliases[value];
+        }
+        return value;
+    }
+
+    // Create a new, empty block. It's not reachable until something branches to it.
+    block_id create_block() noexcept;
+    // Mark a block as removed, it's instructions are removed with it.
+    void remove_block(block_id block) noexcept;
+
+    // Create a new instruction that isn't inside of any block yet. "targets" is only used by
+    // instructions that reference blocks.
+    value_id create(
+        opcode op,
+        value_type type,
+        std::span<const value_id> operands = {},
+        std::int64_t imm = 0,
+        std::span<const block_id> targets = {}
+    ) noexcept;
+
+    // Link an instruction created with create() into a block.
+    void append(block_id block, value_id id) noexcept;
+    void insert_before(value_id before, value_id id) noexcept;
+    void insert_after(value_id after, value_id id) noexcept;
+    // Unlink an instruction from its block and turn it into a nop. Its id stays valid, but
+    // nothing should refer to it anymore.
+    void remove(value_id id) noexcept;
+    // Unlink an instruction from its block without destroying it, so it can be inserted
+    // somewhere else.
+    void unlink(value_id id) noexcept;
+
+    // Every use of "from" now refers to "to". This is O(1), the operands are rewritten lazily
+    // (see compact_aliases()).
+    void replace_all_uses_with(value_id from, value_id to) noexcept;
+    // Rewrite every operand that refers to an aliased value and clear the alias table.
+    void compact_aliases() noexcept;
+
+    // Phis are created with room for every predecessor, use this to fill them in.
+    inline void set_phi_incoming(value_id phi, std::uint32_t index, value_id value, block_id from) noexcept {
+        set_operand(phi, index, value);
+        set_target(phi, index, from);
+    }
+    // Remove the incoming value from "from", if it exists.
+    void remove_phi_incoming(value_id phi, block_id from) noexcept;
+
+    // The terminator of "block", or invalid_id if it doesn't have one yet.
+    value_id terminator(block_id block) const noexcept;
+
+    // Iterate the instructions in "block", in order. Removing the current instruction
+    // while iterating is fine as long as the next id is read first.
+    template<class Fn>
+    inline void for_each_inst(block_id block, Fn&& fn) const {
+        for (auto id = m_blocks[block].first; id != invalid_id;) {
+            const auto next = m_insts[id].next;
+            fn(id);
+            id = next;
+        }
+    }
+
+    // The successors of "block", taken from its terminator.
+    template<class Fn>
+    inline void for_each_successor(block_id block, Fn&& fn) const {
+        const auto term = terminator(block);
+        if (term == invalid_id) {
+            return;
+        }
+        const auto count = m_insts[term].target_count();
+        for (std::uint32_t i = 0; i < count; ++i) {
+            fn(target(term, i));
+        }
+    }
+
+    // Approximate amount of memory used by the arenas, in bytes.
+    std::size_t memory_usage() const noexcept;
+};
+
+enum class symbol_kind : std::uint8_t {
+    function,
+    global,
+};
+
+struct symbol {
+    std::string name;
+    symbol_kind kind;
+    linkage link;
+    // is this defined in this module? (otherwise it must be resolved by the linker)
+    bool defined{ false };
+};
+
+// A global variable.
+struct global {
+    symbol_id symbol;
+    value_type type;
+    // the initial value, globals without an initializer are zero.
+    std::int64_t init{ 0 };
+};
+
+// A string literal the module uses, a private read only array of its bytes and a NUL.
+struct string_constant {
+    symbol_id symbol;
+    // the bytes, in the module's strings().
+    string_id string;
+};
+
+// A whole translation unit.
+class module {
+private:
+    std::vector<symbol> m_symbols{};
+    std::unordered_map<std::string, symbol_id> m_symbol_lookup{};
+    std::vector<std::unique_ptr<function>> m_functions{};
+    std::vector<global> m_globals{};
+    string_pool m_strings{};
+    // the symbol of every string_id that's used so far, invalid_id for the rest.
+    std::vector<symbol_id> m_string_symbols{};
+    std::vector<string_constant> m_string_constants{};
+public:
+    // Get the symbol named "name", creating it if it doesn't exist yet.
+    symbol_id intern_symbol(const std::string& name, symbol_kind kind, linkage link) noexcept;
+    // Find a symbol by name, invalid_id if it doesn't exist.
+    symbol_id find_symbol(const std::string& name) const noexcept;
+
+    inline symbol& get_symbol(symbol_id id) noexcept { return m_symbols[id]; }
+    inline const symbol& get_symbol(symbol_id id) const noexcept { return m_symbols[id]; }
+    inline const std::vector<symbol>& symbols() const noexcept { return m_symbols; }
+
+    function& add_function(std::unique_ptr<function> fn) noexcept;
+    inline std::vector<std::unique_ptr<function>>& functions() noexcept { return m_functions; }
+    inline const std::vector<std::unique_ptr<function>>& functions() const noexcept { return m_functions; }
+
+    inline void add_global(global g) noexcept { m_globals.push_back(g); }
+    inline const std::vector<global>& globals() const noexcept { return m_globals; }
+
+    // The string literals of the translation unit, the ids in the AST refer to these.
+    inline void set_strings(string_pool strings) noexcept { m_strings = std::move(strings); }
+    inline const string_pool& strings() const noexcept { return m_strings; }
+    // The symbol of string literal "id". It's created the first time, so only the literals
+    // that are used are emitted and each of them once.
+    symbol_id string_symbol(string_id id) noexcept;
+    inline const std::vector<string_constant>& string_constants() const noexcept { return m_string_constants; }
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_IR_HPP
+#endif // !_COMPILER_IR_IR_HPP
@@ -0,0 +1,92 @@
+#include "loops.hpp"
+
+using namespace compiler::ir;
+
+loop_info::loop_info(const function& fn, const cfg& graph, const dominator_tree& doms) noexcept {
+    m_loop_of.assign(fn.block_count(), invalid_id);
+
+    // the last loop that claimed a block while collecting the current body.
+    std::vector<loop_id> stamp(fn.block_count(), invalid_id);
+    std::vector<block_id> worklist;
+
+    // headers in rpo order, so outer loops are found before the loops nested in them and
+    // the innermost loop of a block is the last one that claims it.
+    for (const auto header : graph.rpo()) {
+        bool is_header = false;
+        for (const auto pred : graph.preds(header)) {
+            if (graph.is_reachable(pred) && doms.dominates(header, pred)) {
+                worklist.push_back(pred);
+                is_header = true;
+            }
+        }
+        if (!is_header) {
+            continue;
+        }
+
+        const auto id = static_cast<loop_id>(m_loops.size());
+        loop l{};
+        l.header = header;
+        l.parent = m_loop_of[header];
+        l.depth = l.parent == invalid_id ? 1 : m_loops[l.parent].depth + 1;
+        l.blocks_begin = static_cast<std::uint32_t>(m_blocks.size());
+
+        // everything that reaches a back edge without going through the header.
+        stamp[header] = id;
+        m_blocks.push_back(header);
+        while (!worklist.empty()) {
+            const auto block = worklist.back();
+            worklist.pop_back();
+            if (stamp[block] == id) {
+                continue;
+            }
+            stamp[block] = id;
+            m_blocks.push_back(block);
+            for (const auto pred : graph.preds(block)) {
+                if (graph.is_reachable(pred)) {
+                    worklist.push_back(pred);
+                }
+            }
+        }
+        l.blocks_end = static_cast<std::uint32_t>(m_blocks.size());
+        m_loops.push_back(l);
+
+        for (auto i = l.blocks_begin; i < l.blocks_end; ++i) {
+            m_loop_of[m_blocks[i]] = id;
+        }
+    }
+}
+
+bool loop_info::contains(loop_id id, block_id block) const noexcept {
+    for (auto inner = m_loop_of[block]; inner != invalid_id; inner = m_loops[inner].parent) {
+        if (inner == id) {
+            return true;
+        }
+        if (inner < id) {
+            // parents always have smaller ids.
+            return false;
+        }
+    }
+    return false;
+}
+
+block_id loop_info::preheader(const function& fn, const cfg& graph, loop_id id) const noexcept {
+    const auto header = m_loops[id].header;
+    auto found = invalid_id;
+    for (const auto pred : graph.preds(header)) {
+        if (contains(id, pred)) {
+            continue;
+        }
+        if (found != invalid_id) {
+            return invalid_id;
+        }
+        found = pred;
+    }
+    if (found == invalid_id) {
+        return invalid_id;
+    }
+    const auto term = fn.terminator(found);
+    if (term == invalid_id || fn.inst(term).op != opcode::br) {
+        return invalid_id;
+    }
+    return found;
+}
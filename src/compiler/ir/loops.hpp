@@ -0,0 +1,69 @@
+#ifndef _COMPILER_IR_LOOPS_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+#include "cfg.hpp"
+#include "dominators.hpp"
+
+#include <span>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+using loop_id = std::uint32_t;
+
+// A natural loop: the header dominates every block in it, and every back edge goes to the
+// header.
+struct loop {
+    block_id header;
+    // the enclosing loop, invalid_id for outermost loops.
+    loop_id parent{ invalid_id };
+    // 1 for outermost loops.
+    std::uint32_t depth{ 1 };
+    // the blocks of the loop (including the ones of nested loops) are
+    // loop_info::m_blocks[blocks_begin, blocks_end), the header is first.
+    std::uint32_t blocks_begin{ 0 };
+    std::uint32_t blocks_end{ 0 };
+};
+
+/*
+  The natural loops of a function, found from the back edges of the dominator tree. Loops
+  are numbered outermost first (in reverse post-order of their headers), so a loop's parent
+  always has a smaller id.
+*/
+class loop_info {
+private:
+    std::vector<loop> m_loops{};
+    std::vector<block_id> m_blocks{};
+    // block -> the innermost loop it's in, invalid_id if it's not in a loop.
+    std::vector<loop_id> m_loop_of{};
+public:
+    loop_info(const function& fn, const cfg& graph, const dominator_tree& doms) noexcept;
+
+    inline const std::vector<loop>& loops() const noexcept { return m_loops; }
+    inline const loop& get(loop_id id) const noexcept { return m_loops[id]; }
+    inline std::span<const block_id> blocks(loop_id id) const noexcept {
+        const auto& l = m_loops[id];
+        return { m_blocks.data() + l.blocks_begin, l.blocks_end - l.blocks_begin };
+    }
+
+    inline loop_id loop_of(block_id block) const noexcept { return m_loop_of[block]; }
+    // How many loops "block" is nested in, 0 if it's in none.
+    inline std::uint32_t depth_of(block_id block) const noexcept {
+        const auto id = m_loop_of[block];
+        return id == invalid_id ? 0 : m_loops[id].depth;
+    }
+    bool contains(loop_id id, block_id block) const noexcept;
+
+    // The single block outside of the loop that branches to the header and nowhere else,
+    // invalid_id if there isn't one.
+    block_id preheader(const function& fn, const cfg& graph, loop_id id) const noexcept;
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_LOOPS_HPP
+#endif // !_COMPILER_IR_LOOPS_HPP
@@ -0,0 +1,924 @@
+#include "lower.hpp"
+
+#include <format>
+#include <limits>
+
+using namespace compiler;
+using namespace compiler::ir;
+
+c_type c_type::integer(value_type type, bool is_unsigned) noexcept {
+    return c_type{ type, is_unsigned, 0, type };
+}
+
+c_type c_type::from(const type_information& info) noexcept {
+    value_type base = value_type::i32;
+    const auto& name = info.name();
+    if (name == "void") {
+        base = value_type::void_;
+    }
+    else if (name == "char") {
+        base = value_type::i8;
+    }
+    else if (name == "short") {
+        base = value_type::i16;
+    }
+    else if (name == "long" || name == "long long") {
+        base = value_type::i64;
+    }
+
+    c_type type = integer(base, info.has_modifier(mod_unsigned));
+    type.pointer_depth = info.pointer_depth();
+    if (type.is_pointer()) {
+        type.type = value_type::ptr;
+    }
+    return type;
+}
+
+c_type c_type::deref() const noexcept {
+    auto out = *this;
+    if (out.pointer_depth == 0) {
+        return out;
+    }
+    out.pointer_depth--;
+    out.type = out.pointer_depth == 0 ? base : value_type::ptr;
+    return out;
+}
+
+c_type c_type::address_of() const noexcept {
+    auto out = *this;
+    out.pointer_depth++;
+    out.type = value_type::ptr;
+    return out;
+}
+
+std::int64_t c_type::pointee_size() const noexcept {
+    const auto size = static_cast<std::int64_t>(size_of(deref().type));
+    // arithmetic on "void*" works in bytes, like GNU C.
+    return size == 0 ? 1 : size;
+}
+
+lowering::lowering(module& mod, std::string internal_suffix) noexcept
+    : m_module(mod)
+    , m_internal_suffix(std::move(internal_suffix))
+{}
+
+void lowering::import_declarations(const lowering& other) noexcept {
+    m_functions.insert(other.m_functions.begin(), other.m_functions.end());
+    m_globals.insert(other.m_globals.begin(), other.m_globals.end());
+}
+
+symbol_id lowering::intern_symbol(const std::string& name, symbol_kind kind, linkage link) noexcept {
+    if (link == linkage::internal && !m_internal_suffix.empty()) {
+        return m_module.intern_symbol(name + m_internal_suffix, kind, link);
+    }
+    return m_module.intern_symbol(name, kind, link);
+}
+
+result<void, error> lowering::lower(ast& tree) noexcept {
+    for (auto& node : tree) {
+        visit(*node);
+    }
+
+    for (const auto& diag : m_diags) {
+        if (diag.level() == diag_level::error) {
+            return error("{}", diag.message());
+        }
+    }
+    return {};
+}
+
+value_id lowering::fail(const source_location& location, const std::string& message) noexcept {
+    m_diags.push_back(make_diag_builder()
+        .with_level(diag_level::error)
+        .with_location(location)
+        .with_message(message)
+        .emit(m_writer));
+
+    // hand back something usable, so lowering can carry on and report more errors.
+    m_type = c_type::integer(value_type::i32);
+    if (!m_builder.has_value()) {
+        return invalid_id;
+    }
+    ensure_block();
+    return m_builder->emit(opcode::undef, value_type::i32);
+}
+
+bool lowering::constant_initializer(assignment_declaration& node, std::int64_t& out) noexcept {
+    out = 0;
+    if (!node.has_expr()) {
+        return true;
+    }
+    // NOTE: only integer constants (and their negation) are supported as initializers.
+    auto* expr = node.expr();
+    bool negate = false;
+    if (expr->kind() == node_kind::unary_expression
+        && static_cast<unary_expression*>(expr)->op() == unary_op::negate) {
+        negate = true;
+        expr = &static_cast<unary_expression*>(expr)->operand();
+    }
+    if (expr->kind() != node_kind::integer_literal) {
+        DISCARD(fail(expr->location(), std::format("initializer of `{}` is not a constant", node.identifier())));
+        return false;
+    }
+    out = static_cast<std::int64_t>(static_cast<integer_literal*>(expr)->value());
+    if (negate) {
+        out = -out;
+    }
+    return true;
+}
+
+void lowering::lower_global(assignment_declaration& node) noexcept {
+    const auto type = c_type::from(node.type());
+    if (type.is_void()) {
+        DISCARD(fail(node.location(), std::format("variable `{}` cannot have type void", node.identifier())));
+        return;
+    }
+
+    const auto link = node.type().has_modifier(mod_static) ? linkage::internal : linkage::external;
+    const auto symbol = intern_symbol(node.identifier(), symbol_kind::global, link);
+
+    std::int64_t init = 0;
+    if (!constant_initializer(node, init)) {
+        return;
+    }
+
+    auto& sym = m_module.get_symbol(symbol);
+    const bool is_declaration = node.type().has_modifier(mod_extern) && !node.has_expr();
+    // (sym.defined without an entry in m_globals is a definition by another unit.)
+    if (m_globals.contains(node.identifier()) || sym.defined) {
+        if (sym.defined && !is_declaration && node.has_expr()) {
+            DISCARD(fail(node.location(), std::format("redefinition of `{}`", node.identifier())));
+        }
+        m_globals.try_emplace(node.identifier(), variable{ invalid_id, symbol, type });
+        if (is_declaration || sym.defined) {
+            return;
+        }
+    }
+    m_globals[node.identifier()] = variable{ invalid_id, symbol, type };
+
+    if (!is_declaration) {
+        sym.defined = true;
+        m_module.add_global(global{ symbol, type.type, init });
+    }
+}
+
+lowering::function_signature* lowering::declare_function(function_declaration& node) noexcept {
+    if (auto it = m_functions.find(node.name()); it != m_functions.end()) {
+        if (it->second.params.size() != node.params().size()) {
+            DISCARD(fail(node.location(), std::format("conflicting types for `{}`", node.name())));
+        }
+        it->second.is_inline |= node.is_inline();
+        return &it->second;
+    }
+
+    const auto link = node.is_static() ? linkage::internal : linkage::external;
+    function_signature sig{};
+    sig.symbol = intern_symbol(node.name(), symbol_kind::function, link);
+    sig.return_type = c_type::from(node.return_type());
+    sig.returns_void = sig.return_type.is_void();
+    sig.is_inline = node.is_inline();
+    for (const auto& param : node.params()) {
+        sig.params.push_back(c_type::from(param.type));
+    }
+    return &m_functions.emplace(node.name(), std::move(sig)).first->second;
+}
+
+value_id lowering::visit_function_declaration(function_declaration& node) {
+    auto* sig = declare_function(node);
+    if (!node.has_body()) {
+        return invalid_id;
+    }
+
+    auto& sym = m_module.get_symbol(sig->symbol);
+    if (sym.defined) {
+        return fail(node.location(), std::format("redefinition of `{}`", node.name()));
+    }
+    sym.defined = true;
+
+    std::vector<value_type> params;
+    for (const auto& param : sig->params) {
+        params.push_back(param.type);
+    }
+    auto& fn = m_module.add_function(std::make_unique<function>(
+        node.name(), sig->symbol, sig->return_type.type, std::move(params), sym.link));
+    fn.set_inline_hint(sig->is_inline);
+
+    m_function = &fn;
+    m_builder.emplace(fn);
+    m_signature = sig;
+    m_scopes.emplace_back();
+    m_alloca_point = invalid_id;
+
+    m_builder->set_insert_point(fn.create_block());
+    std::vector<value_id> incoming;
+    for (std::uint32_t i = 0; i < sig->params.size(); ++i) {
+        incoming.push_back(m_builder->param(sig->params[i].type, i));
+        m_alloca_point = incoming.back();
+    }
+    // parameters can be assigned to, so they get a slot just like any other local.
+    for (std::uint32_t i = 0; i < sig->params.size(); ++i) {
+        const auto& name = node.params()[i].name;
+        const auto slot = new_slot(sig->params[i]);
+        m_builder->store(slot, incoming[i]);
+        if (!name.empty()) {
+            m_scopes.back()[name] = variable{ slot, invalid_id, sig->params[i] };
+        }
+    }
+
+    visit(*node.body());
+
+    // falling off the end of a function.
+    if (!m_builder->is_terminated()) {
+        if (sig->returns_void) {
+            m_builder->ret();
+        }
+        else {
+            m_builder->ret(m_builder->iconst(sig->return_type.type, 0));
+        }
+    }
+
+    m_scopes.clear();
+    m_loops.clear();
+    m_signature = nullptr;
+    m_builder.reset();
+    m_function = nullptr;
+    return invalid_id;
+}
+
+value_id lowering::visit_assignment_declaration(assignment_declaration& node) {
+    if (m_function == nullptr) {
+        lower_global(node);
+        return invalid_id;
+    }
+
+    const auto type = c_type::from(node.type());
+    if (type.is_void()) {
+        return fail(node.location(), std::format("variable `{}` cannot have type void", node.identifier()));
+    }
+    if (node.type().has_modifier(mod_static)) {
+        // a global only this scope can see. The same name can be a static in several
+        // functions (or scopes of one), the counter keeps their symbols apart.
+        // a bad initializer is reported, the variable is still declared so its uses don't
+        // fail as well.
+        std::int64_t init = 0;
+        constant_initializer(node, init);
+        const auto function_name = m_module.get_symbol(m_signature->symbol).name;
+        const auto symbol = intern_symbol(std::format("{}.{}.{}", function_name, node.identifier(), m_static_locals++),
+            symbol_kind::global, linkage::internal);
+        m_module.get_symbol(symbol).defined = true;
+        m_module.add_global(global{ symbol, type.type, init });
+        m_scopes.back()[node.identifier()] = variable{ invalid_id, symbol, type };
+        return invalid_id;
+    }
+
+    const auto slot = new_slot(type);
+    if (node.has_expr()) {
+        const auto value = lower_as(*node.expr(), type);
+        m_builder->store(slot, value);
+    }
+    m_scopes.back()[node.identifier()] = variable{ slot, invalid_id, type };
+    return invalid_id;
+}
+
+void lowering::lower_statement(ast_node& node) noexcept {
+    ensure_block();
+    visit(node);
+}
+
+value_id lowering::visit_compound_statement(compound_statement& node) {
+    m_scopes.emplace_back();
+    for (auto& item : node.items()) {
+        lower_statement(*item);
+    }
+    m_scopes.pop_back();
+    return invalid_id;
+}
+
+value_id lowering::visit_expression_statement(expression_statement& node) {
+    if (node.has_expr()) {
+        DISCARD(visit(*node.expr()));
+    }
+    return invalid_id;
+}
+
+value_id lowering::visit_return_statement(return_statement& node) {
+    if (!node.has_expr()) {
+        if (!m_signature->returns_void) {
+            m_builder->ret(m_builder->emit(opcode::undef, m_signature->return_type.type));
+            return invalid_id;
+        }
+        m_builder->ret();
+        return invalid_id;
+    }
+
+    if (m_signature->returns_void) {
+        return fail(node.location(), "void function should not return a value");
+    }
+    const auto value = lower_as(*node.expr(), m_signature->return_type);
+    m_builder->ret(value);
+    return invalid_id;
+}
+
+value_id lowering::visit_if_statement(if_statement& node) {
+    auto& fn = *m_function;
+    const auto condition = lower_condition(node.condition());
+
+    const auto then_block = fn.create_block();
+    const auto else_block = node.has_else() ? fn.create_block() : invalid_id;
+    const auto end_block = fn.create_block();
+    m_builder->cond_br(condition, then_block, node.has_else() ? else_block : end_block);
+
+    m_builder->set_insert_point(then_block);
+    lower_statement(node.then());
+    if (!m_builder->is_terminated()) {
+        m_builder->br(end_block);
+    }
+
+    if (node.has_else()) {
+        m_builder->set_insert_point(else_block);
+        lower_statement(*node.otherwise());
+        if (!m_builder->is_terminated()) {
+            m_builder->br(end_block);
+        }
+    }
+
+    m_builder->set_insert_point(end_block);
+    return invalid_id;
+}
+
+value_id lowering::visit_while_statement(while_statement& node) {
+    auto& fn = *m_function;
+    const auto header = fn.create_block();
+    const auto body = fn.create_block();
+    const auto end = fn.create_block();
+
+    m_builder->br(header);
+    m_builder->set_insert_point(header);
+    m_builder->cond_br(lower_condition(node.condition()), body, end);
+
+    m_builder->set_insert_point(body);
+    m_loops.push_back(loop_targets{ end, header });
+    lower_statement(node.body());
+    m_loops.pop_back();
+    if (!m_builder->is_terminated()) {
+        m_builder->br(header);
+    }
+
+    m_builder->set_insert_point(end);
+    return invalid_id;
+}
+
+value_id lowering::visit_for_statement(for_statement& node) {
+    auto& fn = *m_function;
+    // the init is in its own scope, "for (int i = 0; ...)"
+    m_scopes.emplace_back();
+    if (node.init() != nullptr) {
+        visit(*node.init());
+    }
+
+    const auto header = fn.create_block();
+    const auto body = fn.create_block();
+    const auto step = fn.create_block();
+    const auto end = fn.create_block();
+
+    m_builder->br(header);
+    m_builder->set_insert_point(header);
+    if (node.condition() != nullptr) {
+        m_builder->cond_br(lower_condition(*node.condition()), body, end);
+    }
+    else {
+        m_builder->br(body);
+    }
+
+    m_builder->set_insert_point(body);
+    m_loops.push_back(loop_targets{ end, step });
+    lower_statement(node.body());
+    m_loops.pop_back();
+    if (!m_builder->is_terminated()) {
+        m_builder->br(step);
+    }
+
+    m_builder->set_insert_point(step);
+    if (node.step() != nullptr) {
+        DISCARD(visit(*node.step()));
+    }
+    m_builder->br(header);
+
+    m_builder->set_insert_point(end);
+    m_scopes.pop_back();
+    return invalid_id;
+}
+
+value_id lowering::visit_jump_statement(jump_statement& node) {
+    if (m_loops.empty()) {
+        return fail(node.location(), node.jump() == jump_kind::break_
+            ? "`break` statement not in a loop"
+            : "`continue` statement not in a loop");
+    }
+    const auto& loop = m_loops.back();
+    m_builder->br(node.jump() == jump_kind::break_ ? loop.break_target : loop.continue_target);
+    return invalid_id;
+}
+
+value_id lowering::visit_integer_literal(integer_literal& node) {
+    const auto value = node.value();
+    // the type of an integer constant is the first one that can hold it.
+    const auto limit = node.is_unsigned()
+        ? std::uint64_t{ std::numeric_limits<std::uint32_t>::max() }
+        : std::uint64_t{ std::numeric_limits<std::int32_t>::max() };
+    const auto type = (node.is_long() || value > limit) ? value_type::i64 : value_type::i32;
+
+    m_type = c_type::integer(type, node.is_unsigned());
+    return m_builder->iconst(type, static_cast<std::int64_t>(value));
+}
+
+value_id lowering::visit_string_literal(string_literal& node) {
+    // a string literal is a char array, it's only ever used as a pointer to its first char.
+    m_type = c_type::integer(value_type::i8).address_of();
+    return m_builder->global_addr(m_module.string_symbol(node.id()));
+}
+
+value_id lowering::visit_name_expression(name_expression& node) {
+    auto* var = find_variable(node.name());
+    if (var == nullptr) {
+        return fail(node.location(), std::format("use of undeclared identifier `{}`", node.name()));
+    }
+    const auto address = var->slot != invalid_id ? var->slot : m_builder->global_addr(var->global);
+    return load(address, var->type);
+}
+
+value_id lowering::visit_assignment(assignment& node) {
+    value_id address;
+    c_type object;
+    if (node.target() != nullptr) {
+        address = lower_address(*node.target());
+        object = m_type;
+    }
+    else {
+        auto* var = find_variable(node.assignee());
+        if (var == nullptr) {
+            return fail(node.location(), std::format("use of undeclared identifier `{}`", node.assignee()));
+        }
+        address = var->slot != invalid_id ? var->slot : m_builder->global_addr(var->global);
+        object = var->type;
+    }
+
+    if (!node.has_expression()) {
+        return fail(node.location(), "expected an expression to assign");
+    }
+    auto& rhs_expr = *node.expression().value();
+
+    value_id value;
+    if (node.compound_op().has_value()) {
+        const auto op = node.compound_op().value();
+        const auto current = load(address, object);
+        auto current_type = m_type;
+        auto rhs = visit(rhs_expr);
+        auto rhs_type = m_type;
+
+        value_id combined;
+        c_type combined_type;
+        if (object.is_pointer() && (op == binary_op::add || op == binary_op::sub)) {
+            combined = pointer_offset(current, object, rhs, rhs_type, op == binary_op::sub);
+            combined_type = object;
+        }
+        else {
+            combined_type = common_type(rhs, rhs_type, combined = current, current_type);
+            combined = arithmetic(op, combined, rhs, combined_type);
+        }
+        value = convert(combined, combined_type, object);
+    }
+    else {
+        value = lower_as(rhs_expr, object);
+    }
+
+    m_builder->store(address, value);
+    m_type = object;
+    return promote(value, m_type);
+}
+
+value_id lowering::visit_binary_expression(binary_expression& node) {
+    auto& fn = *m_function;
+    const auto op = node.op();
+
+    if (op == binary_op::logical_and || op == binary_op::logical_or) {
+        const bool is_and = op == binary_op::logical_and;
+        const auto lhs = lower_condition(node.lhs());
+        // the result when the right side is skipped.
+        const auto short_circuit = m_builder->iconst(value_type::i1, is_and ? 0 : 1);
+        const auto lhs_block = m_builder->insert_point();
+
+        const auto rhs_block = fn.create_block();
+        const auto end = fn.create_block();
+        if (is_and) {
+            m_builder->cond_br(lhs, rhs_block, end);
+        }
+        else {
+            m_builder->cond_br(lhs, end, rhs_block);
+        }
+
+        m_builder->set_insert_point(rhs_block);
+        const auto rhs = lower_condition(node.rhs());
+        const auto rhs_end = m_builder->insert_point();
+        m_builder->br(end);
+
+        m_builder->set_insert_point(end);
+        const auto phi = m_builder->phi(value_type::i1, 2);
+        fn.set_phi_incoming(phi, 0, short_circuit, lhs_block);
+        fn.set_phi_incoming(phi, 1, rhs, rhs_end);
+
+        m_type = c_type::integer(value_type::i32);
+        return m_builder->cast(opcode::zext, value_type::i32, phi);
+    }
+
+    auto lhs = visit(node.lhs());
+    auto lhs_type = m_type;
+    auto rhs = visit(node.rhs());
+    auto rhs_type = m_type;
+
+    if (lhs_type.is_void() || rhs_type.is_void()) {
+        return fail(node.location(), "void value not ignored as it ought to be");
+    }
+
+    switch (op) {
+    case binary_op::eq:
+    case binary_op::ne:
+    case binary_op::lt:
+    case binary_op::le:
+    case binary_op::gt:
+    case binary_op::ge: {
+        bool is_unsigned;
+        if (lhs_type.is_pointer() || rhs_type.is_pointer()) {
+            // pointers compare as unsigned addresses.
+            const auto ptr = lhs_type.is_pointer() ? lhs_type : rhs_type;
+            lhs = convert(lhs, lhs_type, ptr);
+            rhs = convert(rhs, rhs_type, ptr);
+            is_unsigned = true;
+        }
+        else {
+            is_unsigned = common_type(lhs, lhs_type, rhs, rhs_type).is_unsigned;
+        }
+
+        cmp_pred pred{};
+        switch (op) {
+        case binary_op::eq: pred = cmp_pred::eq; break;
+        case binary_op::ne: pred = cmp_pred::ne; break;
+        case binary_op::lt: pred = is_unsigned ? cmp_pred::ult : cmp_pred::slt; break;
+        case binary_op::le: pred = is_unsigned ? cmp_pred::ule : cmp_pred::sle; break;
+        case binary_op::gt: pred = is_unsigned ? cmp_pred::ugt : cmp_pred::sgt; break;
+        case binary_op::ge: pred = is_unsigned ? cmp_pred::uge : cmp_pred::sge; break;
+        default: break;
+        }
+        const auto cmp = m_builder->icmp(pred, lhs, rhs);
+        m_type = c_type::integer(value_type::i32);
+        return m_builder->cast(opcode::zext, value_type::i32, cmp);
+    }
+    case binary_op::add:
+        if (lhs_type.is_pointer() && !rhs_type.is_pointer()) {
+            return pointer_offset(lhs, lhs_type, rhs, rhs_type, false);
+        }
+        if (rhs_type.is_pointer() && !lhs_type.is_pointer()) {
+            return pointer_offset(rhs, rhs_type, lhs, lhs_type, false);
+        }
+        break;
+    case binary_op::sub:
+        if (lhs_type.is_pointer() && rhs_type.is_pointer()) {
+            // the distance between two pointers, in elements.
+            const auto a = m_builder->cast(opcode::bitcast, value_type::i64, lhs);
+            const auto b = m_builder->cast(opcode::bitcast, value_type::i64, rhs);
+            const auto bytes = m_builder->binary(opcode::sub, value_type::i64, a, b);
+            m_type = c_type::integer(value_type::i64);
+            return m_builder->binary(opcode::sdiv, value_type::i64, bytes,
+                m_builder->iconst(value_type::i64, lhs_type.pointee_size()));
+        }
+        if (lhs_type.is_pointer()) {
+            return pointer_offset(lhs, lhs_type, rhs, rhs_type, true);
+        }
+        break;
+    case binary_op::shl:
+    case binary_op::shr: {
+        // the type of a shift is the (promoted) type of its left side.
+        lhs = promote(lhs, lhs_type);
+        rhs = promote(rhs, rhs_type);
+        rhs = convert(rhs, rhs_type, lhs_type);
+        m_type = lhs_type;
+        return arithmetic(op, lhs, rhs, lhs_type);
+    }
+    default:
+        break;
+    }
+
+    if (lhs_type.is_pointer() || rhs_type.is_pointer()) {
+        return fail(node.location(), "invalid operands to binary expression");
+    }
+
+    const auto type = common_type(lhs, lhs_type, rhs, rhs_type);
+    m_type = type;
+    return arithmetic(op, lhs, rhs, type);
+}
+
+value_id lowering::visit_unary_expression(unary_expression& node) {
+    switch (node.op()) {
+    case unary_op::negate:
+    case unary_op::bitwise_not: {
+        auto value = visit(node.operand());
+        if (m_type.is_pointer() || m_type.is_void()) {
+            return fail(node.location(), "invalid argument type to unary expression");
+        }
+        value = promote(value, m_type);
+        return m_builder->unary(node.op() == unary_op::negate ? opcode::neg : opcode::not_, m_type.type, value);
+    }
+    case unary_op::logical_not: {
+        const auto condition = lower_condition(node.operand());
+        const auto inverted = m_builder->binary(opcode::xor_, value_type::i1, condition,
+            m_builder->iconst(value_type::i1, 1));
+        m_type = c_type::integer(value_type::i32);
+        return m_builder->cast(opcode::zext, value_type::i32, inverted);
+    }
+    case unary_op::dereference: {
+        const auto ptr = visit(node.operand());
+        if (!m_type.is_pointer()) {
+            return fail(node.location(), "indirection requires a pointer operand");
+        }
+        return load(ptr, m_type.deref());
+    }
+    case unary_op::address_of: {
+        const auto address = lower_address(node.operand());
+        m_type = m_type.address_of();
+        return address;
+    }
+    case unary_op::pre_increment:
+    case unary_op::pre_decrement:
+    case unary_op::post_increment:
+    case unary_op::post_decrement: {
+        const bool is_increment = node.op() == unary_op::pre_increment || node.op() == unary_op::post_increment;
+        const bool is_prefix = node.op() == unary_op::pre_increment || node.op() == unary_op::pre_decrement;
+
+        const auto address = lower_address(node.operand());
+        const auto object = m_type;
+        const auto old_value = load(address, object);
+        const auto type = m_type;
+
+        value_id new_value;
+        if (object.is_pointer()) {
+            new_value = m_builder->ptr_add(old_value,
+                m_builder->iconst(value_type::i64, is_increment ? 1 : -1), object.pointee_size());
+        }
+        else {
+            new_value = m_builder->binary(is_increment ? opcode::add : opcode::sub, type.type,
+                old_value, m_builder->iconst(type.type, 1));
+        }
+        const auto stored = convert(new_value, type, object);
+        m_builder->store(address, stored);
+        if (!is_prefix) {
+            m_type = type;
+            return old_value;
+        }
+        // "++c" is the value "c" holds after it, narrowed to the object's type first.
+        m_type = object;
+        return promote(stored, m_type);
+    }
+    }
+
+    return fail(node.location(), "unknown unary operator");
+}
+
+value_id lowering::visit_call_expression(call_expression& node) {
+    auto it = m_functions.find(node.callee());
+    if (it == m_functions.end()) {
+        return fail(node.location(), std::format("call to undeclared function `{}`", node.callee()));
+    }
+    const auto& sig = it->second;
+    if (sig.params.size() != node.args().size()) {
+        return fail(node.location(), std::format("`{}` expects {} arguments, but {} were given",
+            node.callee(), sig.params.size(), node.args().size()));
+    }
+
+    std::vector<value_id> args;
+    args.reserve(node.args().size());
+    for (std::size_t i = 0; i < node.args().size(); ++i) {
+        args.push_back(lower_as(*node.args()[i], sig.params[i]));
+    }
+
+    const auto result = m_builder->call(sig.return_type.type, sig.symbol, args);
+    m_type = sig.return_type;
+    if (sig.returns_void) {
+        return result;
+    }
+    return promote(result, m_type);
+}
+
+value_id lowering::visit_subscript_expression(subscript_expression& node) {
+    const auto address = lower_address(node);
+    return load(address, m_type);
+}
+
+value_id lowering::lower_address(expression& expr) noexcept {
+    switch (expr.kind()) {
+    case node_kind::name_expression: {
+        const auto& name = static_cast<name_expression&>(expr).name();
+        auto* var = find_variable(name);
+        if (var == nullptr) {
+            return fail(expr.location(), std::format("use of undeclared identifier `{}`", name));
+        }
+        m_type = var->type;
+        return var->slot != invalid_id ? var->slot : m_builder->global_addr(var->global);
+    }
+    case node_kind::subscript_expression: {
+        auto& subscript = static_cast<subscript_expression&>(expr);
+        auto base = visit(subscript.base());
+        auto base_type = m_type;
+        auto index = visit(subscript.index());
+        auto index_type = m_type;
+        // "i[array]" is the same as "array[i]".
+        if (!base_type.is_pointer() && index_type.is_pointer()) {
+            std::swap(base, index);
+            std::swap(base_type, index_type);
+        }
+        if (!base_type.is_pointer()) {
+            return fail(expr.location(), "subscripted value is not an array or pointer");
+        }
+        const auto address = pointer_offset(base, base_type, index, index_type, false);
+        m_type = base_type.deref();
+        return address;
+    }
+    case node_kind::unary_expression: {
+        auto& unary = static_cast<unary_expression&>(expr);
+        if (unary.op() != unary_op::dereference) {
+            break;
+        }
+        const auto ptr = visit(unary.operand());
+        if (!m_type.is_pointer()) {
+            return fail(expr.location(), "indirection requires a pointer operand");
+        }
+        m_type = m_type.deref();
+        return ptr;
+    }
+    default:
+        break;
+    }
+    return fail(expr.location(), "expression is not assignable");
+}
+
+value_id lowering::lower_as(expression& expr, const c_type& to) noexcept {
+    const auto value = visit(expr);
+    if (m_type.is_void()) {
+        return fail(expr.location(), "void value not ignored as it ought to be");
+    }
+    return convert(value, m_type, to);
+}
+
+value_id lowering::lower_condition(expression& expr) noexcept {
+    const auto value = visit(expr);
+    if (m_type.is_void()) {
+        return fail(expr.location(), "void value not ignored as it ought to be");
+    }
+
+    // "a < b" is lowered as zext(icmp), just use the icmp.
+    const auto& inst = m_function->inst(value);
+    if (inst.op == opcode::zext && m_function->inst(m_function->operand(value, 0)).type == value_type::i1) {
+        return m_function->operand(value, 0);
+    }
+    if (inst.type == value_type::i1) {
+        return value;
+    }
+    return m_builder->icmp(cmp_pred::ne, value, m_builder->iconst(inst.type, 0));
+}
+
+value_id lowering::convert(value_id value, const c_type& from, const c_type& to) noexcept {
+    if (from.type == to.type || to.is_void()) {
+        return value;
+    }
+
+    if (to.type == value_type::i1) {
+        return m_builder->icmp(cmp_pred::ne, value, m_builder->iconst(from.type, 0));
+    }
+    if (from.type == value_type::i1) {
+        const auto wide = to.type == value_type::ptr ? value_type::i64 : to.type;
+        const auto extended = m_builder->cast(opcode::zext, wide, value);
+        return wide == to.type ? extended : m_builder->cast(opcode::bitcast, to.type, extended);
+    }
+
+    if (to.type == value_type::ptr) {
+        // integer -> pointer, widen to 64 bits first.
+        const auto wide = convert(value, from, c_type::integer(value_type::i64, from.is_unsigned));
+        return m_builder->cast(opcode::bitcast, value_type::ptr, wide);
+    }
+    if (from.type == value_type::ptr) {
+        const auto bits = m_builder->cast(opcode::bitcast, value_type::i64, value);
+        return convert(bits, c_type::integer(value_type::i64, true), to);
+    }
+
+    const auto from_size = size_of(from.type);
+    const auto to_size = size_of(to.type);
+    if (to_size < from_size) {
+        return m_builder->cast(opcode::trunc, to.type, value);
+    }
+    return m_builder->cast(from.is_unsigned ? opcode::zext : opcode::sext, to.type, value);
+}
+
+value_id lowering::promote(value_id value, c_type& type) noexcept {
+    if (type.is_pointer()) {
+        return value;
+    }
+    switch (type.type) {
+    case value_type::i1:
+    case value_type::i8:
+    case value_type::i16: {
+        const auto op = (type.type == value_type::i1 || type.is_unsigned) ? opcode::zext : opcode::sext;
+        // every value of a smaller type fits in an int, so the result is always signed.
+        type = c_type::integer(value_type::i32);
+        return m_builder->cast(op, value_type::i32, value);
+    }
+    default:
+        return value;
+    }
+}
+
+value_id lowering::load(value_id address, const c_type& type) noexcept {
+    m_type = type;
+    const auto value = m_builder->load(type.type, address);
+    return promote(value, m_type);
+}
+
+c_type lowering::common_type(value_id& lhs, c_type lhs_type, value_id& rhs, c_type rhs_type) noexcept {
+    lhs = promote(lhs, lhs_type);
+    rhs = promote(rhs, rhs_type);
+
+    c_type result;
+    const auto lhs_size = size_of(lhs_type.type);
+    const auto rhs_size = size_of(rhs_type.type);
+    if (lhs_size != rhs_size) {
+        result = lhs_size > rhs_size ? lhs_type : rhs_type;
+    }
+    else {
+        result = c_type::integer(lhs_type.type, lhs_type.is_unsigned || rhs_type.is_unsigned);
+    }
+
+    lhs = convert(lhs, lhs_type, result);
+    rhs = convert(rhs, rhs_type, result);
+    return result;
+}
+
+value_id lowering::arithmetic(binary_op op, value_id lhs, value_id rhs, const c_type& type) noexcept {
+    opcode code = opcode::add;
+    switch (op) {
+    case binary_op::add: code = opcode::add; break;
+    case binary_op::sub: code = opcode::sub; break;
+    case binary_op::mul: code = opcode::mul; break;
+    case binary_op::div: code = type.is_unsigned ? opcode::udiv : opcode::sdiv; break;
+    case binary_op::mod: code = type.is_unsigned ? opcode::urem : opcode::srem; break;
+    case binary_op::shl: code = opcode::shl; break;
+    case binary_op::shr: code = type.is_unsigned ? opcode::lshr : opcode::ashr; break;
+    case binary_op::bit_and: code = opcode::and_; break;
+    case binary_op::bit_or: code = opcode::or_; break;
+    case binary_op::bit_xor: code = opcode::xor_; break;
+    default: break;
+    }
+    return m_builder->binary(code, type.type, lhs, rhs);
+}
+
+value_id lowering::pointer_offset(value_id ptr, const c_type& ptr_type, value_id index, const c_type& index_type, bool negate) noexcept {
+    auto wide = convert(index, index_type, c_type::integer(value_type::i64, index_type.is_unsigned));
+    if (negate) {
+        wide = m_builder->unary(opcode::neg, value_type::i64, wide);
+    }
+    m_type = ptr_type;
+    return m_builder->ptr_add(ptr, wide, ptr_type.pointee_size());
+}
+
+value_id lowering::new_slot(const c_type& type) noexcept {
+    auto& fn = *m_function;
+    const auto slot = fn.create(opcode::alloca, value_type::ptr, {}, static_cast<std::int64_t>(size_of(type.type)));
+
+    if (m_alloca_point != invalid_id) {
+        fn.insert_after(m_alloca_point, slot);
+    }
+    else if (fn.block(fn.entry()).empty()) {
+        fn.append(fn.entry(), slot);
+    }
+    else {
+        fn.insert_before(fn.block(fn.entry()).first, slot);
+    }
+    m_alloca_point = slot;
+    return slot;
+}
+
+lowering::variable* lowering::find_variable(const std::string& name) noexcept {
+    for (auto it = m_scopes.rbegin(); it != m_scopes.rend(); ++it) {
+        if (auto found = it->find(name); found != it->end()) {
+            return &found->second;
+        }
+    }
+    if (auto found = m_globals.find(name); found != m_globals.end()) {
+        return &found->second;
+    }
+    return nullptr;
+}
+
+void lowering::ensure_block() noexcept {
+    if (m_builder->is_terminated()) {
+        // anything after a return, break or continue is unreachable.
+        m_builder->set_insert_point(m_function->create_block());
+    }
+}
@@ -0,0 +1,182 @@
+#ifndef _COMPILER_IR_LOWER_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/result.hpp"
+#include "../../common/error.hpp"
+
+#include "ir.hpp"
+#include "builder.hpp"
+
+#include "../parser/parser.hpp"
+#include "../parser/static_visitor.hpp"
+#include "../diagnostics/diag.hpp"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+// The C type of a lowered expression, this is what decides conversions and which
+// signed/unsigned instruction is used.
+struct c_type {
+    // ptr whenever pointer_depth isn't zero.
+    value_type type{ value_type::i32 };
+    // the signedness of the base type.
+    bool is_unsigned{ false };
+    // levels of indirection, "int**" has a depth of 2.
+    std::size_t pointer_depth{ 0 };
+    // the type at the bottom of all of the pointers, the same as "type" for non-pointers.
+    value_type base{ value_type::i32 };
+
+    static c_type from(const type_information& info) noexcept;
+    static c_type integer(value_type type, bool is_unsigned = false) noexcept;
+
+    inline bool is_pointer() const noexcept { return pointer_depth != 0; }
+    inline bool is_void() const noexcept { return type == value_type::void_; }
+    // The type you get by dereferencing this pointer.
+    c_type deref() const noexcept;
+    // The pointer type that points to this type.
+    c_type address_of() const noexcept;
+    // The size of the type this pointer points to.
+    std::int64_t pointee_size() const noexcept;
+};
+
+/*
+  Lowers the AST into SSA form.
+
+  Locals are given a stack slot (alloca) in the entry block and every access is a load or a
+  store, this keeps lowering simple. mem2reg is what turns them into SSA values afterwards.
+  Short-circuiting operators are the only place phis are created here.
+
+  This walks the tree with static_visitor, so there is no virtual dispatch per node.
+*/
+class lowering : public static_visitor<lowering, value_id> {
+private:
+    struct variable {
+        // the alloca of a local, or invalid_id for a global.
+        value_id slot{ invalid_id };
+        symbol_id global{ invalid_id };
+        c_type type{};
+    };
+    struct function_signature {
+        symbol_id symbol;
+        c_type return_type;
+        bool returns_void;
+        std::vector<c_type> params;
+        // any of its declarations said "inline".
+        bool is_inline{ false };
+    };
+    struct loop_targets {
+        block_id break_target;
+        block_id continue_target;
+    };
+
+    module& m_module;
+    // appended to the symbols of everything with internal linkage, see lowering().
+    std::string m_internal_suffix;
+    std::vector<diagnostic> m_diags{};
+    // writes each diagnostic out as it's produced, see set_diagnostic_writer().
+    std::optional<diagnostic_writer> m_writer{};
+
+    std::unordered_map<std::string, function_signature> m_functions{};
+    std::unordered_map<std::string, variable> m_globals{};
+    // how many static locals have been lowered, part of their symbol names.
+    std::uint32_t m_static_locals{ 0 };
+
+    // only set while lowering a function body.
+    function* m_function{ nullptr };
+    std::optional<builder> m_builder{};
+    const function_signature* m_signature{ nullptr };
+    std::vector<std::unordered_map<std::string, variable>> m_scopes{};
+    std::vector<loop_targets> m_loops{};
+    // allocas are inserted after this instruction, so they stay at the top of the entry block.
+    value_id m_alloca_point{ invalid_id };
+
+    // the C type of the last expression that was lowered.
+    c_type m_type{};
+public:
+    // Several translation units can be lowered into one module (--unity), each with its own
+    // lowering. "internal_suffix" keeps their statics apart, a "static int f" becomes the
+    // symbol "f" followed by it.
+    explicit lowering(module& mod, std::string internal_suffix = {}) noexcept;
+
+    // Start out with every function and global "other" declared in scope, as if they had
+    // been declared at the top of the tree. For declarations shared by several units.
+    void import_declarations(const lowering& other) noexcept;
+
+    // Write each diagnostic out with "writer" as soon as it's produced, not only push it into
+    // diagnostics().
+    inline void set_diagnostic_writer(const diagnostic_writer& writer) noexcept { m_writer.emplace(writer); }
+
+    // Lower every top level declaration, errors are also pushed into diagnostics().
+    NODISCARD result<void, error> lower(ast& tree) noexcept;
+
+    inline const std::vector<diagnostic>& diagnostics() const noexcept { return m_diags; }
+
+    // static_visitor
+    value_id visit_function_declaration(function_declaration& node);
+    value_id visit_assignment_declaration(assignment_declaration& node);
+    value_id visit_compound_statement(compound_statement& node);
+    value_id visit_expression_statement(expression_statement& node);
+    value_id visit_return_statement(return_statement& node);
+    value_id visit_if_statement(if_statement& node);
+    value_id visit_while_statement(while_statement& node);
+    value_id visit_for_statement(for_statement& node);
+    value_id visit_jump_statement(jump_statement& node);
+
+    value_id visit_integer_literal(integer_literal& node);
+    value_id visit_string_literal(string_literal& node);
+    value_id visit_name_expression(name_expression& node);
+    value_id visit_assignment(assignment& node);
+    value_id visit_binary_expression(binary_expression& node);
+    value_id visit_unary_expression(unary_expression& node);
+    value_id visit_call_expression(call_expression& node);
+    value_id visit_subscript_expression(subscript_expression& node);
+
+private:
+    symbol_id intern_symbol(const std::string& name, symbol_kind kind, linkage link) noexcept;
+    // Lower a global variable.
+    void lower_global(assignment_declaration& node) noexcept;
+    // The value of the constant initializer of "node" (0 without one) in "out". Fails the
+    // declaration and returns false if it isn't a constant.
+    bool constant_initializer(assignment_declaration& node, std::int64_t& out) noexcept;
+    // Declare (or define) a function, makes it callable from everything after it.
+    function_signature* declare_function(function_declaration& node) noexcept;
+
+    // Lower an expression into a value of type "to".
+    value_id lower_as(expression& expr, const c_type& to) noexcept;
+    // Lower an expression into an i1, for use in branches.
+    value_id lower_condition(expression& expr) noexcept;
+    // Lower an lvalue into its address, m_type is the type of the object (not the pointer).
+    value_id lower_address(expression& expr) noexcept;
+    // Lower a statement, starting a new (unreachable) block if the current one has ended.
+    void lower_statement(ast_node& node) noexcept;
+
+    value_id convert(value_id value, const c_type& from, const c_type& to) noexcept;
+    // Integer promotion: i1, i8 and i16 become i32.
+    value_id promote(value_id value, c_type& type) noexcept;
+    // Load a value of "type" from "address", promoting small integers.
+    value_id load(value_id address, const c_type& type) noexcept;
+    // The usual arithmetic conversions, converts both sides to a common type.
+    c_type common_type(value_id& lhs, c_type lhs_type, value_id& rhs, c_type rhs_type) noexcept;
+    // lhs op rhs, where both sides are already of type "type".
+    value_id arithmetic(binary_op op, value_id lhs, value_id rhs, const c_type& type) noexcept;
+    // Pointer +/- integer.
+    value_id pointer_offset(value_id ptr, const c_type& ptr_type, value_id index, const c_type& index_type, bool negate) noexcept;
+
+    value_id new_slot(const c_type& type) noexcept;
+    variable* find_variable(const std::string& name) noexcept;
+    // Make sure there's a block to add instructions to, after a return/break there isn't one.
+    void ensure_block() noexcept;
+
+    value_id fail(const source_location& location, const std::string& message) noexcept;
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_LOWER_HPP
+#endif // !_COMPILER_IR_LOWER_HPP
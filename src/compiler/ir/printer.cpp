@@ -0,0 +1,131 @@
+#include "printer.hpp"
+
+#include <format>
+#include <iterator>
+
+using namespace compiler::ir;
+
+static void print_instruction(std::string& out, const module& mod, const function& fn, value_id id) {
+    const auto& inst = fn.inst(id);
+    auto it = std::back_inserter(out);
+
+    out += "  ";
+    if (inst.type != value_type::void_) {
+        std::format_to(it, "%{} = ", id);
+    }
+    out += opcode_to_string(inst.op);
+    if (inst.type != value_type::void_) {
+        std::format_to(it, " {}", value_type_to_string(inst.type));
+    }
+
+    switch (inst.op) {
+    case opcode::param:
+    case opcode::iconst:
+    case opcode::alloca:
+        std::format_to(it, " {}", inst.imm);
+        break;
+    case opcode::icmp:
+        std::format_to(it, " {}", cmp_pred_to_string(static_cast<cmp_pred>(inst.imm)));
+        break;
+    case opcode::reduce:
+        std::format_to(it, " {}", opcode_to_string(static_cast<opcode>(inst.imm)));
+        break;
+    case opcode::global_addr:
+    case opcode::call:
+        std::format_to(it, " @{}", mod.get_symbol(static_cast<symbol_id>(inst.imm)).name);
+        break;
+    default:
+        break;
+    }
+
+    if (inst.op == opcode::phi) {
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            std::format_to(it, "{} [%{}, bb{}]", i == 0 ? "" : ",", fn.operand(id, i), fn.target(id, i));
+        }
+        out += '\n';
+        return;
+    }
+
+    for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+        std::format_to(it, "{} %{}", i == 0 ? "" : ",", fn.operand(id, i));
+    }
+    if (inst.op == opcode::ptr_add) {
+        std::format_to(it, " x {}", inst.imm);
+    }
+    for (std::uint32_t i = 0; i < inst.target_count(); ++i) {
+        std::format_to(it, "{} bb{}", (i == 0 && inst.operand_count == 0) ? "" : ",", fn.target(id, i));
+    }
+    out += '\n';
+}
+
+std::string compiler::ir::print_function(const module& mod, const function& fn) noexcept {
+    std::string out;
+    auto it = std::back_inserter(out);
+
+    std::format_to(it, "{} {} @{}(",
+        fn.is_definition() ? "define" : "declare",
+        value_type_to_string(fn.return_type()),
+        fn.name());
+    for (std::size_t i = 0; i < fn.params().size(); ++i) {
+        std::format_to(it, "{}{}", i == 0 ? "" : ", ", value_type_to_string(fn.params()[i]));
+    }
+    out += ")";
+    if (fn.link() == linkage::internal) {
+        out += " internal";
+    }
+    if (fn.inline_hint()) {
+        out += " inline";
+    }
+    if (!fn.is_definition()) {
+        out += "\n";
+        return out;
+    }
+
+    out += " {\n";
+    for (block_id b = 0; b < fn.block_count(); ++b) {
+        if (fn.block(b).removed) {
+            continue;
+        }
+        std::format_to(it, "bb{}:\n", b);
+        fn.for_each_inst(b, [&](value_id id) { print_instruction(out, mod, fn, id); });
+    }
+    out += "}\n";
+    return out;
+}
+
+std::string compiler::ir::print_module(const module& mod) noexcept {
+    std::string out;
+    auto it = std::back_inserter(out);
+
+    for (const auto& g : mod.globals()) {
+        const auto& sym = mod.get_symbol(g.symbol);
+        std::format_to(it, "@{} = {}global {} {}\n",
+            sym.name,
+            sym.link == linkage::internal ? "internal " : "",
+            value_type_to_string(g.type),
+            g.init);
+    }
+    for (const auto& constant : mod.string_constants()) {
+        // printable characters as they are, everything else as \XX.
+        std::format_to(it, "@{} = internal constant c\"", mod.get_symbol(constant.symbol).name);
+        for (const auto c : mod.strings().get(constant.string)) {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte >= 0x20 && byte < 0x7F && c != '"' && c != '\\') {
+                out += c;
+            }
+            else {
+                std::format_to(it, "\\{:02X}", byte);
+            }
+        }
+        out += "\\00\"\n";
+    }
+    if (!mod.globals().empty() || !mod.string_constants().empty()) {
+        out += '\n';
+    }
+
+    for (const auto& fn : mod.functions()) {
+        out += print_function(mod, *fn);
+        out += '\n';
+    }
+    return out;
+}
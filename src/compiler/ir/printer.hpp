@@ -0,0 +1,20 @@
+#ifndef _COMPILER_IR_PRINTER_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+
+#include <string>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+// Textual form of the IR, for debugging (see --emit-ir).
+NODISCARD std::string print_function(const module& mod, const function& fn) noexcept;
+NODISCARD std::string print_module(const module& mod) noexcept;
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_PRINTER_HPP
+#endif // !_COMPILER_IR_PRINTER_HPP
@@ -0,0 +1,81 @@
+#ifndef _COMPILER_IR_USE_LISTS_HPP
+
+#include "../../common/common.hpp"
+
+#include "ir.hpp"
+
+#include <span>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace ir {
+
+// A single use of a value, "user" has the value as its operand number "index".
+struct use {
+    value_id user;
+    std::uint32_t index;
+};
+
+/*
+  The users of every value in a function, in compressed sparse row form: one offset per
+  value and one flat array of uses. That's 8 bytes per use plus 4 per value, built with two
+  linear passes over the function.
+
+  This is a snapshot, it's not updated when the function changes. Passes build it once,
+  do their work and throw it away (or rebuild it if they need it again).
+*/
+class use_lists {
+private:
+    std::vector<std::uint32_t> m_offsets{};
+    std::vector<use> m_uses{};
+public:
+    inline explicit use_lists(const function& fn) noexcept {
+        const auto count = fn.value_count();
+        m_offsets.assign(count + 1, 0);
+
+        // count the uses of every value.
+        for (value_id id = 0; id < count; ++id) {
+            const auto& inst = fn.inst(id);
+            if (inst.block == invalid_id) {
+                continue;
+            }
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                m_offsets[fn.operand(id, i) + 1]++;
+            }
+        }
+        for (std::uint32_t i = 0; i < count; ++i) {
+            m_offsets[i + 1] += m_offsets[i];
+        }
+
+        // then fill them in, "cursor" is where the next use of each value goes.
+        m_uses.resize(m_offsets[count]);
+        auto cursor = std::vector<std::uint32_t>(m_offsets.begin(), m_offsets.end() - 1);
+        for (value_id id = 0; id < count; ++id) {
+            const auto& inst = fn.inst(id);
+            if (inst.block == invalid_id) {
+                continue;
+            }
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                m_uses[cursor[fn.operand(id, i)]++] = use{ id, i };
+            }
+        }
+    }
+
+    inline std::span<const use> uses(value_id value) const noexcept {
+        return { m_uses.data() + m_offsets[value], m_offsets[value + 1] - m_offsets[value] };
+    }
+
+    inline std::uint32_t use_count(value_id value) const noexcept {
+        return m_offsets[value + 1] - m_offsets[value];
+    }
+
+    inline bool has_uses(value_id value) const noexcept {
+        return use_count(value) != 0;
+    }
+};
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_USE_LISTS_HPP
+#endif // !_COMPILER_IR_USE_LISTS_HPP
@@ -0,0 +1,76 @@
+#include "verifier.hpp"
+#include "cfg.hpp"
+
+#include <algorithm>
+
+using namespace compiler::ir;
+
+result<void, error> compiler::ir::verify_function(const module& mod, const function& fn) noexcept {
+    if (!fn.is_definition()) {
+        return {};
+    }
+
+    const auto graph = cfg(fn);
+
+    for (block_id b = 0; b < fn.block_count(); ++b) {
+        const auto& bb = fn.block(b);
+        if (bb.removed) {
+            continue;
+        }
+        if (fn.terminator(b) == invalid_id) {
+            return error("@{}: bb{} does not end with a terminator", fn.name(), b);
+        }
+
+        bool past_phis = false;
+        for (auto id = bb.first; id != invalid_id; id = fn.inst(id).next) {
+            const auto& inst = fn.inst(id);
+            if (inst.block != b) {
+                return error("@{}: %{} thinks it's in bb{} but it's in bb{}", fn.name(), id, inst.block, b);
+            }
+            if (is_terminator(inst.op) && id != bb.last) {
+                return error("@{}: terminator %{} is in the middle of bb{}", fn.name(), id, b);
+            }
+
+            if (inst.op == opcode::phi) {
+                if (past_phis) {
+                    return error("@{}: phi %{} is not at the start of bb{}", fn.name(), id, b);
+                }
+                const auto preds = graph.preds(b);
+                if (inst.operand_count != preds.size()) {
+                    return error("@{}: phi %{} has {} incoming values, but bb{} has {} predecessors",
+                        fn.name(), id, inst.operand_count, b, preds.size());
+                }
+                for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                    if (std::find(preds.begin(), preds.end(), fn.target(id, i)) == preds.end()) {
+                        return error("@{}: phi %{} has an incoming value from bb{} which is not a predecessor of bb{}",
+                            fn.name(), id, fn.target(id, i), b);
+                    }
+                }
+            }
+            else {
+                past_phis = true;
+            }
+
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                const auto operand = fn.operand(id, i);
+                if (operand >= fn.value_count() || fn.inst(operand).block == invalid_id) {
+                    return error("@{}: %{} uses a value that doesn't exist (operand {})", fn.name(), id, i);
+                }
+                if (fn.inst(operand).type == value_type::void_) {
+                    return error("@{}: %{} uses %{} which has no value", fn.name(), id, operand);
+                }
+            }
+            for (std::uint32_t i = 0; i < inst.target_count(); ++i) {
+                const auto target = fn.target(id, i);
+                if (target >= fn.block_count() || fn.block(target).removed) {
+                    return error("@{}: %{} branches to a block that doesn't exist", fn.name(), id);
+                }
+            }
+            if (inst.op == opcode::call && static_cast<std::size_t>(inst.imm) >= mod.symbols().size()) {
+                return error("@{}: %{} calls an unknown symbol", fn.name(), id);
+            }
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,22 @@
+#ifndef _COMPILER_IR_VERIFIER_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/result.hpp"
+#include "../../common/error.hpp"
+
+#include "ir.hpp"
+
+COMPILER_API_BEGIN
+namespace ir {
+
+// Check the structural invariants of a function: every block ends in exactly one terminator,
+// phis are at the start of their block and have one value per predecessor, and every operand
+// refers to an instruction that's still inside of a block.
+// NOTE: this does not check that definitions dominate their uses.
+NODISCARD result<void, error> verify_function(const module& mod, const function& fn) noexcept;
+
+} // namespace ir
+COMPILER_API_END
+
+#define _COMPILER_IR_VERIFIER_HPP
+#endif // !_COMPILER_IR_VERIFIER_HPP
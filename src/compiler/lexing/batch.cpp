@@ -0,0 +1,75 @@
+#include "batch.hpp"
+
+#include "../../common/mapped_file.hpp"
+
+#include <chrono>
+
+namespace {
+
+// What each thread of the pool keeps between files.
+struct worker_state {
+    std::optional<compiler::lexer> lexer{};
+    compiler::lex_stats stats{};
+};
+
+} // namespace
+
+compiler::lex_stats compiler::lex_files(const std::vector<std::string>& paths, thread_pool& pool, const lexed_file_callback& callback) noexcept {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<worker_state> workers(pool.size());
+    // far enough ahead that a file is in memory by the time a thread gets to it.
+    const auto prefetch_distance = pool.size() * 2;
+    for (std::size_t i = 0; i < prefetch_distance && i < paths.size(); ++i) {
+        mapped_file::prefetch(paths[i]);
+    }
+
+    pool.for_each_index(paths.size(), [&](std::size_t index, std::size_t worker) {
+        if (index + prefetch_distance < paths.size()) {
+            mapped_file::prefetch(paths[index + prefetch_distance]);
+        }
+
+        auto& state = workers[worker];
+        const auto& path = paths[index];
+        state.stats.files++;
+
+        auto file = mapped_file::open(path);
+        if (file.is_err()) {
+            static const std::vector<token> no_tokens{};
+            static const string_pool no_strings{};
+            state.stats.failed++;
+            callback(lexed_file{ index, path, no_tokens, no_strings, 0, std::move(file).err() }, worker);
+            return;
+        }
+        file.get()->will_need();
+        const auto bytes = file.get()->bytes();
+
+        // lexed straight from the mapping, which stays open until the callback is done.
+        auto info = source_info::borrow(path, std::string_view{ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+        if (state.lexer.has_value()) {
+            state.lexer->reset(std::move(info));
+        }
+        else {
+            state.lexer.emplace(std::move(info));
+        }
+        auto lex_result = state.lexer->lex_tokens();
+
+        state.stats.bytes += bytes.size();
+        state.stats.tokens += state.lexer->tokens().size();
+        std::optional<error> failure;
+        if (lex_result.is_err()) {
+            state.stats.failed++;
+            failure = std::move(lex_result).err();
+        }
+        callback(lexed_file{ index, path, state.lexer->tokens(), state.lexer->strings(), bytes.size(), std::move(failure) }, worker);
+    });
+
+    auto total = lex_stats{};
+    for (const auto& state : workers) {
+        total.files += state.stats.files;
+        total.failed += state.stats.failed;
+        total.bytes += state.stats.bytes;
+        total.tokens += state.stats.tokens;
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
@@ -0,0 +1,71 @@
+#ifndef _COMPILER_LEXING_BATCH_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/error.hpp"
+#include "../../common/thread_pool.hpp"
+
+#include "lexer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+COMPILER_API_BEGIN
+
+// One file lexed by lex_files(). Everything in it is only valid during the callback, the
+// buffers are reused for the thread's next file right after.
+struct lexed_file {
+    // the index of the file in the list of paths.
+    std::size_t index;
+    const std::string& path;
+    const std::vector<token>& tokens;
+    const string_pool& strings;
+    std::size_t bytes;
+    // why the file couldn't be read or lexed, the tokens are empty (or partial) then.
+    std::optional<error> failure;
+};
+
+// Called from every thread of the pool at once, "worker" is the thread (see thread_pool).
+using lexed_file_callback = std::function<void(const lexed_file& file, std::size_t worker)>;
+
+// What a lex_files() call did in total.
+struct lex_stats {
+    std::size_t files{ 0 };
+    std::size_t failed{ 0 };
+    std::uint64_t bytes{ 0 };
+    std::uint64_t tokens{ 0 };
+    double seconds{ 0.0 };
+
+    inline double megabytes_per_second() const noexcept {
+        return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+
+    inline std::string to_string() const noexcept {
+        return std::format("lexed {} files ({} failed), {:.1f} MB into {} tokens in {:.3f}s, {:.1f} MB/s",
+            files, failed, static_cast<double>(bytes) / (1024.0 * 1024.0), tokens, seconds, megabytes_per_second());
+    }
+};
+
+/*
+  Lex a batch of files on "pool", for tools that only need tokens (indexing symbols across
+  a repository and such) and not the rest of the compiler.
+
+  Each thread keeps one lexer and goes from file to file with it, so the token vector and the
+  string pool are only grown, not allocated anew for every file. Files are mapped and lexed
+  straight from the mapping, nothing copies them, and the ones a few places further down the
+  list are prefetched into the page cache while the current ones are lexed, so the threads
+  aren't left waiting on the disk. The tokens themselves still allocate: each one owns a copy
+  of the file name in its location and (an identifier, a keyword, ...) its lexeme, they are
+  the same tokens the parser takes.
+
+  Results go to "callback" as each file is done, in no particular order.
+*/
+COMPILER_API lex_stats lex_files(const std::vector<std::string>& paths, thread_pool& pool, const lexed_file_callback& callback) noexcept;
+
+COMPILER_API_END
+
+#define _COMPILER_LEXING_BATCH_HPP
+#endif // !_COMPILER_LEXING_BATCH_HPP
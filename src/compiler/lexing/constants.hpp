@@ -1,64 +1,37 @@
 #ifndef COMPILER_LEXING_CONSTANTS_HPP
 
 #include "../../common/common.hpp"
+#include "../../common/token_tables.hpp"
 
 #include "token_type.hpp"
 
-#include <string>
-#include <unordered_map>
+#include <array>
 #include <cctype>
+#include <string>
 
 COMPILER_API_BEGIN
 
-// All C keywords. 
-// NOTE: This is static and global, which is usually an issue but this is readonly.
-// NOTE: It should never change or be modified, which makes it fine for this use case.
-static const inline std::unordered_map<std::string, token_type> keywords = {
-      { "alignas", token_type::ALIGNAS },
-      { "alignof", token_type::ALIGNOF },
-      { "auto", token_type::AUTO },
-      { "bool", token_type::BOOL },
-      { "break", token_type::BREAK },
-      { "case", token_type::CASE },
-      { "char", token_type::CHAR },
-      { "const", token_type::CONST },
-      { "continue", token_type::CONTINUE },
-      { "default", token_type::DEFAULT },
-      { "do", token_type::DO },
-      { "double", token_type::DOUBLE },
-      { "else", token_type::ELSE },
-      { "enum", token_type::ENUM },
-      { "extern", token_type::EXTERN },
-      { "false", token_type::FALSE },
-      { "float", token_type::FLOAT },
-      { "for", token_type::FOR },
-      { "goto", token_type::GOTO },
-      { "if", token_type::IF },
-      { "inline", token_type::INLINE },
-      { "int", token_type::INT },
-      { "long", token_type::LONG },
-      { "nullptr", token_type::NULLPTR },
-      { "register", token_type::REGISTER },
-      { "restrict", token_type::RESTRICT },
-      { "return", token_type::RETURN },
-      { "short", token_type::SHORT },
-      { "signed", token_type::SIGNED },
-      { "sizeof", token_type::SIZEOF },
-      { "static", token_type::STATIC },
-      { "static_assert", token_type::STATIC_ASSERT },
-      { "struct", token_type::STRUCT },
-      { "switch", token_type::SWITCH },
-      { "thread_local", token_type::THREAD_LOCAL },
-      { "true", token_type::TRUE },
-      { "typedef", token_type::TYPEDEF },
-      { "typeof", token_type::TYPEOF },
-      { "typeof_unqual", token_type::TYPEOF_UNQUAL },
-      { "union", token_type::UNION },
-      { "unsigned", token_type::UNSIGNED },
-      { "void", token_type::VOID },
-      { "volatile", token_type::VOLATILE },
-      { "while", token_type::WHILE }
-};
+#define TOKEN(name, string)
+#define PUNCTUATOR(name, spelling, precedence)
+#define KEYWORD(name, spelling) token_spelling<token_type>{ spelling, token_type::name },
+static constexpr inline std::array keyword_spellings = { COMPILER_TOKEN_TYPES(TOKEN, PUNCTUATOR, KEYWORD) };
+#undef TOKEN
+#undef PUNCTUATOR
+#undef KEYWORD
+
+#define TOKEN(name, string)
+#define PUNCTUATOR(name, spelling, precedence) token_spelling<token_type>{ spelling, token_type::name },
+#define KEYWORD(name, spelling)
+static constexpr inline std::array punctuator_spellings = { COMPILER_TOKEN_TYPES(TOKEN, PUNCTUATOR, KEYWORD) };
+#undef TOKEN
+#undef PUNCTUATOR
+#undef KEYWORD
+
+// All C keywords, keywords.find(word) is the keyword "word" is, if any.
+static constexpr inline spelling_table<token_type, keyword_spellings.size()> keywords{ keyword_spellings };
+
+// All punctuators, punctuators.longest(text) is the one "text" starts with.
+static constexpr inline punctuator_trie<token_type, punctuator_trie_size(punctuator_spellings)> punctuators{ punctuator_spellings };
 
 // Define a constant character with the name "identifier" and "value".
 #define CONSTANT_CHAR(identifier, value) static constexpr inline char identifier = value
@@ -87,6 +60,7 @@ CONSTANT_CHAR(lesser_than, '<');
 
 CONSTANT_CHAR(semi_colon, ';');
 CONSTANT_CHAR(space, ' ');
+CONSTANT_CHAR(tab, '\t');
 
 CONSTANT_CHAR(double_quote, '"');
 CONSTANT_CHAR(single_quote, '\'');
@@ -111,14 +85,6 @@ inline bool is_valid_identifier_rest(char c) noexcept {
     return (c == '_' || std::isalpha(c) || std::isdigit(c));
 }
 
-inline bool is_valid_number_start(char c) noexcept {
-    return (c == '+' || c == '-' || std::isdigit(c));
-}
-
-inline bool is_valid_number_content(char c) noexcept {
-    return (c == '.' || std::isdigit(c));
-}
-
 COMPILER_API_END // COMPILER_API_BEGIN
 
 #define COMPILER_LEXING_CONSTANTS_HPP
@@ -1,31 +1,44 @@
 #include "lexer.hpp"
 #include "constants.hpp"
+#include "number.hpp"
 
 auto compiler::lexer::lex_tokens() noexcept -> result<void, error> {
     while (m_internals.position <= m_source_info.contents().size()) {
         auto lex_result = this->lex_single_char(this->peek_current());
         if (lex_result.is_err()) {
-            // TODO: add an actual diagnostics system for outputting errors.
-            const char* msg = lex_result.get_err()->what();
-            eprintln("[LEXER]: failed to lex contents. ({})", msg);
-            return error("{}", msg);
+            // the caller reports it, in whatever format it writes diagnostics in.
+            return lex_result.get_err()->to_error(m_source_info.file_name());
         }
         else {
-            auto&& token = std::move(*lex_result.get());
             // discard empty tokens.
 #if LEXER_DEBUG
-            eprintln("[LEXER]: lexed token ({}) at ({})", token.to_string(), get_source_location().to_string());
+            eprintln("[LEXER]: lexed token ({}) at ({})", lex_result.get()->to_string(), get_source_location().to_string());
 #endif
-            if (token.type() != token_type::EMPTY) {
-                m_tokens.push_back(token);
+            const auto type = lex_result.get()->type();
+            if (type == token_type::STRING_LITERAL && m_string_pending) {
+                // "a" "b" is one literal, lex_string_literal() already added it to the first.
+                continue;
+            }
+            if (type != token_type::EMPTY) {
+                finish_string();
+                m_tokens.push_back(std::move(lex_result).value());
+                m_string_pending = type == token_type::STRING_LITERAL;
             }
         }
     }
+    finish_string();
 
     return {};
 }
 
-auto compiler::lexer::lex_single_char(char c) noexcept -> result<token, error> {
+auto compiler::lexer::finish_string() noexcept -> void {
+    if (m_string_pending) {
+        m_tokens.back().set_string(m_strings.intern(m_string_buffer));
+        m_string_pending = false;
+    }
+}
+
+auto compiler::lexer::lex_single_char(char c) noexcept -> result<token, coded_error> {
     switch (c) {
     case '\n':
         m_internals.line += 1;
@@ -38,128 +51,32 @@ auto compiler::lexer::lex_single_char(char c) noexcept -> result<token, error> {
             m_internals.column = 0;
         }
         return make_token(token_type::EMPTY);
-    case semi_colon:
-        return make_token(token_type::SEMI_COLON);
     case space:
+    case tab:
         return make_token(token_type::EMPTY);
-    case left_paren:
-        return make_token(token_type::LEFT_PAREN);
-    case right_paren:
-        return make_token(token_type::RIGHT_PAREN);
-    case left_brace:
-        return make_token(token_type::LEFT_BRACE);
-    case right_brace:
-        return make_token(token_type::RIGHT_BRACE);
-    case left_bracket:
-        return make_token(token_type::LEFT_BRACKET);
-    case right_bracket:
-        return make_token(token_type::RIGHT_BRACKET);
-    case comma:
-        return make_token(token_type::COMMA);
     case dot:
-        return make_token(token_type::DOT);
-    case minus:
-        if (is_valid_number_content(peek_next())) {
-            break;        
-        }
-        if (peek_next() == greater_than) {
-            this->move_forward();
-            return make_token(token_type::ARROW);
-        }
-        if (peek_next() == minus) {
-            this->move_forward();
-            return make_token(token_type::MINUS_MINUS);
-        }
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::PLUS_EQUAL);
-        }
-        return make_token(token_type::MINUS);
-    case plus:
-        if (is_valid_number_content(peek_next())) {
-            // NOTE: This check does nothing. We need more context.
-            break;
-        }
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::PLUS_EQUAL);
-        }
-        if (peek_next() == plus) {
-            this->move_forward();
-            return make_token(token_type::PLUS_PLUS);
-        }
-        return make_token(token_type::ADD);
-    case slash:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::SLASH_EQUAL);
-        }
-        return make_token(token_type::SLASH);
-    case star:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::STAR_EQUAL);
-        }
-        return make_token(token_type::STAR);
-    case lesser_than:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::LESSER_EQUALS);
+        if (is_decimal_digit(peek_next())) {
+            return this->lex_numeric_literal();
         }
-        return make_token(token_type::LESSER_THAN);
-    case greater_than:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::GREATER_EQUALS);
-        }
-        return make_token(token_type::GREATER_THAN);
-    case equal:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::EQUALS_EQUALS);
-        }
-        return make_token(token_type::EQUALS);
-    case ampersand:
-        if (peek_next() == ampersand) {
-            this->move_forward();
-            return make_token(token_type::AND);
-        }
-        return make_token(token_type::AMPERSAND);
-    case pipe:
-        if (peek_next() == pipe) {
-            this->move_forward();
-            return make_token(token_type::OR);
-        }
-        return make_token(token_type::BITWISE_OR);
-    case tilde:
-        return make_token(token_type::BITWISE_NOT);
-    case percent:
-        return make_token(token_type::MODULO);
-    case caret:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::XOR_EQUALS);
-        }
-        return make_token(token_type::BITWISE_XOR);
-    case bang:
-        if (peek_next() == equal) {
-            this->move_forward();
-            return make_token(token_type::NOT_EQUAL);
-        }
-        return make_token(token_type::BANG);
-    case question_mark:
-        return make_token(token_type::QUESTION_MARK);
-    case colon:
-        return make_token(token_type::COLON);
+        break;
     case eof:
         return make_token(token_type::END_OF_FILE);
     }
 
+    const auto rest = m_source_info.contents().substr(m_internals.position);
+    if (const auto match = punctuators.longest(rest)) {
+        for (std::size_t i = 1; i < match->length; ++i) {
+            this->move_forward();
+        }
+        return make_token(match->type);
+    }
+
     if (is_valid_identifier_start(c)) {
         return this->lex_identifier();
     }
 
-    if (is_valid_number_start(c)) {
+    // a sign is never part of the literal, "-1" is a negation of the int 1 like in C.
+    if (is_decimal_digit(c)) {
         return this->lex_numeric_literal();
     }
 
@@ -171,7 +88,7 @@ auto compiler::lexer::lex_single_char(char c) noexcept -> result<token, error> {
         return this->lex_char_literal();
     }
 
-    return error("unexpected character ({}) at ({})", c, get_source_location().to_string());
+    return fail(error_code::unexpected_character, c);
 }
 
 template<class T, typename ...Others>
@@ -180,63 +97,137 @@ bool is_any_of(T val, Others... others) {
     return ((val == others) || ...);
 }
 
-auto compiler::lexer::lex_numeric_literal() noexcept -> result<token, error> {
-    auto contents = std::string{};
+auto compiler::lexer::lex_numeric_literal() noexcept -> result<token, coded_error> {
+    // the literal is decoded straight from the source: first find where its digits, exponent
+    // and suffix are, then turn the digits into its value (see number.hpp).
+    const std::string_view src = m_source_info.contents();
+    const auto start = m_internals.position;
+    const auto at = [&](std::size_t i) { return i < src.size() ? src[i] : eof; };
+    // an error at "i", the lexer is moved there so the error has its column.
+    const auto fail_at = [&](std::size_t i, error_code code, auto... args) {
+        skip(i - m_internals.position);
+        return fail(code, args...);
+    };
+
+    if (!is_decimal_digit(peek_current()) && peek_current() != dot) {
+        return fail(error_code::invalid_number_start, peek_current());
+    }
 
-    // TODO: Integrals can contain postfixes like "i" or "u" to infer the type. 
-    //       Handle these cases.
+    std::size_t i = start;
 
-    if (!is_valid_number_start(peek_current())) {
-        return error("invalid character for the start of an integral literal ({})", peek_current());
+    unsigned radix = 10;
+    if (at(i) == '0' && (at(i + 1) | 0x20) == 'x') {
+        radix = 16;
+        i += 2;
     }
-    else {
-        contents.push_back(peek_current());
+    else if (at(i) == '0' && (at(i + 1) | 0x20) == 'b') {
+        radix = 2;
+        i += 2;
+    }
+    const auto digits_begin = i;
+    const auto count_digits = [&](std::size_t from) {
+        return radix == 16 ? count_hex_digits(src.substr(from)) : count_decimal_digits(src.substr(from));
+    };
+
+    i += count_digits(i);
+    const auto integer_end = i;
+    bool is_floating = false;
+    if (radix != 2 && at(i) == dot) {
+        is_floating = true;
+        i += 1;
+        i += count_digits(i);
+        if (at(i) == dot) {
+            return fail_at(i, error_code::multiple_decimal_points);
+        }
+    }
+    // "." itself isn't a digit, a literal needs one on either side of it.
+    if (i - digits_begin == static_cast<std::size_t>(is_floating)) {
+        return fail_at(i, error_code::missing_digits);
     }
 
-    DISCARD(advance());
+    const char exponent_char = radix == 16 ? 'p' : 'e';
+    if (radix != 2 && (at(i) | 0x20) == exponent_char) {
+        is_floating = true;
+        i += 1;
+        if (at(i) == plus || at(i) == minus) {
+            i += 1;
+        }
+        const auto exponent_digits = count_decimal_digits(src.substr(i));
+        if (exponent_digits == 0) {
+            return fail_at(i, error_code::missing_exponent_digits);
+        }
+        i += exponent_digits;
+    }
+    else if (radix == 16 && is_floating) {
+        return fail_at(i, error_code::hex_float_exponent);
+    }
+    const auto number_end = i;
 
-    char next;
-    bool encountered_dot = false;
-    while (is_valid_number_content(next = peek_current())) {
-        if (next == '.') {
-            if (encountered_dot) {
-                return error("invalid numeric literal. floating point numbers can only contain one \".\"");
+    // a leading 0 makes an integer octal.
+    if (radix == 10 && !is_floating && integer_end - digits_begin > 1 && src[digits_begin] == '0') {
+        radix = 8;
+    }
+    if (radix == 2 || radix == 8) {
+        for (auto d = digits_begin; d < integer_end; ++d) {
+            if (src[d] >= static_cast<char>('0' + radix)) {
+                return fail_at(d, error_code::invalid_digit, src[d], radix);
             }
-            encountered_dot = true;
         }
-        contents.push_back(next);
-        move_forward();
     }
 
-    next = peek_current();
-
-    if (is_any_of(next, 'f', 'u', 'i', 'l', 'd')) {
-        move_forward();
-        contents.push_back(next);
-        if (is_any_of('f', 'd')) {
-            return make_token_with_explicit_contents(token_type::FLOATING_POINT_LITERAL, std::move(contents));
+    // the suffix is everything up to the end of the identifier-like run.
+    bool is_unsigned = false, is_float = false;
+    std::uint8_t long_count = 0;
+    while (is_valid_identifier_rest(at(i))) {
+        const char c = src[i];
+        if (is_floating) {
+            if ((c | 0x20) == 'f' && !is_float && long_count == 0) {
+                is_float = true;
+            }
+            else if ((c | 0x20) == 'l' && !is_float && long_count == 0) {
+                long_count = 1;
+            }
+            else {
+                return fail_at(i, error_code::float_suffix, c);
+            }
+        }
+        else if ((c | 0x20) == 'u' && !is_unsigned) {
+            is_unsigned = true;
+        }
+        else if ((c | 0x20) == 'l' && long_count == 0) {
+            // "ll" or "LL", never mixed case.
+            long_count = at(i + 1) == c ? 2 : 1;
+            i += long_count - 1;
         }
         else {
-            if (encountered_dot) {
-                return error("invalid suffix, cannot use \"{}\" suffix on a floating point number.", next);
-            }
-            return make_token_with_explicit_contents(token_type::INTEGER_LITERAL, std::move(contents));
+            return fail_at(i, error_code::invalid_suffix, c);
         }
+        ++i;
     }
 
-    if (encountered_dot) {
-        return make_token_with_explicit_contents(token_type::FLOATING_POINT_LITERAL, std::move(contents));
+    const auto digits = src.substr(digits_begin, number_end - digits_begin);
+    numeric_value number;
+    if (is_floating) {
+        auto value = radix == 16 ? decode_hex_floating(digits, is_float) : decode_decimal_floating(digits, is_float);
+        number = numeric_value::from_floating(value, is_float, long_count != 0);
     }
     else {
-        return make_token_with_explicit_contents(token_type::INTEGER_LITERAL, std::move(contents));
+        const auto value = radix == 10 ? decode_decimal(digits) : decode_radix(digits, radix);
+        if (!value) {
+            return fail(error_code::integer_too_large);
+        }
+        number = numeric_value::from_integer(*value, is_unsigned, long_count);
     }
+
+    skip(i - m_internals.position);
+    return make_token_with_number(is_floating ? token_type::FLOATING_POINT_LITERAL : token_type::INTEGER_LITERAL, number);
 }
 
-auto compiler::lexer::lex_identifier() noexcept -> result<token, error> {
+auto compiler::lexer::lex_identifier() noexcept -> result<token, coded_error> {
     std::string contents{};
 
     if (!is_valid_identifier_start(peek_current())) {
-        return error("invalid character for the start of an identifier ({}) (A-z+_ is supported)", peek_current());
+        return fail(error_code::invalid_identifier_start, peek_current());
     }
 
     while (is_valid_identifier_rest(peek_current())) {
@@ -244,36 +235,60 @@ auto compiler::lexer::lex_identifier() noexcept -> result<token, error> {
         move_forward();
     }
 
-    if (keywords.contains(contents)) {
-        // return make_token_with_explicit_contents(keywords.at(contents), std::move(contents));
-        return make_token(keywords.at(contents));
+    if (const auto keyword = keywords.find(contents)) {
+        // NOTE: make_token() would step over the character after the keyword.
+        return make_token_with_explicit_contents(*keyword, std::move(contents));
     }
 
     return make_token_with_explicit_contents(token_type::IDENTIFIER, std::move(contents));
 }
 
-auto compiler::lexer::lex_string_literal() noexcept -> result<token, error>
+auto compiler::lexer::lex_string_literal() noexcept -> result<token, coded_error>
 {
     // expect the current character to be the first double quote.
     if (peek_current() != double_quote) {
-        return error("expected double quote at ({})", get_source_location().to_string());
+        return fail(error_code::expected_double_quote);
     }
 
     // move forward to the next character.
     move_forward();
 
-    std::string contents{}; 
-    while (peek_current() != double_quote) {
-        if (peek_current() == eof) {
-            return error("unexpected end of file while lexing string literal.");
+    // the decoded bytes go into m_string_buffer, after the literal before this one if they
+    // are to be joined. finish_string() interns them once the literal is complete.
+    if (!m_string_pending) {
+        m_string_buffer.clear();
+    }
+    const std::string_view src = m_source_info.contents();
+    while (true) {
+        // everything up to the next quote, backslash or newline is copied as is.
+        const auto stop = src.find_first_of("\"\\\n", m_internals.position);
+        if (stop == std::string_view::npos) {
+            skip(src.size() - m_internals.position);
+            return fail(error_code::unterminated_string);
+        }
+        m_string_buffer.append(src, m_internals.position, stop - m_internals.position);
+        skip(stop - m_internals.position);
+
+        const auto c = peek_current();
+        if (c == double_quote) {
+            break;
+        }
+        if (c == '\n') {
+            return fail(error_code::newline_in_string);
         }
-        contents.push_back(peek_current());
+        move_forward();
+        if (at_end()) {
+            return fail(error_code::unterminated_string);
+        }
+        RESULT_TRY(escaped, lex_escape_character(peek_current()));
+        m_string_buffer.push_back(escaped);
         move_forward();
     }
 
     // move forward to the next character.
     move_forward();
-    return make_token_with_explicit_contents(token_type::STRING_LITERAL, std::move(contents));
+    // no lexeme, the bytes are in the pool.
+    return token(token_type::STRING_LITERAL, m_span, get_source_location());
 }
 
 auto compiler::lexer::move_forward() noexcept -> void {
@@ -282,7 +297,13 @@ auto compiler::lexer::move_forward() noexcept -> void {
     m_span.end++;
 }
 
-auto compiler::lexer::lex_char_literal() noexcept -> result<token, error>
+auto compiler::lexer::skip(std::size_t count) noexcept -> void {
+    m_internals.position += count;
+    m_internals.column += count;
+    m_span.end += count;
+}
+
+auto compiler::lexer::lex_char_literal() noexcept -> result<token, coded_error>
 {
     // lex a single character, if the character begins with the escape character, then
     // we need to lex the next character as well.
@@ -290,7 +311,7 @@ auto compiler::lexer::lex_char_literal() noexcept -> result<token, error>
 
     // expect the current character to be the first single quote.
     if (peek_current() != single_quote) {
-        return error("expected single quote at ({})", get_source_location().to_string());
+        return fail(error_code::expected_single_quote);
     }
 
     // move forward to the next character.
@@ -301,16 +322,12 @@ auto compiler::lexer::lex_char_literal() noexcept -> result<token, error>
         move_forward();
         contents = peek_current();
 
-        if (contents == single_quote) {
-            return error("expected escape character after backslash at ({})", get_source_location().to_string());
+        if (at_end() || contents == single_quote) {
+            return fail(error_code::expected_escape);
         }
 
-        auto escaped_result = lex_escape_character(contents);
-
-        if (escaped_result.is_err())
-            return std::move(*escaped_result.get_err());
-
-        contents = *escaped_result.get();
+        RESULT_TRY(escaped, lex_escape_character(contents));
+        contents = escaped;
     }
 
     // move forward to the next character.
@@ -318,7 +335,7 @@ auto compiler::lexer::lex_char_literal() noexcept -> result<token, error>
 
     // expect the current character to be the second single quote.
     if (peek_current() != single_quote) {
-        return error("expected single quote at ({})", get_source_location().to_string());
+        return fail(error_code::expected_single_quote);
     }
 
     // move forward to the next character.
@@ -327,7 +344,7 @@ auto compiler::lexer::lex_char_literal() noexcept -> result<token, error>
     return make_token_with_explicit_contents(token_type::CHARACTER_LITERAL, std::string{contents});
 }
 
-auto compiler::lexer::lex_escape_character(char c) noexcept -> result<char, error>
+auto compiler::lexer::lex_escape_character(char c) noexcept -> result<char, coded_error>
 {
     switch (c) {
     case 'n':
@@ -336,17 +353,60 @@ auto compiler::lexer::lex_escape_character(char c) noexcept -> result<char, erro
         return '\r';
     case 't':
         return '\t';
-    case '0':
-        return '\0';
+    case 'a':
+        return '\a';
+    case 'b':
+        return '\b';
+    case 'f':
+        return '\f';
+    case 'v':
+        return '\v';
     case '\\':
         return '\\';
     case '\'':
         return '\'';
     case '\"':
         return '\"';
+    case '?':
+        return '?';
+    case 'x': {
+        // any amount of hex digits, the value has to fit in a char.
+        if (!is_hex_digit(peek_next())) {
+            return fail(error_code::expected_escape);
+        }
+        unsigned value = 0;
+        while (is_hex_digit(peek_next())) {
+            move_forward();
+            const auto digit = peek_current();
+            value = value << 4 | (is_decimal_digit(digit) ? digit - '0' : (digit | 0x20) - 'a' + 10);
+            if (value > 0xFF) {
+                return fail(error_code::escape_out_of_range);
+            }
+        }
+        return static_cast<char>(value);
+    }
     default:
-        return error("unrecognized escape character ({}) at ({})", c, get_source_location().to_string());
+        break;
     }
+
+    // up to three octal digits, "\0" is the most common.
+    if (c >= '0' && c <= '7') {
+        unsigned value = static_cast<unsigned>(c - '0');
+        for (int i = 1; i < 3 && peek_next() >= '0' && peek_next() <= '7'; ++i) {
+            move_forward();
+            value = value << 3 | static_cast<unsigned>(peek_current() - '0');
+        }
+        if (value > 0xFF) {
+            return fail(error_code::escape_out_of_range);
+        }
+        return static_cast<char>(value);
+    }
+    return fail(error_code::unknown_escape, c);
+}
+
+auto compiler::lexer::make_token_with_number(token_type kind, numeric_value number) noexcept -> token
+{
+    return token(kind, m_span, get_source_location(), number);
 }
 
 auto compiler::lexer::make_token_with_explicit_contents(token_type kind, std::string&& content) noexcept -> token
@@ -354,8 +414,12 @@ auto compiler::lexer::make_token_with_explicit_contents(token_type kind, std::st
     return token(kind, m_span, get_source_location(), std::move(content));
 }
 
+auto compiler::lexer::at_end() const noexcept -> bool {
+    return m_internals.position >= m_source_info.contents().size();
+}
+
 auto compiler::lexer::peek_current() const noexcept -> char {
-    auto& src = m_source_info.contents();
+    const auto src = m_source_info.contents();
     if (m_internals.position >= src.size()) {
         return eof;
     }
@@ -363,7 +427,7 @@ auto compiler::lexer::peek_current() const noexcept -> char {
 }
 
 auto compiler::lexer::peek_next() const noexcept -> char {
-    auto& src = m_source_info.contents();
+    const auto src = m_source_info.contents();
     if (m_internals.position + 1 >= src.size()) {
         return eof;
     }
@@ -371,7 +435,7 @@ auto compiler::lexer::peek_next() const noexcept -> char {
 }
 
 auto compiler::lexer::advance() noexcept -> char {
-    auto& src = m_source_info.contents();
+    const auto src = m_source_info.contents();
     if (m_internals.position + 1 >= src.size()) {
         return eof;
     }
@@ -405,8 +469,8 @@ auto compiler::lexer::get_source_location() noexcept -> source_location {
 }
 
 auto compiler::lexer::get_current_contents() const noexcept -> std::string {
-    auto& contents = m_source_info.contents();
+    const auto contents = m_source_info.contents();
     auto start_pos = m_span.begin;
     auto count = m_span.end - m_span.begin;
-    return contents.substr(start_pos, count);
+    return std::string{ contents.substr(start_pos, count) };
 }
\ No newline at end of file
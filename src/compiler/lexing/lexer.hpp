@@ -7,6 +7,7 @@
 #include <sstream>
 #include <stdlib.h>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <vector>
 #include <fstream>
@@ -19,6 +20,8 @@
 #include "../../common/result.hpp"
 #include "../../common/error.hpp"
 #include "../../common/io.hpp"
+#include "../../common/file_loader.hpp"
+#include "../diagnostics/coded_error.hpp"
 
 #define LEXER_DEBUG 0
 
@@ -36,18 +39,26 @@ struct source_info {
 private:
     std::string m_file_name;
     std::string m_file_contents;
+    // set if the contents are someone else's memory (see borrow()), "m_file_contents" is empty then.
+    std::optional<std::string_view> m_borrowed{};
 public:
-    // Initialize with a file name.
+    // Initialize with a file name, the contents are empty if it can't be read.
     inline explicit source_info(const std::string& file_name)
+        : m_file_name(file_name)
     {
-        m_file_name = file_name;
-        auto file_stream = std::ifstream{ file_name };
-        std::stringstream ss;
-        ss << file_stream.rdbuf();
-
-        m_file_contents = ss.str();
+        auto contents = file_loader::read(file_name);
+        if (contents.is_okay()) {
+            m_file_contents = std::move(contents).value();
+        }
     }
 
+    // Initialize with contents that are already in memory, "file_name" is only used in
+    // source locations.
+    inline source_info(std::string file_name, std::string contents) noexcept
+        : m_file_name(std::move(file_name))
+        , m_file_contents(std::move(contents))
+    {}
+
     // The name of the file
     NODISCARD
     inline const std::string& file_name() const noexcept {
@@ -56,8 +67,19 @@ public:
 
     // The contents within the file.
     NODISCARD
-    inline const std::string& contents() const noexcept {
-        return m_file_contents;
+    inline std::string_view contents() const noexcept {
+        return m_borrowed ? *m_borrowed : std::string_view{ m_file_contents };
+    }
+
+    // Refer to contents that are already in memory (a mapped file) without copying them,
+    // they have to outlive the source_info and whatever lexer it's given to.
+    NODISCARD
+    inline static
+    auto borrow(std::string file_name, std::string_view contents) noexcept -> source_info
+    {
+        auto info = source_info(std::move(file_name), std::string{});
+        info.m_borrowed = contents;
+        return info;
     }
 
     // Static helper function for use with auto.
@@ -65,12 +87,11 @@ public:
     inline static  
     auto from_name(const std::string& file) -> result<source_info, error> 
     {
-        try {
-            return source_info(file);
-        }
-        catch (const std::exception& ex) {
-            return error("ERROR: failed to read source file. ({})", ex.what());
+        auto contents = file_loader::read(file);
+        if (contents.is_err()) {
+            return std::move(contents).err();
         }
+        return source_info(file, std::move(contents).value());
     }
 };
 
@@ -85,33 +106,67 @@ private:
     // m_span.end should always be equal to m_internals.position.
     source_span m_span{ 0, 0 };
     source_info m_source_info;
+    // the decoded bytes of every string literal, see release_strings().
+    string_pool m_strings{};
+    // the string literal that's being lexed, and whether the last token is a string literal
+    // that hasn't been interned yet (the next literal is joined to it).
+    std::string m_string_buffer{};
+    bool m_string_pending{ false };
 public:
     lexer() = delete;
     inline explicit lexer(source_info info) noexcept
-        : m_source_info{ info }
+        : m_source_info{ std::move(info) }
+    {}
+    // Intern the string literals into "strings", which already has those of other files.
+    // For several files that end up in one module, their ids can't overlap.
+    inline lexer(source_info info, string_pool strings) noexcept
+        : m_source_info{ std::move(info) }
+        , m_strings{ std::move(strings) }
     {}
 
+    // Start over on "info". The buffers (tokens, string literals) keep their memory, so one
+    // lexer per thread can go through any number of files without reallocating them.
+    inline auto reset(source_info info) noexcept -> void {
+        m_tokens.clear();
+        m_internals = _Lexer_internals{ 1, 0, 0, "<unknown>" };
+        m_span = source_span{ 0, 0 };
+        m_source_info = std::move(info);
+        m_strings.clear();
+        m_string_buffer.clear();
+        m_string_pending = false;
+    }
+
     // Lexes the source contents, populates an inner vector of tokens.
     // NOTE: see lexer::release_tokens() to get the tokens.
     NODISCARD auto lex_tokens() noexcept -> result<void, error>;
      
     // Handles a single token based on the parameter.
-    NODISCARD auto lex_single_char(char c) noexcept -> result<token, error>;
-    // Handles any numeric literal including signed, unsigned and floating point numbers
-    //  relative to the current position.
-    NODISCARD auto lex_numeric_literal() noexcept -> result<token, error>;
+    NODISCARD auto lex_single_char(char c) noexcept -> result<token, coded_error>;
+    // Handles any numeric literal relative to the current position: decimal, octal, hex and
+    //  binary integers, decimal and hex floating point numbers, and their suffixes. The token
+    //  gets the decoded value, see token::number().
+    NODISCARD auto lex_numeric_literal() noexcept -> result<token, coded_error>;
     // Handles any identifiers, this includes keywords. This is relative to the current position.
-    NODISCARD auto lex_identifier() noexcept -> result<token, error>;
-    // Handles any string literal relative to the current position.
-    NODISCARD auto lex_string_literal() noexcept -> result<token, error>;
+    NODISCARD auto lex_identifier() noexcept -> result<token, coded_error>;
+    // Handles any string literal relative to the current position, its escapes are decoded
+    //  into m_string_buffer.
+    NODISCARD auto lex_string_literal() noexcept -> result<token, coded_error>;
     // lexes any character literal relative to the current position.
-    NODISCARD auto lex_char_literal() noexcept -> result<token, error>;
+    NODISCARD auto lex_char_literal() noexcept -> result<token, coded_error>;
 
-    // Handles escape characters such as '\n', '\0' etc...
-    NODISCARD auto lex_escape_character(char c) noexcept -> result<char, error>;
+    // Handles escape characters such as '\n', '\0', '\x1b' etc... "c" is the character after the
+    //  backslash, the lexer ends up on the escape's last character.
+    NODISCARD auto lex_escape_character(char c) noexcept -> result<char, coded_error>;
+
+    // Intern the pending string literal and give its id to the last token.
+    auto finish_string() noexcept -> void;
 
     // Move the lexer forward by one character.
     auto move_forward() noexcept -> void;
+    // Move the lexer forward by "count" characters, none of them a newline.
+    auto skip(std::size_t count) noexcept -> void;
+    // Is the lexer past the last character of the source? (eof is also a character a file can have)
+    NODISCARD auto at_end() const noexcept -> bool;
     // Peek the current character. If there is nothing where we are, eof is returned.
     NODISCARD auto peek_current() const noexcept -> char;
     // Peek the next character. If there is nothing where we are, eof is returned.
@@ -124,9 +179,16 @@ public:
     NODISCARD auto make_token(token_type kind, bool use_source = false) noexcept -> token;
     // Make a token based on the current state of the lexer, but with explicit contents. 
     NODISCARD auto make_token_with_explicit_contents(token_type kind, std::string&& content) noexcept -> token;
+    // Make a numeric literal token with its decoded value.
+    NODISCARD auto make_token_with_number(token_type kind, numeric_value number) noexcept -> token;
 
     // Get the current source location.
     NODISCARD auto get_source_location() noexcept -> source_location;
+    // An error of "code" at the current position, see coded_error.
+    template<class... Args>
+    NODISCARD inline auto fail(error_code code, Args... args) const noexcept -> coded_error {
+        return coded_error(code, m_internals.line, m_internals.column, args...);
+    }
     // Get the current source contents, based from the current span.
     NODISCARD auto get_current_contents() const noexcept -> std::string;
 
@@ -136,6 +198,14 @@ public:
     inline auto release_tokens() noexcept -> std::vector<token> {
         return std::move(m_tokens);
     }
+    // The tokens and string literals lexed so far, without moving them out.
+    inline auto tokens() const noexcept -> const std::vector<token>& { return m_tokens; }
+    inline auto strings() const noexcept -> const string_pool& { return m_strings; }
+    // Get the string literals the tokens' string() ids refer to, moved to the caller.
+    [[nodiscard("this is a move function, the caller will own the strings after this call.")]]
+    inline auto release_strings() noexcept -> string_pool {
+        return std::move(m_strings);
+    }
 };
 
 COMPILER_API_END
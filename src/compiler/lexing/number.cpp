@@ -0,0 +1,219 @@
+#include "number.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <system_error>
+
+namespace {
+
+// SWAR over eight characters loaded little endian, the first character in the low byte.
+inline std::uint64_t load_eight(const char* p) noexcept {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = __builtin_bswap64(value);
+    }
+    return value;
+}
+
+// Are all eight characters '0'-'9'? Adding 6 carries a digit's low nibble into the high one
+// for anything past '9'.
+inline bool is_eight_digits(std::uint64_t chars) noexcept {
+    return ((chars & 0xF0F0F0F0F0F0F0F0) | (((chars + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+        == 0x3333333333333333;
+}
+
+// The value of eight digits, combined pairwise: 2 digits per byte, then 4 per 16 bits and
+// 8 in the end.
+inline std::uint64_t eight_digits_value(std::uint64_t chars) noexcept {
+    constexpr std::uint64_t mask = 0x000000FF000000FF;
+    constexpr std::uint64_t mul1 = 100 + (1000000ull << 32);
+    constexpr std::uint64_t mul2 = 1 + (10000ull << 32);
+    chars -= 0x3030303030303030;
+    chars = chars * 10 + (chars >> 8);
+    return (((chars & mask) * mul1) + (((chars >> 16) & mask) * mul2)) >> 32;
+}
+
+inline unsigned digit_value(char c) noexcept {
+    return compiler::is_decimal_digit(c) ? static_cast<unsigned>(c - '0') : static_cast<unsigned>((c | 0x20) - 'a' + 10);
+}
+
+// Powers of ten a double (or float) holds exactly, for the fast path.
+constexpr double exact_powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+constexpr float exact_float_powers[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+// A floating point literal split into its first 19 significant digits and a power of ten.
+struct decimal_parts {
+    std::uint64_t mantissa{ 0 };
+    std::int64_t exponent{ 0 };
+    std::size_t significant_digits{ 0 };
+    // significant digits were dropped past the 19th.
+    bool truncated{ false };
+};
+
+decimal_parts split_decimal(std::string_view text) noexcept {
+    auto parts = decimal_parts{};
+    std::size_t i = 0;
+    const auto take = [&](char c, bool fraction) {
+        if (parts.mantissa == 0 && c == '0') {
+            parts.exponent -= fraction;
+            return;
+        }
+        if (parts.significant_digits < 19) {
+            parts.mantissa = parts.mantissa * 10 + static_cast<unsigned>(c - '0');
+            parts.exponent -= fraction;
+        }
+        else {
+            parts.exponent += !fraction;
+            parts.truncated |= c != '0';
+        }
+        ++parts.significant_digits;
+    };
+    for (; i < text.size() && compiler::is_decimal_digit(text[i]); ++i) {
+        take(text[i], false);
+    }
+    if (i < text.size() && text[i] == '.') {
+        for (++i; i < text.size() && compiler::is_decimal_digit(text[i]); ++i) {
+            take(text[i], true);
+        }
+    }
+    if (i < text.size() && (text[i] | 0x20) == 'e') {
+        ++i;
+        const bool negative = i < text.size() && text[i] == '-';
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+            ++i;
+        }
+        std::int64_t exponent = 0;
+        for (; i < text.size() && compiler::is_decimal_digit(text[i]); ++i) {
+            // anything this big is out of range anyway, don't let it wrap.
+            if (exponent < 100000) {
+                exponent = exponent * 10 + (text[i] - '0');
+            }
+        }
+        parts.exponent += negative ? -exponent : exponent;
+    }
+    return parts;
+}
+
+// The nearest value through from_chars, or infinity / zero when out of range.
+template<class T>
+T from_chars_or_limit(std::string_view text, std::chars_format format, bool too_large) noexcept {
+    T value{};
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value, format);
+    if (ec == std::errc::result_out_of_range) {
+        return too_large ? std::numeric_limits<T>::infinity() : T{ 0 };
+    }
+    return value;
+}
+
+} // namespace
+
+std::size_t compiler::count_decimal_digits(std::string_view text) noexcept {
+    std::size_t i = 0;
+    while (i + 8 <= text.size() && is_eight_digits(load_eight(text.data() + i))) {
+        i += 8;
+    }
+    while (i < text.size() && is_decimal_digit(text[i])) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t compiler::count_hex_digits(std::string_view text) noexcept {
+    std::size_t i = 0;
+    while (i < text.size() && is_hex_digit(text[i])) {
+        ++i;
+    }
+    return i;
+}
+
+std::optional<std::uint64_t> compiler::decode_decimal(std::string_view digits) noexcept {
+    const auto first = digits.find_first_not_of('0');
+    if (first == std::string_view::npos) {
+        return 0;
+    }
+    digits.remove_prefix(first);
+    // 19 digits always fit, 20 might.
+    if (digits.size() > 20) {
+        return std::nullopt;
+    }
+
+    const auto safe = digits.size() < 19 ? digits.size() : 19;
+    std::uint64_t value = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= safe; i += 8) {
+        value = value * 100000000 + eight_digits_value(load_eight(digits.data() + i));
+    }
+    for (; i < safe; ++i) {
+        value = value * 10 + static_cast<unsigned>(digits[i] - '0');
+    }
+    if (i < digits.size()) {
+        const auto digit = static_cast<unsigned>(digits[i] - '0');
+        if (value > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) {
+            return std::nullopt;
+        }
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+std::optional<std::uint64_t> compiler::decode_radix(std::string_view digits, unsigned radix) noexcept {
+    const unsigned bits = radix == 16 ? 4 : radix == 8 ? 3 : 1;
+    std::uint64_t value = 0;
+    for (const auto c : digits) {
+        if (value >> (64 - bits) != 0) {
+            return std::nullopt;
+        }
+        value = value << bits | digit_value(c);
+    }
+    return value;
+}
+
+double compiler::decode_decimal_floating(std::string_view text, bool as_float) noexcept {
+    const auto parts = split_decimal(text);
+    if (parts.mantissa == 0) {
+        return 0.0;
+    }
+
+    // Clinger's fast path: the mantissa and the power of ten are both exact, so one rounded
+    // multiplication or division gives the nearest value.
+    if (!parts.truncated) {
+        if (as_float) {
+            if (parts.mantissa <= (1ull << 24) && parts.exponent >= -10 && parts.exponent <= 10) {
+                const auto mantissa = static_cast<float>(parts.mantissa);
+                return parts.exponent < 0
+                    ? mantissa / exact_float_powers[-parts.exponent]
+                    : mantissa * exact_float_powers[parts.exponent];
+            }
+        }
+        else if (parts.mantissa <= (1ull << 53) && parts.exponent >= -22 && parts.exponent <= 22) {
+            const auto mantissa = static_cast<double>(parts.mantissa);
+            return parts.exponent < 0
+                ? mantissa / exact_powers[-parts.exponent]
+                : mantissa * exact_powers[parts.exponent];
+        }
+    }
+
+    // the decimal exponent of the leading digit decides which way out of range it went.
+    const bool too_large = parts.exponent + static_cast<std::int64_t>(parts.significant_digits) > 0;
+    if (as_float) {
+        return from_chars_or_limit<float>(text, std::chars_format::general, too_large);
+    }
+    return from_chars_or_limit<double>(text, std::chars_format::general, too_large);
+}
+
+double compiler::decode_hex_floating(std::string_view text, bool as_float) noexcept {
+    const auto p = text.find_first_of("pP");
+    const bool too_large = p == std::string_view::npos || p + 1 >= text.size() || text[p + 1] != '-';
+    if (as_float) {
+        return from_chars_or_limit<float>(text, std::chars_format::hex, too_large);
+    }
+    return from_chars_or_limit<double>(text, std::chars_format::hex, too_large);
+}
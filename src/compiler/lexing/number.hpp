@@ -0,0 +1,47 @@
+#ifndef _COMPILER_LEXING_NUMBER_HPP
+
+#include "../../common/common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+COMPILER_API_BEGIN
+
+// Decoding numeric literals into values. The lexer works out where a literal's digits,
+// exponent and suffix are, these turn the digits into a value straight from the source,
+// without copying them anywhere.
+
+inline bool is_decimal_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_hex_digit(char c) noexcept {
+    return is_decimal_digit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+// The length of the run of decimal digits "text" starts with. Checks eight at a time.
+COMPILER_API std::size_t count_decimal_digits(std::string_view text) noexcept;
+// The length of the run of hexadecimal digits "text" starts with.
+COMPILER_API std::size_t count_hex_digits(std::string_view text) noexcept;
+
+// The value of "digits" (only '0'-'9'), converted eight digits at a time. nullopt if it
+// doesn't fit in 64 bits.
+COMPILER_API std::optional<std::uint64_t> decode_decimal(std::string_view digits) noexcept;
+// The value of "digits" in base 2, 8 or 16, without the prefix. nullopt if it doesn't fit
+// in 64 bits.
+COMPILER_API std::optional<std::uint64_t> decode_radix(std::string_view digits, unsigned radix) noexcept;
+
+// The double nearest to the decimal floating point literal "text" (digits, an optional '.'
+// and an optional exponent, no sign or suffix), or the float nearest to it for "as_float".
+// Exact in every case: short literals take Clinger's fast path, the rest go to
+// std::from_chars. Literals out of range become infinity or zero.
+COMPILER_API double decode_decimal_floating(std::string_view text, bool as_float) noexcept;
+// Same for a hexadecimal floating point literal, "text" starts after the "0x".
+COMPILER_API double decode_hex_floating(std::string_view text, bool as_float) noexcept;
+
+COMPILER_API_END
+
+#define _COMPILER_LEXING_NUMBER_HPP
+#endif // !_COMPILER_LEXING_NUMBER_HPP
@@ -0,0 +1,59 @@
+#ifndef _COMPILER_LEXING_STRING_POOL_HPP
+
+#include "../../common/common.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+COMPILER_API_BEGIN
+
+using string_id = std::uint32_t;
+
+/*
+  The decoded bytes of every string literal in a translation unit, each distinct one stored
+  once. The lexer decodes a literal's escapes (and joins adjacent literals) straight into
+  the pool, tokens and the AST only carry its id, and the backend emits each id once. A
+  format string repeated a thousand times is one entry.
+
+  The bytes don't include the terminating NUL and can contain NULs of their own.
+*/
+class string_pool {
+private:
+    // a deque never moves its elements, so the keys of m_lookup stay valid.
+    std::deque<std::string> m_strings{};
+    std::unordered_map<std::string_view, string_id> m_lookup{};
+public:
+    string_pool() = default;
+    string_pool(string_pool&&) = default;
+    string_pool& operator=(string_pool&&) = default;
+    string_pool(const string_pool&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+
+    // The id of "bytes", it's only copied in the first time it's seen.
+    inline string_id intern(std::string_view bytes) noexcept {
+        if (auto it = m_lookup.find(bytes); it != m_lookup.end()) {
+            return it->second;
+        }
+        const auto id = static_cast<string_id>(m_strings.size());
+        const auto& stored = m_strings.emplace_back(bytes);
+        m_lookup.emplace(stored, id);
+        return id;
+    }
+
+    inline const std::string& get(string_id id) const noexcept { return m_strings[id]; }
+    inline std::size_t size() const noexcept { return m_strings.size(); }
+
+    // Forget every string, ids start over from 0.
+    inline void clear() noexcept {
+        m_lookup.clear();
+        m_strings.clear();
+    }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_LEXING_STRING_POOL_HPP
+#endif // !_COMPILER_LEXING_STRING_POOL_HPP
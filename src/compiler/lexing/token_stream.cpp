@@ -0,0 +1,292 @@
+#include "token_stream.hpp"
+
+#include "../../common/mapped_file.hpp"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <unordered_map>
+
+using namespace compiler;
+
+namespace {
+
+constexpr char stream_magic[8] = { 'C', 'T', 'O', 'K', 'E', 'N', 'S', '\0' };
+
+// number flags.
+constexpr std::uint64_t number_floating = 1 << 0;
+constexpr std::uint64_t number_unsigned = 1 << 1;
+constexpr std::uint64_t number_float = 1 << 2;
+// the long count is stored above the flags.
+constexpr std::uint64_t number_long_shift = 3;
+
+inline std::uint64_t zigzag(std::int64_t v) noexcept {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t v) noexcept {
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+inline bool is_number(token_type type) noexcept {
+    return type == token_type::INTEGER_LITERAL || type == token_type::FLOATING_POINT_LITERAL;
+}
+
+class stream_writer {
+private:
+    std::vector<std::uint8_t> m_out{};
+public:
+    inline void varint(std::uint64_t v) noexcept {
+        while (v >= 0x80) {
+            m_out.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        m_out.push_back(static_cast<std::uint8_t>(v));
+    }
+    inline void bytes(std::string_view data) noexcept {
+        varint(data.size());
+        m_out.insert(m_out.end(), data.begin(), data.end());
+    }
+    inline void raw(const void* data, std::size_t size) noexcept {
+        const auto* begin = static_cast<const std::uint8_t*>(data);
+        m_out.insert(m_out.end(), begin, begin + size);
+    }
+    inline std::vector<std::uint8_t> finish() noexcept { return std::move(m_out); }
+};
+
+// Reads the stream, a read past the end (or a varint that doesn't fit) sets m_failed and
+// everything after reads as 0.
+class stream_reader {
+private:
+    std::span<const std::uint8_t> m_data;
+    std::size_t m_pos{ 0 };
+    bool m_failed{ false };
+public:
+    explicit stream_reader(std::span<const std::uint8_t> data) noexcept
+        : m_data(data)
+    {}
+
+    inline bool failed() const noexcept { return m_failed; }
+    inline std::size_t remaining() const noexcept { return m_data.size() - m_pos; }
+
+    inline std::uint64_t varint() noexcept {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64 && !m_failed; shift += 7) {
+            if (m_pos >= m_data.size()) {
+                break;
+            }
+            const auto byte = m_data[m_pos++];
+            v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return v;
+            }
+        }
+        m_failed = true;
+        return 0;
+    }
+    inline std::string_view bytes() noexcept {
+        const auto size = varint();
+        if (m_failed || size > remaining()) {
+            m_failed = true;
+            return {};
+        }
+        const auto out = std::string_view{ reinterpret_cast<const char*>(m_data.data() + m_pos), static_cast<std::size_t>(size) };
+        m_pos += size;
+        return out;
+    }
+    // A count of things that take at least a byte each, so a corrupt one can't make a
+    // reserve() allocate more than the stream could hold.
+    inline std::size_t count() noexcept {
+        const auto v = varint();
+        if (v > remaining()) {
+            m_failed = true;
+            return 0;
+        }
+        return static_cast<std::size_t>(v);
+    }
+    inline bool magic() noexcept {
+        if (remaining() < sizeof(stream_magic) || std::memcmp(m_data.data(), stream_magic, sizeof(stream_magic)) != 0) {
+            m_failed = true;
+            return false;
+        }
+        m_pos += sizeof(stream_magic);
+        return true;
+    }
+};
+
+} // namespace
+
+std::vector<std::uint8_t> compiler::encode_tokens(const std::vector<token>& tokens, const string_pool& strings, std::string_view file) noexcept {
+    // the distinct lexemes, in the order they first appear.
+    std::vector<std::string_view> lexemes;
+    std::unordered_map<std::string_view, std::uint32_t> lexeme_ids;
+    std::vector<std::uint32_t> token_lexemes;
+    token_lexemes.reserve(tokens.size());
+    for (const auto& tok : tokens) {
+        if (!tok.lexeme()) {
+            continue;
+        }
+        const auto [it, inserted] = lexeme_ids.try_emplace(*tok.lexeme(), static_cast<std::uint32_t>(lexemes.size()));
+        if (inserted) {
+            lexemes.push_back(*tok.lexeme());
+        }
+        token_lexemes.push_back(it->second);
+    }
+
+    stream_writer out;
+    out.raw(stream_magic, sizeof(stream_magic));
+    out.varint(token_stream_version);
+    out.varint(token_type_count);
+    out.bytes(file);
+
+    out.varint(strings.size());
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        out.bytes(strings.get(static_cast<string_id>(i)));
+    }
+    out.varint(lexemes.size());
+    for (const auto lexeme : lexemes) {
+        out.bytes(lexeme);
+    }
+
+    out.varint(tokens.size());
+    std::size_t previous_begin = 0;
+    std::size_t previous_line = 0;
+    std::size_t previous_column = 0;
+    std::size_t next_lexeme = 0;
+    for (const auto& tok : tokens) {
+        const bool has_lexeme = tok.lexeme().has_value();
+        out.varint(static_cast<std::uint64_t>(tok.type()) << 1 | has_lexeme);
+        out.varint(zigzag(static_cast<std::int64_t>(tok.span().begin - previous_begin)));
+        out.varint(zigzag(static_cast<std::int64_t>(tok.span().end - tok.span().begin)));
+        // the column as a delta too while on the same line, one long line would be all
+        // four byte columns otherwise.
+        const auto line = tok.location().line();
+        const auto column = tok.location().column();
+        out.varint(zigzag(static_cast<std::int64_t>(line - previous_line)));
+        out.varint(line == previous_line ? zigzag(static_cast<std::int64_t>(column - previous_column)) : column);
+        previous_begin = tok.span().begin;
+        previous_line = line;
+        previous_column = column;
+
+        if (has_lexeme) {
+            out.varint(token_lexemes[next_lexeme++]);
+        }
+        else if (is_number(tok.type())) {
+            const auto& number = tok.number();
+            out.varint(number.bits());
+            out.varint((number.is_floating() ? number_floating : 0)
+                | (number.is_unsigned() ? number_unsigned : 0)
+                | (number.is_float() ? number_float : 0)
+                | static_cast<std::uint64_t>(number.long_count()) << number_long_shift);
+        }
+        else if (tok.type() == token_type::STRING_LITERAL) {
+            out.varint(tok.string());
+        }
+    }
+    return out.finish();
+}
+
+result<void, error> compiler::write_tokens(const std::vector<token>& tokens, const string_pool& strings, std::string_view file, const std::string& path) noexcept {
+    const auto bytes = encode_tokens(tokens, strings, file);
+    auto stream = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+    if (!stream) {
+        return error("failed to open `{}` for writing.", path);
+    }
+    stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!stream) {
+        return error("failed to write `{}`.", path);
+    }
+    return {};
+}
+
+result<token_stream, error> compiler::decode_tokens(std::span<const std::uint8_t> bytes, string_pool& strings) noexcept {
+    stream_reader in{ bytes };
+    if (!in.magic()) {
+        return error("not a token dump.");
+    }
+    const auto version = in.varint();
+    if (version != token_stream_version) {
+        return error("the token dump was written by a different version of the compiler. (format {}, expected {})",
+            version, token_stream_version);
+    }
+    const auto kinds = in.varint();
+    if (kinds != token_type_count) {
+        return error("the token dump was written by a compiler with {} token types, this one has {}.",
+            kinds, token_type_count);
+    }
+
+    token_stream out{};
+    out.file = std::string{ in.bytes() };
+
+    // the ids the dump's string literals have in "strings".
+    std::vector<string_id> string_ids(in.count());
+    for (auto& id : string_ids) {
+        id = strings.intern(in.bytes());
+    }
+    std::vector<std::string_view> lexemes(in.count());
+    for (auto& lexeme : lexemes) {
+        lexeme = in.bytes();
+    }
+
+    const auto count = in.count();
+    out.tokens.reserve(count);
+    std::size_t begin = 0;
+    std::size_t line = 0;
+    std::size_t column = 0;
+    for (std::size_t i = 0; i < count && !in.failed(); ++i) {
+        const auto head = in.varint();
+        const auto type_index = head >> 1;
+        if (type_index >= token_type_count) {
+            return error("corrupt token dump, token {} has an unknown type ({}).", i, type_index);
+        }
+        const auto type = static_cast<token_type>(type_index);
+        begin += static_cast<std::size_t>(unzigzag(in.varint()));
+        const auto end = begin + static_cast<std::size_t>(unzigzag(in.varint()));
+        const auto line_delta = unzigzag(in.varint());
+        line += static_cast<std::size_t>(line_delta);
+        column = line_delta == 0 ? column + static_cast<std::size_t>(unzigzag(in.varint())) : static_cast<std::size_t>(in.varint());
+        const auto span = source_span{ begin, end };
+        auto location = source_location::from(out.file, line, column);
+
+        if (head & 1) {
+            const auto index = in.varint();
+            if (index >= lexemes.size()) {
+                return error("corrupt token dump, token {} has lexeme {} of {}.", i, index, lexemes.size());
+            }
+            out.tokens.emplace_back(type, span, std::move(location), std::string{ lexemes[index] });
+        }
+        else if (is_number(type)) {
+            const auto bits = in.varint();
+            const auto flags = in.varint();
+            const auto long_count = static_cast<std::uint8_t>(flags >> number_long_shift);
+            const auto number = (flags & number_floating)
+                ? numeric_value::from_floating(std::bit_cast<double>(bits), flags & number_float, long_count != 0)
+                : numeric_value::from_integer(bits, flags & number_unsigned, long_count);
+            out.tokens.emplace_back(type, span, std::move(location), number);
+        }
+        else {
+            auto& tok = out.tokens.emplace_back(type, span, std::move(location));
+            if (type == token_type::STRING_LITERAL) {
+                const auto id = in.varint();
+                if (id >= string_ids.size()) {
+                    return error("corrupt token dump, token {} has string {} of {}.", i, id, string_ids.size());
+                }
+                tok.set_string(string_ids[id]);
+            }
+        }
+    }
+    if (in.failed()) {
+        return error("corrupt token dump, it ends in the middle of something.");
+    }
+    return out;
+}
+
+result<token_stream, error> compiler::read_tokens(const std::string& path, string_pool& strings) noexcept {
+    RESULT_TRY(file, mapped_file::open(path));
+    auto decoded = decode_tokens(file.bytes(), strings);
+    if (decoded.is_err()) {
+        return error("`{}`: {}", path, decoded.get_err()->what());
+    }
+    return std::move(decoded).value();
+}
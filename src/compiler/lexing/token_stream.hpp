@@ -0,0 +1,59 @@
+#ifndef _COMPILER_LEXING_TOKEN_STREAM_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/result.hpp"
+#include "../../common/error.hpp"
+
+#include "../types.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+COMPILER_API_BEGIN
+
+/*
+  The lexer's output as a file, so the parser can be run (and profiled) without lexing, and
+  a slow parse can be kept as a reproducible case. Every number is an unsigned LEB128
+  varint, signed ones are zigzag encoded first:
+
+    header      magic, format version, the number of token types (a dump from a compiler
+                with a different token list is refused) and the name of the source file
+    strings     the decoded bytes of every string literal, in string_id order
+    lexemes     every distinct lexeme (identifiers, keywords, characters) once
+    tokens      per token: its type shifted left by one with "has a lexeme" in bit 0, the
+                span's begin as a delta from the previous token's and its length, the line
+                as a delta from the previous token's and the column (a delta as well on the
+                same line). Then the lexeme's index, a number's bits and flags, or a string
+                literal's id.
+
+  A token takes about 6 bytes, against well over 100 for a token in memory.
+*/
+// the header only checks how many token types there are, a change to the token list that
+// keeps the count (moving a token) needs a new version.
+inline constexpr std::uint32_t token_stream_version = 2;
+
+// Tokens read back from a dump.
+struct token_stream {
+    // the source file the tokens were lexed from, their locations refer to it.
+    std::string file{};
+    std::vector<token> tokens{};
+};
+
+// Encode "tokens", lexed from "file" with their string literals in "strings".
+NODISCARD std::vector<std::uint8_t> encode_tokens(const std::vector<token>& tokens, const string_pool& strings, std::string_view file) noexcept;
+// encode_tokens() and write the result to "path".
+NODISCARD result<void, error> write_tokens(const std::vector<token>& tokens, const string_pool& strings, std::string_view file, const std::string& path) noexcept;
+
+// Decode a dump, its string literals are interned into "strings" and the tokens refer to
+// their ids in there.
+NODISCARD result<token_stream, error> decode_tokens(std::span<const std::uint8_t> bytes, string_pool& strings) noexcept;
+// decode_tokens() of the file at "path".
+NODISCARD result<token_stream, error> read_tokens(const std::string& path, string_pool& strings) noexcept;
+
+COMPILER_API_END
+
+#define _COMPILER_LEXING_TOKEN_STREAM_HPP
+#endif // !_COMPILER_LEXING_TOKEN_STREAM_HPP
@@ -0,0 +1,58 @@
+#include "passes.hpp"
+
+using namespace compiler;
+using namespace compiler::ir;
+
+std::uint8_t opt::dce(module&, function& fn, analysis_manager& analyses, pass_context&) noexcept {
+    const auto& graph = analyses.graph();
+    bool cfg_changed = false;
+
+    // unreachable blocks first, so nothing in them keeps a value alive.
+    for (block_id block = 0; block < fn.block_count(); ++block) {
+        if (graph.is_reachable(block) || fn.block(block).removed) {
+            continue;
+        }
+        fn.for_each_successor(block, [&](block_id succ) {
+            fn.for_each_inst(succ, [&](value_id id) {
+                if (fn.inst(id).op == opcode::phi) {
+                    fn.remove_phi_incoming(id, block);
+                }
+            });
+        });
+        fn.remove_block(block);
+        cfg_changed = true;
+    }
+
+    // everything is dead until something with a side effect needs it.
+    std::vector<std::uint8_t> live(fn.value_count(), 0);
+    std::vector<value_id> worklist;
+    for (const auto block : graph.rpo()) {
+        fn.for_each_inst(block, [&](value_id id) {
+            if (has_side_effects(fn.inst(id).op)) {
+                live[id] = 1;
+                worklist.push_back(id);
+            }
+        });
+    }
+    while (!worklist.empty()) {
+        const auto id = worklist.back();
+        worklist.pop_back();
+        const auto& inst = fn.inst(id);
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            const auto operand = fn.operand(id, i);
+            if (!live[operand]) {
+                live[operand] = 1;
+                worklist.push_back(operand);
+            }
+        }
+    }
+
+    for (const auto block : graph.rpo()) {
+        fn.for_each_inst(block, [&](value_id id) {
+            if (!live[id]) {
+                fn.remove(id);
+            }
+        });
+    }
+    return cfg_changed ? preserve_none : preserve_all;
+}
@@ -0,0 +1,151 @@
+#include "fold.hpp"
+
+using namespace compiler;
+using namespace compiler::ir;
+
+namespace {
+
+std::uint64_t mask_of(value_type type) noexcept {
+    switch (type) {
+    case value_type::i1: return 1;
+    case value_type::i8: return 0xFF;
+    case value_type::i16: return 0xFFFF;
+    case value_type::i32: return 0xFFFFFFFF;
+    default: return ~std::uint64_t{ 0 };
+    }
+}
+
+// The value as the backend sees it in a signed operation, small integers are sign extended
+// except i1, which is always zero extended.
+std::int64_t as_signed(value_type type, std::int64_t value) noexcept {
+    return opt::normalize(type, value);
+}
+
+std::uint64_t as_unsigned(value_type type, std::int64_t value) noexcept {
+    return static_cast<std::uint64_t>(value) & mask_of(type);
+}
+
+// Arithmetic on anything up to 32 bits is done on 32-bit registers, so shift amounts are
+// masked like a 32-bit shift.
+std::uint32_t shift_amount(value_type type, std::int64_t amount) noexcept {
+    const auto bits = (type == value_type::i64 || type == value_type::ptr) ? 63u : 31u;
+    return static_cast<std::uint32_t>(amount) & bits;
+}
+
+bool compare(cmp_pred pred, value_type type, std::int64_t a, std::int64_t b) noexcept {
+    const auto sa = as_signed(type, a);
+    const auto sb = as_signed(type, b);
+    const auto ua = as_unsigned(type, a);
+    const auto ub = as_unsigned(type, b);
+    switch (pred) {
+    case cmp_pred::eq: return ua == ub;
+    case cmp_pred::ne: return ua != ub;
+    case cmp_pred::slt: return sa < sb;
+    case cmp_pred::sle: return sa <= sb;
+    case cmp_pred::sgt: return sa > sb;
+    case cmp_pred::sge: return sa >= sb;
+    case cmp_pred::ult: return ua < ub;
+    case cmp_pred::ule: return ua <= ub;
+    case cmp_pred::ugt: return ua > ub;
+    case cmp_pred::uge: return ua >= ub;
+    }
+    return false;
+}
+
+} // namespace
+
+std::int64_t opt::normalize(value_type type, std::int64_t value) noexcept {
+    switch (type) {
+    case value_type::i1: return value & 1;
+    case value_type::i8: return static_cast<std::int8_t>(value);
+    case value_type::i16: return static_cast<std::int16_t>(value);
+    case value_type::i32: return static_cast<std::int32_t>(value);
+    default: return value;
+    }
+}
+
+std::optional<std::int64_t> opt::fold(
+    opcode op,
+    value_type type,
+    std::int64_t imm,
+    value_type operand_type,
+    std::span<const std::int64_t> operands
+) noexcept {
+    const auto a = operands.empty() ? 0 : operands[0];
+    const auto b = operands.size() < 2 ? 0 : operands[1];
+    // wrapping arithmetic without signed overflow.
+    const auto ua = static_cast<std::uint64_t>(a);
+    const auto ub = static_cast<std::uint64_t>(b);
+
+    switch (op) {
+    case opcode::add: return normalize(type, static_cast<std::int64_t>(ua + ub));
+    case opcode::sub: return normalize(type, static_cast<std::int64_t>(ua - ub));
+    case opcode::mul: return normalize(type, static_cast<std::int64_t>(ua * ub));
+    case opcode::and_: return normalize(type, a & b);
+    case opcode::or_: return normalize(type, a | b);
+    case opcode::xor_: return normalize(type, a ^ b);
+    case opcode::sdiv:
+    case opcode::srem: {
+        const auto sa = as_signed(type, a);
+        const auto sb = as_signed(type, b);
+        // both of these trap at run time.
+        if (sb == 0 || (sb == -1 && sa == normalize(type, static_cast<std::int64_t>(~(mask_of(type) >> 1))))) {
+            return std::nullopt;
+        }
+        return normalize(type, op == opcode::sdiv ? sa / sb : sa % sb);
+    }
+    case opcode::udiv:
+    case opcode::urem: {
+        const auto xa = as_unsigned(type, a);
+        const auto xb = as_unsigned(type, b);
+        if (xb == 0) {
+            return std::nullopt;
+        }
+        return normalize(type, static_cast<std::int64_t>(op == opcode::udiv ? xa / xb : xa % xb));
+    }
+    case opcode::shl:
+        return normalize(type, static_cast<std::int64_t>(ua << shift_amount(type, b)));
+    case opcode::lshr:
+        return normalize(type, static_cast<std::int64_t>(as_unsigned(type, a) >> shift_amount(type, b)));
+    case opcode::ashr:
+        return normalize(type, as_signed(type, a) >> shift_amount(type, b));
+    case opcode::neg: return normalize(type, static_cast<std::int64_t>(0 - ua));
+    case opcode::not_: return normalize(type, ~a);
+    case opcode::icmp: return compare(static_cast<cmp_pred>(imm), operand_type, a, b) ? 1 : 0;
+    case opcode::sext:
+        // an i1 true is all ones once sign extended.
+        if (operand_type == value_type::i1) {
+            return normalize(type, (a & 1) != 0 ? -1 : 0);
+        }
+        return normalize(type, as_signed(operand_type, a));
+    case opcode::zext: return normalize(type, static_cast<std::int64_t>(as_unsigned(operand_type, a)));
+    case opcode::trunc:
+    case opcode::bitcast: return normalize(type, a);
+    default: return std::nullopt;
+    }
+}
+
+void opt::make_constant(function& fn, value_id id, std::int64_t value) noexcept {
+    auto& inst = fn.inst(id);
+    const bool was_phi = inst.op == opcode::phi;
+    inst.op = opcode::iconst;
+    inst.imm = normalize(inst.type, value);
+    inst.operand_count = 0;
+    if (!was_phi) {
+        return;
+    }
+
+    // phis have to stay at the start of the block, so this moves after them.
+    const auto block = inst.block;
+    fn.unlink(id);
+    auto first = fn.block(block).first;
+    while (first != invalid_id && fn.inst(first).op == opcode::phi) {
+        first = fn.inst(first).next;
+    }
+    if (first == invalid_id) {
+        fn.append(block, id);
+    }
+    else {
+        fn.insert_before(first, id);
+    }
+}
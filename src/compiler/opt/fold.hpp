@@ -0,0 +1,44 @@
+#ifndef _COMPILER_OPT_FOLD_HPP
+
+#include "../../common/common.hpp"
+
+#include "../ir/ir.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+COMPILER_API_BEGIN
+namespace opt {
+
+// The canonical imm of an iconst of "type": sign extended to 64 bits, except i1 which is
+// always 0 or 1.
+std::int64_t normalize(ir::value_type type, std::int64_t value) noexcept;
+
+/*
+  Evaluate an instruction whose operands are all constants, the same way the backend would
+  at run time. "operand_type" is the type of the first operand (what an icmp or a cast reads).
+
+  Returns nothing if the result can't be known at compile time, like a division by zero.
+*/
+std::optional<std::int64_t> fold(
+    ir::opcode op,
+    ir::value_type type,
+    std::int64_t imm,
+    ir::value_type operand_type,
+    std::span<const std::int64_t> operands
+) noexcept;
+
+// Can fold() ever do anything with this opcode?
+constexpr bool is_foldable(ir::opcode op) noexcept {
+    return ir::is_binary(op) || ir::is_cast(op) || op == ir::opcode::icmp || op == ir::opcode::neg || op == ir::opcode::not_;
+}
+
+// Turn "id" into "iconst value" in place, it keeps its id and type.
+void make_constant(ir::function& fn, ir::value_id id, std::int64_t value) noexcept;
+
+} // namespace opt
+COMPILER_API_END
+
+#define _COMPILER_OPT_FOLD_HPP
+#endif // !_COMPILER_OPT_FOLD_HPP
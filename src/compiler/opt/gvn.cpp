@@ -0,0 +1,256 @@
+#include "passes.hpp"
+#include "fold.hpp"
+
+#include <unordered_map>
+
+using namespace compiler;
+using namespace compiler::ir;
+
+namespace {
+
+// What makes two pure instructions compute the same value.
+struct expression {
+    opcode op;
+    value_type type;
+    std::int64_t imm;
+    value_id lhs;
+    value_id rhs;
+
+    inline bool operator==(const expression& other) const noexcept {
+        return op == other.op && type == other.type && imm == other.imm && lhs == other.lhs && rhs == other.rhs;
+    }
+};
+
+struct expression_hash {
+    inline std::size_t operator()(const expression& e) const noexcept {
+        auto h = static_cast<std::uint64_t>(e.op) | (static_cast<std::uint64_t>(e.type) << 8);
+        const auto mix = [&](std::uint64_t v) {
+            h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        };
+        mix(static_cast<std::uint64_t>(e.imm));
+        mix(e.lhs);
+        mix(e.rhs);
+        return static_cast<std::size_t>(h);
+    }
+};
+
+// Pure instructions with at most two operands, the only ones that get numbered.
+bool is_numbered(opcode op) noexcept {
+    return is_binary(op) || is_cast(op)
+        || op == opcode::icmp || op == opcode::neg || op == opcode::not_
+        || op == opcode::ptr_add || op == opcode::global_addr || op == opcode::iconst
+        || op == opcode::broadcast;
+}
+
+class numbering {
+private:
+    function& m_fn;
+    std::unordered_map<expression, value_id, expression_hash> m_table{};
+public:
+    explicit numbering(function& fn) noexcept
+        : m_fn(fn)
+    {}
+
+    void run(const dominator_tree& doms) noexcept {
+        // (block, first index into "added" for it), blocks are pushed again with
+        // "leaving" set to drop the expressions they added.
+        struct frame {
+            block_id block;
+            std::size_t added;
+            bool leaving;
+        };
+        std::vector<expression> added;
+        std::vector<frame> stack;
+        if (doms.preorder().empty()) {
+            return;
+        }
+        stack.push_back(frame{ doms.preorder().front(), 0, false });
+
+        while (!stack.empty()) {
+            const auto top = stack.back();
+            stack.pop_back();
+            if (top.leaving) {
+                while (added.size() > top.added) {
+                    m_table.erase(added.back());
+                    added.pop_back();
+                }
+                continue;
+            }
+            stack.push_back(frame{ top.block, added.size(), true });
+
+            m_fn.for_each_inst(top.block, [&](value_id id) {
+                const auto& inst = m_fn.inst(id);
+                if (inst.op == opcode::phi) {
+                    simplify_phi(id);
+                    return;
+                }
+                if (!is_numbered(inst.op)) {
+                    return;
+                }
+                if (const auto same = simplify(id); same != invalid_id) {
+                    m_fn.replace_all_uses_with(id, same);
+                    m_fn.remove(id);
+                    return;
+                }
+
+                const auto key = expression_of(id);
+                if (const auto found = m_table.find(key); found != m_table.end()) {
+                    m_fn.replace_all_uses_with(id, found->second);
+                    m_fn.remove(id);
+                    return;
+                }
+                m_table.emplace(key, id);
+                added.push_back(key);
+            });
+
+            const auto children = doms.children(top.block);
+            for (auto i = children.size(); i > 0; --i) {
+                stack.push_back(frame{ children[i - 1], 0, false });
+            }
+        }
+    }
+private:
+    expression expression_of(value_id id) const noexcept {
+        const auto& inst = m_fn.inst(id);
+        expression e{ inst.op, inst.type, inst.imm, invalid_id, invalid_id };
+        if (inst.op == opcode::iconst) {
+            e.imm = opt::normalize(inst.type, inst.imm);
+        }
+        if (inst.operand_count > 0) {
+            e.lhs = m_fn.operand(id, 0);
+        }
+        if (inst.operand_count > 1) {
+            e.rhs = m_fn.operand(id, 1);
+        }
+        if (is_commutative(inst.op) && e.rhs < e.lhs) {
+            std::swap(e.lhs, e.rhs);
+        }
+        return e;
+    }
+
+    bool constant_of(value_id id, std::int64_t& value) const noexcept {
+        const auto& inst = m_fn.inst(id);
+        if (inst.op != opcode::iconst) {
+            return false;
+        }
+        value = opt::normalize(inst.type, inst.imm);
+        return true;
+    }
+
+    // A phi whose incoming values are all the same (or the phi itself) is just that value.
+    void simplify_phi(value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        auto same = invalid_id;
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            const auto value = m_fn.operand(id, i);
+            if (value == id || value == same) {
+                continue;
+            }
+            if (same != invalid_id) {
+                return;
+            }
+            same = value;
+        }
+        if (same != invalid_id) {
+            m_fn.replace_all_uses_with(id, same);
+            m_fn.remove(id);
+        }
+    }
+
+    // Fold constants in place, or find an existing value this is equal to.
+    value_id simplify(value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        // there are no vector constants, so none of the folds below work on vectors.
+        if (inst.op == opcode::iconst || inst.op == opcode::global_addr || is_vector(inst.type)) {
+            return invalid_id;
+        }
+
+        std::int64_t constants[2]{};
+        bool all_constant = true;
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            all_constant &= constant_of(m_fn.operand(id, i), constants[i]);
+        }
+        if (all_constant && opt::is_foldable(inst.op)) {
+            const auto operand_type = m_fn.inst(m_fn.operand(id, 0)).type;
+            if (const auto folded = opt::fold(inst.op, inst.type, inst.imm, operand_type, { constants, inst.operand_count })) {
+                opt::make_constant(m_fn, id, *folded);
+            }
+            return invalid_id;
+        }
+        if (inst.operand_count != 2) {
+            return invalid_id;
+        }
+
+        const auto lhs = m_fn.operand(id, 0);
+        const auto rhs = m_fn.operand(id, 1);
+        std::int64_t c = 0;
+        const bool rhs_constant = constant_of(rhs, c);
+        switch (inst.op) {
+        case opcode::add:
+        case opcode::sub:
+        case opcode::or_:
+        case opcode::xor_:
+        case opcode::shl:
+        case opcode::ashr:
+        case opcode::lshr:
+            // x op 0 == x
+            if (rhs_constant && c == 0) {
+                return lhs;
+            }
+            break;
+        case opcode::ptr_add:
+            if (rhs_constant && c == 0) {
+                return lhs;
+            }
+            break;
+        case opcode::mul:
+        case opcode::sdiv:
+        case opcode::udiv:
+            if (rhs_constant && c == 1) {
+                return lhs;
+            }
+            break;
+        case opcode::and_:
+            if (lhs == rhs) {
+                return lhs;
+            }
+            break;
+        default:
+            break;
+        }
+        if (inst.op == opcode::or_ && lhs == rhs) {
+            return lhs;
+        }
+
+        // x - x, x ^ x and x * 0 are all 0.
+        if (((inst.op == opcode::sub || inst.op == opcode::xor_) && lhs == rhs)
+            || ((inst.op == opcode::mul || inst.op == opcode::and_) && rhs_constant && c == 0)) {
+            opt::make_constant(m_fn, id, 0);
+        }
+        // the commutative ones with the constant on the left.
+        else if (is_commutative(inst.op) && constant_of(lhs, c) && !rhs_constant) {
+            if (c == 0 && (inst.op == opcode::add || inst.op == opcode::or_ || inst.op == opcode::xor_)) {
+                return rhs;
+            }
+            if (c == 1 && inst.op == opcode::mul) {
+                return rhs;
+            }
+            if (c == 0 && (inst.op == opcode::mul || inst.op == opcode::and_)) {
+                opt::make_constant(m_fn, id, 0);
+                return invalid_id;
+            }
+            // constants go on the right, that's where the backend can use an immediate.
+            m_fn.set_operand(id, 0, rhs);
+            m_fn.set_operand(id, 1, lhs);
+        }
+        return invalid_id;
+    }
+};
+
+} // namespace
+
+std::uint8_t opt::gvn(module&, function& fn, analysis_manager& analyses, pass_context&) noexcept {
+    auto table = numbering{ fn };
+    table.run(analyses.dominators());
+    return preserve_all;
+}
@@ -0,0 +1,290 @@
+#include "passes.hpp"
+
+#include <algorithm>
+
+using namespace compiler;
+using namespace compiler::ir;
+
+namespace {
+
+// how big a callee may be (after the bonuses) to be inlined.
+constexpr std::int32_t default_threshold = 40;
+// for functions declared "inline".
+constexpr std::int32_t hint_threshold = 150;
+// what a call costs by itself: the call, saving the caller saved registers, the return...
+constexpr std::int32_t call_cost = 5;
+// bounds for how much a single function may grow.
+constexpr std::uint32_t min_function_growth = 256;
+constexpr std::uint32_t max_function_growth = 4096;
+
+// What the callee costs once it's inlined into "call", roughly its instruction count.
+// Returns as soon as the cost goes over "limit", the exact amount doesn't matter then.
+std::int32_t inline_cost(const function& caller, value_id call, const function& callee, std::int32_t limit) noexcept {
+    const auto& c = caller.inst(call);
+    std::int32_t cost = -call_cost - static_cast<std::int32_t>(c.operand_count);
+
+    for (block_id b = 0; b < callee.block_count(); ++b) {
+        if (callee.block(b).removed) {
+            continue;
+        }
+        for (auto id = callee.block(b).first; id != invalid_id; id = callee.inst(id).next) {
+            const auto& inst = callee.inst(id);
+            switch (inst.op) {
+            case opcode::param:
+            case opcode::iconst:
+            case opcode::undef:
+            case opcode::nop:
+            case opcode::alloca:
+                continue;
+            default:
+                break;
+            }
+            cost++;
+
+            // a parameter that's a constant at this call site, whatever uses it likely folds.
+            // comparisons get more, they decide branches and take whole blocks with them.
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                const auto& operand = callee.inst(callee.operand(id, i));
+                if (operand.op != opcode::param || operand.imm >= c.operand_count) {
+                    continue;
+                }
+                const auto arg = caller.operand(call, static_cast<std::uint32_t>(operand.imm));
+                if (caller.inst(arg).op == opcode::iconst) {
+                    cost -= inst.op == opcode::icmp || inst.op == opcode::cond_br ? 3 : 1;
+                }
+            }
+        }
+        if (cost > limit) {
+            break;
+        }
+    }
+    return cost;
+}
+
+// The instructions of "callee", not counting parameters.
+std::uint32_t body_size(const function& callee) noexcept {
+    std::uint32_t size = 0;
+    for (block_id b = 0; b < callee.block_count(); ++b) {
+        if (!callee.block(b).removed) {
+            size += callee.block(b).size;
+        }
+    }
+    return size - std::min<std::uint32_t>(size, static_cast<std::uint32_t>(callee.params().size()));
+}
+
+// Why "call" to "callee" can't be inlined at all, nullptr if it can.
+const char* cannot_inline(const function& caller, value_id call, const function& callee) noexcept {
+    const auto& c = caller.inst(call);
+    if (c.operand_count != callee.params().size()) {
+        return "the argument count doesn't match";
+    }
+    for (std::uint32_t i = 0; i < c.operand_count; ++i) {
+        if (caller.inst(caller.operand(call, i)).type != callee.params()[i]) {
+            return "an argument type doesn't match";
+        }
+    }
+    if (c.type != value_type::void_ && c.type != callee.return_type()) {
+        return "the return type doesn't match";
+    }
+    // the entry block gets a new predecessor, its phis would have nothing for it.
+    for (auto id = callee.block(callee.entry()).first; id != invalid_id; id = callee.inst(id).next) {
+        if (callee.inst(id).op == opcode::phi) {
+            return "its entry block is a loop header";
+        }
+    }
+    return nullptr;
+}
+
+// Replace "call" with a copy of the body of "callee".
+void inline_call(function& fn, value_id call, const function& callee) noexcept {
+    const auto block = fn.inst(call).block;
+
+    // everything after the call moves to "cont", that's where the returns go.
+    const auto cont = fn.create_block();
+    for (auto id = fn.inst(call).next; id != invalid_id;) {
+        const auto next = fn.inst(id).next;
+        fn.unlink(id);
+        fn.append(cont, id);
+        id = next;
+    }
+    fn.for_each_successor(cont, [&](block_id succ) {
+        fn.for_each_inst(succ, [&](value_id id) {
+            const auto& inst = fn.inst(id);
+            if (inst.op != opcode::phi) {
+                return;
+            }
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                if (fn.target(id, i) == block) {
+                    fn.set_target(id, i, cont);
+                }
+            }
+        });
+    });
+
+    std::vector<block_id> block_map(callee.block_count(), invalid_id);
+    for (block_id b = 0; b < callee.block_count(); ++b) {
+        if (!callee.block(b).removed) {
+            block_map[b] = fn.create_block();
+        }
+    }
+
+    // copy with the callees operands first, phis can refer to values that come later.
+    std::vector<value_id> value_map(callee.value_count(), invalid_id);
+    std::vector<std::pair<block_id, value_id>> returns;
+    const auto first_copy = fn.value_count();
+    for (block_id b = 0; b < callee.block_count(); ++b) {
+        if (callee.block(b).removed) {
+            continue;
+        }
+        callee.for_each_inst(b, [&](value_id id) {
+            const auto& inst = callee.inst(id);
+            if (inst.op == opcode::param) {
+                value_map[id] = fn.operand(call, static_cast<std::uint32_t>(inst.imm));
+                return;
+            }
+            if (inst.op == opcode::ret) {
+                returns.emplace_back(block_map[b], inst.operand_count > 0 ? callee.operand(id, 0) : invalid_id);
+                return;
+            }
+            std::vector<value_id> operands(inst.operand_count);
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                operands[i] = callee.operand(id, i);
+            }
+            std::vector<block_id> targets(inst.target_count());
+            for (std::uint32_t i = 0; i < targets.size(); ++i) {
+                targets[i] = callee.target(id, i);
+            }
+            value_map[id] = fn.create(inst.op, inst.type, operands, inst.imm, targets);
+            fn.append(block_map[b], value_map[id]);
+        });
+    }
+    for (auto id = first_copy; id < fn.value_count(); ++id) {
+        const auto& inst = fn.inst(id);
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            // raw, the callees ids mean nothing to the callers alias table.
+            fn.set_operand(id, i, value_map[fn.raw_operands(id)[i]]);
+        }
+        for (std::uint32_t i = 0; i < inst.target_count(); ++i) {
+            fn.set_target(id, i, block_map[fn.target(id, i)]);
+        }
+    }
+
+    // the returns branch to "cont", with a phi in there if there's more than one value.
+    const auto type = fn.inst(call).type;
+    std::vector<value_id> values;
+    std::vector<block_id> from;
+    for (const auto& [b, value] : returns) {
+        if (type != value_type::void_) {
+            auto result = value != invalid_id ? value_map[value] : invalid_id;
+            if (result == invalid_id) {
+                // falling off the end of a non-void function.
+                result = fn.create(opcode::undef, type);
+                fn.append(b, result);
+            }
+            values.push_back(result);
+            from.push_back(b);
+        }
+        const block_id target[] = { cont };
+        fn.append(b, fn.create(opcode::br, value_type::void_, {}, 0, target));
+    }
+    if (type != value_type::void_) {
+        auto result = values.empty() ? invalid_id : values.front();
+        if (values.empty()) {
+            // the callee never returns, the result is never seen.
+            result = fn.create(opcode::undef, type);
+            fn.insert_before(call, result);
+        }
+        else if (values.size() > 1) {
+            result = fn.create(opcode::phi, type, values, 0, from);
+            if (fn.block(cont).empty()) {
+                fn.append(cont, result);
+            }
+            else {
+                fn.insert_before(fn.block(cont).first, result);
+            }
+        }
+        fn.replace_all_uses_with(call, result);
+    }
+
+    fn.remove(call);
+    const block_id entry[] = { block_map[callee.entry()] };
+    fn.append(block, fn.create(opcode::br, value_type::void_, {}, 0, entry));
+}
+
+} // namespace
+
+std::uint8_t opt::inline_calls(module& mod, function& fn, analysis_manager& analyses, pass_context& context) noexcept {
+    const auto* calls = context.calls();
+    if (calls == nullptr) {
+        return preserve_all;
+    }
+    const auto self = calls->function_of(fn.symbol());
+    const auto& loops = analyses.loops();
+
+    // the call sites are collected first, the calls inside of inlined bodies have already been
+    // looked at when the callee went through the pipeline.
+    struct call_site {
+        value_id call;
+        std::uint32_t callee;
+        bool in_loop;
+    };
+    std::vector<call_site> sites;
+    std::uint32_t size = 0;
+    for (block_id b = 0; b < fn.block_count(); ++b) {
+        if (fn.block(b).removed) {
+            continue;
+        }
+        size += fn.block(b).size;
+        fn.for_each_inst(b, [&](value_id id) {
+            const auto& inst = fn.inst(id);
+            if (inst.op != opcode::call) {
+                return;
+            }
+            const auto callee = calls->function_of(static_cast<symbol_id>(inst.imm));
+            if (callee != invalid_id) {
+                sites.push_back(call_site{ id, callee, loops.loop_of(b) != invalid_id });
+            }
+        });
+    }
+
+    auto function_budget = std::clamp(size, min_function_growth, max_function_growth);
+    auto& module_budget = context.inline_budget();
+    bool changed = false;
+    for (const auto& site : sites) {
+        const auto& callee = *mod.functions()[site.callee];
+        if (site.callee == self || (self != invalid_id && calls->scc_of(site.callee) == calls->scc_of(self))) {
+            context.note(fn, false, "`{}` not inlined: it's recursive", callee.name());
+            continue;
+        }
+        if (const auto* reason = cannot_inline(fn, site.call, callee)) {
+            context.note(fn, false, "`{}` not inlined: {}", callee.name(), reason);
+            continue;
+        }
+
+        auto threshold = callee.inline_hint() ? hint_threshold : default_threshold;
+        if (site.in_loop) {
+            threshold += threshold / 2;
+        }
+        const auto cost = inline_cost(fn, site.call, callee, threshold);
+        if (cost > threshold) {
+            context.note(fn, false, "`{}` not inlined: cost {} over threshold {}", callee.name(), cost, threshold);
+            continue;
+        }
+        const auto growth = body_size(callee);
+        if (growth > function_budget) {
+            context.note(fn, false, "`{}` not inlined: `{}` grew too much already", callee.name(), fn.name());
+            continue;
+        }
+        if (growth > module_budget) {
+            context.note(fn, false, "`{}` not inlined: the module grew too much already", callee.name());
+            continue;
+        }
+
+        inline_call(fn, site.call, callee);
+        function_budget -= growth;
+        module_budget -= growth;
+        changed = true;
+        context.note(fn, true, "`{}` inlined (cost {}, threshold {})", callee.name(), cost, threshold);
+    }
+    return changed ? preserve_none : preserve_all;
+}
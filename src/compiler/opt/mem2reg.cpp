@@ -0,0 +1,347 @@
+#include "passes.hpp"
+
+#include "../ir/use_lists.hpp"
+
+#include <algorithm>
+
+using namespace compiler;
+using namespace compiler::ir;
+
+namespace {
+
+// An access to an alloca: a load or store whose address is the alloca plus "offset".
+struct slot_access {
+    value_id inst;
+    // the ptr_add in between, invalid_id if the address is the alloca itself.
+    value_id address;
+    std::int64_t offset;
+    value_type type;
+};
+
+// The type a load reads or a store writes through "address", void if "user" isn't a load or
+// a store using it as the address.
+value_type access_type(const function& fn, value_id user, std::uint32_t index) noexcept {
+    const auto& inst = fn.inst(user);
+    if (index != 0) {
+        return value_type::void_;
+    }
+    if (inst.op == opcode::load) {
+        return inst.type;
+    }
+    if (inst.op == opcode::store) {
+        return fn.inst(fn.operand(user, 1)).type;
+    }
+    return value_type::void_;
+}
+
+// Every access of "slot", or false if its address escapes (or is used in a way we can't
+// see through).
+bool collect_accesses(const function& fn, const use_lists& uses, value_id slot, std::vector<slot_access>& out) noexcept {
+    out.clear();
+    for (const auto& use : uses.uses(slot)) {
+        const auto& user = fn.inst(use.user);
+        if (user.block == invalid_id) {
+            continue;
+        }
+        const auto type = access_type(fn, use.user, use.index);
+        if (type != value_type::void_) {
+            out.push_back(slot_access{ use.user, invalid_id, 0, type });
+            continue;
+        }
+
+        // "slot + constant", as long as that's only used as an address too.
+        if (user.op != opcode::ptr_add || use.index != 0) {
+            return false;
+        }
+        const auto& index = fn.inst(fn.operand(use.user, 1));
+        if (index.op != opcode::iconst) {
+            return false;
+        }
+        const auto offset = index.imm * user.imm;
+        for (const auto& inner : uses.uses(use.user)) {
+            if (fn.inst(inner.user).block == invalid_id) {
+                continue;
+            }
+            const auto inner_type = access_type(fn, inner.user, inner.index);
+            if (inner_type == value_type::void_) {
+                return false;
+            }
+            out.push_back(slot_access{ inner.user, use.user, offset, inner_type });
+        }
+    }
+    return true;
+}
+
+/*
+  Scalar replacement: an alloca that's only accessed at a few constant offsets, with the same
+  type at each one and without overlaps, is really a handful of separate variables. Each
+  offset gets its own alloca so mem2reg can promote them.
+*/
+bool split_aggregates(function& fn, const cfg& graph) noexcept {
+    const use_lists uses{ fn };
+    std::vector<slot_access> accesses;
+    bool changed = false;
+
+    const auto count = fn.value_count();
+    for (value_id slot = 0; slot < count; ++slot) {
+        const auto& inst = fn.inst(slot);
+        if (inst.op != opcode::alloca || inst.block == invalid_id || !graph.is_reachable(inst.block)) {
+            continue;
+        }
+        if (!collect_accesses(fn, uses, slot, accesses)) {
+            continue;
+        }
+        const bool has_offsets = std::any_of(accesses.begin(), accesses.end(), [](const slot_access& a) {
+            return a.address != invalid_id;
+        });
+        if (!has_offsets) {
+            continue;
+        }
+
+        // one type per offset, in bounds, and no two pieces overlap.
+        std::sort(accesses.begin(), accesses.end(), [](const slot_access& a, const slot_access& b) { return a.offset < b.offset; });
+        bool ok = true;
+        for (std::size_t i = 0; i < accesses.size() && ok; ++i) {
+            const auto& a = accesses[i];
+            const auto size = static_cast<std::int64_t>(size_of(a.type));
+            if (a.offset < 0 || a.offset + size > inst.imm) {
+                ok = false;
+            }
+            else if (i + 1 < accesses.size()) {
+                const auto& next = accesses[i + 1];
+                ok = next.offset == a.offset ? next.type == a.type : next.offset >= a.offset + size;
+            }
+        }
+        if (!ok) {
+            continue;
+        }
+
+        auto piece = invalid_id;
+        for (std::size_t i = 0; i < accesses.size(); ++i) {
+            const auto& a = accesses[i];
+            if (i == 0 || a.offset != accesses[i - 1].offset) {
+                piece = fn.create(opcode::alloca, value_type::ptr, {}, static_cast<std::int64_t>(size_of(a.type)));
+                fn.insert_after(slot, piece);
+            }
+            fn.set_operand(a.inst, 0, piece);
+        }
+        for (const auto& a : accesses) {
+            if (a.address != invalid_id && fn.inst(a.address).block != invalid_id) {
+                fn.remove(a.address);
+            }
+        }
+        fn.remove(slot);
+        changed = true;
+    }
+    return changed;
+}
+
+} // namespace
+
+std::uint8_t opt::mem2reg(module&, function& fn, analysis_manager& analyses, pass_context&) noexcept {
+    const auto& graph = analyses.graph();
+    split_aggregates(fn, graph);
+
+    const auto& doms = analyses.dominators();
+    const use_lists uses{ fn };
+    const auto count = fn.value_count();
+
+    // find the promotable allocas, "slot_of" maps them to a dense index.
+    std::vector<value_id> slots;
+    std::vector<value_type> slot_types;
+    std::vector<std::uint32_t> slot_of(count, invalid_id);
+    std::vector<slot_access> accesses;
+    for (value_id id = 0; id < count; ++id) {
+        const auto& inst = fn.inst(id);
+        if (inst.op != opcode::alloca || inst.block == invalid_id) {
+            continue;
+        }
+        if (!collect_accesses(fn, uses, id, accesses)) {
+            continue;
+        }
+        auto type = value_type::void_;
+        bool ok = true;
+        for (const auto& a : accesses) {
+            if (a.address != invalid_id || (type != value_type::void_ && a.type != type)
+                || static_cast<std::int64_t>(size_of(a.type)) > inst.imm) {
+                ok = false;
+                break;
+            }
+            type = a.type;
+        }
+        if (!ok) {
+            continue;
+        }
+        slot_of[id] = static_cast<std::uint32_t>(slots.size());
+        slots.push_back(id);
+        slot_types.push_back(type);
+    }
+    if (slots.empty()) {
+        return preserve_all;
+    }
+
+    // the promoted slot a load or store accesses, invalid_id if it isn't one.
+    const auto slot_accessed_by = [&](value_id id) -> std::uint32_t {
+        const auto& inst = fn.inst(id);
+        if ((inst.op != opcode::load && inst.op != opcode::store) || inst.operand_count == 0) {
+            return invalid_id;
+        }
+        const auto address = fn.operand(id, 0);
+        return address < count ? slot_of[address] : invalid_id;
+    };
+
+    // undef is what a slot holds before its first store.
+    std::vector<value_id> undefs(static_cast<std::size_t>(value_type::ptr) + 1, invalid_id);
+    const auto undef = [&](value_type type) {
+        auto& cached = undefs[static_cast<std::size_t>(type)];
+        if (cached == invalid_id) {
+            cached = fn.create(opcode::undef, type);
+            auto first = fn.block(fn.entry()).first;
+            while (first != invalid_id && fn.inst(first).op == opcode::param) {
+                first = fn.inst(first).next;
+            }
+            fn.insert_before(first, cached);
+        }
+        return cached;
+    };
+
+    // place phis on the iterated dominance frontier of the blocks that store to each slot.
+    const auto frontiers = doms.frontiers(graph);
+    std::vector<std::uint32_t> phi_slot;
+    std::vector<std::uint32_t> has_phi(fn.block_count(), invalid_id);
+    std::vector<std::uint32_t> queued(fn.block_count(), invalid_id);
+    std::vector<block_id> worklist;
+    for (std::uint32_t s = 0; s < slots.size(); ++s) {
+        for (const auto& use : uses.uses(slots[s])) {
+            const auto& user = fn.inst(use.user);
+            if (user.op == opcode::store && user.block != invalid_id && graph.is_reachable(user.block) && queued[user.block] != s) {
+                queued[user.block] = s;
+                worklist.push_back(user.block);
+            }
+        }
+        while (!worklist.empty()) {
+            const auto block = worklist.back();
+            worklist.pop_back();
+            for (const auto frontier : frontiers[block]) {
+                if (has_phi[frontier] == s) {
+                    continue;
+                }
+                has_phi[frontier] = s;
+
+                const auto preds = graph.preds(frontier).size();
+                const std::vector<value_id> operands(preds, invalid_id);
+                const std::vector<block_id> targets(preds, invalid_id);
+                const auto phi = fn.create(opcode::phi, slot_types[s], operands, 0, targets);
+                fn.insert_before(fn.block(frontier).first, phi);
+                phi_slot.resize(fn.value_count(), invalid_id);
+                phi_slot[phi] = s;
+
+                if (queued[frontier] != s) {
+                    queued[frontier] = s;
+                    worklist.push_back(frontier);
+                }
+            }
+        }
+    }
+    phi_slot.resize(fn.value_count(), invalid_id);
+
+    // rename: walk the dominator tree keeping the current value of every slot, with an undo
+    // log so leaving a block restores what its dominator had.
+    std::vector<value_id> current(slots.size(), invalid_id);
+    std::vector<std::pair<std::uint32_t, value_id>> undo;
+    // (block, undo log size when it was entered), a block is pushed twice: once to enter
+    // it and once (with "leaving" set) to restore the log.
+    struct frame {
+        block_id block;
+        std::size_t log;
+        bool leaving;
+    };
+    std::vector<frame> stack;
+    stack.push_back(frame{ fn.entry(), 0, false });
+
+    while (!stack.empty()) {
+        const auto top = stack.back();
+        stack.pop_back();
+        if (top.leaving) {
+            while (undo.size() > top.log) {
+                current[undo.back().first] = undo.back().second;
+                undo.pop_back();
+            }
+            continue;
+        }
+        stack.push_back(frame{ top.block, undo.size(), true });
+
+        fn.for_each_inst(top.block, [&](value_id id) {
+            if (id < phi_slot.size() && phi_slot[id] != invalid_id) {
+                const auto s = phi_slot[id];
+                undo.push_back({ s, current[s] });
+                current[s] = id;
+                return;
+            }
+            const auto s = slot_accessed_by(id);
+            if (s == invalid_id) {
+                return;
+            }
+            if (fn.inst(id).op == opcode::load) {
+                const auto value = current[s] == invalid_id ? undef(slot_types[s]) : current[s];
+                fn.replace_all_uses_with(id, value);
+            }
+            else {
+                undo.push_back({ s, current[s] });
+                current[s] = fn.resolve(fn.operand(id, 1));
+            }
+            fn.remove(id);
+        });
+
+        // fill in our incoming value of every phi we placed in the successors.
+        fn.for_each_successor(top.block, [&](block_id succ) {
+            const auto preds = graph.preds(succ);
+            fn.for_each_inst(succ, [&](value_id phi) {
+                if (phi >= phi_slot.size() || phi_slot[phi] == invalid_id) {
+                    return;
+                }
+                const auto s = phi_slot[phi];
+                for (std::uint32_t i = 0; i < preds.size(); ++i) {
+                    if (preds[i] == top.block) {
+                        const auto value = current[s] == invalid_id ? undef(slot_types[s]) : current[s];
+                        fn.set_phi_incoming(phi, i, value, top.block);
+                    }
+                }
+            });
+        });
+
+        const auto children = doms.children(top.block);
+        for (auto i = children.size(); i > 0; --i) {
+            stack.push_back(frame{ children[i - 1], 0, false });
+        }
+    }
+
+    // incoming values from unreachable predecessors were never filled in.
+    for (value_id phi = 0; phi < phi_slot.size(); ++phi) {
+        if (phi_slot[phi] == invalid_id) {
+            continue;
+        }
+        const auto preds = graph.preds(fn.inst(phi).block);
+        for (std::uint32_t i = 0; i < preds.size(); ++i) {
+            if (fn.target(phi, i) == invalid_id) {
+                fn.set_phi_incoming(phi, i, undef(slot_types[phi_slot[phi]]), preds[i]);
+            }
+        }
+    }
+
+    // what's left of the slots is in unreachable blocks.
+    for (std::uint32_t s = 0; s < slots.size(); ++s) {
+        for (const auto& use : uses.uses(slots[s])) {
+            const auto& user = fn.inst(use.user);
+            if (user.block == invalid_id) {
+                continue;
+            }
+            if (user.op == opcode::load) {
+                fn.replace_all_uses_with(use.user, undef(slot_types[s]));
+            }
+            fn.remove(use.user);
+        }
+        fn.remove(slots[s]);
+    }
+    return preserve_all;
+}
@@ -0,0 +1,237 @@
+#include "pass_manager.hpp"
+#include "passes.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+
+using namespace compiler;
+using namespace compiler::opt;
+
+namespace {
+
+// Inlining may add half of the module's size to it, small modules at least this much.
+constexpr std::uint32_t min_module_growth = 2048;
+
+std::uint64_t instruction_count(const ir::function& fn) noexcept {
+    std::uint64_t size = 0;
+    for (ir::block_id b = 0; b < fn.block_count(); ++b) {
+        if (!fn.block(b).removed) {
+            size += fn.block(b).size;
+        }
+    }
+    return size;
+}
+
+// How much inlining every call "fn" makes to a function of the module could add, the most
+// of the module's budget it could ever use.
+std::uint64_t inline_demand(const ir::module& mod, const ir::call_graph& calls, const ir::function& fn) noexcept {
+    std::uint64_t demand = 0;
+    for (ir::block_id b = 0; b < fn.block_count(); ++b) {
+        if (fn.block(b).removed) {
+            continue;
+        }
+        fn.for_each_inst(b, [&](ir::value_id id) {
+            const auto& inst = fn.inst(id);
+            if (inst.op != ir::opcode::call) {
+                return;
+            }
+            const auto callee = calls.function_of(static_cast<ir::symbol_id>(inst.imm));
+            if (callee != ir::invalid_id) {
+                demand += instruction_count(*mod.functions()[callee]);
+            }
+        });
+    }
+    return demand;
+}
+
+} // namespace
+
+const ir::cfg& analysis_manager::graph() noexcept {
+    if (!m_cfg) {
+        m_cfg.emplace(m_fn);
+        m_computed++;
+    }
+    return *m_cfg;
+}
+
+const ir::dominator_tree& analysis_manager::dominators() noexcept {
+    if (!m_doms) {
+        m_doms.emplace(m_fn, graph());
+        m_computed++;
+    }
+    return *m_doms;
+}
+
+const ir::loop_info& analysis_manager::loops() noexcept {
+    if (!m_loops) {
+        m_loops.emplace(m_fn, graph(), dominators());
+        m_computed++;
+    }
+    return *m_loops;
+}
+
+void analysis_manager::invalidate(std::uint8_t kept) noexcept {
+    // dominators are built from the cfg and loops from both.
+    if (!(kept & preserve_cfg)) {
+        m_cfg.reset();
+        kept = preserve_none;
+    }
+    if (!(kept & preserve_dominators)) {
+        m_doms.reset();
+        kept = preserve_none;
+    }
+    if (!(kept & preserve_loops)) {
+        m_loops.reset();
+    }
+}
+
+pass_manager pass_manager::for_level(opt_level level, const target_info& target) noexcept {
+    pass_manager pm{};
+    pm.m_context.set_target(target);
+    switch (level) {
+    case opt_level::O0:
+        break;
+    case opt_level::O1:
+        pm.add({ "mem2reg", mem2reg });
+        pm.add({ "sccp", sccp });
+        pm.add({ "dce", dce });
+        break;
+    case opt_level::O2:
+        pm.add({ "mem2reg", mem2reg });
+        pm.add({ "inline", inline_calls });
+        pm.add({ "sccp", sccp });
+        pm.add({ "gvn", gvn });
+        pm.add({ "vectorize", vectorize });
+        // the vector loop's setup is built from copies of the loop's constants.
+        pm.add({ "gvn", gvn });
+        pm.add({ "dce", dce });
+        break;
+    }
+    return pm;
+}
+
+void pass_manager::add(pass p) noexcept {
+    m_passes.push_back(p);
+    m_timings.push_back(pass_timing{ p.name });
+}
+
+void pass_manager::run(ir::module& mod, thread_pool& pool) noexcept {
+    const auto calls = ir::call_graph{ mod };
+    m_context.set_calls(&calls);
+    m_context.inline_budget() = std::max(calls.module_size() / 2, min_module_growth);
+
+    // a component is one wave after the latest of the components it calls.
+    std::vector<std::uint32_t> wave_of(calls.scc_count(), 0);
+    std::vector<std::vector<std::uint32_t>> waves;
+    for (std::uint32_t scc = 0; scc < calls.scc_count(); ++scc) {
+        auto wave = std::uint32_t{ 0 };
+        for (const auto index : calls.scc(scc)) {
+            for (const auto callee : calls.callees(index)) {
+                if (calls.scc_of(callee) != scc) {
+                    wave = std::max(wave, wave_of[calls.scc_of(callee)] + 1);
+                }
+            }
+        }
+        wave_of[scc] = wave;
+        if (wave >= waves.size()) {
+            waves.resize(wave + 1);
+        }
+        for (const auto index : calls.scc(scc)) {
+            if (mod.functions()[index]->is_definition()) {
+                waves[wave].push_back(index);
+            }
+        }
+    }
+
+    // every worker times into its own table, they're added up at the end.
+    std::vector<std::vector<pass_timing>> timings(pool.size(), m_timings);
+    for (auto& table : timings) {
+        for (auto& t : table) {
+            t.total = std::chrono::nanoseconds{ 0 };
+            t.runs = 0;
+        }
+    }
+    std::vector<pass_context> contexts;
+    std::vector<std::uint32_t> shares;
+    for (const auto& wave : waves) {
+        // the functions of a wave run at the same time, so the budget is split between them
+        // before it starts. They're handed what they could use at most in wave order, until
+        // it runs out. The shares never add up to more than the budget whatever the threads
+        // do, and it goes to whole functions instead of being spread too thin to be of use.
+        auto& budget = m_context.inline_budget();
+        shares.assign(wave.size(), 0);
+        auto unassigned = budget;
+        for (std::size_t i = 0; i < wave.size() && unassigned != 0; ++i) {
+            const auto demand = inline_demand(mod, calls, *mod.functions()[wave[i]]);
+            shares[i] = static_cast<std::uint32_t>(std::min<std::uint64_t>(demand, unassigned));
+            unassigned -= shares[i];
+        }
+
+        contexts.assign(wave.size(), m_context.fork());
+        for (std::size_t i = 0; i < wave.size(); ++i) {
+            contexts[i].inline_budget() = shares[i];
+        }
+        pool.for_each_index(wave.size(), [&](std::size_t i, std::size_t worker) {
+            run_function(mod, *mod.functions()[wave[i]], contexts[i], timings[worker]);
+        });
+
+        // what a function didn't spend of its share goes back for the next waves.
+        for (std::size_t i = 0; i < wave.size(); ++i) {
+            budget -= shares[i] - contexts[i].inline_budget();
+            m_context.merge(std::move(contexts[i]));
+        }
+    }
+    for (const auto& table : timings) {
+        for (std::size_t i = 0; i < m_timings.size(); ++i) {
+            m_timings[i].total += table[i].total;
+            m_timings[i].runs += table[i].runs;
+        }
+    }
+    m_context.set_calls(nullptr);
+}
+
+void pass_manager::run_function(
+    ir::module& mod,
+    ir::function& fn,
+    pass_context& context,
+    std::vector<pass_timing>& timings
+) const noexcept {
+    using clock = std::chrono::steady_clock;
+
+    auto analyses = analysis_manager{ fn };
+    for (std::size_t i = 0; i < m_passes.size(); ++i) {
+        const auto& p = m_passes[i];
+        context.set_pass(p.name);
+        const auto start = clock::now();
+        const auto kept = p.run(mod, fn, analyses, context);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+
+        analyses.invalidate(kept);
+        timings[i].total += elapsed;
+        timings[i].runs++;
+        if (m_hook) {
+            m_hook(p, fn, elapsed);
+        }
+    }
+    // passes replace values lazily, rewrite the operands once at the end.
+    fn.compact_aliases();
+}
+
+std::string pass_manager::report() const noexcept {
+    std::chrono::nanoseconds total{ 0 };
+    for (const auto& t : m_timings) {
+        total += t.total;
+    }
+
+    std::string out;
+    auto it = std::back_inserter(out);
+    std::format_to(it, "{:<12} {:>8} {:>12} {:>7}\n", "pass", "runs", "time (ms)", "%");
+    for (const auto& t : m_timings) {
+        const auto ms = static_cast<double>(t.total.count()) / 1e6;
+        const auto percent = total.count() == 0 ? 0.0 : 100.0 * static_cast<double>(t.total.count()) / static_cast<double>(total.count());
+        std::format_to(it, "{:<12} {:>8} {:>12.3f} {:>6.1f}%\n", t.name, t.runs, ms, percent);
+    }
+    std::format_to(it, "{:<12} {:>8} {:>12.3f}\n", "total", "", static_cast<double>(total.count()) / 1e6);
+    return out;
+}
@@ -0,0 +1,205 @@
+#ifndef _COMPILER_OPT_PASS_MANAGER_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/thread_pool.hpp"
+
+#include "../ir/ir.hpp"
+#include "../ir/call_graph.hpp"
+#include "../ir/cfg.hpp"
+#include "../ir/dominators.hpp"
+#include "../ir/loops.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace opt {
+
+enum class opt_level : std::uint8_t {
+    // nothing, the IR goes to the backend as it was lowered.
+    O0,
+    // the cheap passes that matter the most: mem2reg, constant propagation and DCE.
+    O1,
+    // everything.
+    O2,
+};
+
+// What a pass kept valid, analyses that aren't in here are thrown away after it runs.
+enum preserved : std::uint8_t {
+    preserve_none = 0,
+    // the blocks and the edges between them.
+    preserve_cfg = 1 << 0,
+    preserve_dominators = 1 << 1,
+    preserve_loops = 1 << 2,
+    // the pass only changed instructions, never branches.
+    preserve_all = preserve_cfg | preserve_dominators | preserve_loops,
+};
+
+/*
+  The analyses of one function, computed the first time they're asked for and cached until
+  a pass invalidates them.
+
+  Invalidation is lazy: a pass that changes the CFG only drops the cached results, and they
+  are rebuilt when (and if) a later pass asks again. Analyses are also kept separately, so a
+  pass that preserves dominators but not loops only pays for loop_info next time.
+*/
+class analysis_manager {
+private:
+    const ir::function& m_fn;
+    std::optional<ir::cfg> m_cfg{};
+    std::optional<ir::dominator_tree> m_doms{};
+    std::optional<ir::loop_info> m_loops{};
+    std::uint32_t m_computed{ 0 };
+public:
+    inline explicit analysis_manager(const ir::function& fn) noexcept
+        : m_fn(fn)
+    {}
+
+    const ir::cfg& graph() noexcept;
+    const ir::dominator_tree& dominators() noexcept;
+    const ir::loop_info& loops() noexcept;
+
+    // Drop everything that isn't in "kept", analyses that depend on something that was
+    // dropped go with it.
+    void invalidate(std::uint8_t kept) noexcept;
+
+    // How many times an analysis had to be computed.
+    inline std::uint32_t computed() const noexcept { return m_computed; }
+};
+
+// What the passes may assume about the machine the code runs on.
+struct target_info {
+    // the widest vector registers the backend can use, in bytes. 16 is SSE2 (every x86-64 has
+    // it), 32 is AVX2 and 0 turns vectorization off.
+    std::uint32_t vector_bytes{ 16 };
+};
+
+// What a pass did to some part of a function, or why it didn't.
+struct remark {
+    const char* pass;
+    std::string function;
+    // the transformation happened, otherwise "message" is why it didn't.
+    bool applied;
+    std::string message;
+};
+
+// Everything a pass gets besides the function and its analyses.
+class pass_context {
+private:
+    target_info m_target{};
+    const ir::call_graph* m_calls{ nullptr };
+    // how many instructions inlining may still add to the module.
+    std::uint32_t m_inline_budget{ 0 };
+    bool m_collect_remarks{ false };
+    const char* m_pass{ "" };
+    std::vector<remark> m_remarks{};
+public:
+    inline const target_info& target() const noexcept { return m_target; }
+    inline void set_target(const target_info& target) noexcept { m_target = target; }
+
+    // The call graph of the module, as it was before the pipeline started. Only set while
+    // the pass manager runs.
+    inline const ir::call_graph* calls() const noexcept { return m_calls; }
+    inline void set_calls(const ir::call_graph* calls) noexcept { m_calls = calls; }
+    inline std::uint32_t& inline_budget() noexcept { return m_inline_budget; }
+
+    inline bool wants_remarks() const noexcept { return m_collect_remarks; }
+    inline void collect_remarks(bool collect) noexcept { m_collect_remarks = collect; }
+    inline const std::vector<remark>& remarks() const noexcept { return m_remarks; }
+
+    // A context for another function running at the same time: the same settings and
+    // budget, but no remarks yet.
+    inline pass_context fork() const noexcept {
+        pass_context out{};
+        out.m_target = m_target;
+        out.m_calls = m_calls;
+        out.m_inline_budget = m_inline_budget;
+        out.m_collect_remarks = m_collect_remarks;
+        return out;
+    }
+    // Take the remarks of a forked context, in order.
+    inline void merge(pass_context&& other) noexcept {
+        m_remarks.insert(m_remarks.end(), std::make_move_iterator(other.m_remarks.begin()), std::make_move_iterator(other.m_remarks.end()));
+    }
+
+    // The pass that's running, remarks are attributed to it.
+    inline void set_pass(const char* name) noexcept { m_pass = name; }
+
+    // Record a remark about "fn", it's only formatted if anyone asked for remarks.
+    template<class... Args>
+    inline void note(const ir::function& fn, bool applied, std::format_string<Args...> fmt, Args&&... args) {
+        if (!m_collect_remarks) {
+            return;
+        }
+        m_remarks.push_back(remark{ m_pass, fn.name(), applied, std::format(fmt, std::forward<Args>(args)...) });
+    }
+};
+
+// A pass over a single function. It returns the analyses it preserved.
+struct pass {
+    const char* name;
+    std::uint8_t (*run)(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+};
+
+struct pass_timing {
+    const char* name;
+    std::chrono::nanoseconds total{ 0 };
+    std::uint32_t runs{ 0 };
+};
+
+/*
+  Runs a list of passes over every function of a module, one function at a time so its
+  arenas stay in cache for the whole pipeline. Functions go bottom-up through the call
+  graph, whatever a function calls has been through the whole pipeline before it is.
+
+  The call graph is cut into waves: a function is in the wave after the last one any of its
+  callees is in. Functions in the same wave don't depend on each other and go through the
+  pipeline on the thread pool at the same time. Each one gets its own pass_context with a
+  share of the inline budget the previous waves left, the shares are split up before the
+  wave runs and the remarks are merged back in wave order, so the result doesn't depend on
+  the amount of threads and the module never grows past its budget.
+
+  Every pass is timed. The hook, when set, is called after each pass on each function with
+  the time it took, that's where verification or IR dumps between passes go. It's called
+  from the worker threads, possibly for several functions at once.
+*/
+class pass_manager {
+public:
+    using hook = std::function<void(const pass&, const ir::function&, std::chrono::nanoseconds)>;
+private:
+    std::vector<pass> m_passes{};
+    std::vector<pass_timing> m_timings{};
+    hook m_hook{};
+    pass_context m_context{};
+
+    void run_function(ir::module& mod, ir::function& fn, pass_context& context, std::vector<pass_timing>& timings) const noexcept;
+public:
+    // The pipeline for an optimization level.
+    static pass_manager for_level(opt_level level, const target_info& target = {}) noexcept;
+
+    void add(pass p) noexcept;
+    inline void set_hook(hook h) noexcept { m_hook = std::move(h); }
+    inline pass_context& context() noexcept { return m_context; }
+    inline const std::vector<remark>& remarks() const noexcept { return m_context.remarks(); }
+
+    void run(ir::module& mod, thread_pool& pool) noexcept;
+
+    inline bool empty() const noexcept { return m_passes.empty(); }
+    // Total time spent in each pass, in pipeline order.
+    inline const std::vector<pass_timing>& timings() const noexcept { return m_timings; }
+    // The timings as a table, for --time-passes.
+    std::string report() const noexcept;
+};
+
+} // namespace opt
+COMPILER_API_END
+
+#define _COMPILER_OPT_PASS_MANAGER_HPP
+#endif // !_COMPILER_OPT_PASS_MANAGER_HPP
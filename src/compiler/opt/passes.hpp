@@ -0,0 +1,57 @@
+#ifndef _COMPILER_OPT_PASSES_HPP
+
+#include "../../common/common.hpp"
+
+#include "pass_manager.hpp"
+
+COMPILER_API_BEGIN
+namespace opt {
+
+// Promote allocas that are only loaded from and stored to into SSA values, with phis
+// placed on the iterated dominance frontier. Allocas only accessed at constant offsets are
+// split into one alloca per offset first (scalar replacement), so those get promoted too.
+std::uint8_t mem2reg(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+
+/*
+  Inline calls to functions defined in the module. Functions are optimized callees first,
+  so a callee is already as small as it gets when its cost is looked at: its instruction
+  count, minus what constant arguments will fold away. Calls cheaper than the threshold
+  are inlined, the threshold is bigger for functions declared "inline" and for calls
+  inside of loops.
+
+  Each function may grow by about its own size and the whole module by half of its size,
+  so inlining stays linear on huge translation units. Calls inside of a recursive cycle
+  are never inlined.
+*/
+std::uint8_t inline_calls(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+
+// Sparse conditional constant propagation (Wegman & Zadeck). Folds constants through phis
+// and branches at the same time, blocks that turn out to be unreachable are removed.
+std::uint8_t sccp(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+
+// Global value numbering over the dominator tree: pure instructions computed again in a
+// dominated block are replaced by the first one. Also folds constants and simple algebraic
+// identities (x + 0, x - x...) on the way.
+std::uint8_t gvn(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+
+/*
+  Loop vectorization. Innermost counted loops ("for (i = start; i < n; i++)") whose body is
+  straight-line code over a[i], b[i]... are widened to the targets vector registers: every
+  iteration of the vector loop does as many iterations of the original as fit in a vector.
+  Sums (and and/or/xor reductions) are kept in a vector and combined once the loop is done.
+
+  The original loop stays behind as the scalar epilogue, it runs the iterations that don't
+  fill a whole vector, and all of them when the pointers overlap at run time. Every loop
+  gets a remark saying it was vectorized, or why not.
+*/
+std::uint8_t vectorize(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+
+// Remove instructions whose results are never used and have no side effects, and blocks
+// that can't be reached.
+std::uint8_t dce(ir::module& mod, ir::function& fn, analysis_manager& analyses, pass_context& context) noexcept;
+
+} // namespace opt
+COMPILER_API_END
+
+#define _COMPILER_OPT_PASSES_HPP
+#endif // !_COMPILER_OPT_PASSES_HPP
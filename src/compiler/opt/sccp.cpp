@@ -0,0 +1,300 @@
+#include "passes.hpp"
+#include "fold.hpp"
+
+#include "../ir/use_lists.hpp"
+
+#include <algorithm>
+
+using namespace compiler;
+using namespace compiler::ir;
+
+namespace {
+
+// unknown -> constant -> overdefined, values only ever move to the right.
+enum class lattice : std::uint8_t {
+    unknown,
+    constant,
+    overdefined,
+};
+
+struct lattice_value {
+    lattice state{ lattice::unknown };
+    std::int64_t value{ 0 };
+};
+
+class propagator {
+private:
+    function& m_fn;
+    const cfg& m_cfg;
+    const use_lists m_uses;
+
+    std::vector<lattice_value> m_values{};
+    std::vector<std::uint8_t> m_executable{};
+    // the executable edges into each block, as indices into cfg::preds().
+    std::vector<std::vector<std::uint8_t>> m_edges{};
+
+    std::vector<block_id> m_block_worklist{};
+    std::vector<value_id> m_value_worklist{};
+public:
+    propagator(function& fn, const cfg& graph) noexcept
+        : m_fn(fn)
+        , m_cfg(graph)
+        , m_uses(fn)
+    {
+        m_values.resize(fn.value_count());
+        m_executable.assign(fn.block_count(), 0);
+        m_edges.resize(fn.block_count());
+        for (block_id b = 0; b < fn.block_count(); ++b) {
+            m_edges[b].assign(graph.preds(b).size(), 0);
+        }
+    }
+
+    void solve() noexcept {
+        m_executable[m_fn.entry()] = 1;
+        m_block_worklist.push_back(m_fn.entry());
+        propagate();
+
+        // a branch on a value that never got one (a cycle of phis that only feed each
+        // other) would leave both of its successors unreachable, assume it goes both ways.
+        for (bool resolved = true; resolved;) {
+            resolved = false;
+            for (block_id block = 0; block < m_fn.block_count(); ++block) {
+                const auto term = m_executable[block] ? m_fn.terminator(block) : invalid_id;
+                if (term == invalid_id || m_fn.inst(term).op != opcode::cond_br) {
+                    continue;
+                }
+                const auto condition = m_fn.operand(term, 0);
+                if (m_values[condition].state == lattice::unknown) {
+                    overdefine(condition);
+                    visit(term);
+                    resolved = true;
+                }
+            }
+            propagate();
+        }
+    }
+
+    void propagate() noexcept {
+        while (!m_block_worklist.empty() || !m_value_worklist.empty()) {
+            while (!m_value_worklist.empty()) {
+                const auto value = m_value_worklist.back();
+                m_value_worklist.pop_back();
+                for (const auto& use : m_uses.uses(value)) {
+                    const auto block = m_fn.inst(use.user).block;
+                    if (block != invalid_id && m_executable[block]) {
+                        visit(use.user);
+                    }
+                }
+            }
+            if (!m_block_worklist.empty()) {
+                const auto block = m_block_worklist.back();
+                m_block_worklist.pop_back();
+                m_fn.for_each_inst(block, [&](value_id id) { visit(id); });
+            }
+        }
+    }
+
+    // Rewrite the function with what we found, returns true if the CFG changed.
+    bool rewrite() noexcept {
+        for (const auto block : m_cfg.rpo()) {
+            if (!m_executable[block]) {
+                continue;
+            }
+            m_fn.for_each_inst(block, [&](value_id id) {
+                const auto& inst = m_fn.inst(id);
+                if (m_values[id].state == lattice::constant && inst.op != opcode::iconst && inst.type != value_type::void_) {
+                    opt::make_constant(m_fn, id, m_values[id].value);
+                }
+            });
+        }
+
+        bool changed = false;
+        for (const auto block : m_cfg.rpo()) {
+            if (!m_executable[block]) {
+                continue;
+            }
+            const auto term = m_fn.terminator(block);
+            if (term == invalid_id || m_fn.inst(term).op != opcode::cond_br) {
+                continue;
+            }
+            const auto if_true = m_fn.target(term, 0);
+            const auto if_false = m_fn.target(term, 1);
+            const bool takes_true = is_edge_executable(block, if_true);
+            const bool takes_false = is_edge_executable(block, if_false);
+            if (if_true == if_false || takes_true == takes_false) {
+                continue;
+            }
+
+            // only one way out, the other successor loses this block as a predecessor.
+            const auto taken = takes_true ? if_true : if_false;
+            const auto dropped = takes_true ? if_false : if_true;
+            remove_incoming(block, dropped);
+            auto& inst = m_fn.inst(term);
+            inst.op = opcode::br;
+            inst.operand_count = 0;
+            m_fn.set_target(term, 0, taken);
+            changed = true;
+        }
+
+        for (block_id block = 0; block < m_fn.block_count(); ++block) {
+            if (m_executable[block] || m_fn.block(block).removed) {
+                continue;
+            }
+            m_fn.for_each_successor(block, [&](block_id succ) { remove_incoming(block, succ); });
+            m_fn.remove_block(block);
+            changed = true;
+        }
+        return changed;
+    }
+private:
+    bool is_edge_executable(block_id from, block_id to) const noexcept {
+        const auto preds = m_cfg.preds(to);
+        for (std::size_t i = 0; i < preds.size(); ++i) {
+            if (preds[i] == from && m_edges[to][i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void remove_incoming(block_id from, block_id to) noexcept {
+        m_fn.for_each_inst(to, [&](value_id id) {
+            if (m_fn.inst(id).op == opcode::phi) {
+                m_fn.remove_phi_incoming(id, from);
+            }
+        });
+    }
+
+    void mark_edge(block_id from, block_id to) noexcept {
+        const auto preds = m_cfg.preds(to);
+        bool added = false;
+        for (std::size_t i = 0; i < preds.size(); ++i) {
+            if (preds[i] == from && !m_edges[to][i]) {
+                m_edges[to][i] = 1;
+                added = true;
+            }
+        }
+        if (!added) {
+            return;
+        }
+        if (!m_executable[to]) {
+            m_executable[to] = 1;
+            m_block_worklist.push_back(to);
+            return;
+        }
+        // already visited, only its phis can see something new.
+        m_fn.for_each_inst(to, [&](value_id id) {
+            if (m_fn.inst(id).op == opcode::phi) {
+                visit(id);
+            }
+        });
+    }
+
+    void set(value_id id, lattice_value value) noexcept {
+        auto& current = m_values[id];
+        if (current.state == value.state && (value.state != lattice::constant || current.value == value.value)) {
+            return;
+        }
+        current = value;
+        m_value_worklist.push_back(id);
+    }
+
+    inline void overdefine(value_id id) noexcept {
+        set(id, lattice_value{ lattice::overdefined });
+    }
+
+    void visit_phi(value_id id, const instruction& inst) noexcept {
+        const auto preds = m_cfg.preds(inst.block);
+        lattice_value result{};
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            const auto from = m_fn.target(id, i);
+            if (!is_edge_executable(from, inst.block)) {
+                continue;
+            }
+            const auto& incoming = m_values[m_fn.operand(id, i)];
+            if (incoming.state == lattice::unknown) {
+                continue;
+            }
+            if (incoming.state == lattice::overdefined
+                || (result.state == lattice::constant && result.value != incoming.value)) {
+                overdefine(id);
+                return;
+            }
+            result = incoming;
+        }
+        if (result.state != lattice::unknown) {
+            set(id, result);
+        }
+    }
+
+    void visit(value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        if (m_values[id].state == lattice::overdefined) {
+            return;
+        }
+
+        switch (inst.op) {
+        case opcode::iconst:
+            set(id, lattice_value{ lattice::constant, opt::normalize(inst.type, inst.imm) });
+            return;
+        case opcode::phi:
+            visit_phi(id, inst);
+            return;
+        case opcode::br:
+            mark_edge(inst.block, m_fn.target(id, 0));
+            return;
+        case opcode::cond_br: {
+            const auto& condition = m_values[m_fn.operand(id, 0)];
+            if (condition.state == lattice::unknown) {
+                return;
+            }
+            if (condition.state == lattice::constant) {
+                mark_edge(inst.block, m_fn.target(id, condition.value != 0 ? 0 : 1));
+                return;
+            }
+            mark_edge(inst.block, m_fn.target(id, 0));
+            mark_edge(inst.block, m_fn.target(id, 1));
+            return;
+        }
+        default:
+            break;
+        }
+
+        if (inst.type == value_type::void_) {
+            return;
+        }
+        if (!opt::is_foldable(inst.op)) {
+            overdefine(id);
+            return;
+        }
+
+        std::int64_t operands[2]{};
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            const auto& operand = m_values[m_fn.operand(id, i)];
+            if (operand.state == lattice::overdefined) {
+                overdefine(id);
+                return;
+            }
+            if (operand.state == lattice::unknown) {
+                return;
+            }
+            operands[i] = operand.value;
+        }
+        const auto operand_type = m_fn.inst(m_fn.operand(id, 0)).type;
+        const auto folded = opt::fold(inst.op, inst.type, inst.imm, operand_type, { operands, inst.operand_count });
+        if (folded) {
+            set(id, lattice_value{ lattice::constant, *folded });
+        }
+        else {
+            overdefine(id);
+        }
+    }
+};
+
+} // namespace
+
+std::uint8_t opt::sccp(module&, function& fn, analysis_manager& analyses, pass_context&) noexcept {
+    auto solver = propagator{ fn, analyses.graph() };
+    solver.solve();
+    return solver.rewrite() ? preserve_none : preserve_all;
+}
@@ -0,0 +1,819 @@
+#include "passes.hpp"
+#include "fold.hpp"
+
+#include "../ir/builder.hpp"
+#include "../ir/use_lists.hpp"
+
+#include <algorithm>
+#include <format>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace compiler;
+using namespace compiler::ir;
+using namespace compiler::opt;
+
+namespace {
+
+// What an instruction of the loop becomes in the vector loop.
+enum class shape : std::uint8_t {
+    unknown,
+    // the same in every iteration, it's computed once before the vector loop.
+    uniform,
+    // the induction variable, or it extended to 64 bits.
+    index,
+    // base + index * lane size, a[i].
+    address,
+    // induction + 1, it only feeds the induction phi.
+    increment,
+    // one lane per iteration.
+    vector,
+    // one lane per iteration, but only the low bits (as many as fit in a lane) are right.
+    // That's C's integer promotion, "char + char" is computed as an int and truncated back.
+    narrowed,
+    // a reduction phi, or the instruction that updates it.
+    reduction,
+};
+
+// "sum = sum op x" where op is add, and_, or_ or xor_. They're associative and commutative
+// (integer add wraps), so every lane can keep a part of the result and they're combined
+// after the loop.
+struct reduction {
+    value_id phi;
+    value_id update;
+    value_id init;
+    opcode op;
+};
+
+// A loop that can be vectorized, and everything the rewrite needs to know about it.
+struct plan {
+    block_id header{ invalid_id };
+    block_id preheader{ invalid_id };
+    block_id latch{ invalid_id };
+    // the blocks after the header, in the order they run.
+    std::vector<block_id> body{};
+    value_id induction{ invalid_id };
+    value_id start{ invalid_id };
+    value_id bound{ invalid_id };
+    // "induction < bound" is a signed comparison.
+    bool is_signed{ true };
+    // the size of a lane in bytes, it's the size of every load and store in the loop.
+    std::uint32_t lane_size{ 0 };
+    value_type vector{ value_type::void_ };
+    std::vector<reduction> reductions{};
+    // the pointers that are stored through, and the ones that are only loaded from.
+    std::vector<value_id> stored{};
+    std::vector<value_id> loaded{};
+    // the pairs of pointers that have to be far enough apart at run time.
+    std::vector<std::pair<value_id, value_id>> checks{};
+};
+
+// More pointer pairs than this and the checks cost more than the loop saves.
+constexpr std::size_t max_runtime_checks = 8;
+
+constexpr bool is_reduction_op(opcode op) noexcept {
+    return op == opcode::add || op == opcode::and_ || op == opcode::or_ || op == opcode::xor_;
+}
+
+class loop_vectorizer {
+private:
+    function& m_fn;
+    const cfg& m_cfg;
+    const loop_info& m_loops;
+    pass_context& m_context;
+    const use_lists m_uses;
+
+    std::vector<shape> m_shapes{};
+    loop_id m_loop{ invalid_id };
+    std::string m_reason{};
+
+    // the value standing in for an instruction of the loop in the vector loop, by the id of
+    // the original.
+    std::vector<value_id> m_map{};
+    std::vector<value_id> m_splats{};
+public:
+    loop_vectorizer(function& fn, const cfg& graph, const loop_info& loops, pass_context& context) noexcept
+        : m_fn(fn)
+        , m_cfg(graph)
+        , m_loops(loops)
+        , m_context(context)
+        , m_uses(fn)
+    {
+        m_shapes.assign(fn.value_count(), shape::unknown);
+    }
+
+    // Why the last loop given to analyze() can't be vectorized, only set if the context
+    // wants remarks.
+    inline const std::string& reason() const noexcept { return m_reason; }
+
+    bool analyze(loop_id id, plan& p) noexcept {
+        m_loop = id;
+        m_reason.clear();
+        p.header = m_loops.get(id).header;
+
+        const auto blocks = m_loops.blocks(id);
+        for (const auto block : blocks) {
+            if (m_loops.loop_of(block) != id) {
+                return fail("it isn't an innermost loop");
+            }
+        }
+        p.preheader = m_loops.preheader(m_fn, m_cfg, id);
+        if (p.preheader == invalid_id) {
+            return fail("it has no preheader");
+        }
+        for (const auto pred : m_cfg.preds(p.header)) {
+            if (!m_loops.contains(id, pred)) {
+                continue;
+            }
+            if (p.latch != invalid_id) {
+                return fail("it has more than one back edge");
+            }
+            p.latch = pred;
+        }
+
+        // the header decides whether to go on, and the body is a straight line back to it.
+        const auto term = m_fn.terminator(p.header);
+        if (m_fn.inst(term).op != opcode::cond_br) {
+            return fail("it doesn't exit at the top");
+        }
+        const auto if_true = m_fn.target(term, 0);
+        const auto if_false = m_fn.target(term, 1);
+        const bool exits_on_true = !m_loops.contains(id, if_true);
+        if (exits_on_true == !m_loops.contains(id, if_false)) {
+            return fail("it has control flow in the body");
+        }
+        for (auto block = exits_on_true ? if_false : if_true;;) {
+            if (block == p.header || p.body.size() >= blocks.size() || m_cfg.preds(block).size() != 1) {
+                return fail("it has control flow in the body");
+            }
+            p.body.push_back(block);
+            const auto last = m_fn.terminator(block);
+            if (m_fn.inst(last).op != opcode::br) {
+                return fail("it has control flow in the body");
+            }
+            block = m_fn.target(last, 0);
+            if (block == p.header) {
+                break;
+            }
+        }
+        if (p.body.size() + 1 != blocks.size()) {
+            return fail("it has control flow in the body");
+        }
+
+        if (!analyze_condition(p, term, exits_on_true) || !analyze_phis(p)) {
+            return false;
+        }
+        for (const auto block : p.body) {
+            bool ok = true;
+            m_fn.for_each_inst(block, [&](value_id id) {
+                ok = ok && classify(p, id);
+            });
+            if (!ok) {
+                return false;
+            }
+        }
+
+        if (p.lane_size == 0) {
+            return fail("it doesn't access memory");
+        }
+        const auto lane = lane_type(p.lane_size);
+        p.vector = vector_of(lane, m_context.target().vector_bytes);
+        if (p.vector == value_type::void_) {
+            return fail("the target has no vectors of {}", value_type_to_string(lane));
+        }
+
+        // different pointers may still point into the same array, every pointer that's
+        // stored through is checked against every other one.
+        for (std::size_t i = 0; i < p.stored.size(); ++i) {
+            for (std::size_t j = i + 1; j < p.stored.size(); ++j) {
+                p.checks.push_back({ p.stored[i], p.stored[j] });
+            }
+            for (const auto other : p.loaded) {
+                p.checks.push_back({ p.stored[i], other });
+            }
+        }
+        if (p.checks.size() > max_runtime_checks) {
+            return fail("it would need {} runtime checks for overlapping pointers", p.checks.size());
+        }
+        return true;
+    }
+
+    void rewrite(const plan& p) noexcept {
+        auto b = builder{ m_fn };
+        const auto iv_type = m_fn.inst(p.induction).type;
+        const auto lanes = static_cast<std::int64_t>(lane_count(p.vector));
+        m_map.assign(m_shapes.size(), invalid_id);
+        m_splats.assign(m_shapes.size(), invalid_id);
+
+        const auto check = m_fn.create_block();
+        const auto setup = m_fn.create_block();
+        const auto body = m_fn.create_block();
+        const auto done = m_fn.create_block();
+        const auto scalar = m_fn.create_block();
+        m_fn.set_target(m_fn.terminator(p.preheader), 0, check);
+
+        // is there at least one whole vector of iterations? The count is computed in 64
+        // bits, so "bound - start" can't overflow.
+        b.set_insert_point(check);
+        const auto widen = [&](value_id value) {
+            value = invariant(b, value);
+            return iv_type == value_type::i64 ? value : b.cast(p.is_signed ? opcode::sext : opcode::zext, value_type::i64, value);
+        };
+        const auto start = invariant(b, p.start);
+        const auto entered = b.icmp(p.is_signed ? cmp_pred::slt : cmp_pred::ult, start, invariant(b, p.bound));
+        const auto first = widen(p.start);
+        const auto count = b.binary(opcode::sub, value_type::i64, widen(p.bound), first);
+        const auto vector_count = b.binary(opcode::and_, value_type::i64, count, b.iconst(value_type::i64, -lanes));
+        const auto nonzero = b.icmp(cmp_pred::ne, vector_count, b.iconst(value_type::i64, 0));
+        b.cond_br(b.binary(opcode::and_, value_type::i1, entered, nonzero), setup, scalar);
+
+        // everything that doesn't change between iterations, and the overlap checks.
+        b.set_insert_point(setup);
+        m_fn.for_each_inst(p.header, [&](value_id id) {
+            if (m_fn.inst(id).op == opcode::iconst) {
+                clone_uniform(b, id);
+            }
+        });
+        for (const auto block : p.body) {
+            m_fn.for_each_inst(block, [&](value_id id) {
+                if (m_shapes[id] == shape::uniform) {
+                    clone_uniform(b, id);
+                }
+            });
+        }
+        const auto span = static_cast<std::int64_t>(size_of(p.vector));
+        auto no_overlap = invalid_id;
+        for (const auto& [x, y] : p.checks) {
+            // |y - x| >= span, or they're the same pointer.
+            const auto distance = b.binary(opcode::sub, value_type::i64,
+                b.cast(opcode::bitcast, value_type::i64, scalar_of(y)),
+                b.cast(opcode::bitcast, value_type::i64, scalar_of(x)));
+            const auto biased = b.binary(opcode::add, value_type::i64, distance, b.iconst(value_type::i64, span - 1));
+            const auto far = b.icmp(cmp_pred::uge, biased, b.iconst(value_type::i64, 2 * span - 1));
+            const auto same = b.icmp(cmp_pred::eq, distance, b.iconst(value_type::i64, 0));
+            const auto safe = b.binary(opcode::or_, value_type::i1, far, same);
+            no_overlap = no_overlap == invalid_id ? safe : b.binary(opcode::and_, value_type::i1, no_overlap, safe);
+        }
+        const auto zero = b.iconst(value_type::i64, 0);
+        std::vector<value_id> identities;
+        for (const auto& r : p.reductions) {
+            const auto type = m_fn.inst(r.phi).type;
+            identities.push_back(b.unary(opcode::broadcast, p.vector, b.iconst(type, r.op == opcode::and_ ? -1 : 0)));
+        }
+        const auto setup_term = no_overlap == invalid_id ? b.br(body) : b.cond_br(no_overlap, body, scalar);
+
+        // the vector loop, "lanes" iterations of the original at a time.
+        b.set_insert_point(body);
+        const auto j = b.phi(value_type::i64, 2);
+        std::vector<value_id> accumulators;
+        for (const auto& r : p.reductions) {
+            const auto phi = b.phi(p.vector, 2);
+            m_map[r.phi] = phi;
+            accumulators.push_back(phi);
+        }
+        const auto& start_inst = m_fn.inst(p.start);
+        const auto index = start_inst.op == opcode::iconst && start_inst.imm == 0
+            ? j
+            : b.binary(opcode::add, value_type::i64, first, j);
+        m_map[p.induction] = index;
+
+        for (const auto block : p.body) {
+            m_fn.for_each_inst(block, [&](value_id id) {
+                widen_instruction(b, p, id, setup_term);
+            });
+        }
+        const auto next = b.binary(opcode::add, value_type::i64, j, b.iconst(value_type::i64, lanes));
+        b.cond_br(b.icmp(cmp_pred::ne, next, vector_count), body, done);
+        m_fn.set_phi_incoming(j, 0, zero, setup);
+        m_fn.set_phi_incoming(j, 1, next, body);
+        for (std::size_t i = 0; i < p.reductions.size(); ++i) {
+            m_fn.set_phi_incoming(accumulators[i], 0, identities[i], setup);
+            m_fn.set_phi_incoming(accumulators[i], 1, m_map[p.reductions[i].update], body);
+        }
+
+        // where the scalar loop picks up.
+        b.set_insert_point(done);
+        const auto resume = iv_type == value_type::i64
+            ? b.binary(opcode::add, iv_type, start, vector_count)
+            : b.binary(opcode::add, iv_type, start, b.cast(opcode::trunc, iv_type, vector_count));
+        std::vector<value_id> totals;
+        for (const auto& r : p.reductions) {
+            const auto type = m_fn.inst(r.phi).type;
+            const auto lanes_combined = b.emit(opcode::reduce, type, { m_map[r.update] }, static_cast<std::int64_t>(r.op));
+            totals.push_back(b.binary(r.op, type, lanes_combined, invariant(b, r.init)));
+        }
+        b.br(scalar);
+
+        // the original loop is the epilogue, and everything the vector loop couldn't do.
+        b.set_insert_point(scalar);
+        const auto from_setup = no_overlap != invalid_id;
+        const auto incoming = from_setup ? 3u : 2u;
+        const auto resume_phi = b.phi(iv_type, incoming);
+        m_fn.set_phi_incoming(resume_phi, 0, start, check);
+        m_fn.set_phi_incoming(resume_phi, 1, resume, done);
+        if (from_setup) {
+            m_fn.set_phi_incoming(resume_phi, 2, start, setup);
+        }
+        retarget_incoming(p.induction, p.preheader, scalar, resume_phi);
+
+        for (std::size_t i = 0; i < p.reductions.size(); ++i) {
+            const auto& r = p.reductions[i];
+            const auto phi = b.phi(m_fn.inst(r.phi).type, incoming);
+            m_fn.set_phi_incoming(phi, 0, r.init, check);
+            m_fn.set_phi_incoming(phi, 1, totals[i], done);
+            if (from_setup) {
+                m_fn.set_phi_incoming(phi, 2, r.init, setup);
+            }
+            retarget_incoming(r.phi, p.preheader, scalar, phi);
+        }
+        // dead phis keep their value, it's from before the loop so it's still available.
+        m_fn.for_each_inst(p.header, [&](value_id phi) {
+            if (m_fn.inst(phi).op == opcode::phi) {
+                for (std::uint32_t i = 0; i < m_fn.inst(phi).operand_count; ++i) {
+                    if (m_fn.target(phi, i) == p.preheader) {
+                        m_fn.set_phi_incoming(phi, i, m_fn.operand(phi, i), scalar);
+                    }
+                }
+            }
+        });
+        b.br(p.header);
+    }
+private:
+    template<class... Args>
+    bool fail(std::format_string<Args...> fmt, Args&&... args) {
+        if (m_context.wants_remarks()) {
+            m_reason = std::format(fmt, std::forward<Args>(args)...);
+        }
+        return false;
+    }
+
+    static value_type lane_type(std::uint32_t size) noexcept {
+        switch (size) {
+        case 1: return value_type::i8;
+        case 2: return value_type::i16;
+        case 4: return value_type::i32;
+        default: return value_type::i64;
+        }
+    }
+
+    inline bool in_loop(value_id id) const noexcept {
+        const auto block = m_fn.inst(id).block;
+        return block != invalid_id && m_loops.loop_of(block) == m_loop;
+    }
+
+    inline shape shape_of(value_id id) const noexcept {
+        if (!in_loop(id) || m_fn.inst(id).op == opcode::iconst) {
+            return shape::uniform;
+        }
+        return m_shapes[id];
+    }
+
+    inline bool is_vector_shape(shape s) const noexcept {
+        return s == shape::vector || s == shape::narrowed;
+    }
+
+    // Every load and store has to be the same size, that's the size of a lane.
+    bool set_lane_size(plan& p, value_type type) noexcept {
+        if (type < value_type::i8 || type > value_type::i64) {
+            return fail("it accesses {} values", value_type_to_string(type));
+        }
+        const auto size = static_cast<std::uint32_t>(size_of(type));
+        if (p.lane_size != 0 && p.lane_size != size) {
+            return fail("it mixes {}-bit and {}-bit elements", p.lane_size * 8, size * 8);
+        }
+        p.lane_size = size;
+        return true;
+    }
+
+    // "induction < bound", the induction variable starts somewhere outside of the loop and
+    // goes up by one.
+    bool analyze_condition(plan& p, value_id term, bool exits_on_true) noexcept {
+        const auto condition = m_fn.operand(term, 0);
+        const auto& cmp = m_fn.inst(condition);
+        if (cmp.op != opcode::icmp || cmp.block != p.header) {
+            return fail("it isn't a counted loop");
+        }
+        auto pred = static_cast<cmp_pred>(cmp.imm);
+        if (exits_on_true) {
+            pred = inverse(pred);
+        }
+        auto lhs = m_fn.operand(condition, 0);
+        auto rhs = m_fn.operand(condition, 1);
+        const auto is_header_phi = [&](value_id id) {
+            const auto& inst = m_fn.inst(id);
+            return inst.op == opcode::phi && inst.block == p.header;
+        };
+        if (!is_header_phi(lhs)) {
+            std::swap(lhs, rhs);
+            pred = swapped(pred);
+        }
+        if (!is_header_phi(lhs) || (pred != cmp_pred::slt && pred != cmp_pred::ult)) {
+            return fail("it isn't a counted loop, the condition should be `i < n`");
+        }
+        if (shape_of(rhs) != shape::uniform) {
+            return fail("the trip count changes inside of the loop");
+        }
+        const auto type = m_fn.inst(lhs).type;
+        if (type != value_type::i32 && type != value_type::i64) {
+            return fail("the induction variable is a {}", value_type_to_string(type));
+        }
+        p.induction = lhs;
+        p.bound = rhs;
+        p.is_signed = pred == cmp_pred::slt;
+
+        auto step = invalid_id;
+        for (std::uint32_t i = 0; i < m_fn.inst(lhs).operand_count; ++i) {
+            if (m_fn.target(lhs, i) == p.preheader) {
+                p.start = m_fn.operand(lhs, i);
+            }
+            else {
+                step = m_fn.operand(lhs, i);
+            }
+        }
+        const auto is_one = [&](value_id id) {
+            const auto& inst = m_fn.inst(id);
+            return inst.op == opcode::iconst && opt::normalize(inst.type, inst.imm) == 1;
+        };
+        const auto& add = m_fn.inst(step);
+        if (add.op != opcode::add || !in_loop(step) || add.block == p.header
+            || !((m_fn.operand(step, 0) == lhs && is_one(m_fn.operand(step, 1)))
+                || (m_fn.operand(step, 1) == lhs && is_one(m_fn.operand(step, 0))))) {
+            return fail("the induction variable doesn't go up by one");
+        }
+        for (const auto& use : m_uses.uses(step)) {
+            if (use.user != lhs) {
+                return fail("the induction variable is used as a value");
+            }
+        }
+        m_shapes[lhs] = shape::index;
+        m_shapes[step] = shape::increment;
+
+        // dead instructions are fine too, dce hasn't run yet.
+        bool header_ok = true;
+        m_fn.for_each_inst(p.header, [&](value_id id) {
+            const auto op = m_fn.inst(id).op;
+            header_ok = header_ok && (op == opcode::phi || op == opcode::iconst || id == condition || id == term
+                || (!has_side_effects(op) && m_uses.uses(id).empty()));
+        });
+        if (!header_ok) {
+            return fail("the loop condition does more than compare the induction variable");
+        }
+        return true;
+    }
+
+    // Every other phi of the header has to be a reduction.
+    bool analyze_phis(plan& p) noexcept {
+        bool ok = true;
+        m_fn.for_each_inst(p.header, [&](value_id phi) {
+            // a dead phi is left for dce, like a variable declared in the body.
+            if (!ok || m_fn.inst(phi).op != opcode::phi || phi == p.induction || m_uses.uses(phi).empty()) {
+                return;
+            }
+            reduction r{ phi, invalid_id, invalid_id, opcode::nop };
+            for (std::uint32_t i = 0; i < m_fn.inst(phi).operand_count; ++i) {
+                if (m_fn.target(phi, i) == p.preheader) {
+                    r.init = m_fn.operand(phi, i);
+                }
+                else {
+                    r.update = m_fn.operand(phi, i);
+                }
+            }
+            const auto& update = m_fn.inst(r.update);
+            r.op = update.op;
+            bool is_reduction = in_loop(r.update) && update.block != p.header && is_reduction_op(update.op)
+                && (m_fn.operand(r.update, 0) == phi) != (m_fn.operand(r.update, 1) == phi);
+            // the phi and its update only feed each other inside of the loop.
+            for (const auto& use : m_uses.uses(phi)) {
+                is_reduction = is_reduction && (use.user == r.update || !in_loop(use.user));
+            }
+            for (const auto& use : m_uses.uses(r.update)) {
+                is_reduction = is_reduction && use.user == phi;
+            }
+            if (!is_reduction) {
+                ok = fail("%{} depends on the previous iteration", phi);
+                return;
+            }
+            m_shapes[phi] = shape::reduction;
+            m_shapes[r.update] = shape::reduction;
+            p.reductions.push_back(r);
+        });
+        return ok;
+    }
+
+    // Does the target have this operation on lanes of "p.lane_size"?
+    bool is_supported(const plan& p, opcode op, bool narrowed) noexcept {
+        const auto size = p.lane_size;
+        bool ok = false;
+        switch (op) {
+        case opcode::add:
+        case opcode::sub:
+        case opcode::and_:
+        case opcode::or_:
+        case opcode::xor_:
+        case opcode::neg:
+        case opcode::not_:
+            ok = true;
+            break;
+        case opcode::mul:
+            // pmullw is SSE2, pmulld needs SSE4.1, which every AVX2 machine has.
+            ok = size == 2 || (size == 4 && m_context.target().vector_bytes >= 32);
+            break;
+        case opcode::shl:
+            ok = size >= 2;
+            break;
+        case opcode::lshr:
+            ok = size >= 2 && !narrowed;
+            break;
+        case opcode::ashr:
+            ok = (size == 2 || size == 4) && !narrowed;
+            break;
+        default:
+            break;
+        }
+        if (!ok && narrowed && (op == opcode::lshr || op == opcode::ashr)) {
+            return fail("it shifts a promoted {}-bit value right", size * 8);
+        }
+        return ok || fail("the target has no {}-bit vector `{}`", size * 8, opcode_to_string(op));
+    }
+
+    bool classify(plan& p, value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        if (m_shapes[id] == shape::increment) {
+            return true;
+        }
+        if (m_shapes[id] == shape::reduction) {
+            // the phi was checked already, but not what's added to it.
+            const auto& r = *std::find_if(p.reductions.begin(), p.reductions.end(), [&](const reduction& r) { return r.update == id; });
+            const auto value = m_fn.operand(id, 0) == r.phi ? m_fn.operand(id, 1) : m_fn.operand(id, 0);
+            const auto s = shape_of(value);
+            if (s != shape::vector && s != shape::uniform) {
+                return fail("it can't reduce %{}", value);
+            }
+            return set_lane_size(p, inst.type);
+        }
+
+        switch (inst.op) {
+        case opcode::nop:
+        case opcode::br:
+            return true;
+        case opcode::iconst:
+            m_shapes[id] = shape::uniform;
+            return true;
+        case opcode::ptr_add: {
+            const auto base = shape_of(m_fn.operand(id, 0));
+            const auto index = m_fn.operand(id, 1);
+            if (base == shape::uniform && shape_of(index) == shape::uniform) {
+                m_shapes[id] = shape::uniform;
+                return true;
+            }
+            if (base != shape::uniform || shape_of(index) != shape::index || m_fn.inst(index).type != value_type::i64) {
+                return fail("it has a memory access that isn't unit stride");
+            }
+            m_shapes[id] = shape::address;
+            return true;
+        }
+        case opcode::load:
+        case opcode::store: {
+            const auto address = m_fn.operand(id, 0);
+            const auto type = inst.op == opcode::load ? inst.type : m_fn.inst(m_fn.operand(id, 1)).type;
+            if (shape_of(address) != shape::address || m_fn.inst(address).imm != static_cast<std::int64_t>(size_of(type))) {
+                return fail("it has a memory access that isn't unit stride");
+            }
+            if (!set_lane_size(p, type)) {
+                return false;
+            }
+            const auto base = m_fn.operand(address, 0);
+            if (inst.op == opcode::store) {
+                const auto value = shape_of(m_fn.operand(id, 1));
+                if (value != shape::vector && value != shape::uniform) {
+                    return fail("it stores %{}", m_fn.operand(id, 1));
+                }
+                if (std::find(p.stored.begin(), p.stored.end(), base) == p.stored.end()) {
+                    p.stored.push_back(base);
+                    std::erase(p.loaded, base);
+                }
+            }
+            else if (std::find(p.stored.begin(), p.stored.end(), base) == p.stored.end()
+                && std::find(p.loaded.begin(), p.loaded.end(), base) == p.loaded.end()) {
+                p.loaded.push_back(base);
+            }
+            m_shapes[id] = shape::vector;
+            return true;
+        }
+        case opcode::sext:
+        case opcode::zext:
+        case opcode::trunc:
+        case opcode::bitcast: {
+            const auto value = m_fn.operand(id, 0);
+            const auto s = shape_of(value);
+            if (s == shape::uniform) {
+                m_shapes[id] = shape::uniform;
+                return true;
+            }
+            if (s == shape::index && value == p.induction && inst.type == value_type::i64
+                && inst.op == (p.is_signed ? opcode::sext : opcode::zext)) {
+                m_shapes[id] = shape::index;
+                return true;
+            }
+            if (!is_vector_shape(s)) {
+                return fail("the induction variable is used as a value");
+            }
+            // the lanes keep their size, only which of their bits are right changes.
+            const auto size = size_of(inst.type);
+            if (size < p.lane_size) {
+                return fail("it mixes {}-bit and {}-bit elements", p.lane_size * 8, size * 8);
+            }
+            m_shapes[id] = size == p.lane_size ? shape::vector : shape::narrowed;
+            return true;
+        }
+        default:
+            break;
+        }
+
+        if (is_binary(inst.op) || inst.op == opcode::neg || inst.op == opcode::not_) {
+            bool narrowed = false;
+            bool uniform = true;
+            for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+                const auto s = shape_of(m_fn.operand(id, i));
+                if (s != shape::uniform && !is_vector_shape(s)) {
+                    return fail("the induction variable is used as a value");
+                }
+                narrowed |= s == shape::narrowed;
+                uniform &= s == shape::uniform;
+            }
+            if (uniform) {
+                m_shapes[id] = shape::uniform;
+                return true;
+            }
+            const bool is_shift = inst.op == opcode::shl || inst.op == opcode::ashr || inst.op == opcode::lshr;
+            if (is_shift && (shape_of(m_fn.operand(id, 1)) != shape::uniform || !is_vector_shape(shape_of(m_fn.operand(id, 0))))) {
+                return fail("it shifts by an amount that changes every iteration");
+            }
+            if (!is_supported(p, inst.op, narrowed)) {
+                return false;
+            }
+            m_shapes[id] = size_of(inst.type) == p.lane_size ? shape::vector : shape::narrowed;
+            return true;
+        }
+
+        switch (inst.op) {
+        case opcode::call: return fail("it contains a call");
+        case opcode::icmp: return fail("it compares values in the body");
+        case opcode::alloca: return fail("it allocates stack memory");
+        case opcode::phi: return fail("it has control flow in the body");
+        default: return fail("the target has no vector `{}`", opcode_to_string(inst.op));
+        }
+    }
+
+    // A value from outside of the loop, constants are copied so the new blocks don't use
+    // one defined inside of the loop.
+    value_id invariant(builder& b, value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        if (inst.op == opcode::iconst && in_loop(id)) {
+            return b.iconst(inst.type, inst.imm);
+        }
+        return id;
+    }
+
+    // The scalar value standing in for "id" before the vector loop.
+    inline value_id scalar_of(value_id id) const noexcept {
+        return in_loop(id) ? m_map[id] : id;
+    }
+
+    void clone_uniform(builder& b, value_id id) noexcept {
+        const auto& inst = m_fn.inst(id);
+        std::vector<value_id> operands;
+        for (std::uint32_t i = 0; i < inst.operand_count; ++i) {
+            operands.push_back(scalar_of(m_fn.operand(id, i)));
+        }
+        const auto copy = m_fn.create(inst.op, inst.type, operands, inst.imm);
+        m_fn.append(b.insert_point(), copy);
+        m_map[id] = copy;
+    }
+
+    // The vector standing in for "id" in the vector loop, values that don't change are
+    // broadcast once, right before it.
+    value_id vector_of_value(const plan& p, value_id id, value_id setup_term) noexcept {
+        if (shape_of(id) != shape::uniform) {
+            return m_map[id];
+        }
+        const auto scalar = scalar_of(id);
+        if (scalar < m_splats.size() && m_splats[scalar] != invalid_id) {
+            return m_splats[scalar];
+        }
+        const auto splat = m_fn.create(opcode::broadcast, p.vector, { &scalar, 1 });
+        m_fn.insert_before(setup_term, splat);
+        if (scalar < m_splats.size()) {
+            m_splats[scalar] = splat;
+        }
+        return splat;
+    }
+
+    void widen_instruction(builder& b, const plan& p, value_id id, value_id setup_term) noexcept {
+        const auto& inst = m_fn.inst(id);
+        switch (m_shapes[id]) {
+        case shape::index:
+            m_map[id] = m_map[p.induction];
+            return;
+        case shape::address:
+            m_map[id] = b.ptr_add(scalar_of(m_fn.operand(id, 0)), m_map[p.induction], inst.imm);
+            return;
+        case shape::reduction: {
+            const auto& r = *std::find_if(p.reductions.begin(), p.reductions.end(), [&](const reduction& r) { return r.update == id; });
+            const auto value = m_fn.operand(id, 0) == r.phi ? m_fn.operand(id, 1) : m_fn.operand(id, 0);
+            m_map[id] = b.binary(inst.op, p.vector, m_map[r.phi], vector_of_value(p, value, setup_term));
+            return;
+        }
+        case shape::vector:
+        case shape::narrowed:
+            break;
+        default:
+            return;
+        }
+
+        switch (inst.op) {
+        case opcode::load:
+            m_map[id] = b.load(p.vector, m_map[m_fn.operand(id, 0)]);
+            return;
+        case opcode::store:
+            b.store(m_map[m_fn.operand(id, 0)], vector_of_value(p, m_fn.operand(id, 1), setup_term));
+            return;
+        case opcode::sext:
+        case opcode::zext:
+        case opcode::trunc:
+        case opcode::bitcast:
+            m_map[id] = m_map[m_fn.operand(id, 0)];
+            return;
+        case opcode::neg:
+        case opcode::not_:
+            m_map[id] = b.unary(inst.op, p.vector, vector_of_value(p, m_fn.operand(id, 0), setup_term));
+            return;
+        case opcode::shl:
+        case opcode::ashr:
+        case opcode::lshr: {
+            // scalar shifts mask the amount, vector shifts by too much give 0 (or the sign).
+            const auto amount = m_fn.operand(id, 1);
+            const auto type = m_fn.inst(amount).type;
+            const auto mask = (inst.type == value_type::i64 || inst.type == value_type::ptr) ? 63 : 31;
+            const auto& constant = m_fn.inst(amount);
+            value_id masked;
+            if (constant.op == opcode::iconst) {
+                masked = b.iconst(type, constant.imm & mask);
+            }
+            else {
+                const auto mask_value = m_fn.create(opcode::iconst, type, {}, mask);
+                m_fn.insert_before(setup_term, mask_value);
+                const auto operands = { scalar_of(amount), mask_value };
+                masked = m_fn.create(opcode::and_, type, { operands.begin(), operands.size() });
+                m_fn.insert_before(setup_term, masked);
+            }
+            m_map[id] = b.binary(inst.op, p.vector, m_map[m_fn.operand(id, 0)], masked);
+            return;
+        }
+        default:
+            m_map[id] = b.binary(inst.op, p.vector,
+                vector_of_value(p, m_fn.operand(id, 0), setup_term),
+                vector_of_value(p, m_fn.operand(id, 1), setup_term));
+            return;
+        }
+    }
+
+    // The incoming value of "phi" from "from" now comes from "to" instead.
+    void retarget_incoming(value_id phi, block_id from, block_id to, value_id value) noexcept {
+        for (std::uint32_t i = 0; i < m_fn.inst(phi).operand_count; ++i) {
+            if (m_fn.target(phi, i) == from) {
+                m_fn.set_phi_incoming(phi, i, value, to);
+            }
+        }
+    }
+};
+
+} // namespace
+
+std::uint8_t opt::vectorize(module&, function& fn, analysis_manager& analyses, pass_context& context) noexcept {
+    if (context.target().vector_bytes < 16 || analyses.loops().loops().empty()) {
+        return preserve_all;
+    }
+    const auto& loops = analyses.loops();
+    auto vectorizer = loop_vectorizer{ fn, analyses.graph(), loops, context };
+
+    // every loop is looked at before any is changed, the analyses stay valid that way.
+    std::vector<plan> plans;
+    for (loop_id id = 0; id < loops.loops().size(); ++id) {
+        plan p{};
+        const auto header = loops.get(id).header;
+        if (!vectorizer.analyze(id, p)) {
+            context.note(fn, false, "loop at bb{} not vectorized: {}", header, vectorizer.reason());
+            continue;
+        }
+        context.note(fn, true, "loop at bb{} vectorized: {} lanes of {}{}",
+            header, lane_count(p.vector), value_type_to_string(element_of(p.vector)),
+            p.checks.empty() ? std::string{} : std::format(", with {} runtime overlap checks", p.checks.size()));
+        plans.push_back(std::move(p));
+    }
+    for (const auto& p : plans) {
+        vectorizer.rewrite(p);
+    }
+    return plans.empty() ? preserve_all : preserve_none;
+}
@@ -0,0 +1,101 @@
+#ifndef _PARSER_NAME_COLLECTOR_HPP
+
+#include "../../common/common.hpp"
+
+#include "static_visitor.hpp"
+
+#include <string>
+#include <vector>
+
+COMPILER_API_BEGIN
+
+// Every name a subtree refers to: called functions and used variables.
+class name_collector : public static_visitor<name_collector> {
+private:
+    std::vector<std::string>& m_out;
+public:
+    inline explicit name_collector(std::vector<std::string>& out) noexcept
+        : m_out(out)
+    {}
+
+    void visit_assignment(assignment& node) noexcept {
+        if (node.target() != nullptr) {
+            visit(*node.target());
+        }
+        else {
+            m_out.push_back(node.assignee());
+        }
+        if (node.has_expression()) {
+            visit(**node.expression());
+        }
+    }
+    void visit_assignment_declaration(assignment_declaration& node) noexcept {
+        if (node.has_expr()) {
+            visit(*node.expr());
+        }
+    }
+    void visit_name_expression(name_expression& node) noexcept { m_out.push_back(node.name()); }
+    void visit_binary_expression(binary_expression& node) noexcept {
+        visit(node.lhs());
+        visit(node.rhs());
+    }
+    void visit_unary_expression(unary_expression& node) noexcept { visit(node.operand()); }
+    void visit_call_expression(call_expression& node) noexcept {
+        m_out.push_back(node.callee());
+        for (auto& arg : node.args()) {
+            visit(*arg);
+        }
+    }
+    void visit_subscript_expression(subscript_expression& node) noexcept {
+        visit(node.base());
+        visit(node.index());
+    }
+    void visit_compound_statement(compound_statement& node) noexcept {
+        for (auto& item : node.items()) {
+            visit(*item);
+        }
+    }
+    void visit_expression_statement(expression_statement& node) noexcept {
+        if (node.has_expr()) {
+            visit(*node.expr());
+        }
+    }
+    void visit_return_statement(return_statement& node) noexcept {
+        if (node.has_expr()) {
+            visit(*node.expr());
+        }
+    }
+    void visit_if_statement(if_statement& node) noexcept {
+        visit(node.condition());
+        visit(node.then());
+        if (node.has_else()) {
+            visit(*node.otherwise());
+        }
+    }
+    void visit_while_statement(while_statement& node) noexcept {
+        visit(node.condition());
+        visit(node.body());
+    }
+    void visit_for_statement(for_statement& node) noexcept {
+        if (node.init() != nullptr) {
+            visit(*node.init());
+        }
+        if (node.condition() != nullptr) {
+            visit(*node.condition());
+        }
+        if (node.step() != nullptr) {
+            visit(*node.step());
+        }
+        visit(node.body());
+    }
+    void visit_function_declaration(function_declaration& node) noexcept {
+        if (node.has_body()) {
+            visit(*node.body());
+        }
+    }
+};
+
+COMPILER_API_END
+
+#define _PARSER_NAME_COLLECTOR_HPP
+#endif // !_PARSER_NAME_COLLECTOR_HPP
@@ -3,18 +3,86 @@
 
 #include "../lexing/token_type.hpp"
 
+#include "prod/assignment_stmt.hpp"
+#include "prod/literal.hpp"
+#include "prod/name_expression.hpp"
+#include "prod/binary_expression.hpp"
+#include "prod/unary_expression.hpp"
+#include "prod/call_expression.hpp"
+#include "prod/subscript_expression.hpp"
+#include "prod/expression_statement.hpp"
+#include "prod/return_statement.hpp"
+#include "prod/if_statement.hpp"
+#include "prod/while_statement.hpp"
+#include "prod/for_statement.hpp"
+#include "prod/jump_statement.hpp"
+#include "prod/function_declaration.hpp"
+#include "name_collector.hpp"
+
 #include "../../common/io.hpp"
+#include <array>
 #include <memory>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 using std::optional;
 using std::reference_wrapper;
 using std::ref;
 
+// Record "diagnostic" and return its error from the enclosing function.
+#define PARSE_FAILURE(diagnostic)             \
+    return push_diagnostic(diagnostic)
+
+// Report that "what" (a plural) isn't supported yet, at the current token.
+#define PARSE_UNSUPPORTED(what)                                    \
+    PARSE_FAILURE(make_diag_builder()                              \
+        .with_level(diag_level::error)                             \
+        .with_location(current().location())                       \
+        .with_message(std::format("{} are not supported yet", what)) \
+        .build())
+
+// Count one more level of nesting until the end of the scope, and fail if that's deeper
+// than max_depth.
+#define PARSE_NESTED()                                             \
+    const auto depth_guard = nesting{ m_depth };                   \
+    if (m_depth > max_depth) {                                     \
+        PARSE_FAILURE(make_diag_builder()                          \
+            .with_level(diag_level::error)                         \
+            .with_location(current().location())                   \
+            .with_message("statements or expressions are nested too deeply") \
+            .build());                                             \
+    }
+
+namespace {
+
+class nesting {
+private:
+    std::size_t& m_depth;
+public:
+    explicit nesting(std::size_t& depth) noexcept
+        : m_depth(++depth)
+    {}
+    ~nesting() { --m_depth; }
+};
+
+} // namespace
+
+// Report "expected <what>" at the current token.
+#define PARSE_EXPECTED(what)                                       \
+    PARSE_FAILURE(make_diag_builder()                              \
+        .with_level(diag_level::error)                             \
+        .with_location(current().location())                       \
+        .with_message(std::format("expected {}, got `{}`", what,   \
+            token_type_to_string(current().type())))               \
+        .build())
+
 COMPILER_API bool compiler::parser::matches(token_type tok) const noexcept
 {
-    if (m_pos > m_tokens.size()) {
-        return false;
+    if (m_pos >= m_tokens.size()) {
+        return tok == token_type::END_OF_FILE;
     }
 
     const auto& token = m_tokens.at(m_pos);
@@ -33,34 +101,210 @@ COMPILER_API optional<reference_wrapper<compiler::token>> compiler::parser::expe
     return std::ref(m_tokens.at(m_pos));
 }
 
-COMPILER_API error compiler::parser::push_diagnostic(diagnostic&& diag) noexcept
+COMPILER_API bool compiler::parser::consume(token_type tok) noexcept
+{
+    if (!matches(tok)) {
+        return false;
+    }
+    DISCARD(advance());
+    return true;
+}
+
+COMPILER_API const compiler::token& compiler::parser::current() const noexcept
+{
+    // The lexer always finishes with END_OF_FILE, so the last token is a safe place to stop.
+    if (m_pos >= m_tokens.size()) {
+        return m_tokens.back();
+    }
+    return m_tokens.at(m_pos);
+}
+
+COMPILER_API const compiler::token& compiler::parser::advance() noexcept
+{
+    const auto& tok = current();
+    if (m_pos < m_tokens.size() && tok.type() != token_type::END_OF_FILE) {
+        ++m_pos;
+    }
+    return tok;
+}
+
+COMPILER_API void compiler::parser::synchronize() noexcept
+{
+    std::size_t depth = 0;
+    while (!matches(token_type::END_OF_FILE)) {
+        // leave the closing brace of the enclosing block for it to consume.
+        if (depth == 0 && matches(token_type::RIGHT_BRACE)) {
+            return;
+        }
+        const auto type = advance().type();
+        if (type == token_type::LEFT_BRACE) {
+            ++depth;
+        }
+        else if (type == token_type::RIGHT_BRACE) {
+            if (--depth == 0) {
+                return;
+            }
+        }
+        else if (type == token_type::SEMI_COLON && depth == 0) {
+            return;
+        }
+    }
+}
+
+COMPILER_API compiler::coded_error compiler::parser::push_diagnostic(diagnostic&& diag) noexcept
 {
-    auto ret = error("{}", diag.message());
+    // the message is in the diagnostic, the error only tells the caller to recover.
+    auto ret = coded_error::at(error_code::syntax_error, diag.location());
+    if (m_writer) {
+        m_writer->write(diag);
+    }
     m_diags.push_back(std::move(diag));
     return ret;
 }
 
-COMPILER_API void compiler::parser::parse(const std::vector<std::string>& src) noexcept
+COMPILER_API bool compiler::parser::has_errors() const noexcept
+{
+    for (const auto& diag : m_diags) {
+        if (diag.level() == diag_level::error) {
+            return true;
+        }
+    }
+    return false;
+}
+
+COMPILER_API void compiler::parser::parse(const std::vector<std::string>& src, diag_format format, std::string* record) noexcept
 {
+    m_writer.emplace(src, format, record);
+    if (m_tokens.empty()) {
+        return;
+    }
+
     while (!matches(token_type::END_OF_FILE)) {
         this->parse_next();
     }
-    // After parsing has been done, check if there are any diagnostics.
+    // bodies that were skipped are reported as they're parsed, after the rest of the file.
+    if (m_lazy_bodies) {
+        parse_referenced_bodies(m_ast);
+    }
+}
+
+COMPILER_API void compiler::parser::parse_next() noexcept
+{
+    // stray semi-colons at the top level are allowed.
+    if (consume(token_type::SEMI_COLON)) {
+        return;
+    }
 
-    if (m_diags.empty()) {
+    const auto start = m_pos;
+    if (!seq_looks_like_typename()) {
+        push_diagnostic(make_diag_builder()
+            .with_level(diag_level::error)
+            .with_location(current().location())
+            .with_message(std::format("expected a declaration, got `{}`", token_type_to_string(current().type())))
+            .build());
+        synchronize();
+    }
+    else if (auto result = parse_declaration(m_ast); result.is_err()) {
+        synchronize();
+    }
+
+    // always make progress, a stray "}" at the top level would loop forever otherwise.
+    if (m_pos == start) {
+        DISCARD(advance());
+    }
+}
+
+COMPILER_API void compiler::parser::parse_referenced_bodies(ast& tree) noexcept
+{
+    std::unordered_map<std::string_view, std::vector<std::size_t>> skipped;
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < m_deferred.size(); ++i) {
+        const auto* function = m_deferred[i].function;
+        if (function == nullptr) {
+            continue;
+        }
+        skipped[function->name()].push_back(i);
+        if (!function->is_static()) {
+            names.push_back(function->name());
+        }
+    }
+    if (skipped.empty()) {
         return;
     }
 
-    for (const auto& diagnostic : m_diags) {
-        eprintln("{}", diagnostic.build_into_message(src));
+    auto collector = name_collector{ names };
+    for (auto& node : tree) {
+        collector.visit(*node);
+    }
+    while (!names.empty()) {
+        const auto name = std::move(names.back());
+        names.pop_back();
+        const auto it = skipped.find(name);
+        if (it == skipped.end()) {
+            continue;
+        }
+        for (const auto index : it->second) {
+            auto& deferred = m_deferred[index];
+            parse_deferred(deferred);
+            if (deferred.function->has_body()) {
+                collector.visit(*deferred.function->body());
+            }
+            deferred.function = nullptr;
+        }
+        skipped.erase(it);
+    }
+
+    // "function" is now null for every body that was parsed.
+    std::unordered_set<const ast_node*> unused;
+    for (const auto& deferred : m_deferred) {
+        if (deferred.function != nullptr) {
+            unused.insert(deferred.function);
+        }
+    }
+    const auto is_unused = [&](const node_ptr& node) { return unused.contains(node.get()); };
+    for (auto& node : m_unused) {
+        if (!is_unused(node)) {
+            tree.push_back(std::move(node));
+        }
+    }
+    std::erase(m_unused, nullptr);
+    for (auto& node : tree) {
+        if (is_unused(node)) {
+            m_unused.push_back(std::move(node));
+        }
     }
+    std::erase(tree, nullptr);
 }
 
-COMPILER_API void compiler::parser::parse_next() noexcept 
+COMPILER_API std::optional<compiler::source_span> compiler::parser::skip_braces() noexcept
 {
-    if (seq_looks_like_typename()) {
-        
+    std::size_t depth = 0;
+    for (auto pos = m_pos; pos < m_tokens.size(); ++pos) {
+        const auto type = m_tokens[pos].type();
+        if (type == token_type::LEFT_BRACE) {
+            ++depth;
+        }
+        else if (type == token_type::RIGHT_BRACE && --depth == 0) {
+            const auto begin = m_pos;
+            m_pos = pos + 1;
+            return source_span{ begin, m_pos };
+        }
     }
+    return std::nullopt;
+}
+
+COMPILER_API void compiler::parser::parse_deferred(deferred_body& deferred) noexcept
+{
+    // only top level bodies are skipped, anything (wrongly) nested in this one is parsed with it.
+    const auto lazy = std::exchange(m_lazy_bodies, false);
+    const auto resume = m_pos;
+    m_pos = deferred.tokens.begin;
+    auto body = parse_compound_statement();
+    if (body.is_okay()) {
+        deferred.function->set_body(std::move(body).value());
+    }
+    m_pos = resume;
+    m_lazy_bodies = lazy;
 }
 
 template<class T>
@@ -81,9 +325,10 @@ COMPILER_API bool compiler::parser::seq_looks_like_typename() const noexcept
 
     if (is_any_of(token.type(),
         tt::SIGNED, tt::UNSIGNED, tt::CHAR,
-        tt::SHORT, tt::INT, tt::LONG, 
+        tt::SHORT, tt::INT, tt::LONG,
         tt::VOLATILE, tt::STATIC, tt::REGISTER,
-        tt::VOID))
+        tt::VOID, tt::CONST, tt::EXTERN, tt::INLINE,
+        tt::BOOL, tt::AUTO))
     {
         return true;
     }
@@ -92,8 +337,11 @@ COMPILER_API bool compiler::parser::seq_looks_like_typename() const noexcept
         return true;
     }
 
+    // NOTE: an identifier followed by another identifier is the only way a typedef'd name
+    //       can start a declaration. ("my_type value;")
     if (is_any_of(token.type(), tt::IDENTIFIER)) {
-        return true;
+        const auto next = this->peek_next();
+        return next.has_value() && next.value().get().type() == tt::IDENTIFIER;
     }
 
     if (is_any_of(token.type(), tt::ENUM)) {
@@ -101,55 +349,89 @@ COMPILER_API bool compiler::parser::seq_looks_like_typename() const noexcept
     }
 
     return false;
-} 
+}
 
 COMPILER_API optional<reference_wrapper<const compiler::token>> compiler::parser::peek() const noexcept {
-    if (m_tokens.size() > m_pos) {
+    if (m_pos >= m_tokens.size()) {
         return std::nullopt;
     }
 
     return std::cref(m_tokens.at(m_pos));
-} 
+}
 
 COMPILER_API optional<reference_wrapper<const compiler::token>> compiler::parser::peek_next() const noexcept {
-    if (m_tokens.size() > (m_pos + 1)) {
+    if ((m_pos + 1) >= m_tokens.size()) {
         return std::nullopt;
     }
 
     return std::cref(m_tokens.at(m_pos + 1));
 }
 
-#define PARSE_FAILURE(diagnostic)         \
-    auto diag = diagnostic;               \
-    auto e = error("{}", diag.message()); \
-    push_diagnostic(std::move(diag));     \
-    return e;
-
-COMPILER_API result<compiler::type_information, error> compiler::parser::parse_typename() noexcept {
+COMPILER_API result<compiler::type_information, compiler::coded_error> compiler::parser::parse_typename() noexcept {
     auto modifiers = std::bitset<type_modifier::mod_count>{};
     std::optional<std::reference_wrapper<const token>> next;
     using tt = token_type;
 
-    while ((next = peek())) {
+    bool is_void = false;
+    bool is_bool = false;
+    bool saw_specifier = false;
+    bool done = false;
+
+    while (!done && (next = peek())) {
         switch (next.value().get().type()) {
         case tt::UNSIGNED:
             modifiers.set(mod_unsigned);
+            saw_specifier = true;
             break;
         case tt::SIGNED:
             modifiers.set(mod_signed);
+            saw_specifier = true;
             break;
         case tt::EXTERN:
             modifiers.set(mod_extern);
             break;
+        case tt::STATIC:
+            modifiers.set(mod_static);
+            break;
+        case tt::INLINE:
+            modifiers.set(mod_inline);
+            break;
+        case tt::CONST:
+            modifiers.set(mod_const);
+            break;
         case tt::VOLATILE:
             modifiers.set(mod_volatile);
             break;
+        case tt::REGISTER:
+        case tt::AUTO:
+            // accepted, but they don't mean anything to us.
+            break;
+        case tt::VOID:
+            is_void = true;
+            saw_specifier = true;
+            break;
+        case tt::BOOL:
+            is_bool = true;
+            saw_specifier = true;
+            break;
+        case tt::CHAR:
+            if (modifiers.test(mod_char)) {
+                PARSE_FAILURE(make_diag_builder()
+                    .with_level(diag_level::error)
+                    .with_location(next.value().get().location())
+                    .with_message("invalid type modifiers. (cannot have `char char`)")
+                    .build());
+            }
+            modifiers.set(mod_char);
+            saw_specifier = true;
+            break;
         case tt::INT:
+            saw_specifier = true;
             if (modifiers.test(mod_short)) {
                 modifiers.set(mod_short, false);
-                modifiers.set(mod_short_int, true);        
+                modifiers.set(mod_short_int, true);
             }
-            else if (modifiers.test(mod_long)) {
+            else if (modifiers.test(mod_long) || modifiers.test(mod_long_long)) {
                 if (modifiers.test(mod_long_int) || modifiers.test(mod_long_long_int)) {
                     PARSE_FAILURE(make_diag_builder()
                         .with_level(diag_level::error)
@@ -160,26 +442,26 @@ COMPILER_API result<compiler::type_information, error> compiler::parser::parse_t
                 }
                 else if (modifiers.test(mod_long_long)) {
                     modifiers.set(mod_long_long, false);
-                    modifiers.set(mod_long_long_int, true);        
+                    modifiers.set(mod_long_long_int, true);
                 }
                 else if (modifiers.test(mod_long)) {
                     modifiers.set(mod_long, false);
-                    modifiers.set(mod_long_int);        
+                    modifiers.set(mod_long_int);
                 }
-                break;
             }
             else if (modifiers.test(mod_int)) {
                 PARSE_FAILURE(make_diag_builder()
                     .with_level(diag_level::error)
                     .with_location(next.value().get().location())
                     .with_message("invalid type modifiers. (cannot have `int int`)")
-                    .build());        
+                    .build());
             }
             else {
-                modifiers.set(mod_int, true);        
+                modifiers.set(mod_int, true);
             }
             break;
         case tt::SHORT:
+            saw_specifier = true;
             if (modifiers.test(mod_short)) {
                 PARSE_FAILURE(make_diag_builder()
                     .with_level(diag_level::error)
@@ -190,11 +472,12 @@ COMPILER_API result<compiler::type_information, error> compiler::parser::parse_t
             modifiers.set(mod_short);
             break;
         case tt::LONG:
-            if (modifiers.test(mod_long)) {                    
+            saw_specifier = true;
+            if (modifiers.test(mod_long)) {
                 if (!modifiers.test(mod_long_long)) {
                     modifiers.set(mod_long, false);
                     modifiers.set(mod_long_long, true);
-                    break;  
+                    break;
                 }
                 PARSE_FAILURE(make_diag_builder()
                     .with_level(diag_level::error)
@@ -202,25 +485,572 @@ COMPILER_API result<compiler::type_information, error> compiler::parser::parse_t
                     .with_message("invalid type modifiers. (cannot have `long long long`)")
                     .build());
             }
+            else if (modifiers.test(mod_long_int) && !modifiers.test(mod_long_long_int)) {
+                // "long int long"
+                modifiers.set(mod_long_int, false);
+                modifiers.set(mod_long_long_int, true);
+            }
             else if (!modifiers.test(mod_long_long)) {
-                modifiers.set(mod_long);        
+                modifiers.set(mod_long);
             }
             else {
                 PARSE_FAILURE(make_diag_builder()
                     .with_level(diag_level::error)
                     .with_location(next.value().get().location())
                     .with_message("invalid type specifiers. (cannot have `long long long`)")
-                    .build());   
+                    .build());
             }
             break;
+        case tt::IDENTIFIER:
+            // after a type specifier, the identifier is the name being declared.
+            if (saw_specifier) {
+                done = true;
+                continue;
+            }
+            [[fallthrough]];
+        case tt::STRUCT:
+        case tt::ENUM:
+            PARSE_UNSUPPORTED("struct, enum and typedef'd types");
+        default:
+            done = true;
+            continue;
         }
+        DISCARD(advance());
     }
 
-    // TODO: handle multiple pointers.
-    // NOTE: Something like `char** argv`
-    if (matches(tt::STAR)) {
-        modifiers.set(mod_pointer);
+    if (!saw_specifier) {
+        PARSE_EXPECTED("a type");
     }
 
-    return type_information("integral", type_kind::integral, std::move(modifiers));
-}
\ No newline at end of file
+    std::string name;
+    if (is_void) {
+        name = "void";
+    }
+    else if (is_bool || modifiers.test(mod_char)) {
+        name = "char";
+    }
+    else if (modifiers.test(mod_short) || modifiers.test(mod_short_int)) {
+        name = "short";
+    }
+    else if (modifiers.test(mod_long_long) || modifiers.test(mod_long_long_int)) {
+        name = "long long";
+    }
+    else if (modifiers.test(mod_long) || modifiers.test(mod_long_int)) {
+        name = "long";
+    }
+    else {
+        // plain "unsigned" or "signed" is an int.
+        name = "int";
+    }
+
+    std::size_t pointer_depth = 0;
+    while (consume(tt::STAR)) {
+        ++pointer_depth;
+        // "int* const p"
+        while (consume(tt::CONST) || consume(tt::VOLATILE) || consume(tt::RESTRICT)) {}
+    }
+
+    auto info = type_information(name, type_kind::integral, std::move(modifiers));
+    info.set_pointer_depth(pointer_depth);
+
+    if (auto valid = info.has_valid_modifiers(); valid.is_err()) {
+        PARSE_FAILURE(make_diag_builder()
+            .with_level(diag_level::error)
+            .with_location(current().location())
+            .with_message(valid.get_err()->what())
+            .build());
+    }
+
+    return info;
+}
+
+COMPILER_API result<void, compiler::coded_error> compiler::parser::parse_declaration(std::vector<node_ptr>& out) noexcept
+{
+    RESULT_TRY(base_type, parse_typename());
+
+    // The pointer depth belongs to the declarator, not the base type. "int *a, b;"
+    const auto first_depth = base_type.pointer_depth();
+    bool first = true;
+
+    do {
+        auto type = base_type;
+        if (first) {
+            type.set_pointer_depth(first_depth);
+        }
+        else {
+            std::size_t depth = 0;
+            while (consume(token_type::STAR)) {
+                ++depth;
+            }
+            type.set_pointer_depth(depth);
+        }
+
+        if (!matches(token_type::IDENTIFIER)) {
+            PARSE_EXPECTED("an identifier");
+        }
+        const auto& name = advance();
+
+        if (first && matches(token_type::LEFT_PAREN)) {
+            RESULT_TRY(function, parse_function(std::move(type), name));
+            out.push_back(std::move(function));
+            return {};
+        }
+        first = false;
+
+        if (matches(token_type::LEFT_BRACKET)) {
+            PARSE_UNSUPPORTED("array declarations");
+        }
+
+        std::optional<expr_ptr> init = std::nullopt;
+        if (consume(token_type::EQUALS)) {
+            RESULT_TRY(value, parse_assignment_expression());
+            init = std::move(value);
+        }
+
+        out.push_back(std::make_unique<assignment_declaration>(
+            type, name.lexeme().value_or(""), name.location(), std::move(init)));
+    } while (consume(token_type::COMMA));
+
+    if (!consume(token_type::SEMI_COLON)) {
+        PARSE_EXPECTED("`;` after declaration");
+    }
+    return {};
+}
+
+COMPILER_API result<compiler::node_ptr, compiler::coded_error> compiler::parser::parse_function(type_information&& return_type, const token& name) noexcept
+{
+    using tt = token_type;
+    // consume the "("
+    DISCARD(advance());
+
+    std::vector<parameter> params;
+    // "f(void)" is a function with no parameters.
+    if (matches(tt::VOID) && peek_next().has_value() && peek_next().value().get().type() == tt::RIGHT_PAREN) {
+        DISCARD(advance());
+    }
+    else if (!matches(tt::RIGHT_PAREN)) {
+        do {
+            RESULT_TRY(type, parse_typename());
+            identifier param_name{};
+            if (matches(tt::IDENTIFIER)) {
+                param_name = advance().lexeme().value_or("");
+            }
+            params.push_back(parameter{ std::move(type), std::move(param_name) });
+        } while (consume(tt::COMMA));
+    }
+
+    if (!consume(tt::RIGHT_PAREN)) {
+        PARSE_EXPECTED("`)` after parameter list");
+    }
+
+    std::unique_ptr<compound_statement> body = nullptr;
+    if (!consume(tt::SEMI_COLON)) {
+        if (!matches(tt::LEFT_BRACE)) {
+            PARSE_EXPECTED("`;` or a function body");
+        }
+        // braces that don't match are parsed right away, that's what reports where.
+        if (m_lazy_bodies) {
+            if (const auto tokens = skip_braces()) {
+                auto function = std::make_unique<function_declaration>(
+                    return_type, name.lexeme().value_or(""), std::move(params), nullptr, name.location());
+                m_deferred.push_back(deferred_body{ function.get(), *tokens });
+                return node_ptr(std::move(function));
+            }
+        }
+        RESULT_TRY(parsed_body, parse_compound_statement());
+        body = std::move(parsed_body);
+    }
+
+    return node_ptr(std::make_unique<function_declaration>(
+        return_type, name.lexeme().value_or(""), std::move(params), std::move(body), name.location()));
+}
+
+COMPILER_API result<std::unique_ptr<compiler::compound_statement>, compiler::coded_error> compiler::parser::parse_compound_statement() noexcept
+{
+    const auto location = current().location();
+    if (!consume(token_type::LEFT_BRACE)) {
+        PARSE_EXPECTED("`{`");
+    }
+
+    std::vector<node_ptr> items;
+    while (!matches(token_type::RIGHT_BRACE)) {
+        if (matches(token_type::END_OF_FILE)) {
+            PARSE_EXPECTED("`}` before the end of the file");
+        }
+
+        if (seq_looks_like_typename()) {
+            auto result = parse_declaration(items);
+            if (result.is_err()) {
+                synchronize();
+            }
+            continue;
+        }
+
+        auto result = parse_statement();
+        if (result.is_err()) {
+            synchronize();
+            continue;
+        }
+        items.push_back(std::move(result).value());
+    }
+    DISCARD(advance());
+
+    return std::make_unique<compound_statement>(std::move(items), location);
+}
+
+COMPILER_API result<compiler::node_ptr, compiler::coded_error> compiler::parser::parse_statement() noexcept
+{
+    PARSE_NESTED();
+    using tt = token_type;
+    const auto location = current().location();
+
+    switch (current().type()) {
+    case tt::LEFT_BRACE: {
+        RESULT_TRY(block, parse_compound_statement());
+        return node_ptr(std::move(block));
+    }
+    case tt::SEMI_COLON:
+        DISCARD(advance());
+        return node_ptr(std::make_unique<expression_statement>(nullptr, location));
+    case tt::RETURN: {
+        DISCARD(advance());
+        expr_ptr value = nullptr;
+        if (!matches(tt::SEMI_COLON)) {
+            RESULT_TRY(expr, parse_expression());
+            value = std::move(expr);
+        }
+        if (!consume(tt::SEMI_COLON)) {
+            PARSE_EXPECTED("`;` after return");
+        }
+        return node_ptr(std::make_unique<return_statement>(std::move(value), location));
+    }
+    case tt::BREAK:
+    case tt::CONTINUE: {
+        const auto kind = advance().type() == tt::BREAK ? jump_kind::break_ : jump_kind::continue_;
+        if (!consume(tt::SEMI_COLON)) {
+            PARSE_EXPECTED("`;`");
+        }
+        return node_ptr(std::make_unique<jump_statement>(kind, location));
+    }
+    case tt::IF: {
+        DISCARD(advance());
+        if (!consume(tt::LEFT_PAREN)) {
+            PARSE_EXPECTED("`(` after if");
+        }
+        RESULT_TRY(condition, parse_expression());
+        if (!consume(tt::RIGHT_PAREN)) {
+            PARSE_EXPECTED("`)` after condition");
+        }
+        RESULT_TRY(then, parse_statement());
+        node_ptr otherwise = nullptr;
+        if (consume(tt::ELSE)) {
+            RESULT_TRY(else_branch, parse_statement());
+            otherwise = std::move(else_branch);
+        }
+        return node_ptr(std::make_unique<if_statement>(
+            std::move(condition), std::move(then), std::move(otherwise), location));
+    }
+    case tt::WHILE: {
+        DISCARD(advance());
+        if (!consume(tt::LEFT_PAREN)) {
+            PARSE_EXPECTED("`(` after while");
+        }
+        RESULT_TRY(condition, parse_expression());
+        if (!consume(tt::RIGHT_PAREN)) {
+            PARSE_EXPECTED("`)` after condition");
+        }
+        RESULT_TRY(body, parse_statement());
+        return node_ptr(std::make_unique<while_statement>(std::move(condition), std::move(body), location));
+    }
+    case tt::FOR: {
+        DISCARD(advance());
+        if (!consume(tt::LEFT_PAREN)) {
+            PARSE_EXPECTED("`(` after for");
+        }
+
+        node_ptr init = nullptr;
+        if (seq_looks_like_typename()) {
+            std::vector<node_ptr> decls;
+            if (auto result = parse_declaration(decls); result.is_err()) {
+                return std::move(result).err();
+            }
+            if (decls.size() != 1) {
+                PARSE_UNSUPPORTED("multiple declarations inside of a for loop");
+            }
+            init = std::move(decls.front());
+        }
+        else if (!consume(tt::SEMI_COLON)) {
+            RESULT_TRY(expr, parse_expression());
+            init = std::make_unique<expression_statement>(std::move(expr), location);
+            if (!consume(tt::SEMI_COLON)) {
+                PARSE_EXPECTED("`;` after for loop initializer");
+            }
+        }
+
+        expr_ptr condition = nullptr;
+        if (!matches(tt::SEMI_COLON)) {
+            RESULT_TRY(expr, parse_expression());
+            condition = std::move(expr);
+        }
+        if (!consume(tt::SEMI_COLON)) {
+            PARSE_EXPECTED("`;` after for loop condition");
+        }
+
+        expr_ptr step = nullptr;
+        if (!matches(tt::RIGHT_PAREN)) {
+            RESULT_TRY(expr, parse_expression());
+            step = std::move(expr);
+        }
+        if (!consume(tt::RIGHT_PAREN)) {
+            PARSE_EXPECTED("`)` after for loop");
+        }
+
+        RESULT_TRY(body, parse_statement());
+        return node_ptr(std::make_unique<for_statement>(
+            std::move(init), std::move(condition), std::move(step), std::move(body), location));
+    }
+    default:
+        break;
+    }
+
+    RESULT_TRY(expr, parse_expression());
+    if (!consume(tt::SEMI_COLON)) {
+        PARSE_EXPECTED("`;` after expression");
+    }
+    return node_ptr(std::make_unique<expression_statement>(std::move(expr), location));
+}
+
+COMPILER_API result<compiler::expr_ptr, compiler::coded_error> compiler::parser::parse_expression() noexcept
+{
+    // NOTE: the comma operator is not supported yet.
+    return parse_assignment_expression();
+}
+
+// If "type" is an assignment operator, returns the operator to combine with.
+// "=" is an assignment without a compound operator.
+static bool assignment_operator(compiler::token_type type, std::optional<compiler::binary_op>& compound) noexcept
+{
+    using tt = compiler::token_type;
+    using op = compiler::binary_op;
+    switch (type) {
+    case tt::EQUALS: compound = std::nullopt; return true;
+    case tt::PLUS_EQUAL: compound = op::add; return true;
+    case tt::MINUS_EQUAL: compound = op::sub; return true;
+    case tt::STAR_EQUAL: compound = op::mul; return true;
+    case tt::SLASH_EQUAL: compound = op::div; return true;
+    case tt::XOR_EQUALS: compound = op::bit_xor; return true;
+    default: return false;
+    }
+}
+
+COMPILER_API result<compiler::expr_ptr, compiler::coded_error> compiler::parser::parse_assignment_expression() noexcept
+{
+    PARSE_NESTED();
+    const auto location = current().location();
+    RESULT_TRY(lhs, parse_binary_expression(1));
+
+    std::optional<binary_op> compound = std::nullopt;
+    if (!assignment_operator(current().type(), compound)) {
+        return lhs;
+    }
+    DISCARD(advance());
+
+    // assignments are right associative, "a = b = c" is "a = (b = c)".
+    RESULT_TRY(rhs, parse_assignment_expression());
+
+    std::unique_ptr<assignment> node;
+    switch (lhs->kind()) {
+    case node_kind::name_expression:
+        node = std::make_unique<assignment>(static_cast<name_expression&>(*lhs).name(), location, std::move(rhs));
+        break;
+    case node_kind::subscript_expression:
+        node = std::make_unique<assignment>(std::move(lhs), location, std::move(rhs));
+        break;
+    case node_kind::unary_expression:
+        if (static_cast<unary_expression&>(*lhs).op() == unary_op::dereference) {
+            node = std::make_unique<assignment>(std::move(lhs), location, std::move(rhs));
+            break;
+        }
+        [[fallthrough]];
+    default:
+        PARSE_FAILURE(make_diag_builder()
+            .with_level(diag_level::error)
+            .with_location(location)
+            .with_message("expression is not assignable")
+            .build());
+    }
+
+    if (compound.has_value()) {
+        node->set_compound_op(compound.value());
+    }
+    return expr_ptr(std::move(node));
+}
+
+// The operator each binary operator token is, the tokens with a binary_precedence() that is.
+static constexpr auto binary_ops = [] {
+    using tt = compiler::token_type;
+    using op = compiler::binary_op;
+    std::array<op, compiler::token_type_count> ops{};
+    const auto set = [&](tt type, op value) { ops[static_cast<std::size_t>(type)] = value; };
+    set(tt::OR, op::logical_or);
+    set(tt::AND, op::logical_and);
+    set(tt::BITWISE_OR, op::bit_or);
+    set(tt::BITWISE_XOR, op::bit_xor);
+    set(tt::AMPERSAND, op::bit_and);
+    set(tt::EQUALS_EQUALS, op::eq);
+    set(tt::NOT_EQUAL, op::ne);
+    set(tt::LESSER_THAN, op::lt);
+    set(tt::LESSER_EQUALS, op::le);
+    set(tt::GREATER_THAN, op::gt);
+    set(tt::GREATER_EQUALS, op::ge);
+    set(tt::SHIFT_LEFT, op::shl);
+    set(tt::SHIFT_RIGHT, op::shr);
+    set(tt::ADD, op::add);
+    set(tt::MINUS, op::sub);
+    set(tt::STAR, op::mul);
+    set(tt::SLASH, op::div);
+    set(tt::MODULO, op::mod);
+    return ops;
+}();
+
+COMPILER_API result<compiler::expr_ptr, compiler::coded_error> compiler::parser::parse_binary_expression(int min_precedence) noexcept
+{
+    RESULT_TRY(lhs, parse_unary_expression());
+
+    int precedence;
+    while ((precedence = binary_precedence(current().type())) >= min_precedence && precedence > 0) {
+        const auto op = binary_ops[static_cast<std::size_t>(current().type())];
+        const auto location = advance().location();
+        // every binary operator is left associative.
+        RESULT_TRY(rhs, parse_binary_expression(precedence + 1));
+        lhs = std::make_unique<binary_expression>(op, std::move(lhs), std::move(rhs), location);
+    }
+
+    return lhs;
+}
+
+COMPILER_API result<compiler::expr_ptr, compiler::coded_error> compiler::parser::parse_unary_expression() noexcept
+{
+    PARSE_NESTED();
+    using tt = token_type;
+    const auto location = current().location();
+
+    unary_op op;
+    switch (current().type()) {
+    case tt::MINUS: op = unary_op::negate; break;
+    case tt::ADD: {
+        // unary plus does nothing.
+        DISCARD(advance());
+        return parse_unary_expression();
+    }
+    case tt::BANG: op = unary_op::logical_not; break;
+    case tt::BITWISE_NOT: op = unary_op::bitwise_not; break;
+    case tt::STAR: op = unary_op::dereference; break;
+    case tt::AMPERSAND: op = unary_op::address_of; break;
+    case tt::PLUS_PLUS: op = unary_op::pre_increment; break;
+    case tt::MINUS_MINUS: op = unary_op::pre_decrement; break;
+    default:
+        return parse_postfix_expression();
+    }
+    DISCARD(advance());
+
+    RESULT_TRY(operand, parse_unary_expression());
+    return expr_ptr(std::make_unique<unary_expression>(op, std::move(operand), location));
+}
+
+COMPILER_API result<compiler::expr_ptr, compiler::coded_error> compiler::parser::parse_postfix_expression() noexcept
+{
+    using tt = token_type;
+    RESULT_TRY(expr, parse_primary_expression());
+
+    while (true) {
+        const auto location = current().location();
+        if (consume(tt::LEFT_BRACKET)) {
+            RESULT_TRY(index, parse_expression());
+            if (!consume(tt::RIGHT_BRACKET)) {
+                PARSE_EXPECTED("`]` after subscript");
+            }
+            expr = std::make_unique<subscript_expression>(std::move(expr), std::move(index), location);
+        }
+        else if (consume(tt::PLUS_PLUS)) {
+            expr = std::make_unique<unary_expression>(unary_op::post_increment, std::move(expr), location);
+        }
+        else if (consume(tt::MINUS_MINUS)) {
+            expr = std::make_unique<unary_expression>(unary_op::post_decrement, std::move(expr), location);
+        }
+        else {
+            break;
+        }
+    }
+
+    return expr;
+}
+
+COMPILER_API result<compiler::expr_ptr, compiler::coded_error> compiler::parser::parse_primary_expression() noexcept
+{
+    using tt = token_type;
+    const auto& tok = current();
+    const auto location = tok.location();
+
+    switch (tok.type()) {
+    case tt::INTEGER_LITERAL: {
+        const auto number = tok.number();
+        DISCARD(advance());
+        return expr_ptr(std::make_unique<integer_literal>(number.integer(), location, number.is_unsigned(), number.is_long()));
+    }
+    case tt::CHARACTER_LITERAL: {
+        const auto& text = tok.lexeme().value_or("");
+        const auto value = text.empty() ? 0 : static_cast<unsigned char>(text.front());
+        DISCARD(advance());
+        return expr_ptr(std::make_unique<integer_literal>(value, location));
+    }
+    case tt::TRUE:
+    case tt::FALSE: {
+        const auto value = tok.type() == tt::TRUE ? 1 : 0;
+        DISCARD(advance());
+        return expr_ptr(std::make_unique<integer_literal>(value, location));
+    }
+    case tt::IDENTIFIER: {
+        const auto name = tok.lexeme().value_or("");
+        DISCARD(advance());
+        if (!consume(tt::LEFT_PAREN)) {
+            return expr_ptr(std::make_unique<name_expression>(name, location));
+        }
+
+        std::vector<expr_ptr> args;
+        if (!matches(tt::RIGHT_PAREN)) {
+            do {
+                RESULT_TRY(arg, parse_assignment_expression());
+                args.push_back(std::move(arg));
+            } while (consume(tt::COMMA));
+        }
+        if (!consume(tt::RIGHT_PAREN)) {
+            PARSE_EXPECTED("`)` after arguments");
+        }
+        return expr_ptr(std::make_unique<call_expression>(name, std::move(args), location));
+    }
+    case tt::LEFT_PAREN: {
+        DISCARD(advance());
+        RESULT_TRY(inner, parse_expression());
+        if (!consume(tt::RIGHT_PAREN)) {
+            PARSE_EXPECTED("`)`");
+        }
+        return inner;
+    }
+    case tt::STRING_LITERAL: {
+        const auto id = tok.string();
+        DISCARD(advance());
+        return expr_ptr(std::make_unique<string_literal>(id, location));
+    }
+    case tt::FLOATING_POINT_LITERAL:
+        PARSE_FAILURE(make_diag_builder()
+            .with_level(diag_level::error)
+            .with_location(location)
+            .with_message(std::format("{} expressions are not supported yet", token_type_to_string(tok.type())))
+            .build());
+    default:
+        break;
+    }
+
+    PARSE_EXPECTED("an expression");
+}
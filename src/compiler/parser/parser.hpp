@@ -1,4 +1,3 @@
-
 #include <optional>
 #ifndef _COMPILER_PARSER_HPP
 
@@ -11,10 +10,13 @@
 
 #include "prod/assignment.hpp"
 #include "prod/node.hpp"
+#include "prod/compound_statement.hpp"
+#include "prod/function_declaration.hpp"
 
 #include "../types.hpp"
 #include "../lexing/token_type.hpp"
 #include "../diagnostics/diag.hpp"
+#include "../diagnostics/coded_error.hpp"
 
 #include <vector>
 #include <memory>
@@ -24,37 +26,114 @@ COMPILER_API_BEGIN
 using ast = std::vector<std::unique_ptr<ast_node>>;
 using token_list = std::vector<token>;
 
+using node_ptr = std::unique_ptr<ast_node>;
+using expr_ptr = std::unique_ptr<expression>;
+
 class parser {
+public:
+    // Statements and expressions nested deeper than this are an error. The parser (and
+    // everything that walks the ast after it) recurses once per level, this keeps the
+    // stack bounded for any input. A parenthesis takes two levels (an assignment and a
+    // unary expression), so this allows 256 of them.
+    static constexpr std::size_t max_depth = 512;
 private:
     ast m_ast{};
     token_list m_tokens;
     size_t m_pos{0};
+    // how deeply the statement and expression being parsed are nested, see max_depth.
+    std::size_t m_depth{ 0 };
     std::vector<diagnostic> m_diags;
+    // writes each diagnostic out as it's pushed, set by parse().
+    std::optional<diagnostic_writer> m_writer{};
+
+    // A function body that hasn't been parsed yet, "tokens" is the range of m_tokens from
+    // its "{" up to and including the matching "}". "function" is null once it's parsed.
+    struct deferred_body {
+        function_declaration* function;
+        source_span tokens;
+    };
+    bool m_lazy_bodies{ false };
+    std::vector<deferred_body> m_deferred{};
+    // the functions whose bodies nothing needed (yet), taken out of the ast. An internal
+    // function that's declared but not defined is an error.
+    ast m_unused{};
 public:
     COMPILER_API parser() = delete;
     COMPILER_API parser(token_list&& tokens) noexcept
         : m_tokens(std::move(tokens))
     {}
 
-    COMPILER_API void parse(const std::vector<std::string>& src) noexcept;
-    COMPILER_API void parse_next() noexcept;  
-
-    COMPILER_API result<type_information, error> parse_typename() noexcept;
+    // Parse everything, each diagnostic is written to stderr in "format" as soon as it's
+    // found and appended to "record" if that's set. So are those of parse_referenced_bodies()
+    // later on, "src" and "record" have to outlive the parser.
+    COMPILER_API void parse(const std::vector<std::string>& src, diag_format format = diag_format::text, std::string* record = nullptr) noexcept;
+    COMPILER_API void parse_next() noexcept;
+
+    // Skip the bodies of function definitions by matching braces and only parse them once
+    // something needs them. A non-static function is always emitted, so its body is always
+    // parsed, a static one only when its name is referenced from something that is. Errors
+    // in a body that's never needed aren't reported. This has to be set before parse().
+    COMPILER_API inline void set_lazy_bodies(bool lazy) noexcept { m_lazy_bodies = lazy; }
+    // Parse every skipped body "tree" needs, transitively, and take the functions whose
+    // bodies are still skipped out of "tree". parse() does this for the ast it built, this
+    // is for declarations that come from elsewhere. (a precompiled header)
+    COMPILER_API void parse_referenced_bodies(ast& tree) noexcept;
+
+    COMPILER_API result<type_information, coded_error> parse_typename() noexcept;
+
+    // Parses a variable or function declaration, every declarator is pushed into "out".
+    // "int a = 1, b;" pushes two assignment_declarations.
+    COMPILER_API result<void, coded_error> parse_declaration(std::vector<node_ptr>& out) noexcept;
+    // Parses the parameter list and (optional) body of a function, the return type and name
+    // have already been consumed.
+    COMPILER_API result<node_ptr, coded_error> parse_function(type_information&& return_type, const token& name) noexcept;
+
+    COMPILER_API result<node_ptr, coded_error> parse_statement() noexcept;
+    COMPILER_API result<std::unique_ptr<compound_statement>, coded_error> parse_compound_statement() noexcept;
+
+    COMPILER_API result<expr_ptr, coded_error> parse_expression() noexcept;
+    COMPILER_API result<expr_ptr, coded_error> parse_assignment_expression() noexcept;
+    COMPILER_API result<expr_ptr, coded_error> parse_binary_expression(int min_precedence) noexcept;
+    COMPILER_API result<expr_ptr, coded_error> parse_unary_expression() noexcept;
+    COMPILER_API result<expr_ptr, coded_error> parse_postfix_expression() noexcept;
+    COMPILER_API result<expr_ptr, coded_error> parse_primary_expression() noexcept;
+
+    // The top level declarations parsed so far.
+    COMPILER_API inline ast& get_ast() noexcept { return m_ast; }
+    [[nodiscard("this is a move function, the caller will own the ast after this call.")]]
+    COMPILER_API inline ast release_ast() noexcept { return std::move(m_ast); }
+
+    COMPILER_API inline const std::vector<diagnostic>& diagnostics() const noexcept { return m_diags; }
+    COMPILER_API bool has_errors() const noexcept;
 
 private:
     // check if the current token is of type "tok"
     COMPILER_API bool matches(token_type tok) const noexcept;
     COMPILER_API std::optional<std::reference_wrapper<token>> expect(token_type type, diagnostic&& diag) noexcept;
+    // if the current token is of type "tok", move past it and return true.
+    COMPILER_API bool consume(token_type tok) noexcept;
+    // the current token, this is END_OF_FILE once everything has been consumed.
+    COMPILER_API const token& current() const noexcept;
+    // move past the current token, returns the token that was moved past.
+    COMPILER_API const token& advance() noexcept;
+    // after an error, skip tokens until something that looks like the start of the next
+    // statement or declaration.
+    COMPILER_API void synchronize() noexcept;
 
     COMPILER_API bool seq_looks_like_typename() const noexcept;
 
+    // The current token is a "{", move past its matching "}". Returns the range that was
+    // skipped, or nothing (without moving) if the braces don't match before the end.
+    COMPILER_API std::optional<source_span> skip_braces() noexcept;
+    COMPILER_API void parse_deferred(deferred_body& deferred) noexcept;
+
     COMPILER_API std::optional<std::reference_wrapper<const token>> peek_next() const noexcept;
     COMPILER_API std::optional<std::reference_wrapper<const token>> peek() const noexcept;
 
-    COMPILER_API error push_diagnostic(diagnostic&& diag) noexcept;
+    COMPILER_API coded_error push_diagnostic(diagnostic&& diag) noexcept;
 };
 
 COMPILER_API_END
 
 #define _COMPILER_PARSER_HPP
-#endif
\ No newline at end of file
+#endif
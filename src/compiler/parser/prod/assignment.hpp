@@ -1,5 +1,3 @@
-
-#include <random>
 #ifndef _PARSER_PROD_ASSIGNMENT_H
 
 #include <optional>
@@ -9,6 +7,7 @@
 #include "../../types.hpp"
 
 #include "node.hpp"
+#include "binary_expression.hpp"
 
 #include "../visitor.hpp"
 
@@ -18,45 +17,69 @@ COMPILER_API_BEGIN
 // With them as expressions, you can do stuff like:
 // call_function(data = call_function());
 // The expression would evaluate to "data" after the assignment.
+//
+// The assignee is usually a plain name, but it can also be any other lvalue such as
+// "array[i] = value" or "*ptr = value", in which case target() is set instead.
 
 class assignment : public expression {
 private:
     identifier m_assignee;
-    std::optional<std::unique_ptr<expression>> m_expr;
-    source_location m_location;
+    std::unique_ptr<compiler::expression> m_target;
+    std::optional<std::unique_ptr<compiler::expression>> m_expr;
+    // set for compound assignments, "a += 2" is an assignment with compound_op() == add.
+    std::optional<binary_op> m_compound_op;
 public:
     COMPILER_API inline assignment(
         const identifier& assignee,
         const source_location& location,
-        std::optional<std::unique_ptr<expression>> expr = std::nullopt
-    ) noexcept 
-        : m_location(location)
+        std::optional<std::unique_ptr<compiler::expression>> expr = std::nullopt
+    ) noexcept
+        : compiler::expression(node_kind::assignment, location)
     {
         m_assignee = assignee;
         m_expr = std::move(expr);
     }
+    COMPILER_API inline assignment(
+        std::unique_ptr<compiler::expression> target,
+        const source_location& location,
+        std::optional<std::unique_ptr<compiler::expression>> expr = std::nullopt
+    ) noexcept
+        : compiler::expression(node_kind::assignment, location)
+        , m_target(std::move(target))
+    {
+        m_expr = std::move(expr);
+    }
 
-    virtual COMPILER_API void accept(ast_visitor& vis)  {
+    virtual COMPILER_API void accept(ast_visitor& vis) override {
         return vis.visit_assignment(*this);
     }
-    virtual COMPILER_API const source_location& location() const noexcept override {
-        return m_location;
-    }
 
     COMPILER_API inline const identifier& assignee() const noexcept {
         return m_assignee;
     }
-    
-    COMPILER_API inline const std::optional<std::unique_ptr<expression>>& expression() const noexcept {
+
+    // The lvalue being assigned to, this is null when assigning to a name. (see assignee())
+    COMPILER_API inline compiler::expression* target() const noexcept {
+        return m_target.get();
+    }
+
+    COMPILER_API inline const std::optional<std::unique_ptr<compiler::expression>>& expression() const noexcept {
         return m_expr;
     }
 
     COMPILER_API inline bool has_expression() const noexcept {
         return m_expr.has_value();
     }
+
+    COMPILER_API inline const std::optional<binary_op>& compound_op() const noexcept {
+        return m_compound_op;
+    }
+    COMPILER_API inline void set_compound_op(binary_op op) noexcept {
+        m_compound_op = op;
+    }
 };
 
 COMPILER_API_END
 
 #define _PARSER_PROD_ASSIGNMENT_H
-#endif // !_PARSER_PROD_ASSIGNMENT_H
\ No newline at end of file
+#endif // !_PARSER_PROD_ASSIGNMENT_H
@@ -1,4 +1,3 @@
-
 #ifndef _COMPILER_PARSER_PROD_ASSIGNMENT_STMT_HPP
 
 #include "../../../common/common.hpp"
@@ -20,38 +19,33 @@ COMPILER_API_BEGIN
 class assignment_declaration : public declaration {
 private:
   type_information m_type_info;
-  identifier m_identifier;
-  source_location m_source_location;
+  compiler::identifier m_identifier;
   std::optional<std::unique_ptr<expression>> m_expr;
 public:
   COMPILER_API inline explicit assignment_declaration(
       const type_information& type,
-      const identifier& identifier,
+      const compiler::identifier& identifier,
       const source_location& location,
-      std::optional<std::unique_ptr<expression>> expr = std::nullopt          
+      std::optional<std::unique_ptr<expression>> expr = std::nullopt
   )
-    : m_type_info(type)
+    : declaration(node_kind::assignment_declaration, location)
+    , m_type_info(type)
     , m_identifier(identifier)
-    , m_source_location(location)
   {
       if (expr.has_value()) {
-          m_expr = std::move(expr.value());            
+          m_expr = std::move(expr.value());
       }
   }
 
-  inline virtual void accept(ast_visitor& visitor) noexcept {
-      return visitor.visit_assignment_declaration(*this);          
-  } 
-
-  inline virtual const source_location& location() const noexcept {
-      return m_source_location;          
+  inline virtual void accept(ast_visitor& visitor) noexcept override {
+      return visitor.visit_assignment_declaration(*this);
   }
 
   inline const type_information& type() const noexcept {
-      return m_type_info;          
+      return m_type_info;
   }
 
-  inline const identifier& identifier() const noexcept {
+  inline const compiler::identifier& identifier() const noexcept {
       return m_identifier;
   }
 
@@ -63,4 +57,4 @@ public:
 COMPILER_API_END
 
 #define _COMPILER_PARSER_PROD_ASSIGNMENT_STMT_HPP
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,53 @@
+#ifndef _COMPILER_PARSER_PROD_BINARY_EXPRESSION_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+enum class binary_op {
+    add, sub, mul, div, mod,
+    shl, shr,
+    bit_and, bit_or, bit_xor,
+    logical_and, logical_or,
+    eq, ne, lt, le, gt, ge,
+};
+
+// Something like "a + b", the operands are always present.
+class binary_expression : public expression {
+private:
+    binary_op m_op;
+    std::unique_ptr<expression> m_lhs;
+    std::unique_ptr<expression> m_rhs;
+public:
+    COMPILER_API inline binary_expression(
+        binary_op op,
+        std::unique_ptr<expression> lhs,
+        std::unique_ptr<expression> rhs,
+        const source_location& location
+    ) noexcept
+        : expression(node_kind::binary_expression, location)
+        , m_op(op)
+        , m_lhs(std::move(lhs))
+        , m_rhs(std::move(rhs))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_binary_expression(*this);
+    }
+
+    inline binary_op op() const noexcept { return m_op; }
+    inline expression& lhs() noexcept { return *m_lhs; }
+    inline expression& rhs() noexcept { return *m_rhs; }
+    inline const expression& lhs() const noexcept { return *m_lhs; }
+    inline const expression& rhs() const noexcept { return *m_rhs; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_BINARY_EXPRESSION_HPP
+#endif // !_COMPILER_PARSER_PROD_BINARY_EXPRESSION_HPP
@@ -0,0 +1,42 @@
+#ifndef _COMPILER_PARSER_PROD_CALL_EXPRESSION_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+#include <vector>
+
+COMPILER_API_BEGIN
+
+// A call to a function by name, "callee(args...)".
+// NOTE: calls through function pointers are not supported yet.
+class call_expression : public expression {
+private:
+    identifier m_callee;
+    std::vector<std::unique_ptr<expression>> m_args;
+public:
+    COMPILER_API inline call_expression(
+        const identifier& callee,
+        std::vector<std::unique_ptr<expression>> args,
+        const source_location& location
+    ) noexcept
+        : expression(node_kind::call_expression, location)
+        , m_callee(callee)
+        , m_args(std::move(args))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_call_expression(*this);
+    }
+
+    inline const identifier& callee() const noexcept { return m_callee; }
+    inline std::vector<std::unique_ptr<expression>>& args() noexcept { return m_args; }
+    inline const std::vector<std::unique_ptr<expression>>& args() const noexcept { return m_args; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_CALL_EXPRESSION_HPP
+#endif // !_COMPILER_PARSER_PROD_CALL_EXPRESSION_HPP
@@ -0,0 +1,37 @@
+#ifndef _COMPILER_PARSER_PROD_COMPOUND_STATEMENT_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+#include <vector>
+
+COMPILER_API_BEGIN
+
+// A block, "{ ... }". Holds both declarations and statements, in source order.
+class compound_statement : public statement {
+private:
+    std::vector<std::unique_ptr<ast_node>> m_items;
+public:
+    COMPILER_API inline compound_statement(
+        std::vector<std::unique_ptr<ast_node>> items,
+        const source_location& location
+    ) noexcept
+        : statement(node_kind::compound_statement, location)
+        , m_items(std::move(items))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_compound_statement(*this);
+    }
+
+    inline std::vector<std::unique_ptr<ast_node>>& items() noexcept { return m_items; }
+    inline const std::vector<std::unique_ptr<ast_node>>& items() const noexcept { return m_items; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_COMPOUND_STATEMENT_HPP
+#endif // !_COMPILER_PARSER_PROD_COMPOUND_STATEMENT_HPP
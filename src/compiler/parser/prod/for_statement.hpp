@@ -0,0 +1,48 @@
+#ifndef _COMPILER_PARSER_PROD_FOR_STATEMENT_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+// "for (init; condition; step) body", every part of the header is optional.
+// The init can either be a declaration ("int i = 0") or an expression statement.
+class for_statement : public statement {
+private:
+    std::unique_ptr<ast_node> m_init;
+    std::unique_ptr<expression> m_condition;
+    std::unique_ptr<expression> m_step;
+    std::unique_ptr<ast_node> m_body;
+public:
+    COMPILER_API inline for_statement(
+        std::unique_ptr<ast_node> init,
+        std::unique_ptr<expression> condition,
+        std::unique_ptr<expression> step,
+        std::unique_ptr<ast_node> body,
+        const source_location& location
+    ) noexcept
+        : statement(node_kind::for_statement, location)
+        , m_init(std::move(init))
+        , m_condition(std::move(condition))
+        , m_step(std::move(step))
+        , m_body(std::move(body))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_for_statement(*this);
+    }
+
+    inline ast_node* init() noexcept { return m_init.get(); }
+    inline expression* condition() noexcept { return m_condition.get(); }
+    inline expression* step() noexcept { return m_step.get(); }
+    inline ast_node& body() noexcept { return *m_body; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_FOR_STATEMENT_HPP
+#endif // !_COMPILER_PARSER_PROD_FOR_STATEMENT_HPP
@@ -0,0 +1,73 @@
+#ifndef _COMPILER_PARSER_PROD_FUNCTION_DECLARATION_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "compound_statement.hpp"
+#include "../visitor.hpp"
+
+#include "../../types.hpp"
+
+#include <memory>
+#include <vector>
+
+COMPILER_API_BEGIN
+
+// A single function parameter, "int a". The name is empty for unnamed parameters.
+struct parameter {
+    type_information type;
+    compiler::identifier name;
+};
+
+/*
+  A function prototype or definition:
+    "int add(int a, int b);"
+    "int add(int a, int b) { return a + b; }"
+
+  Storage class and function specifiers (static, extern, inline) are stored as modifiers
+  on the return type, see type_modifier.
+*/
+class function_declaration : public declaration {
+private:
+    type_information m_return_type;
+    compiler::identifier m_name;
+    std::vector<parameter> m_params;
+    std::unique_ptr<compound_statement> m_body;
+public:
+    COMPILER_API inline function_declaration(
+        const type_information& return_type,
+        const compiler::identifier& name,
+        std::vector<parameter> params,
+        std::unique_ptr<compound_statement> body,
+        const source_location& location
+    ) noexcept
+        : declaration(node_kind::function_declaration, location)
+        , m_return_type(return_type)
+        , m_name(name)
+        , m_params(std::move(params))
+        , m_body(std::move(body))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_function_declaration(*this);
+    }
+
+    inline const type_information& return_type() const noexcept { return m_return_type; }
+    inline const compiler::identifier& name() const noexcept { return m_name; }
+    inline const std::vector<parameter>& params() const noexcept { return m_params; }
+
+    // Does this declaration have a body? (is it a definition)
+    inline bool has_body() const noexcept { return m_body != nullptr; }
+    inline compound_statement* body() noexcept { return m_body.get(); }
+    inline const compound_statement* body() const noexcept { return m_body.get(); }
+    // For bodies that are parsed after the declaration, see parser::set_lazy_bodies().
+    inline void set_body(std::unique_ptr<compound_statement> body) noexcept { m_body = std::move(body); }
+
+    inline bool is_static() const noexcept { return m_return_type.has_modifier(mod_static); }
+    inline bool is_inline() const noexcept { return m_return_type.has_modifier(mod_inline); }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_FUNCTION_DECLARATION_HPP
+#endif // !_COMPILER_PARSER_PROD_FUNCTION_DECLARATION_HPP
@@ -0,0 +1,44 @@
+#ifndef _COMPILER_PARSER_PROD_IF_STATEMENT_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+// "if (condition) then" with an optional "else otherwise".
+class if_statement : public statement {
+private:
+    std::unique_ptr<expression> m_condition;
+    std::unique_ptr<ast_node> m_then;
+    std::unique_ptr<ast_node> m_else;
+public:
+    COMPILER_API inline if_statement(
+        std::unique_ptr<expression> condition,
+        std::unique_ptr<ast_node> then,
+        std::unique_ptr<ast_node> otherwise,
+        const source_location& location
+    ) noexcept
+        : statement(node_kind::if_statement, location)
+        , m_condition(std::move(condition))
+        , m_then(std::move(then))
+        , m_else(std::move(otherwise))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_if_statement(*this);
+    }
+
+    inline expression& condition() noexcept { return *m_condition; }
+    inline ast_node& then() noexcept { return *m_then; }
+    inline bool has_else() const noexcept { return m_else != nullptr; }
+    inline ast_node* otherwise() noexcept { return m_else.get(); }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_IF_STATEMENT_HPP
+#endif // !_COMPILER_PARSER_PROD_IF_STATEMENT_HPP
@@ -0,0 +1,35 @@
+#ifndef _COMPILER_PARSER_PROD_JUMP_STATEMENT_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+COMPILER_API_BEGIN
+
+enum class jump_kind {
+    break_, continue_
+};
+
+// "break;" or "continue;"
+// NOTE: goto is not supported yet.
+class jump_statement : public statement {
+private:
+    jump_kind m_jump;
+public:
+    COMPILER_API inline jump_statement(jump_kind jump, const source_location& location) noexcept
+        : statement(node_kind::jump_statement, location)
+        , m_jump(jump)
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_jump_statement(*this);
+    }
+
+    inline jump_kind jump() const noexcept { return m_jump; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_JUMP_STATEMENT_HPP
+#endif // !_COMPILER_PARSER_PROD_JUMP_STATEMENT_HPP
@@ -0,0 +1,61 @@
+#ifndef _COMPILER_PARSER_PROD_LITERAL_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <cstdint>
+
+COMPILER_API_BEGIN
+
+// An integer constant, something like "42".
+class integer_literal : public expression {
+private:
+    std::uint64_t m_value;
+    bool m_is_unsigned;
+    bool m_is_long;
+public:
+    COMPILER_API inline integer_literal(
+        std::uint64_t value,
+        const source_location& location,
+        bool is_unsigned = false,
+        bool is_long = false
+    ) noexcept
+        : expression(node_kind::integer_literal, location)
+        , m_value(value)
+        , m_is_unsigned(is_unsigned)
+        , m_is_long(is_long)
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_integer_literal(*this);
+    }
+
+    inline std::uint64_t value() const noexcept { return m_value; }
+    inline bool is_unsigned() const noexcept { return m_is_unsigned; }
+    inline bool is_long() const noexcept { return m_is_long; }
+};
+
+// A string constant, something like "hello\n". Adjacent literals have already been joined
+// by the lexer, the bytes are in the translation unit's string_pool.
+class string_literal : public expression {
+private:
+    string_id m_id;
+public:
+    COMPILER_API inline string_literal(string_id id, const source_location& location) noexcept
+        : expression(node_kind::string_literal, location)
+        , m_id(id)
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_string_literal(*this);
+    }
+
+    inline string_id id() const noexcept { return m_id; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_LITERAL_HPP
+#endif // !_COMPILER_PARSER_PROD_LITERAL_HPP
@@ -0,0 +1,30 @@
+#ifndef _COMPILER_PARSER_PROD_NAME_EXPRESSION_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+COMPILER_API_BEGIN
+
+// A use of a variable or function by name, such as the "a" in "a + 1".
+class name_expression : public expression {
+private:
+    identifier m_name;
+public:
+    COMPILER_API inline name_expression(const identifier& name, const source_location& location) noexcept
+        : expression(node_kind::name_expression, location)
+        , m_name(name)
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_name_expression(*this);
+    }
+
+    inline const identifier& name() const noexcept { return m_name; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_NAME_EXPRESSION_HPP
+#endif // !_COMPILER_PARSER_PROD_NAME_EXPRESSION_HPP
@@ -1,62 +1,59 @@
-
 #ifndef _PARSER_PROD_NODE_HPP
 
 #include "../../../common/common.hpp"
 #include "../../types.hpp"
 #include "../../../common/io.hpp"
 
-class ast_visitor;
+#include "node_kind.hpp"
 
 COMPILER_API_BEGIN
 
+class ast_visitor;
+
 // The very base class of all AST nodes.
+// NOTE: the kind and location live here (and not behind virtual calls) so that the
+//       static_visitor can walk the tree without any indirect calls.
 class ast_node {
+private:
+    source_location m_location;
+    node_kind m_kind;
 public:
+    inline ast_node(node_kind kind, const source_location& location) noexcept
+        : m_location(location), m_kind(kind)
+    {}
     virtual ~ast_node() = default;
     virtual void accept(ast_visitor& visitor) = 0;
 
-    virtual const source_location& location() const noexcept = 0;
+    // What kind of node this is, see node_kind.hpp.
+    inline node_kind kind() const noexcept {
+        return m_kind;
+    }
+
+    inline const source_location& location() const noexcept {
+        return m_location;
+    }
 };
 
 // The base class of all AST nodes that represent an expression.
 class expression : public ast_node {
 public:
+    using ast_node::ast_node;
     virtual ~expression() = default;
-    virtual void accept(ast_visitor& visitor) {}
-
-    virtual const source_location& location() const noexcept {
-        eprintln("ERROR: you called node.location() on a node without location() overriden");
-        std::exit(-1);
-        return (source_location&)(*(source_location*)0);
-    }
 };
 // The base class of all AST nodes that represent a statement.
 class statement : public ast_node {
 public:
+    using ast_node::ast_node;
     virtual ~statement() = default;
-    virtual void accept(ast_visitor& visitor) {}
-
-    virtual const source_location& location() const noexcept {
-        eprintln("ERROR: you called node.location() on a node without location() overriden.");
-        std::exit(-1);
-        return (source_location&)(*(source_location*)0);
-    }
 };
 // The base class of all AST nodes that represent a declaration.
 class declaration : public ast_node {
 public:
+    using ast_node::ast_node;
     virtual ~declaration() = default;
-    virtual void accept(ast_visitor& visitor) {}
-
-    virtual const source_location& location() const noexcept {
-        eprintln("ERROR: you called node.location() on a node without location() overriden.");
-        std::exit(-1);
-        // just to stop not-returning errors. (obviously std::exit stops this problem.)
-        return (source_location&)(*(source_location*)0);
-    }
 };
 
 COMPILER_API_END
 
 #define _PARSER_PROD_NODE_HPP
-#endif // !_PARSER_PROD_NODE_HPP
\ No newline at end of file
+#endif // !_PARSER_PROD_NODE_HPP
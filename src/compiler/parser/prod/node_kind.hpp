@@ -0,0 +1,53 @@
+#ifndef _PARSER_PROD_NODE_KIND_HPP
+
+#include "../../../common/common.hpp"
+
+#include <cstdint>
+
+COMPILER_API_BEGIN
+
+// Every concrete AST node, as X(kind, class). This is the one place a new node has to be
+// registered, the enum below and the switch in static_visitor are generated from it.
+#define COMPILER_AST_NODES(X)                        \
+    X(assignment, assignment)                        \
+    X(assignment_declaration, assignment_declaration)\
+    X(integer_literal, integer_literal)              \
+    X(string_literal, string_literal)                \
+    X(name_expression, name_expression)              \
+    X(binary_expression, binary_expression)          \
+    X(unary_expression, unary_expression)            \
+    X(call_expression, call_expression)              \
+    X(subscript_expression, subscript_expression)    \
+    X(compound_statement, compound_statement)        \
+    X(expression_statement, expression_statement)    \
+    X(return_statement, return_statement)            \
+    X(if_statement, if_statement)                    \
+    X(while_statement, while_statement)              \
+    X(for_statement, for_statement)                  \
+    X(jump_statement, jump_statement)                \
+    X(function_declaration, function_declaration)
+
+// Tag stored inside of every ast_node, so passes can dispatch with a switch instead of
+// going through the virtual accept().
+enum class node_kind : std::uint8_t {
+#define _NODE_KIND_ENUM(kind, cls) kind,
+    COMPILER_AST_NODES(_NODE_KIND_ENUM)
+#undef _NODE_KIND_ENUM
+    // not a node, just the amount of node kinds.
+    count
+};
+
+inline const char* node_kind_to_string(node_kind kind) noexcept {
+    switch (kind) {
+#define _NODE_KIND_NAME(kind, cls) case node_kind::kind: return #kind;
+    COMPILER_AST_NODES(_NODE_KIND_NAME)
+#undef _NODE_KIND_NAME
+    case node_kind::count: break;
+    }
+    return "unknown";
+}
+
+COMPILER_API_END
+
+#define _PARSER_PROD_NODE_KIND_HPP
+#endif // !_PARSER_PROD_NODE_KIND_HPP
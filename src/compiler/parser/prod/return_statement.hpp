@@ -0,0 +1,37 @@
+#ifndef _COMPILER_PARSER_PROD_RETURN_STATEMENT_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+// "return;" or "return expr;"
+class return_statement : public statement {
+private:
+    std::unique_ptr<expression> m_expr;
+public:
+    COMPILER_API inline return_statement(
+        std::unique_ptr<expression> expr,
+        const source_location& location
+    ) noexcept
+        : statement(node_kind::return_statement, location)
+        , m_expr(std::move(expr))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_return_statement(*this);
+    }
+
+    inline bool has_expr() const noexcept { return m_expr != nullptr; }
+    inline expression* expr() noexcept { return m_expr.get(); }
+    inline const expression* expr() const noexcept { return m_expr.get(); }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_RETURN_STATEMENT_HPP
+#endif // !_COMPILER_PARSER_PROD_RETURN_STATEMENT_HPP
@@ -0,0 +1,41 @@
+#ifndef _COMPILER_PARSER_PROD_SUBSCRIPT_EXPRESSION_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+// An array subscript, "base[index]". This is the same as "*(base + index)".
+class subscript_expression : public expression {
+private:
+    std::unique_ptr<expression> m_base;
+    std::unique_ptr<expression> m_index;
+public:
+    COMPILER_API inline subscript_expression(
+        std::unique_ptr<expression> base,
+        std::unique_ptr<expression> index,
+        const source_location& location
+    ) noexcept
+        : expression(node_kind::subscript_expression, location)
+        , m_base(std::move(base))
+        , m_index(std::move(index))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_subscript_expression(*this);
+    }
+
+    inline expression& base() noexcept { return *m_base; }
+    inline expression& index() noexcept { return *m_index; }
+    inline const expression& base() const noexcept { return *m_base; }
+    inline const expression& index() const noexcept { return *m_index; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_SUBSCRIPT_EXPRESSION_HPP
+#endif // !_COMPILER_PARSER_PROD_SUBSCRIPT_EXPRESSION_HPP
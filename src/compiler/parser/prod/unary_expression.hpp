@@ -0,0 +1,52 @@
+#ifndef _COMPILER_PARSER_PROD_UNARY_EXPRESSION_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+enum class unary_op {
+    negate,
+    logical_not,
+    bitwise_not,
+    // "*ptr"
+    dereference,
+    // "&value"
+    address_of,
+    pre_increment, pre_decrement,
+    post_increment, post_decrement,
+};
+
+// Something like "-a" or "a++".
+class unary_expression : public expression {
+private:
+    unary_op m_op;
+    std::unique_ptr<expression> m_operand;
+public:
+    COMPILER_API inline unary_expression(
+        unary_op op,
+        std::unique_ptr<expression> operand,
+        const source_location& location
+    ) noexcept
+        : expression(node_kind::unary_expression, location)
+        , m_op(op)
+        , m_operand(std::move(operand))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_unary_expression(*this);
+    }
+
+    inline unary_op op() const noexcept { return m_op; }
+    inline expression& operand() noexcept { return *m_operand; }
+    inline const expression& operand() const noexcept { return *m_operand; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_UNARY_EXPRESSION_HPP
+#endif // !_COMPILER_PARSER_PROD_UNARY_EXPRESSION_HPP
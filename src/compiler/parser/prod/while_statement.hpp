@@ -0,0 +1,39 @@
+#ifndef _COMPILER_PARSER_PROD_WHILE_STATEMENT_HPP
+
+#include "../../../common/common.hpp"
+
+#include "node.hpp"
+#include "../visitor.hpp"
+
+#include <memory>
+
+COMPILER_API_BEGIN
+
+// "while (condition) body"
+class while_statement : public statement {
+private:
+    std::unique_ptr<expression> m_condition;
+    std::unique_ptr<ast_node> m_body;
+public:
+    COMPILER_API inline while_statement(
+        std::unique_ptr<expression> condition,
+        std::unique_ptr<ast_node> body,
+        const source_location& location
+    ) noexcept
+        : statement(node_kind::while_statement, location)
+        , m_condition(std::move(condition))
+        , m_body(std::move(body))
+    {}
+
+    inline virtual void accept(ast_visitor& visitor) override {
+        return visitor.visit_while_statement(*this);
+    }
+
+    inline expression& condition() noexcept { return *m_condition; }
+    inline ast_node& body() noexcept { return *m_body; }
+};
+
+COMPILER_API_END
+
+#define _COMPILER_PARSER_PROD_WHILE_STATEMENT_HPP
+#endif // !_COMPILER_PARSER_PROD_WHILE_STATEMENT_HPP
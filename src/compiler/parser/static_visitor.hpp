@@ -0,0 +1,73 @@
+#ifndef _PARSER_STATIC_VISITOR_HPP
+
+#include "../../common/common.hpp"
+
+#include "prod/node.hpp"
+#include "prod/node_kind.hpp"
+#include "prod/assignment.hpp"
+#include "prod/assignment_stmt.hpp"
+#include "prod/literal.hpp"
+#include "prod/name_expression.hpp"
+#include "prod/binary_expression.hpp"
+#include "prod/unary_expression.hpp"
+#include "prod/call_expression.hpp"
+#include "prod/subscript_expression.hpp"
+#include "prod/compound_statement.hpp"
+#include "prod/expression_statement.hpp"
+#include "prod/return_statement.hpp"
+#include "prod/if_statement.hpp"
+#include "prod/while_statement.hpp"
+#include "prod/for_statement.hpp"
+#include "prod/jump_statement.hpp"
+#include "prod/function_declaration.hpp"
+
+COMPILER_API_BEGIN
+
+/*
+  A visitor that dispatches on node_kind with a switch instead of the virtual accept().
+
+  Passes derive from this using CRTP and only implement the visit_* functions they care about:
+
+    struct my_pass : static_visitor<my_pass> {
+        void visit_assignment(assignment& node) { ... }
+    };
+
+  Because the derived type is known at compile time, every visit_* call is a direct call
+  the compiler can inline, so a tree walk costs one predictable branch per node instead of
+  two indirect calls. Analysis and codegen passes should use this, ast_visitor is kept for
+  anything that wants runtime polymorphism.
+*/
+template<class Derived, class R = void>
+class static_visitor {
+public:
+    // Dispatch to the derived visit_* function for this nodes kind.
+    inline R visit(ast_node& node) {
+        switch (node.kind()) {
+#define _STATIC_VISITOR_CASE(kind, cls) \
+        case node_kind::kind: return self().visit_##kind(static_cast<cls&>(node));
+        COMPILER_AST_NODES(_STATIC_VISITOR_CASE)
+#undef _STATIC_VISITOR_CASE
+        case node_kind::count: break;
+        }
+        return self().visit_unknown(node);
+    }
+
+    // The defaults, these do nothing. Derived classes hide the ones they need.
+#define _STATIC_VISITOR_DEFAULT(kind, cls) \
+    inline R visit_##kind(cls&) { return R(); }
+    COMPILER_AST_NODES(_STATIC_VISITOR_DEFAULT)
+#undef _STATIC_VISITOR_DEFAULT
+
+    // Called when a node has a kind that is out of range, this should never happen.
+    inline R visit_unknown(ast_node&) { return R(); }
+
+private:
+    inline Derived& self() noexcept {
+        return static_cast<Derived&>(*this);
+    }
+};
+
+COMPILER_API_END
+
+#define _PARSER_STATIC_VISITOR_HPP
+#endif // !_PARSER_STATIC_VISITOR_HPP
@@ -1,23 +1,28 @@
-
 #ifndef _PARSER_VISITOR_HPP
 
 #include "../../common/common.hpp"
 
+#include "prod/node_kind.hpp"
+
 COMPILER_API_BEGIN
 
-class assignment;
-class assignment_declaration;
+#define _VISITOR_FORWARD_DECLARE(kind, cls) class cls;
+COMPILER_AST_NODES(_VISITOR_FORWARD_DECLARE)
+#undef _VISITOR_FORWARD_DECLARE
 
 // for now, until I know what these should return.
 using visitor_result = void;
 
+// NOTE: every call through this is two indirect calls per node (accept + visit_*).
+//       Hot passes should use static_visitor (see static_visitor.hpp) instead.
 class ast_visitor {
 public:
-    virtual visitor_result visit_assignment(assignment& node) = 0;
-    virtual visitor_result visit_assignment_declaration(assignment_declaration& node) = 0;
+#define _VISITOR_VISIT(kind, cls) virtual visitor_result visit_##kind(cls& node) = 0;
+    COMPILER_AST_NODES(_VISITOR_VISIT)
+#undef _VISITOR_VISIT
 };
 
 COMPILER_API_END
 
 #define _PARSER_VISITOR_HPP
-#endif // !_PARSER_VISITOR_HPP
\ No newline at end of file
+#endif // !_PARSER_VISITOR_HPP
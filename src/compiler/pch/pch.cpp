@@ -0,0 +1,695 @@
+#include "pch.hpp"
+
+#include "../parser/static_visitor.hpp"
+#include "../parser/name_collector.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace compiler;
+using namespace compiler::pch;
+
+namespace {
+
+constexpr char image_magic[8] = { 'C', 'P', 'C', 'H', 'I', 'M', 'G', '\0' };
+constexpr std::uint32_t header_size = 32;
+constexpr std::uint32_t string_entry_size = 8;
+constexpr std::uint32_t decl_entry_size = 16;
+// deeper than anything the parser produces, a corrupt image can't recurse forever.
+constexpr std::uint32_t max_depth = 4096;
+
+// declaration flags.
+enum : std::uint32_t {
+    // a definition that ends up in every object including the header.
+    decl_emitted = 1 << 0,
+};
+
+inline std::uint32_t read_u32(const std::uint8_t* data) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, data, sizeof(v));
+    return v;
+}
+
+inline void put_u32(std::vector<std::uint8_t>& out, std::size_t at, std::uint32_t v) noexcept {
+    std::memcpy(out.data() + at, &v, sizeof(v));
+}
+
+bool is_expression(node_kind kind) noexcept {
+    switch (kind) {
+    case node_kind::assignment:
+    case node_kind::integer_literal:
+    case node_kind::string_literal:
+    case node_kind::name_expression:
+    case node_kind::binary_expression:
+    case node_kind::unary_expression:
+    case node_kind::call_expression:
+    case node_kind::subscript_expression:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Serializes nodes into the node stream, interning every string on the way.
+class image_writer : public static_visitor<image_writer> {
+private:
+    struct decl {
+        std::uint32_t name;
+        std::uint32_t offset;
+        std::uint32_t size;
+        std::uint32_t flags;
+    };
+
+    std::vector<std::uint8_t> m_nodes{};
+    std::vector<const std::string*> m_strings{};
+    std::unordered_map<std::string, std::uint32_t> m_string_ids{};
+    std::vector<decl> m_decls{};
+    // where the bytes of string literals are.
+    const string_pool& m_literals;
+public:
+    explicit image_writer(const string_pool& literals) noexcept
+        : m_literals(literals)
+    {}
+
+    void declaration(ast_node& node) noexcept {
+        const std::string* name = nullptr;
+        std::uint32_t flags = 0;
+        if (node.kind() == node_kind::function_declaration) {
+            const auto& fn = static_cast<function_declaration&>(node);
+            name = &fn.name();
+            flags = fn.has_body() && !fn.is_static() ? std::uint32_t{ decl_emitted } : std::uint32_t{ 0 };
+        }
+        else if (node.kind() == node_kind::assignment_declaration) {
+            const auto& var = static_cast<assignment_declaration&>(node);
+            name = &var.identifier();
+            flags = var.type().has_modifier(mod_static) || var.type().has_modifier(mod_extern) ? std::uint32_t{ 0 } : std::uint32_t{ decl_emitted };
+        }
+        else {
+            // only declarations have a name something can refer to.
+            return;
+        }
+        const auto offset = static_cast<std::uint32_t>(m_nodes.size());
+        write(node);
+        m_decls.push_back(decl{ intern(*name), offset, static_cast<std::uint32_t>(m_nodes.size()) - offset, flags });
+    }
+
+    std::vector<std::uint8_t> finish() noexcept {
+        std::vector<std::uint8_t> out(header_size);
+        std::memcpy(out.data(), image_magic, sizeof(image_magic));
+
+        // strings: the (offset, size) entries, then the bytes they point at.
+        const auto strings = static_cast<std::uint32_t>(out.size());
+        out.resize(out.size() + m_strings.size() * string_entry_size);
+        for (std::size_t i = 0; i < m_strings.size(); ++i) {
+            const auto& s = *m_strings[i];
+            put_u32(out, strings + i * string_entry_size, static_cast<std::uint32_t>(out.size()));
+            put_u32(out, strings + i * string_entry_size + 4, static_cast<std::uint32_t>(s.size()));
+            out.insert(out.end(), s.begin(), s.end());
+        }
+        out.resize((out.size() + 3) & ~std::size_t{ 3 });
+
+        // sorted by name, the header order breaks ties so a name's declarations stay in order.
+        std::sort(m_decls.begin(), m_decls.end(), [&](const decl& a, const decl& b) {
+            const auto order = m_strings[a.name]->compare(*m_strings[b.name]);
+            return order != 0 ? order < 0 : a.offset < b.offset;
+        });
+        const auto decls = static_cast<std::uint32_t>(out.size());
+        const auto nodes = decls + static_cast<std::uint32_t>(m_decls.size() * decl_entry_size);
+        out.resize(nodes);
+        for (std::size_t i = 0; i < m_decls.size(); ++i) {
+            const auto at = decls + i * decl_entry_size;
+            put_u32(out, at, m_decls[i].name);
+            put_u32(out, at + 4, nodes + m_decls[i].offset);
+            put_u32(out, at + 8, m_decls[i].size);
+            put_u32(out, at + 12, m_decls[i].flags);
+        }
+        out.insert(out.end(), m_nodes.begin(), m_nodes.end());
+
+        put_u32(out, 8, format_version);
+        put_u32(out, 12, static_cast<std::uint32_t>(m_strings.size()));
+        put_u32(out, 16, strings);
+        put_u32(out, 20, static_cast<std::uint32_t>(m_decls.size()));
+        put_u32(out, 24, decls);
+        put_u32(out, 28, nodes);
+        return out;
+    }
+
+    // static_visitor, the kind and location have already been written.
+    void visit_assignment(assignment& node) noexcept {
+        u8(static_cast<std::uint8_t>((node.target() != nullptr) | node.has_expression() << 1 | node.compound_op().has_value() << 2));
+        u32(intern(node.assignee()));
+        if (node.compound_op()) {
+            u8(static_cast<std::uint8_t>(*node.compound_op()));
+        }
+        if (node.target() != nullptr) {
+            write(*node.target());
+        }
+        if (node.has_expression()) {
+            write(**node.expression());
+        }
+    }
+    void visit_assignment_declaration(assignment_declaration& node) noexcept {
+        type(node.type());
+        u32(intern(node.identifier()));
+        optional(node.has_expr() ? node.expr() : nullptr);
+    }
+    void visit_integer_literal(integer_literal& node) noexcept {
+        u64(node.value());
+        u8(static_cast<std::uint8_t>(node.is_unsigned() | node.is_long() << 1));
+    }
+    void visit_string_literal(string_literal& node) noexcept {
+        u32(intern(m_literals.get(node.id())));
+    }
+    void visit_name_expression(name_expression& node) noexcept {
+        u32(intern(node.name()));
+    }
+    void visit_binary_expression(binary_expression& node) noexcept {
+        u8(static_cast<std::uint8_t>(node.op()));
+        write(node.lhs());
+        write(node.rhs());
+    }
+    void visit_unary_expression(unary_expression& node) noexcept {
+        u8(static_cast<std::uint8_t>(node.op()));
+        write(node.operand());
+    }
+    void visit_call_expression(call_expression& node) noexcept {
+        u32(intern(node.callee()));
+        u32(static_cast<std::uint32_t>(node.args().size()));
+        for (auto& arg : node.args()) {
+            write(*arg);
+        }
+    }
+    void visit_subscript_expression(subscript_expression& node) noexcept {
+        write(node.base());
+        write(node.index());
+    }
+    void visit_compound_statement(compound_statement& node) noexcept {
+        u32(static_cast<std::uint32_t>(node.items().size()));
+        for (auto& item : node.items()) {
+            write(*item);
+        }
+    }
+    void visit_expression_statement(expression_statement& node) noexcept {
+        optional(node.expr());
+    }
+    void visit_return_statement(return_statement& node) noexcept {
+        optional(node.expr());
+    }
+    void visit_if_statement(if_statement& node) noexcept {
+        write(node.condition());
+        write(node.then());
+        optional(node.otherwise());
+    }
+    void visit_while_statement(while_statement& node) noexcept {
+        write(node.condition());
+        write(node.body());
+    }
+    void visit_for_statement(for_statement& node) noexcept {
+        optional(node.init());
+        optional(node.condition());
+        optional(node.step());
+        write(node.body());
+    }
+    void visit_jump_statement(jump_statement& node) noexcept {
+        u8(static_cast<std::uint8_t>(node.jump()));
+    }
+    void visit_function_declaration(function_declaration& node) noexcept {
+        type(node.return_type());
+        u32(intern(node.name()));
+        u32(static_cast<std::uint32_t>(node.params().size()));
+        for (const auto& param : node.params()) {
+            type(param.type);
+            u32(intern(param.name));
+        }
+        optional(node.body());
+    }
+private:
+    inline void u8(std::uint8_t v) noexcept { m_nodes.push_back(v); }
+    inline void u32(std::uint32_t v) noexcept {
+        const auto at = m_nodes.size();
+        m_nodes.resize(at + sizeof(v));
+        std::memcpy(m_nodes.data() + at, &v, sizeof(v));
+    }
+    inline void u64(std::uint64_t v) noexcept {
+        const auto at = m_nodes.size();
+        m_nodes.resize(at + sizeof(v));
+        std::memcpy(m_nodes.data() + at, &v, sizeof(v));
+    }
+
+    std::uint32_t intern(const std::string& s) noexcept {
+        const auto [it, inserted] = m_string_ids.try_emplace(s, static_cast<std::uint32_t>(m_strings.size()));
+        if (inserted) {
+            m_strings.push_back(&it->first);
+        }
+        return it->second;
+    }
+
+    void type(const type_information& info) noexcept {
+        u32(intern(info.name()));
+        std::uint32_t flags = 0;
+        for (std::size_t i = 0; i < mod_count; ++i) {
+            flags |= static_cast<std::uint32_t>(info.has_modifier(static_cast<type_modifier>(i))) << i;
+        }
+        u32(flags);
+        u8(static_cast<std::uint8_t>(info.kind()));
+        u32(static_cast<std::uint32_t>(info.pointer_depth()));
+    }
+
+    void write(ast_node& node) noexcept {
+        u8(static_cast<std::uint8_t>(node.kind()));
+        u32(intern(node.location().source_file()));
+        u32(static_cast<std::uint32_t>(node.location().line()));
+        u32(static_cast<std::uint32_t>(node.location().column()));
+        visit(node);
+    }
+
+    void optional(ast_node* node) noexcept {
+        u8(node != nullptr);
+        if (node != nullptr) {
+            write(*node);
+        }
+    }
+};
+
+static_assert(mod_count <= 32, "the type flags of a pch image are 32 bits.");
+
+// Decodes one declaration from the node stream. Any read past its end, or a node where the
+// grammar can't have one, marks the whole declaration as corrupt.
+class node_reader {
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_pos{ 0 };
+    std::uint32_t m_depth{ 0 };
+    bool m_failed{ false };
+    // strings are looked up in the image's string table.
+    const image& m_image;
+    // string literals are interned into the TU's pool.
+    string_pool& m_literals;
+public:
+    node_reader(const std::uint8_t* data, std::size_t size, const image& image, string_pool& literals) noexcept
+        : m_data(data)
+        , m_size(size)
+        , m_image(image)
+        , m_literals(literals)
+    {}
+
+    inline bool ok() const noexcept { return !m_failed && m_pos == m_size; }
+
+    node_ptr node() noexcept {
+        if (++m_depth > max_depth) {
+            m_failed = true;
+        }
+        const auto kind = static_cast<node_kind>(u8());
+        const auto file = string();
+        const auto line = u32();
+        const auto column = u32();
+        if (m_failed || kind >= node_kind::count) {
+            m_failed = true;
+            return nullptr;
+        }
+        const auto location = source_location::from(std::move(file), line, column);
+
+        node_ptr out;
+        switch (kind) {
+        case node_kind::assignment: {
+            const auto flags = u8();
+            auto assignee = string();
+            std::optional<binary_op> op;
+            if (flags & 4) {
+                op = enumerator(binary_op::ge);
+            }
+            auto target = (flags & 1) ? expression() : nullptr;
+            std::optional<expr_ptr> value;
+            if (flags & 2) {
+                value = expression();
+            }
+            auto result = target != nullptr
+                ? std::make_unique<assignment>(std::move(target), location, std::move(value))
+                : std::make_unique<assignment>(assignee, location, std::move(value));
+            if (op) {
+                result->set_compound_op(*op);
+            }
+            out = std::move(result);
+            break;
+        }
+        case node_kind::assignment_declaration: {
+            auto info = type();
+            auto name = string();
+            std::optional<expr_ptr> init;
+            if (u8()) {
+                init = expression();
+            }
+            out = std::make_unique<assignment_declaration>(info, name, location, std::move(init));
+            break;
+        }
+        case node_kind::integer_literal: {
+            const auto value = u64();
+            const auto flags = u8();
+            out = std::make_unique<integer_literal>(value, location, (flags & 1) != 0, (flags & 2) != 0);
+            break;
+        }
+        case node_kind::string_literal:
+            out = std::make_unique<string_literal>(m_literals.intern(m_image.string(u32())), location);
+            break;
+        case node_kind::name_expression:
+            out = std::make_unique<name_expression>(string(), location);
+            break;
+        case node_kind::binary_expression: {
+            const auto op = enumerator(binary_op::ge);
+            auto lhs = expression();
+            auto rhs = expression();
+            out = std::make_unique<binary_expression>(op, std::move(lhs), std::move(rhs), location);
+            break;
+        }
+        case node_kind::unary_expression: {
+            const auto op = enumerator(unary_op::post_decrement);
+            out = std::make_unique<unary_expression>(op, expression(), location);
+            break;
+        }
+        case node_kind::call_expression: {
+            auto callee = string();
+            const auto count = u32();
+            std::vector<expr_ptr> args;
+            for (std::uint32_t i = 0; i < count && !m_failed; ++i) {
+                args.push_back(expression());
+            }
+            out = std::make_unique<call_expression>(callee, std::move(args), location);
+            break;
+        }
+        case node_kind::subscript_expression: {
+            auto base = expression();
+            auto index = expression();
+            out = std::make_unique<subscript_expression>(std::move(base), std::move(index), location);
+            break;
+        }
+        case node_kind::compound_statement:
+            out = compound(location);
+            break;
+        case node_kind::expression_statement:
+            out = std::make_unique<expression_statement>(optional_expression(), location);
+            break;
+        case node_kind::return_statement:
+            out = std::make_unique<return_statement>(optional_expression(), location);
+            break;
+        case node_kind::if_statement: {
+            auto condition = expression();
+            auto then = required();
+            auto otherwise = optional();
+            out = std::make_unique<if_statement>(std::move(condition), std::move(then), std::move(otherwise), location);
+            break;
+        }
+        case node_kind::while_statement: {
+            auto condition = expression();
+            auto body = required();
+            out = std::make_unique<while_statement>(std::move(condition), std::move(body), location);
+            break;
+        }
+        case node_kind::for_statement: {
+            auto init = optional();
+            auto condition = optional_expression();
+            auto step = optional_expression();
+            auto body = required();
+            out = std::make_unique<for_statement>(std::move(init), std::move(condition), std::move(step), std::move(body), location);
+            break;
+        }
+        case node_kind::jump_statement:
+            out = std::make_unique<jump_statement>(enumerator(jump_kind::continue_), location);
+            break;
+        case node_kind::function_declaration: {
+            auto return_type = type();
+            auto name = string();
+            const auto count = u32();
+            std::vector<parameter> params;
+            for (std::uint32_t i = 0; i < count && !m_failed; ++i) {
+                auto param_type = type();
+                params.push_back(parameter{ std::move(param_type), string() });
+            }
+            std::unique_ptr<compound_statement> body;
+            if (u8()) {
+                auto item = node();
+                if (item != nullptr && item->kind() == node_kind::compound_statement) {
+                    body.reset(static_cast<compound_statement*>(item.release()));
+                }
+                else {
+                    m_failed = true;
+                }
+            }
+            out = std::make_unique<function_declaration>(return_type, name, std::move(params), std::move(body), location);
+            break;
+        }
+        case node_kind::count:
+            break;
+        }
+        --m_depth;
+        return m_failed ? nullptr : std::move(out);
+    }
+private:
+    inline bool has(std::size_t bytes) noexcept {
+        if (m_failed || m_size - m_pos < bytes) {
+            m_failed = true;
+            return false;
+        }
+        return true;
+    }
+    inline std::uint8_t u8() noexcept {
+        return has(1) ? m_data[m_pos++] : 0;
+    }
+    // A byte that has to be an enumerator of E, "last" is the highest one. A corrupt (or
+    // stale) image can't hand out values the switches over E don't handle.
+    template<class E>
+    inline E enumerator(E last) noexcept {
+        const auto v = u8();
+        if (v > static_cast<std::uint8_t>(last)) {
+            m_failed = true;
+            return E{};
+        }
+        return static_cast<E>(v);
+    }
+    inline std::uint32_t u32() noexcept {
+        if (!has(4)) {
+            return 0;
+        }
+        const auto v = read_u32(m_data + m_pos);
+        m_pos += 4;
+        return v;
+    }
+    inline std::uint64_t u64() noexcept {
+        if (!has(8)) {
+            return 0;
+        }
+        std::uint64_t v;
+        std::memcpy(&v, m_data + m_pos, sizeof(v));
+        m_pos += 8;
+        return v;
+    }
+    inline std::string string() noexcept {
+        return std::string{ m_image.string(u32()) };
+    }
+
+    type_information type() noexcept {
+        auto name = string();
+        const auto flags = u32();
+        const auto kind = enumerator(type_kind::aggregate);
+        const auto depth = u32();
+        auto info = type_information{ name, kind, std::bitset<mod_count>{ flags } };
+        info.set_pointer_depth(depth);
+        return info;
+    }
+
+    // A node that has to be there.
+    node_ptr required() noexcept {
+        auto out = node();
+        if (out == nullptr) {
+            m_failed = true;
+        }
+        return out;
+    }
+    node_ptr optional() noexcept {
+        return u8() ? required() : nullptr;
+    }
+    expr_ptr expression() noexcept {
+        auto out = required();
+        if (out == nullptr || !is_expression(out->kind())) {
+            m_failed = true;
+            return nullptr;
+        }
+        return expr_ptr{ static_cast<compiler::expression*>(out.release()) };
+    }
+    expr_ptr optional_expression() noexcept {
+        return u8() ? expression() : nullptr;
+    }
+
+    std::unique_ptr<compound_statement> compound(const source_location& location) noexcept {
+        const auto count = u32();
+        std::vector<node_ptr> items;
+        for (std::uint32_t i = 0; i < count && !m_failed; ++i) {
+            items.push_back(required());
+        }
+        return std::make_unique<compound_statement>(std::move(items), location);
+    }
+};
+
+} // namespace
+
+std::vector<std::uint8_t> pch::build_image(ast& tree, const string_pool& literals) noexcept {
+    image_writer writer{ literals };
+    for (auto& node : tree) {
+        writer.declaration(*node);
+    }
+    return writer.finish();
+}
+
+result<void, error> pch::write_image(ast& tree, const string_pool& literals, const std::string& path) noexcept {
+    const auto bytes = build_image(tree, literals);
+    auto file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+    if (!file) {
+        return error("failed to open `{}` for writing.", path);
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        return error("failed to write `{}`.", path);
+    }
+    return {};
+}
+
+result<image, error> image::open(const std::string& path) noexcept {
+    RESULT_TRY(file, mapped_file::open(path));
+    image out{};
+    out.m_file = std::move(file);
+    const auto* data = out.m_file.data();
+    const auto size = out.m_file.size();
+    if (size < header_size || std::memcmp(data, image_magic, sizeof(image_magic)) != 0) {
+        return error("`{}` is not a precompiled header.", path);
+    }
+    if (read_u32(data + 8) != format_version) {
+        return error("`{}` was written by a different version of the compiler. (format {}, expected {})",
+            path, read_u32(data + 8), format_version);
+    }
+    out.m_string_count = read_u32(data + 12);
+    out.m_strings = read_u32(data + 16);
+    out.m_decl_count = read_u32(data + 20);
+    out.m_decls = read_u32(data + 24);
+    if (out.m_strings > size || (size - out.m_strings) / string_entry_size < out.m_string_count
+        || out.m_decls > size || (size - out.m_decls) / decl_entry_size < out.m_decl_count) {
+        return error("`{}` is a corrupt precompiled header.", path);
+    }
+    out.m_loaded.assign(out.m_decl_count, false);
+    return out;
+}
+
+std::string_view image::string(std::uint32_t id) const noexcept {
+    if (id >= m_string_count) {
+        return {};
+    }
+    const auto* entry = m_file.data() + m_strings + id * string_entry_size;
+    const auto offset = read_u32(entry);
+    const auto size = read_u32(entry + 4);
+    if (offset > m_file.size() || m_file.size() - offset < size) {
+        return {};
+    }
+    return { reinterpret_cast<const char*>(m_file.data() + offset), size };
+}
+
+std::pair<std::uint32_t, std::uint32_t> image::find(std::string_view name) const noexcept {
+    const auto name_of = [&](std::uint32_t decl) {
+        return string(read_u32(m_file.data() + m_decls + decl * decl_entry_size));
+    };
+    std::uint32_t lo = 0, hi = m_decl_count;
+    while (lo < hi) {
+        const auto mid = lo + (hi - lo) / 2;
+        if (name_of(mid) < name) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    auto end = lo;
+    while (end < m_decl_count && name_of(end) == name) {
+        ++end;
+    }
+    return { lo, end };
+}
+
+result<node_ptr, error> image::decode(std::uint32_t decl, string_pool& literals) noexcept {
+    const auto* entry = m_file.data() + m_decls + decl * decl_entry_size;
+    const auto offset = read_u32(entry + 4);
+    const auto size = read_u32(entry + 8);
+    if (offset > m_file.size() || m_file.size() - offset < size) {
+        return error("corrupt precompiled header, declaration {} is out of bounds.", decl);
+    }
+
+    auto reader = node_reader{ m_file.data() + offset, size, *this, literals };
+    auto node = reader.node();
+    if (node == nullptr || !reader.ok()) {
+        return error("corrupt precompiled header, declaration `{}` can't be decoded.", string(read_u32(entry)));
+    }
+    m_loaded[decl] = true;
+    return node;
+}
+
+result<void, error> image::load(std::string_view name, ast& out, string_pool& literals) noexcept {
+    const auto [begin, end] = find(name);
+    for (auto decl = begin; decl < end; ++decl) {
+        if (m_loaded[decl]) {
+            continue;
+        }
+        RESULT_TRY(node, decode(decl, literals));
+        out.push_back(std::move(node));
+    }
+    return {};
+}
+
+result<void, error> image::prepend_to(ast& tree, string_pool& literals) noexcept {
+    // (offset in the image, node), sorted by offset at the end to get the header order.
+    std::vector<std::pair<std::uint32_t, node_ptr>> loaded;
+    std::vector<std::string> names;
+    auto collector = name_collector{ names };
+    const auto take = [&](std::uint32_t decl) -> result<void, error> {
+        RESULT_TRY(node, decode(decl, literals));
+        collector.visit(*node);
+        loaded.emplace_back(read_u32(m_file.data() + m_decls + decl * decl_entry_size + 4), std::move(node));
+        return {};
+    };
+
+    for (std::uint32_t decl = 0; decl < m_decl_count; ++decl) {
+        if (!m_loaded[decl] && (read_u32(m_file.data() + m_decls + decl * decl_entry_size + 12) & decl_emitted)) {
+            RESULT_CHECK(take(decl));
+        }
+    }
+    for (auto& node : tree) {
+        collector.visit(*node);
+    }
+
+    std::unordered_set<std::string> seen;
+    while (!names.empty()) {
+        auto name = std::move(names.back());
+        names.pop_back();
+        if (!seen.insert(name).second) {
+            continue;
+        }
+        const auto [begin, end] = find(name);
+        for (auto decl = begin; decl < end; ++decl) {
+            if (m_loaded[decl]) {
+                continue;
+            }
+            RESULT_CHECK(take(decl));
+        }
+    }
+
+    std::sort(loaded.begin(), loaded.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    ast merged;
+    merged.reserve(loaded.size() + tree.size());
+    for (auto& [offset, node] : loaded) {
+        merged.push_back(std::move(node));
+    }
+    for (auto& node : tree) {
+        merged.push_back(std::move(node));
+    }
+    tree = std::move(merged);
+    return {};
+}
@@ -0,0 +1,82 @@
+#ifndef _COMPILER_PCH_PCH_HPP
+
+#include "../../common/common.hpp"
+#include "../../common/result.hpp"
+#include "../../common/error.hpp"
+#include "../../common/mapped_file.hpp"
+
+#include "../parser/parser.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace pch {
+
+/*
+  Precompiled headers. The top level declarations of a parsed header are serialized into
+  one position independent image:
+
+    header        magic, format version and the offsets of the three tables below
+    strings       every identifier, type name, file name and string literal once, as
+                  (offset, size) pairs followed by the bytes
+    declarations  (name, node offset, node size, flags) for every top level declaration,
+                  sorted by name so a lookup is a binary search straight on the image
+    nodes         each declaration as a pre-order stream of its nodes, strings are indices
+                  into the string table
+
+  Every offset is relative to the start of the image and nothing in it is a pointer, so a
+  TU maps the file read-only and uses it in place. Opening an image only checks the header,
+  a declaration is decoded into AST nodes the first time something refers to its name.
+*/
+inline constexpr std::uint32_t format_version = 2;
+
+// Serialize the top level declarations of a parsed header, "literals" has the bytes of its
+// string literals.
+NODISCARD std::vector<std::uint8_t> build_image(ast& tree, const string_pool& literals) noexcept;
+// build_image() and write the result to "path".
+NODISCARD result<void, error> write_image(ast& tree, const string_pool& literals, const std::string& path) noexcept;
+
+// A mapped image, see above.
+class image {
+private:
+    mapped_file m_file{};
+    std::uint32_t m_string_count{ 0 };
+    std::uint32_t m_strings{ 0 };
+    std::uint32_t m_decl_count{ 0 };
+    std::uint32_t m_decls{ 0 };
+    // whether each declaration has been decoded already.
+    std::vector<bool> m_loaded{};
+
+    image() = default;
+public:
+    image(image&&) = default;
+    image& operator=(image&&) = default;
+
+    static result<image, error> open(const std::string& path) noexcept;
+
+    inline std::uint32_t declaration_count() const noexcept { return m_decl_count; }
+
+    // Decode the declarations of "name" that haven't been decoded yet, in header order. Their
+    // string literals are interned into "literals", the TU's pool.
+    NODISCARD result<void, error> load(std::string_view name, ast& out, string_pool& literals) noexcept;
+
+    // Put what "tree" needs from the header in front of it, as if the header had been
+    // included: everything "tree" refers to (and what that refers to, transitively), and
+    // the definitions that are always emitted (non-static functions and globals).
+    NODISCARD result<void, error> prepend_to(ast& tree, string_pool& literals) noexcept;
+    // String "id" of the string table, empty if it doesn't exist.
+    std::string_view string(std::uint32_t id) const noexcept;
+private:
+    // The range of declarations named "name" in the sorted declaration table.
+    std::pair<std::uint32_t, std::uint32_t> find(std::string_view name) const noexcept;
+    NODISCARD result<node_ptr, error> decode(std::uint32_t decl, string_pool& literals) noexcept;
+};
+
+} // namespace pch
+COMPILER_API_END
+
+#define _COMPILER_PCH_PCH_HPP
+#endif // !_COMPILER_PCH_PCH_HPP
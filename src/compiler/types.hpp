@@ -4,6 +4,7 @@
 
 #include "../common/common.hpp"
 #include "lexing/token_type.hpp"
+#include "lexing/string_pool.hpp"
 
 #include "../common/error.hpp"
 #include "../common/result.hpp"
@@ -14,6 +15,8 @@
 #include <cstddef>
 #include <bitset>
 #include <array>
+#include <bit>
+#include <cstdint>
 
 COMPILER_API_BEGIN
 
@@ -59,6 +62,56 @@ public:
     }
 };
 
+// The value of a numeric literal, decoded once by the lexer. Floating point values are
+// kept as the bits of a double ("f" suffixed ones are rounded to float first).
+class numeric_value {
+private:
+    std::uint64_t m_bits{ 0 };
+    bool m_is_floating{ false };
+    bool m_is_unsigned{ false };
+    // 1 for an "l" suffix, 2 for "ll".
+    std::uint8_t m_long_count{ 0 };
+    bool m_is_float{ false };
+public:
+    numeric_value() = default;
+
+    static inline numeric_value from_integer(std::uint64_t value, bool is_unsigned, std::uint8_t long_count) noexcept {
+        auto number = numeric_value{};
+        number.m_bits = value;
+        number.m_is_unsigned = is_unsigned;
+        number.m_long_count = long_count;
+        return number;
+    }
+    static inline numeric_value from_floating(double value, bool is_float, bool is_long) noexcept {
+        auto number = numeric_value{};
+        number.m_bits = std::bit_cast<std::uint64_t>(value);
+        number.m_is_floating = true;
+        number.m_is_float = is_float;
+        number.m_long_count = is_long ? 1 : 0;
+        return number;
+    }
+
+    inline bool is_floating() const noexcept { return m_is_floating; }
+    // The value of an integer literal. (never negative, "-1" is a negation of 1)
+    inline std::uint64_t integer() const noexcept { return m_bits; }
+    inline double floating() const noexcept { return std::bit_cast<double>(m_bits); }
+    inline std::uint64_t bits() const noexcept { return m_bits; }
+
+    inline bool is_unsigned() const noexcept { return m_is_unsigned; }
+    inline bool is_long() const noexcept { return m_long_count != 0; }
+    inline std::uint8_t long_count() const noexcept { return m_long_count; }
+    // Has the "f" suffix.
+    inline bool is_float() const noexcept { return m_is_float; }
+
+    inline std::string to_string() const noexcept {
+        const auto longs = std::string(m_long_count, 'l');
+        if (m_is_floating) {
+            return std::format("{}{}{}", floating(), m_is_float ? "f" : "", longs);
+        }
+        return std::format("{}{}{}", integer(), m_is_unsigned ? "u" : "", longs);
+    }
+};
+
 // A token formed from lexical analysis.
 class token {
 private:
@@ -66,6 +119,8 @@ private:
     source_span m_span;
     source_location m_location;
     std::optional<std::string> m_lexeme;
+    numeric_value m_number{};
+    string_id m_string{ 0 };
 public:
     token() = delete;
 
@@ -77,6 +132,15 @@ public:
     ) : m_type(type), m_span(span), m_location(location), m_lexeme(lexeme)
     {}
 
+    // A numeric literal, it has no lexeme.
+    inline
+    token(token_type type,
+          source_span span,
+          source_location location,
+          numeric_value number
+    ) : m_type(type), m_span(span), m_location(location), m_number(number)
+    {}
+
     // the type of this token.
     inline token_type type() const noexcept { return m_type; }
     // the span at which this token occurs at.
@@ -84,9 +148,14 @@ public:
     // this tokens source location.
     inline const source_location& location() const noexcept { return m_location; }
 
-    // The optional contents attached to this token. This is set when the type() is an identifier, string or number.
+    // The optional contents attached to this token. This is set when the type() is an identifier or character, numbers have number() and strings string().
     inline const std::optional<std::string>& lexeme() const noexcept { return m_lexeme; }
     inline std::optional<std::string>& lexeme() noexcept { return m_lexeme; }
+    // The decoded value of an integer or floating point literal.
+    inline const numeric_value& number() const noexcept { return m_number; }
+    // The pool id of a string literal's decoded bytes, see lexer::release_strings().
+    inline string_id string() const noexcept { return m_string; }
+    inline void set_string(string_id id) noexcept { m_string = id; }
 
     inline std::string to_string() const noexcept {
         bool has_content = lexeme().has_value();
@@ -97,6 +166,12 @@ public:
                 content,
                 location().to_string());
         }
+        if (type() == token_type::INTEGER_LITERAL || type() == token_type::FLOATING_POINT_LITERAL) {
+            return std::format("Token({}) [{}] at ({})",
+                token_type_to_string(type()),
+                number().to_string(),
+                location().to_string());
+        }
         return std::format("Token({}) at ({})", token_type_to_string(type()), location().to_string());
     }
 };
@@ -118,6 +193,8 @@ enum type_modifier {
   mod_long_long_int,
   mod_long,
   mod_long_long,
+  // "inline", this is a function specifier but it's stored with the rest.
+  mod_inline,
     
   // not included, just for the size of a bitset 
   mod_count  
@@ -150,6 +227,8 @@ private:
     std::string m_name;
     std::bitset<mod_count> m_flags;
     type_kind m_kind;
+    // how many levels of indirection, "int**" has a depth of 2.
+    std::size_t m_pointer_depth{ 0 };
 public:
     type_information() = delete;
     inline explicit type_information(const std::string& name, type_kind kind, auto... flags) noexcept {
@@ -191,6 +270,19 @@ public:
     inline auto kind() const noexcept -> type_kind {
         return m_kind;
     }
+    inline auto pointer_depth() const noexcept -> std::size_t {
+        return m_pointer_depth;
+    }
+    inline auto set_pointer_depth(std::size_t depth) noexcept -> void {
+        m_pointer_depth = depth;
+        m_flags.set(mod_pointer, depth != 0);
+    }
+    inline auto is_pointer() const noexcept -> bool {
+        return m_pointer_depth != 0;
+    }
+    inline auto is_void() const noexcept -> bool {
+        return m_name == "void" && !is_pointer();
+    }
 
     static inline type_information new_integral(const std::string& name, auto... flags) noexcept {
         return type_information(name, type_kind::integral, flags...);
@@ -0,0 +1,261 @@
+#include "cache.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+using namespace compiler;
+using namespace compiler::driver;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char entry_magic[8] = { 'C', 'C', 'A', 'C', 'H', 'E', '0', '1' };
+// eviction goes down to this fraction of the limit, so the next few stores don't walk again.
+constexpr std::uint64_t evict_to_percent = 90;
+
+// 128 bits from two independently seeded 64-bit lanes. Not cryptographic, it only has to
+// keep different inputs apart.
+class hasher {
+private:
+    std::uint64_t m_a{ 0x9E3779B97F4A7C15ull };
+    std::uint64_t m_b{ 0xC2B2AE3D27D4EB4Full };
+
+    static inline std::uint64_t rotl(std::uint64_t v, int n) noexcept {
+        return (v << n) | (v >> (64 - n));
+    }
+    // splitmix64's finalizer.
+    static inline std::uint64_t avalanche(std::uint64_t v) noexcept {
+        v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ull;
+        v = (v ^ (v >> 27)) * 0x94D049BB133111EBull;
+        return v ^ (v >> 31);
+    }
+    inline void word(std::uint64_t v) noexcept {
+        m_a = rotl(m_a ^ (v * 0x87C37B91114253D5ull), 31) * 0x4CF5AD432745937Full;
+        m_b = rotl(m_b ^ (v * 0xFF51AFD7ED558CCDull), 27) * 0x52DCE729ull + m_a;
+    }
+public:
+    inline void u64(std::uint64_t v) noexcept { word(v); }
+
+    inline void bytes(std::string_view data) noexcept {
+        word(data.size());
+        std::size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            std::uint64_t v;
+            std::memcpy(&v, data.data() + i, 8);
+            word(v);
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+        word(tail);
+    }
+
+    inline std::string hex() const noexcept {
+        const std::uint64_t lanes[] = { avalanche(m_a ^ rotl(m_b, 17)), avalanche(m_b + m_a) };
+        return std::format("{:016x}{:016x}", lanes[0], lanes[1]);
+    }
+};
+
+// Something that changes whenever the compiler is rebuilt, the version alone doesn't.
+void hash_executable(hasher& h) noexcept {
+    std::error_code ec;
+    const auto exe = fs::read_symlink("/proc/self/exe", ec);
+    if (ec) {
+        return;
+    }
+    const auto size = fs::file_size(exe, ec);
+    const auto time = fs::last_write_time(exe, ec);
+    if (!ec) {
+        h.u64(size);
+        h.u64(static_cast<std::uint64_t>(time.time_since_epoch().count()));
+    }
+}
+
+std::uint64_t read_u64(const char* data) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, data, 8);
+    return v;
+}
+
+// Write "contents" to a temporary file next to "path" and rename it over "path", readers
+// only ever see a whole file.
+bool write_atomically(const fs::path& path, std::string_view contents) noexcept {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    auto tmp = path;
+    tmp += std::format(".tmp{:x}", std::random_device{}());
+    {
+        auto file = std::ofstream{ tmp, std::ios::binary | std::ios::trunc };
+        if (!file) {
+            return false;
+        }
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!file) {
+            file.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::string read_file(const fs::path& path) noexcept {
+    auto file = std::ifstream{ path, std::ios::binary };
+    if (!file) {
+        return {};
+    }
+    return std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+}
+
+} // namespace
+
+std::string compile_cache::key(
+    const std::vector<token>& tokens,
+    const string_pool& strings,
+    const compile_options& options,
+    std::string_view version
+) noexcept {
+    hasher h;
+    h.bytes(version);
+    hash_executable(h);
+
+    // the flags that change the object or the diagnostics. The input's name is in every
+    // diagnostic, the thread count changes nothing. A precompiled header is part of the
+    // input, its path and modification time stand in for its contents.
+    h.bytes(options.input);
+    h.u64(static_cast<std::uint64_t>(options.opt_level));
+    h.u64(options.target.vector_bytes);
+    h.u64(options.opt_remarks);
+    h.u64(options.lazy_bodies);
+    h.u64(static_cast<std::uint64_t>(options.diagnostics_format));
+    if (!options.include_pch.empty()) {
+        h.bytes(options.include_pch);
+        std::error_code ec;
+        const auto size = fs::file_size(options.include_pch, ec);
+        const auto time = fs::last_write_time(options.include_pch, ec);
+        h.u64(ec ? 0 : size);
+        h.u64(ec ? 0 : static_cast<std::uint64_t>(time.time_since_epoch().count()));
+    }
+
+    for (const auto& tok : tokens) {
+        h.u64(static_cast<std::uint64_t>(tok.type()));
+        h.u64(tok.location().line() << 32 | tok.location().column());
+        if (tok.lexeme()) {
+            h.bytes(*tok.lexeme());
+        }
+        else if (tok.type() == token_type::INTEGER_LITERAL || tok.type() == token_type::FLOATING_POINT_LITERAL) {
+            const auto& number = tok.number();
+            h.u64(number.bits());
+            h.u64(number.is_unsigned() | number.is_float() << 1 | number.long_count() << 2);
+        }
+        else if (tok.type() == token_type::STRING_LITERAL) {
+            h.bytes(strings.get(tok.string()));
+        }
+        else {
+            h.u64(~std::uint64_t{ 0 });
+        }
+    }
+    return h.hex();
+}
+
+fs::path compile_cache::path_of(const std::string& key) const noexcept {
+    return m_dir / key.substr(0, 2) / key.substr(2);
+}
+
+std::optional<cache_entry> compile_cache::lookup(const std::string& key) const noexcept {
+    const auto path = path_of(key);
+    const auto contents = read_file(path);
+    constexpr auto header = sizeof(entry_magic) + 16;
+    if (contents.size() < header || std::memcmp(contents.data(), entry_magic, sizeof(entry_magic)) != 0) {
+        return std::nullopt;
+    }
+    const auto diagnostics = read_u64(contents.data() + 8);
+    const auto object = read_u64(contents.data() + 16);
+    if (diagnostics > contents.size() - header || object != contents.size() - header - diagnostics) {
+        return std::nullopt;
+    }
+
+    cache_entry entry{};
+    entry.diagnostics.assign(contents.data() + header, diagnostics);
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(contents.data() + header + diagnostics);
+    entry.object.assign(bytes, bytes + object);
+
+    // this entry was just used, it goes to the back of the eviction order.
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return entry;
+}
+
+void compile_cache::store(const std::string& key, const cache_entry& entry) const noexcept {
+    std::string contents;
+    contents.reserve(sizeof(entry_magic) + 16 + entry.diagnostics.size() + entry.object.size());
+    contents.append(entry_magic, sizeof(entry_magic));
+    const std::uint64_t sizes[] = { entry.diagnostics.size(), entry.object.size() };
+    contents.append(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    contents += entry.diagnostics;
+    contents.append(reinterpret_cast<const char*>(entry.object.data()), entry.object.size());
+
+    if (write_atomically(path_of(key), contents)) {
+        account(contents.size());
+    }
+}
+
+void compile_cache::account(std::uint64_t bytes) const noexcept {
+    // racing compilers can lose an update here, the next eviction recounts from the files.
+    const auto path = m_dir / "size";
+    std::uint64_t total = 0;
+    const auto text = read_file(path);
+    std::from_chars(text.data(), text.data() + text.size(), total);
+    total += bytes;
+    if (total > m_max_size) {
+        evict();
+        return;
+    }
+    DISCARD(write_atomically(path, std::to_string(total)));
+}
+
+void compile_cache::evict() const noexcept {
+    struct file {
+        fs::file_time_type time;
+        std::uint64_t size;
+        fs::path path;
+    };
+    std::vector<file> files;
+    std::uint64_t total = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator{ m_dir, ec }; !ec && it != fs::recursive_directory_iterator{}; it.increment(ec)) {
+        // "size" and anything else at the top isn't an entry.
+        std::error_code file_ec;
+        if (!it->is_regular_file(file_ec) || it->path().parent_path() == m_dir) {
+            continue;
+        }
+        const auto size = it->file_size(file_ec);
+        const auto time = it->last_write_time(file_ec);
+        if (!file_ec) {
+            files.push_back(file{ time, size, it->path() });
+            total += size;
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const file& a, const file& b) { return a.time < b.time; });
+    const auto target = m_max_size / 100 * evict_to_percent;
+    for (const auto& f : files) {
+        if (total <= target) {
+            break;
+        }
+        if (fs::remove(f.path, ec)) {
+            total -= f.size;
+        }
+    }
+    DISCARD(write_atomically(m_dir / "size", std::to_string(total)));
+}
@@ -0,0 +1,70 @@
+#ifndef _DRIVER_CACHE_HPP
+
+#include "../common/common.hpp"
+
+#include "../compiler/types.hpp"
+#include "options.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace driver {
+
+// What a compilation produced, everything a cache hit has to reproduce.
+struct cache_entry {
+    // the text that was written to stderr.
+    std::string diagnostics{};
+    // the ELF object.
+    std::vector<std::uint8_t> object{};
+};
+
+/*
+  A local, content-addressed cache of compilations, the same idea as ccache but without the
+  wrapper process. The key hashes everything that can change the output: the token stream,
+  the flags that matter, the compilers version and the compiler binary itself. Entries live
+  in "<dir>/<2 hex digits>/<rest of the key>" and are written to a temporary file first, so
+  several compilers can share a directory.
+
+  Lookups touch the entry's modification time, that's the "recently used" of the LRU. The
+  total size is kept in "<dir>/size" and only once it goes over the limit is the directory
+  walked and the oldest entries removed. Nothing in here ever fails a compilation, a cache
+  that can't be read or written is just a miss.
+*/
+class compile_cache {
+private:
+    std::filesystem::path m_dir;
+    std::uint64_t m_max_size;
+public:
+    inline compile_cache(std::filesystem::path dir, std::uint64_t max_size) noexcept
+        : m_dir(std::move(dir))
+        , m_max_size(max_size)
+    {}
+
+    // The key of compiling "tokens" (with the string literals in "strings") with "options",
+    // a hex string.
+    NODISCARD static std::string key(
+        const std::vector<token>& tokens,
+        const string_pool& strings,
+        const compile_options& options,
+        std::string_view version
+    ) noexcept;
+
+    NODISCARD std::optional<cache_entry> lookup(const std::string& key) const noexcept;
+    void store(const std::string& key, const cache_entry& entry) const noexcept;
+private:
+    std::filesystem::path path_of(const std::string& key) const noexcept;
+    // Add "bytes" to the size file, and evict if that goes over the limit.
+    void account(std::uint64_t bytes) const noexcept;
+    void evict() const noexcept;
+};
+
+} // namespace driver
+COMPILER_API_END
+
+#define _DRIVER_CACHE_HPP
+#endif // !_DRIVER_CACHE_HPP
@@ -0,0 +1,70 @@
+#include "deps.hpp"
+
+#include "../compiler/diagnostics/diag.hpp"
+
+#include <string_view>
+
+using namespace compiler;
+
+namespace {
+
+// the longest a line of a Makefile rule gets before it's continued, like cc -M.
+constexpr std::size_t make_line_width = 76;
+
+// Append "path" with the characters make treats specially escaped.
+void write_make_path(std::string& out, std::string_view path) noexcept {
+    for (const char c : path) {
+        switch (c) {
+        case ' ':
+        case '\t':
+        case '#':
+            out.push_back('\\');
+            out.push_back(c);
+            break;
+        case '$':
+            out += "$$";
+            break;
+        default:
+            out.push_back(c);
+            break;
+        }
+    }
+}
+
+} // namespace
+
+void driver::write_dependencies(std::string& out, const std::string& target, const std::string& source,
+    const std::vector<std::string>& headers, deps_format format) noexcept {
+    if (format == deps_format::json) {
+        out += "{\"target\":";
+        write_json_string(out, target);
+        out += ",\"source\":";
+        write_json_string(out, source);
+        out += ",\"dependencies\":[";
+        for (std::size_t i = 0; i < headers.size(); ++i) {
+            if (i != 0) {
+                out.push_back(',');
+            }
+            write_json_string(out, headers[i]);
+        }
+        out += "]}\n";
+        return;
+    }
+
+    auto line_start = out.size();
+    write_make_path(out, target);
+    out.push_back(':');
+    const auto write_prerequisite = [&](const std::string& path) {
+        if (out.size() - line_start + path.size() + 1 > make_line_width) {
+            out += " \\\n";
+            line_start = out.size();
+        }
+        out.push_back(' ');
+        write_make_path(out, path);
+    };
+    write_prerequisite(source);
+    for (const auto& header : headers) {
+        write_prerequisite(header);
+    }
+    out.push_back('\n');
+}
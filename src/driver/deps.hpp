@@ -0,0 +1,30 @@
+#ifndef _DRIVER_DEPS_HPP
+
+#include "../common/common.hpp"
+
+#include <string>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace driver {
+
+// How -M/-MD write the dependencies of a compilation.
+enum class deps_format {
+    // a Makefile rule, the same as cc -M (long ones are continued with a backslash):
+    //   a.o: a.c a.h b.h
+    make,
+    // one JSON object per line:
+    //   {"target":"a.o","source":"a.c","dependencies":["a.h","b.h"]}
+    json
+};
+
+// Append the dependencies of "target" (built from "source", which includes "headers") to
+// "out" in "format", ending with a newline.
+COMPILER_API void write_dependencies(std::string& out, const std::string& target, const std::string& source,
+    const std::vector<std::string>& headers, deps_format format) noexcept;
+
+} // namespace driver
+COMPILER_API_END
+
+#define _DRIVER_DEPS_HPP
+#endif // !_DRIVER_DEPS_HPP
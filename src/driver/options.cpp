@@ -0,0 +1,232 @@
+#include "options.hpp"
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
+
+using namespace compiler;
+
+result<driver::compile_options, error> driver::parse_options(int argc, char** argv) noexcept {
+    compile_options options{};
+
+    // NOTE: argv[0] is always the path of this executable.
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+
+        if (arg == "--emit-ir") {
+            options.emit_ir = true;
+            continue;
+        }
+        if (arg == "--time-passes") {
+            options.time_passes = true;
+            continue;
+        }
+        if (arg == "--opt-remarks") {
+            options.opt_remarks = true;
+            continue;
+        }
+        if (arg == "--emit-pch") {
+            options.emit_pch = true;
+            continue;
+        }
+        if (arg == "--include-pch") {
+            if (i + 1 >= argc) {
+                return error("expected a path after `--include-pch`");
+            }
+            options.include_pch = argv[++i];
+            continue;
+        }
+        if (arg == "--unity") {
+            options.unity = true;
+            continue;
+        }
+        if (arg == "--lazy-bodies") {
+            options.lazy_bodies = true;
+            continue;
+        }
+        if (arg.starts_with("--diagnostics-format=")) {
+            const auto format = arg.substr(arg.find('=') + 1);
+            if (format == "text") {
+                options.diagnostics_format = diag_format::text;
+            }
+            else if (format == "json") {
+                options.diagnostics_format = diag_format::json;
+            }
+            else {
+                return error("unknown diagnostics format `{}`. (expected text or json)", format);
+            }
+            continue;
+        }
+        if (arg.starts_with("-I")) {
+            auto directory = arg.substr(2);
+            if (directory.empty()) {
+                if (i + 1 >= argc) {
+                    return error("expected a directory after `-I`");
+                }
+                directory = argv[++i];
+            }
+            options.include_directories.emplace_back(directory);
+            continue;
+        }
+        if (arg == "-M") {
+            options.deps_only = true;
+            continue;
+        }
+        if (arg == "-MD") {
+            options.deps = true;
+            continue;
+        }
+        if (arg == "-MF") {
+            if (i + 1 >= argc) {
+                return error("expected a path after `-MF`");
+            }
+            options.deps_file = argv[++i];
+            continue;
+        }
+        if (arg.starts_with("--deps-format=")) {
+            const auto format = arg.substr(arg.find('=') + 1);
+            if (format == "make") {
+                options.dependency_format = deps_format::make;
+            }
+            else if (format == "json") {
+                options.dependency_format = deps_format::json;
+            }
+            else {
+                return error("unknown dependency format `{}`. (expected make or json)", format);
+            }
+            continue;
+        }
+        if (arg.starts_with("--dump-tokens=")) {
+            const auto format = arg.substr(arg.find('=') + 1);
+            if (format == "text") {
+                options.dump_tokens = token_dump::text;
+            }
+            else if (format == "bin") {
+                options.dump_tokens = token_dump::binary;
+            }
+            else {
+                return error("unknown token dump format `{}`. (expected text or bin)", format);
+            }
+            continue;
+        }
+        if (arg == "--load-tokens") {
+            options.load_tokens = true;
+            continue;
+        }
+        if (arg == "-mavx2") {
+            options.target.vector_bytes = 32;
+            continue;
+        }
+        if (arg == "--cache-dir") {
+            if (i + 1 >= argc) {
+                return error("expected a directory after `--cache-dir`");
+            }
+            options.cache_dir = argv[++i];
+            continue;
+        }
+        if (arg == "--cache-size") {
+            if (i + 1 >= argc) {
+                return error("expected a size after `--cache-size`");
+            }
+            const std::string_view size = argv[++i];
+            std::uint64_t bytes = 0;
+            const auto [end, ec] = std::from_chars(size.data(), size.data() + size.size(), bytes);
+            const std::string_view suffix{ end, size.data() + size.size() };
+            if (ec != std::errc{} || suffix.size() > 1) {
+                return error("invalid cache size `{}`. (expected a byte count, optionally followed by K, M or G)", size);
+            }
+            if (suffix == "K") {
+                bytes <<= 10;
+            }
+            else if (suffix == "M") {
+                bytes <<= 20;
+            }
+            else if (suffix == "G") {
+                bytes <<= 30;
+            }
+            else if (!suffix.empty()) {
+                return error("invalid cache size `{}`. (expected a byte count, optionally followed by K, M or G)", size);
+            }
+            options.cache_size = bytes;
+            continue;
+        }
+        if (arg.starts_with("-j")) {
+            auto count = arg.substr(2);
+            if (count.empty()) {
+                if (i + 1 >= argc) {
+                    return error("expected a thread count after `-j`");
+                }
+                count = argv[++i];
+            }
+            std::size_t threads = 0;
+            const auto [end, ec] = std::from_chars(count.data(), count.data() + count.size(), threads);
+            if (ec != std::errc{} || end != count.data() + count.size()) {
+                return error("invalid thread count `{}`", count);
+            }
+            options.threads = threads;
+            continue;
+        }
+        if (arg.starts_with("-O")) {
+            const auto level = arg.substr(2);
+            if (level == "0") {
+                options.opt_level = opt::opt_level::O0;
+            }
+            else if (level == "1" || level.empty()) {
+                options.opt_level = opt::opt_level::O1;
+            }
+            else if (level == "2") {
+                options.opt_level = opt::opt_level::O2;
+            }
+            else {
+                return error("unknown optimization level `{}`. (expected -O0, -O1 or -O2)", arg);
+            }
+            continue;
+        }
+        if (arg == "-c") {
+            // we only ever produce object files, this is accepted so we're a drop in for cc -c.
+            continue;
+        }
+        if (arg == "-o") {
+            if (i + 1 >= argc) {
+                return error("expected a path after `-o`");
+            }
+            options.output = argv[++i];
+            continue;
+        }
+        if (arg.starts_with("-")) {
+            return error("unknown option `{}`", arg);
+        }
+        options.inputs.emplace_back(arg);
+    }
+
+    if (options.inputs.empty()) {
+        return error("expected at least one argument. (the source file)");
+    }
+    if (options.inputs.size() > 1 && !options.unity) {
+        return error("only one source file can be compiled at a time without --unity. (got `{}` and `{}`)", options.inputs[0], options.inputs[1]);
+    }
+    if (options.unity && options.emit_pch) {
+        return error("`--emit-pch` can't be combined with `--unity`");
+    }
+    if (options.dump_tokens != token_dump::none && (options.unity || options.emit_pch)) {
+        return error("`--dump-tokens` can't be combined with `{}`", options.unity ? "--unity" : "--emit-pch");
+    }
+    if (options.load_tokens && (options.deps || options.deps_only)) {
+        return error("`{}` needs the source, it can't be combined with `--load-tokens`", options.deps_only ? "-M" : "-MD");
+    }
+    options.input = options.inputs.front();
+    if (options.cache_dir.empty()) {
+        if (const auto* dir = std::getenv("COMPILER_CACHE_DIR")) {
+            options.cache_dir = dir;
+        }
+    }
+    if (options.output.empty()) {
+        const auto extension = options.emit_pch ? ".pch" : options.dump_tokens == token_dump::binary ? ".tokens" : ".o";
+        options.output = std::filesystem::path(options.input).filename().replace_extension(extension).string();
+    }
+    if (options.deps && !options.deps_only && options.deps_file.empty()) {
+        options.deps_file = std::filesystem::path(options.output).replace_extension(".d").string();
+    }
+    return compile_options{ std::move(options) };
+}
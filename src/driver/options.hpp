@@ -0,0 +1,91 @@
+#ifndef _DRIVER_OPTIONS_HPP
+
+#include "../common/common.hpp"
+#include "../common/result.hpp"
+#include "../common/error.hpp"
+
+#include "../compiler/opt/pass_manager.hpp"
+#include "../compiler/diagnostics/diag.hpp"
+#include "deps.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+COMPILER_API_BEGIN
+namespace driver {
+
+// What --dump-tokens writes.
+enum class token_dump {
+    none,
+    // every token on a line of its own, to stdout.
+    text,
+    // the binary format of token_stream.hpp, to the output.
+    binary,
+};
+
+// Everything the command line can ask for.
+struct compile_options {
+    // the first of the inputs, the only one without --unity.
+    std::string input{};
+    // --unity: every source file, compiled as one unit into one object. Each file's statics
+    // stay its own, the declarations of a precompiled header are loaded and lowered once
+    // for all of them.
+    bool unity{ false };
+    std::vector<std::string> inputs{};
+    // -o: where the object file is written, defaults to the input with a ".o" extension.
+    std::string output{};
+    // --emit-ir: print the IR of the module to stdout.
+    bool emit_ir{ false };
+    // -O0, -O1, -O2
+    opt::opt_level opt_level{ opt::opt_level::O0 };
+    // --time-passes: print how long each optimization pass took to stderr.
+    bool time_passes{ false };
+    // --opt-remarks: print what the optimizer did (or why it didn't) to stderr.
+    bool opt_remarks{ false };
+    // --diagnostics-format=text|json: how errors and warnings are written to stderr, see
+    // diag_format.
+    diag_format diagnostics_format{ diag_format::text };
+    // -mavx2: the code may use AVX2, otherwise it's plain x86-64 (SSE2).
+    opt::target_info target{};
+    // --emit-pch: parse the input as a header and write a precompiled header image to the
+    // output (which defaults to the input with a ".pch" extension) instead of an object.
+    bool emit_pch{ false };
+    // --include-pch FILE: the TU starts with the header FILE was built from.
+    std::string include_pch{};
+    // --lazy-bodies: only parse the bodies of static functions that are used, errors in
+    // the others aren't reported. Ignored with --emit-pch.
+    bool lazy_bodies{ false };
+    // -j N: how many threads optimize and compile functions, 0 is one per core.
+    std::size_t threads{ 0 };
+    // --cache-dir DIR (or $COMPILER_CACHE_DIR): reuse earlier compilations of the same
+    // tokens and flags from there, empty if there's no cache.
+    std::string cache_dir{};
+    // --cache-size N[K|M|G]: the cache is trimmed to this many bytes.
+    std::uint64_t cache_size{ std::uint64_t{ 1 } << 30 };
+    // -I DIR (or -IDIR): where <...> and "..." includes are looked for, in order.
+    std::vector<std::string> include_directories{};
+    // -M: write the headers the input depends on (to stdout, or -MF) and compile nothing.
+    bool deps_only{ false };
+    // -MD: write them as well as compiling, to -MF or the output with a ".d" extension.
+    bool deps{ false };
+    // -MF FILE: where -M/-MD write the dependencies.
+    std::string deps_file{};
+    // --deps-format=make|json: how -M/-MD write them, see deps_format.
+    deps_format dependency_format{ deps_format::make };
+    // --dump-tokens=text|bin: write the input's tokens and compile nothing. "bin" writes them
+    // to the output, which defaults to the input with a ".tokens" extension.
+    token_dump dump_tokens{ token_dump::none };
+    // --load-tokens: the inputs are token dumps (--dump-tokens=bin), the lexer isn't run.
+    bool load_tokens{ false };
+};
+
+// Parse argv into compile_options, argv[0] is skipped.
+NODISCARD result<compile_options, error> parse_options(int argc, char** argv) noexcept;
+
+} // namespace driver
+COMPILER_API_END
+
+#define _DRIVER_OPTIONS_HPP
+#endif // !_DRIVER_OPTIONS_HPP
@@ -1,45 +1,313 @@
 #include "preprocessor/lexing/lexer.hpp"
 #include "compiler/lexing/lexer.hpp"
-#include "compiler/parser/prod/node.hpp"
-#include "compiler/parser/prod/assignment.hpp"
+#include "compiler/lexing/token_stream.hpp"
+#include "compiler/parser/parser.hpp"
+#include "compiler/ir/lower.hpp"
+#include "compiler/ir/printer.hpp"
+#include "compiler/ir/verifier.hpp"
+#include "compiler/opt/pass_manager.hpp"
+#include "compiler/codegen/elf.hpp"
+#include "compiler/codegen/x86_64/codegen.hpp"
+#include "compiler/pch/pch.hpp"
+#include "driver/options.hpp"
+#include "driver/cache.hpp"
+#include "driver/deps.hpp"
+#include "common/thread_pool.hpp"
+#include "common/file_loader.hpp"
 #include <iostream>
 #include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string_view>
 
 // link this in?
 constexpr const char name[] = "Compiler";
 constexpr const char version[] = "0.0.1";
 
-#define FAIL(fmt, ...) std::cerr << std::format("{} v{}", name, version) << "\n\n";\
-  std::cerr << std::format(fmt, ##__VA_ARGS__) << '\n'; return -1
+// how FAIL writes its message, the --diagnostics-format once the options are parsed.
+static compiler::diag_format fail_format = compiler::diag_format::text;
+
+static void report_failure(const std::string& message) {
+    if (fail_format == compiler::diag_format::json) {
+        // a diagnostic without a location, so tools reading the JSON lines see it too.
+        const auto diag = compiler::diagnostic{ message, compiler::source_location::from({}, 0, 0), compiler::diag_level::error };
+        auto& sink = output_sink::err();
+        diag.write_to(sink.buffer(), {}, fail_format);
+        sink.end_message();
+        return;
+    }
+    eprint("{} v{}\n\n", name, version);
+    eprintln("{}", message);
+}
+
+#define FAIL(fmt, ...) report_failure(std::format(fmt, ##__VA_ARGS__)); return -1
+
+// Split the source into lines, this is what diagnostics are built from.
+static std::vector<std::string> split_lines(std::string_view src) {
+    std::vector<std::string> lines;
+    std::istringstream stream{ std::string{ src } };
+    for (std::string line; std::getline(stream, line);) {
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+// One source file of the compilation, --unity compiles several into one object.
+struct translation_unit {
+    std::vector<std::string> lines;
+    // the file "lines" are from.
+    std::string file;
+    std::unique_ptr<compiler::parser> parser;
+    compiler::ast tree{};
+};
 
 int main(int argc, char** argv) {
-    // NOTE: argv[0] is always the path of this executable.
-    if (argc < 2) {
-        FAIL("expected at least one argument. (the source file)");
+    auto options_result = compiler::driver::parse_options(argc, argv);
+    if (options_result.is_err()) {
+        FAIL("{}", options_result.get_err()->what());
+    }
+    const auto& options = *options_result.get();
+    fail_format = options.diagnostics_format;
+    std::vector<compiler::source_info> sources;
+    // --load-tokens reads the tokens of each input instead, there's no source to read.
+    for (const auto& input : options.load_tokens ? std::vector<std::string>{} : options.inputs) {
+        auto source_info = compiler::source_info::from_name(input);
+        if (source_info.is_err()) {
+            FAIL("invalid source file provided. ({})", source_info.get_err()->what());
+        }
+        sources.push_back(std::move(source_info).value());
+    }
+
+    // -M/-MD only scan the directives, nothing is preprocessed for them.
+    if (options.deps_only || options.deps) {
+        auto scanner = preprocessor::lexer{ std::make_shared<preprocessor::header_search>(options.include_directories) };
+        // the other inputs of a --unity build, then the headers of all of them.
+        std::vector<std::string> dependencies(options.inputs.begin() + 1, options.inputs.end());
+        for (const auto& input : options.inputs) {
+            auto headers = scanner.scan_dependencies(input);
+            dependencies.insert(dependencies.end(), std::make_move_iterator(headers.begin()), std::make_move_iterator(headers.end()));
+        }
+        std::string deps;
+        compiler::driver::write_dependencies(deps, options.output, options.input, dependencies, options.dependency_format);
+        if (options.deps_file.empty()) {
+            print("{}", deps);
+        }
+        else {
+            auto file = std::ofstream{ options.deps_file, std::ios::binary };
+            if (!file.write(deps.data(), static_cast<std::streamsize>(deps.size()))) {
+                FAIL("failed to write `{}`.", options.deps_file);
+            }
+        }
+        if (options.deps_only) {
+            return 0;
+        }
+    }
+
+    // every unit interns its string literals into the same pool, they end up in one module.
+    compiler::string_pool strings;
+    std::vector<translation_unit> units;
+    // the parsers write diagnostics quoting their unit's lines until the end, those can't move.
+    units.reserve(options.inputs.size());
+    // everything a successful compile writes to stderr, a cache hit replays it.
+    std::string diagnostics;
+    std::optional<compiler::driver::compile_cache> cache;
+    std::string cache_key;
+    bool parse_failed = false;
+    for (std::size_t i = 0; i < options.inputs.size(); ++i) {
+        std::vector<compiler::token> tokens;
+        std::vector<std::string> lines;
+        std::string file_name;
+        if (options.load_tokens) {
+            auto loaded = compiler::read_tokens(options.inputs[i], strings);
+            if (loaded.is_err()) {
+                FAIL("{}", loaded.get_err()->what());
+            }
+            auto stream = std::move(loaded).value();
+            tokens = std::move(stream.tokens);
+            file_name = std::move(stream.file);
+            // the source is only needed for the lines diagnostics quote, if it's still around.
+            if (auto contents = file_loader::read(file_name); contents.is_okay()) {
+                lines = split_lines(*contents.get());
+            }
+        }
+        else {
+            // NOTE: If you are to preprocess, do it here.
+            //       "src" is a std::string with the file contents.
+            auto& src = sources[i];
+            auto lexer = compiler::lexer{ src, std::move(strings) };
+            auto lex_result = lexer.lex_tokens();
+
+            if (lex_result.is_err()) {
+                FAIL("lexer failed. ({})", lex_result.get_err()->what());
+            }
+
+            tokens = lexer.release_tokens();
+            strings = lexer.release_strings();
+            lines = split_lines(src.contents());
+            file_name = src.file_name();
+        }
+
+        if (options.dump_tokens == compiler::driver::token_dump::text) {
+            std::string text;
+            for (const auto& token : tokens) {
+                text += token.to_string();
+                text += '\n';
+            }
+            print("{}", text);
+            return 0;
+        }
+        if (options.dump_tokens == compiler::driver::token_dump::binary) {
+            auto write_result = compiler::write_tokens(tokens, strings, file_name, options.output);
+            if (write_result.is_err()) {
+                FAIL("{}", write_result.get_err()->what());
+            }
+            return 0;
+        }
+
+        // the tokens are all a cache hit needs, it skips everything after this. --emit-ir and
+        // --time-passes print things that can't come from the cache. (a --unity build isn't
+        // cached, its key would have to cover every unit)
+        if (!options.cache_dir.empty() && !options.emit_ir && !options.time_passes && !options.emit_pch && !options.unity) {
+            cache.emplace(options.cache_dir, options.cache_size);
+            cache_key = compiler::driver::compile_cache::key(tokens, strings, options, version);
+            if (auto hit = cache->lookup(cache_key)) {
+                eprint("{}", hit->diagnostics);
+                auto write_result = compiler::codegen::write_object(hit->object, options.output);
+                if (write_result.is_err()) {
+                    FAIL("{}", write_result.get_err()->what());
+                }
+                return 0;
+            }
+        }
+
+        auto& unit = units.emplace_back(translation_unit{ std::move(lines), std::move(file_name), std::make_unique<compiler::parser>(std::move(tokens)) });
+        auto& parser = *unit.parser;
+        // a precompiled header has to have every body.
+        parser.set_lazy_bodies(options.lazy_bodies && !options.emit_pch);
+        parser.parse(unit.lines, options.diagnostics_format, &diagnostics);
+        if (parser.has_errors()) {
+            // the other units are still parsed, for their errors.
+            parse_failed = true;
+            continue;
+        }
+        unit.tree = parser.release_ast();
+    }
+    if (parse_failed) {
+        return -1;
+    }
+
+    if (options.emit_pch) {
+        auto write_result = compiler::pch::write_image(units.front().tree, strings, options.output);
+        if (write_result.is_err()) {
+            FAIL("{}", write_result.get_err()->what());
+        }
+        return 0;
     }
-    const auto source_file = argv[1];
-    auto source_info = compiler::source_info::from_name(source_file);
+    // with --unity, the declarations of the precompiled header every unit uses. The image
+    // loads each of them once, for the first unit that needs it.
+    compiler::ast header_tree;
+    if (!options.include_pch.empty()) {
+        auto image = compiler::pch::image::open(options.include_pch);
+        if (image.is_err()) {
+            FAIL("{}", image.get_err()->what());
+        }
+        for (auto& unit : units) {
+            const auto before = unit.tree.size();
+            auto load_result = image.get()->prepend_to(unit.tree, strings);
+            if (load_result.is_err()) {
+                FAIL("{}", load_result.get_err()->what());
+            }
+            const auto loaded = static_cast<std::ptrdiff_t>(unit.tree.size() - before);
+            // the header can use static functions of the TU that the TU itself doesn't.
+            unit.parser->parse_referenced_bodies(unit.tree);
+            if (unit.parser->has_errors()) {
+                return -1;
+            }
+            // the loaded declarations are still at the front.
+            if (options.unity) {
+                std::move(unit.tree.begin(), unit.tree.begin() + loaded, std::back_inserter(header_tree));
+                unit.tree.erase(unit.tree.begin(), unit.tree.begin() + loaded);
+            }
+        }
+    }
+    auto mod = compiler::ir::module{};
+    mod.set_strings(std::move(strings));
 
-    if (source_info.is_err()) {
-        FAIL("invalid source file provided. ({})", source_info.get_err()->what());
+    // declarations decoded from a precompiled header keep the header's name in their locations,
+    // the writer quotes only lines of "file" and writes the rest with just their location.
+    const auto lower = [&](compiler::ir::lowering& lowering, compiler::ast& tree, const std::vector<std::string>& lines, const std::string& file) {
+        lowering.set_diagnostic_writer(compiler::diagnostic_writer{ lines, options.diagnostics_format, &diagnostics, file });
+        return lowering.lower(tree).is_okay();
+    };
+    std::optional<compiler::ir::lowering> header_lowering;
+    if (!header_tree.empty()) {
+        // the header's own source isn't at hand, nothing of it is quoted.
+        static const std::vector<std::string> no_lines{};
+        header_lowering.emplace(mod);
+        if (!lower(*header_lowering, header_tree, no_lines, {})) {
+            return -1;
+        }
+    }
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        // each unit of a --unity build has statics of its own.
+        auto lowering = compiler::ir::lowering{ mod, options.unity ? std::format(".{}", i) : std::string{} };
+        if (header_lowering) {
+            lowering.import_declarations(*header_lowering);
+        }
+        if (!lower(lowering, units[i].tree, units[i].lines, units[i].file)) {
+            return -1;
+        }
     }
 
-    auto src = *source_info.get();
-    // NOTE: If you are to preprocess, do it here.
-    //       "src" is a std::string with the file contents.
-    auto lexer = compiler::lexer{src};
-    auto lex_result = lexer.lex_tokens();
+    for (const auto& fn : mod.functions()) {
+        auto verify_result = compiler::ir::verify_function(mod, *fn);
+        if (verify_result.is_err()) {
+            FAIL("internal compiler error: invalid IR. ({})", verify_result.get_err()->what());
+        }
+    }
 
-    if (lex_result.is_err()) {
-        FAIL("lexer failed. ({})", lex_result.get_err()->what());
+    auto pool = thread_pool{ options.threads };
+    auto passes = compiler::opt::pass_manager::for_level(options.opt_level, options.target);
+    passes.context().collect_remarks(options.opt_remarks);
+    if (!passes.empty()) {
+        passes.run(mod, pool);
+        for (const auto& fn : mod.functions()) {
+            auto verify_result = compiler::ir::verify_function(mod, *fn);
+            if (verify_result.is_err()) {
+                FAIL("internal compiler error: invalid IR after optimizing. ({})", verify_result.get_err()->what());
+            }
+        }
+        if (options.time_passes) {
+            eprint("{}", passes.report());
+        }
+        const auto start = diagnostics.size();
+        for (const auto& r : passes.remarks()) {
+            std::format_to(std::back_inserter(diagnostics), "{}: {} [{}] in `{}`: {}\n",
+                options.input, r.applied ? "remark:" : "missed:", r.pass, r.function, r.message);
+        }
+        eprint("{}", std::string_view{ diagnostics }.substr(start));
     }
 
-    auto tokens = lexer.release_tokens();
-#if LEXER_DEBUG
-    for (auto& token : tokens) {
-        println("{}", token.to_string());
+    if (options.emit_ir) {
+        print("{}", compiler::ir::print_module(mod));
+    }
+
+    auto object = compiler::codegen::object_file{};
+    auto codegen_result = compiler::codegen::x86_64::generate(mod, object, pool);
+    if (codegen_result.is_err()) {
+        FAIL("{}", codegen_result.get_err()->what());
+    }
+    auto bytes = compiler::codegen::build_elf(object);
+    auto write_result = compiler::codegen::write_object(bytes, options.output);
+    if (write_result.is_err()) {
+        FAIL("{}", write_result.get_err()->what());
+    }
+    if (cache) {
+        cache->store(cache_key, compiler::driver::cache_entry{ std::move(diagnostics), std::move(bytes) });
     }
-#endif
 
     return 0;
 }
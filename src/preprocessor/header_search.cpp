@@ -0,0 +1,98 @@
+#include "header_search.hpp"
+
+#include <mutex>
+
+PREPROCESSOR_API_BEGIN
+
+header_search::header_search(std::vector<std::string> directories)
+  : m_directories{ std::move(directories) }
+{}
+
+auto header_search::find(const std::string& includer, std::string_view name, bool angled) -> std::optional<std::string> {
+    const bool absolute = std::filesystem::path(name).is_absolute();
+    std::string directory;
+    if (!angled && !absolute) {
+        directory = std::filesystem::path(includer).parent_path().string();
+        // an includer in the working directory ("m.c") still comes before the -I directories.
+        if (directory.empty()) {
+            directory = ".";
+        }
+    }
+
+    // the includer's directory is only part of the key for "...".
+    std::string key;
+    key.reserve(directory.size() + name.size() + 2);
+    key.push_back(angled ? '<' : '"');
+    key += directory;
+    key.push_back('\0');
+    key += name;
+    {
+        std::shared_lock lock{ m_mutex };
+        if (auto it = m_lookups.find(key); it != m_lookups.end()) {
+            return it->second;
+        }
+    }
+
+    std::optional<std::string> found;
+    if (!directory.empty()) {
+        found = lookup(directory, name);
+    }
+    if (!absolute) {
+        for (std::size_t i = 0; i < m_directories.size() && !found; ++i) {
+            found = lookup(m_directories[i], name);
+        }
+    }
+    if (!found) {
+        found = lookup({}, name);
+    }
+
+    std::unique_lock lock{ m_mutex };
+    m_lookups.emplace(std::move(key), found);
+    return found;
+}
+
+auto header_search::lookup(std::string_view directory, std::string_view name) -> std::optional<std::string> {
+    auto path = directory.empty()
+        ? std::filesystem::path(name).lexically_normal()
+        : (std::filesystem::path(directory) / name).lexically_normal();
+    if (!exists(path)) {
+        return std::nullopt;
+    }
+    return path.string();
+}
+
+auto header_search::exists(const std::filesystem::path& path) -> bool {
+    const auto filename = path.filename().string();
+    if (filename.empty()) {
+        return false;
+    }
+    auto directory = path.parent_path().string();
+    if (directory.empty()) {
+        directory = ".";
+    }
+    {
+        std::shared_lock lock{ m_mutex };
+        if (auto it = m_listings.find(directory); it != m_listings.end()) {
+            return it->second.contains(filename);
+        }
+    }
+
+    // listed without the lock, two threads can list the same directory at once but the
+    // second listing is just dropped.
+    std::unordered_set<std::string> listing;
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(directory, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        // symlink_status() is what readdir() already said, status() would stat every entry.
+        // A symlink is taken to be a file.
+        std::error_code type_ec;
+        if (it->symlink_status(type_ec).type() != std::filesystem::file_type::directory) {
+            listing.insert(it->path().filename().string());
+        }
+    }
+
+    std::unique_lock lock{ m_mutex };
+    const auto [it, inserted] = m_listings.emplace(std::move(directory), std::move(listing));
+    return it->second.contains(filename);
+}
+
+PREPROCESSOR_API_END
@@ -0,0 +1,67 @@
+#ifndef PREPROCESSOR_HEADER_SEARCH_HPP
+#define PREPROCESSOR_HEADER_SEARCH_HPP
+
+#include "../common/common.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+PREPROCESSOR_API_BEGIN
+
+/*
+  Finds the file an #include names. "..." is looked for next to the file that includes it,
+  then in each -I directory and last in the working directory, <...> skips the first step.
+
+  A directory is listed once, the first time anything is looked for in it, and every
+  answer after that (a file being there or not) comes from the listing. Every lookup is
+  remembered as well, found or not, so the second #include <stdio.h> is one hash lookup and
+  no syscalls at all. One header_search can be shared by any number of lexers on any number
+  of threads, a driver compiling many files keeps the listings warm between them.
+
+  The caches are never invalidated, headers that appear or disappear during a build aren't
+  noticed.
+*/
+class header_search {
+private:
+    std::vector<std::string> m_directories;
+    mutable std::shared_mutex m_mutex{};
+    // the names of the files (anything but directories) in each directory looked in so far.
+    // A directory that doesn't exist has an empty listing.
+    std::unordered_map<std::string, std::unordered_set<std::string>> m_listings{};
+    // every lookup so far and its answer, nullopt if there's no such header.
+    std::unordered_map<std::string, std::optional<std::string>> m_lookups{};
+
+public:
+    // "directories" are the -I directories, in the order they're searched.
+    explicit header_search(std::vector<std::string> directories = {});
+
+    header_search(const header_search&) = delete;
+    header_search& operator=(const header_search&) = delete;
+
+    // The path of the header "name", included by "includer" with <...> if "angled", or
+    // nullopt if it's nowhere to be found.
+    [[nodiscard]]
+    auto find(const std::string& includer, std::string_view name, bool angled) -> std::optional<std::string>;
+
+    [[nodiscard]]
+    auto directories() const noexcept -> const std::vector<std::string>& { return m_directories; }
+
+private:
+    // whether the file "path" exists, from the listing of its directory.
+    [[nodiscard]]
+    auto exists(const std::filesystem::path& path) -> bool;
+
+    // "name" in "directory" if it's there, an empty directory is the working directory.
+    [[nodiscard]]
+    auto lookup(std::string_view directory, std::string_view name) -> std::optional<std::string>;
+};
+
+PREPROCESSOR_API_END
+
+#endif // !PREPROCESSOR_HEADER_SEARCH_HPP
@@ -1,6 +1,7 @@
 #include "lexer.hpp"
 #include "constants.hpp"
 
+#include <cstring>
 #include <sstream>
 #include <fstream>
 #include <string>
@@ -21,12 +22,220 @@ static const std::string include = "#include";
 PREPROCESSOR_API_BEGIN
 
 lexer::lexer() 
+  : lexer{ std::make_shared<header_search>() }
+{}
+
+lexer::lexer(std::shared_ptr<header_search> search)
   : m_preprocessed{}
   , m_buffer{}
   , m_is_single_line_comment{}
   , m_is_multi_line_comment{}
+  , m_loader{}
+  , m_search{ std::move(search) }
+  , m_current_file{}
 {}
 
+namespace {
+
+// One #if ... #endif group the scanner is in. Only literal 0 and 1 conditions are known,
+// the branches of every other group are all taken (a dependency too many is harmless, one
+// too few isn't).
+struct conditional {
+    enum class branch_state {
+        // the condition isn't known, every branch is live.
+        unknown,
+        // no branch has been live yet, the next known or unknown one is.
+        looking,
+        // a branch was known to be taken, the rest are dead.
+        done,
+    };
+    bool parent_live;
+    branch_state state;
+    bool live;
+};
+
+// 0 or 1 for "#if 0" and "#if 1", -1 for anything else.
+auto literal_condition(std::string_view rest) -> int {
+    const auto begin = rest.find_first_not_of(" \t");
+    if (begin == std::string_view::npos || (rest[begin] != '0' && rest[begin] != '1')) {
+        return -1;
+    }
+    const auto after = rest.find_first_not_of(" \t\r", begin + 1);
+    if (after != std::string_view::npos && rest.substr(after, 2) != "//" && rest.substr(after, 2) != "/*") {
+        return -1;
+    }
+    return rest[begin] - '0';
+}
+
+auto enter_branch(conditional& group, int condition) -> void {
+    if (group.state == conditional::branch_state::done) {
+        group.live = false;
+    }
+    else if (condition == 1) {
+        group.live = group.parent_live;
+        group.state = conditional::branch_state::done;
+    }
+    else if (condition == 0) {
+        group.live = false;
+    }
+    else {
+        group.live = group.parent_live;
+        if (group.state == conditional::branch_state::looking) {
+            group.state = conditional::branch_state::unknown;
+        }
+    }
+}
+
+} // namespace
+
+[[nodiscard]]
+auto lexer::scan_includes(std::string_view contents) -> std::vector<include_directive> {
+    std::vector<include_directive> targets;
+    std::vector<conditional> groups;
+    const auto is_blank = [](char c) { return c == ' ' || c == '\t'; };
+
+    const char* const begin = contents.data();
+    const char* const end = begin + contents.size();
+    const char* p = begin;
+    while (p < end) {
+        // everything that isn't a directive is skipped a memchr() at a time.
+        const auto* hash = static_cast<const char*>(std::memchr(p, '#', static_cast<std::size_t>(end - p)));
+        if (hash == nullptr) {
+            break;
+        }
+        const auto* line_end = static_cast<const char*>(std::memchr(hash, '\n', static_cast<std::size_t>(end - hash)));
+        if (line_end == nullptr) {
+            line_end = end;
+        }
+        p = line_end;
+
+        // only blanks may come before the '#' on its line.
+        const auto* q = hash;
+        while (q > begin && is_blank(q[-1])) {
+            --q;
+        }
+        if (q != begin && q[-1] != '\n') {
+            // "a # b" or "'#'", the rest of the line can still have a '#' in it, but not
+            // a directive.
+            continue;
+        }
+
+        auto line = std::string_view{ hash + 1, static_cast<std::size_t>(line_end - hash - 1) };
+        const auto name_begin = line.find_first_not_of(" \t");
+        if (name_begin == std::string_view::npos) {
+            continue;
+        }
+        line.remove_prefix(name_begin);
+        std::size_t name_length = 0;
+        while (name_length < line.size() && is_valid_directive_char(line[name_length])) {
+            ++name_length;
+        }
+        const auto directive = tokens.find(line.substr(0, name_length));
+        if (!directive.has_value()) {
+            continue;
+        }
+        const auto rest = line.substr(name_length);
+        const bool live = groups.empty() || groups.back().live;
+
+        switch (*directive) {
+            case token_type::INCLUDE: {
+                if (!live) {
+                    break;
+                }
+                const auto open = rest.find_first_not_of(" \t");
+                if (open == std::string_view::npos || (rest[open] != '<' && rest[open] != '"')) {
+                    break;
+                }
+                const bool angled = rest[open] == '<';
+                const auto close = rest.find(angled ? '>' : '"', open + 1);
+                if (close != std::string_view::npos && close > open + 1) {
+                    targets.push_back(include_directive{ std::string{ rest.substr(open + 1, close - open - 1) }, angled });
+                }
+                break;
+            }
+            case token_type::IF:
+            case token_type::IFDEF:
+            case token_type::IFNDEF: {
+                auto& group = groups.emplace_back(conditional{ live, conditional::branch_state::looking, live });
+                enter_branch(group, *directive == token_type::IF ? literal_condition(rest) : -1);
+                break;
+            }
+            case token_type::ELIF:
+            case token_type::ELIFDEF:
+            case token_type::ELIFNDEF:
+                if (!groups.empty()) {
+                    enter_branch(groups.back(), *directive == token_type::ELIF ? literal_condition(rest) : -1);
+                }
+                break;
+            case token_type::ELSE:
+                if (!groups.empty()) {
+                    enter_branch(groups.back(), groups.back().state == conditional::branch_state::looking ? 1 : -1);
+                }
+                break;
+            case token_type::ENDIF:
+                if (!groups.empty()) {
+                    groups.pop_back();
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return targets;
+}
+
+auto lexer::resolve_include(const std::string& includer, const include_directive& include) -> std::optional<std::string> {
+    return m_search->find(includer, include.path, include.angled);
+}
+
+auto lexer::prefetch_includes(const std::string& includer, std::string_view contents) -> void {
+    for (const auto& include : scan_includes(contents)) {
+        auto path = resolve_include(includer, include);
+        if (path && !m_preprocessed.contains(*path)) {
+            m_loader.prefetch(*path);
+        }
+    }
+}
+
+auto lexer::scan_dependencies(const std::string& path) -> std::vector<std::string> {
+    std::vector<std::string> dependencies;
+    m_preprocessed.insert(path);
+    auto contents = m_loader.take(path);
+    if (contents.is_okay()) {
+        scan_dependencies(path, *contents.get(), dependencies);
+    }
+    return dependencies;
+}
+
+auto lexer::scan_dependencies(const std::string& path, std::string_view contents, std::vector<std::string>& dependencies) -> void {
+    // every include of this file is read in the background while the first one is scanned.
+    std::vector<std::string> paths;
+    for (const auto& include : scan_includes(contents)) {
+        // a header that isn't there is left out, like copy_file_contents() does.
+        auto resolved = resolve_include(path, include);
+        if (!resolved) {
+            continue;
+        }
+        if (!m_preprocessed.contains(*resolved)) {
+            m_loader.prefetch(*resolved);
+        }
+        paths.push_back(std::move(*resolved));
+    }
+
+    for (auto& resolved : paths) {
+        if (m_preprocessed.contains(resolved)) {
+            continue;
+        }
+        m_preprocessed.insert(resolved);
+        auto header = m_loader.take(resolved);
+        if (header.is_err()) {
+            continue;
+        }
+        dependencies.push_back(resolved);
+        scan_dependencies(resolved, *header.get(), dependencies);
+    }
+}
+
 [[nodiscard]]
 auto lexer::process_multi_line_comment(std::fstream& file) -> bool {
     while (!file.eof()) {
@@ -45,11 +254,14 @@ auto lexer::process_multi_line_comment(std::fstream& file) -> bool {
 
 [[nodiscard]]
 auto lexer::copy_file_contents(const std::string& path) -> std::string {
-    std::fstream file(path);
-    std::istringstream iss;
-    iss >> file.rdbuf();
-
-    return iss.str();
+    // only regular files, a path like /dev/stdin would block forever. (file_loader checks)
+    auto contents = m_loader.take(path);
+    if (contents.is_err()) {
+        return {};
+    }
+    // the headers this one includes come next.
+    prefetch_includes(path, *contents.get());
+    return std::move(contents).value();
 }
 
 [[nodiscard]]
@@ -87,8 +299,12 @@ auto lexer::process_include(const std::string& line) -> bool {
         }
 
         // capture the file path
-        path = line.substr(i, pos - 1);
-        auto buf = copy_file_contents(path);
+        path = line.substr(i, pos - i);
+        const auto resolved = resolve_include(m_current_file, include_directive{ path, escape_token == ">" });
+        if (!resolved) {
+            return false; // no such header
+        }
+        auto buf = copy_file_contents(*resolved);
 
         return true;
     }
@@ -121,38 +337,52 @@ auto lexer::lex_directive(const std::string& line) -> bool {
     return tokens.contains(buffer);
 }
 
-auto lexer::lex_tokens(const std::string& line) -> bool {
-    trim_leading_whitespace(line);
-
-    for (std::size_t i = 0; i < line.length(); ++i) {
-        if (line[i] == ' ')
-            continue; // ignore whitespace
-
-        // preprocessor directive
-        if (line[i] == '#') {
-            if (i + 1 >= line.length())
-                return false; // error
-
-            lex_directive(line.substr(i + 1));
+auto lexer::lex_tokens(std::string line) -> bool {
+    // the rest of a comment that started on an earlier line.
+    if (m_is_multi_line_comment) {
+        const auto exit_pos = line.find(multi_line_comment_exit_token);
+        if (exit_pos == std::string::npos) {
+            return true;
         }
+        line.erase(0, exit_pos + multi_line_comment_exit_token.length());
+        m_is_multi_line_comment = false;
     }
 
+    trim_leading_whitespace(line);
+
+    // preprocessor directive, only ever at the start of a line. (looking at every '#' made
+    // a line full of them quadratic)
+    if (!line.empty() && line.front() == '#') {
+        if (line.length() == 1)
+            return false; // error
 
+        DISCARD(lex_directive(line.substr(1)));
+    }
 
-    // remove multi-line comments
-    if (auto entry_pos = line.find(multi_line_comment_entry_token); entry_pos != std::string::npos) {
+    // remove multi-line comments, the code between them is copied out in one pass. (erasing
+    // each comment in place made a line full of them quadratic)
+    std::string code;
+    std::size_t from = 0;
+    while (true) {
+        const auto entry_pos = line.find(multi_line_comment_entry_token, from);
+        if (entry_pos == std::string::npos) {
+            code.append(line, from);
+            break;
+        }
+        code.append(line, from, entry_pos - from);
         // check if entry token and exit token are on the same line
-        if (auto exit_pos = line.find(multi_line_comment_exit_token, entry_pos + multi_line_comment_entry_token.length()); exit_pos != std::string::npos) {
-            // remove substring from string
-            line.erase(entry_pos, exit_pos + 1);
+        const auto exit_pos = line.find(multi_line_comment_exit_token, entry_pos + multi_line_comment_entry_token.length());
+        if (exit_pos == std::string::npos) {
+            // the comment goes on, the next lines are skipped until its exit token.
+            m_is_multi_line_comment = true;
+            break;
         }
-
-        // iterate over each line until an exit token is found
-        process_multi_line_comment(file); 
+        from = exit_pos + multi_line_comment_exit_token.length();
     }
+    line = std::move(code);
 
     if (auto pos = line.find(include); pos != std::string::npos) {
-        process_include(line.substr(pos + include.length())); 
+        DISCARD(process_include(line.substr(pos + include.length())));
     }
 
     return false;
@@ -163,15 +393,23 @@ auto lexer::preprocess(const std::string& path) -> void {
         return;
 
     m_preprocessed.insert(path);
-    std::fstream file(path);
-
-    while (!file.eof()) {
-        std::string line;
-        std::getline(file, line);
-
-        preprocess_line(line);
+    auto contents = m_loader.take(path);
+    if (contents.is_err()) {
+        return;
+    }
+    m_current_file = path;
+    const std::string_view source = *contents.get();
+    prefetch_includes(path, source);
+
+    std::size_t begin = 0;
+    while (begin < source.size()) {
+        auto end = source.find('\n', begin);
+        if (end == std::string_view::npos) {
+            end = source.size();
+        }
+        DISCARD(lex_tokens(std::string{ source.substr(begin, end - begin) }));
+        begin = end + 1;
     }
-
 }
 
 PREPROCESSOR_API_END
@@ -2,22 +2,62 @@
 #define PREPROCESSOR_LEXER_HPP
 
 #include "../../common/common.hpp"
+#include "../../common/file_loader.hpp"
+#include "../header_search.hpp"
 
+#include <fstream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_set>
 
 PREPROCESSOR_API_BEGIN
 
+// The target of an #include, <path> is angled and "path" isn't.
+struct include_directive {
+    std::string path;
+    bool angled;
+};
+
 class lexer {
 private:
     std::unordered_set<std::string> m_preprocessed;
     std::vector<std::string>        m_buffer;
     bool                            m_is_single_line_comment;
     bool                            m_is_multi_line_comment;
+    // reads included files ahead of time, see prefetch_includes().
+    file_loader                     m_loader;
+    // where includes are looked for, can be shared with other lexers.
+    std::shared_ptr<header_search>  m_search;
+    // the file preprocess() is in, what "..." includes are relative to.
+    std::string                     m_current_file;
 
 public:
     lexer();
+    explicit lexer(std::shared_ptr<header_search> search);
+
+    // The #include directives in "contents", found without lexing it: only the lines that
+    // start with '#' are looked at, the rest is skipped with memchr(). Conditionals are
+    // followed as far as "#if 0" and "#if 1", the includes in a dead branch are left out.
+    // It can be fooled by a directive inside of a block comment.
+    [[nodiscard]]
+    static auto scan_includes(std::string_view contents) -> std::vector<include_directive>;
+
+    // Where "include" is read from, "includer" is the path of the file it's in. nullopt if
+    // the header doesn't exist.
+    [[nodiscard]]
+    auto resolve_include(const std::string& includer, const include_directive& include) -> std::optional<std::string>;
+
+    // start reading every file "contents" includes, they're in memory by the time
+    // copy_file_contents() gets to them.
+    auto prefetch_includes(const std::string& includer, std::string_view contents) -> void;
+
+    // Every header "path" includes, directly or not, each once and in the order they're
+    // first included. Only the directives are scanned (see scan_includes()), for -M/-MD.
+    [[nodiscard]]
+    auto scan_dependencies(const std::string& path) -> std::vector<std::string>;
 
     [[nodiscard]]
     auto process_multi_line_comment(std::fstream& file) -> bool;
@@ -32,9 +72,18 @@ public:
     auto lex_comment(const std::string& line) -> bool;
 
     [[nodiscard]]
-    auto lex_tokens(const std::string& line) -> bool;
+    auto lex_directive(const std::string& line) -> bool;
+
+    // lexes a single line, comments that span lines are tracked between calls.
+    [[nodiscard]]
+    auto lex_tokens(std::string line) -> bool;
+
+    auto trim_leading_whitespace(std::string& line) -> void;
 
     auto preprocess(const std::string& path) -> void;
+
+private:
+    auto scan_dependencies(const std::string& path, std::string_view contents, std::vector<std::string>& dependencies) -> void;
 };
 
 PREPROCESSOR_API_END
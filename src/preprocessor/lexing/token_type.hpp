@@ -2,96 +2,82 @@
 #define PREPROCESSOR_LEXING_TOKEN_TYPE_HPP
 
 #include "../../common/common.hpp"
+#include "../../common/shared_tokens.hpp"
 
+#include <array>
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 PREPROCESSOR_API_BEGIN
 
-enum class token_type {
-    // standard preprocessor operators
-    HASHTAG,
+/*
+  Every token type, in the order of the enum, and how it's spelled. The enum, the names and
+  the lookup table in constants.hpp are all generated from this list, and from the tokens
+  it shares with the compiler's. (SHARED_TOKEN_TYPES)
 
-    // standard preprocessor directives
-    INCLUDE,
-    DEFINE,
-    IF,
-    ELIF,
-    ELSE,
-    ENDIF,
-    IFDEF,
-    IFNDEF,
-    UNDEF,
-    PRAGMA,
-    USING,
-    ERROR,
-    WARNING,
-    ELIFDEF,
-    ELIFNDEF,
-    EMBED,
+    X(name, spelling)
+*/
+#define PREPROCESSOR_TOKEN_TYPES(X)                     \
+    /* standard preprocessor operators */               \
+    X(HASHTAG, "#")                                     \
+    /* standard preprocessor directives, if and else */ \
+    SHARED_TOKEN_TYPES(X)                               \
+    X(INCLUDE, "include")                               \
+    X(DEFINE, "define")                                 \
+    X(ELIF, "elif")                                     \
+    X(ENDIF, "endif")                                   \
+    X(IFDEF, "ifdef")                                   \
+    X(IFNDEF, "ifndef")                                 \
+    X(UNDEF, "undef")                                   \
+    X(PRAGMA, "pragma")                                 \
+    X(USING, "using")                                   \
+    X(ERROR, "error")                                   \
+    X(WARNING, "warning")                               \
+    X(ELIFDEF, "elifdef")                               \
+    X(ELIFNDEF, "elifndef")                             \
+    X(EMBED, "embed")                                   \
+    /* standard predefined identifier */                \
+    X(FUNC, "__func__")                                 \
+    /* standard predefined macros */                    \
+    X(DATE, "__DATE__")                                 \
+    X(TIME, "__TIME__")                                 \
+    X(FILE, "__FILE__")                                 \
+    X(LINE, "__LINE__")                                 \
+    X(STDC, "__STDC__")                                 \
+    X(STDC_HOSTED, "__STDC_HOSTED__")                   \
+    X(STDC_NO_ATOMICS, "__STDC_NO_ATOMICS__")           \
+    X(STDC_NO_COMPLEX, "__STDC_NO_COMPLEX__")           \
+    X(STDC_NO_THREADS, "__STDC_NO_THREADS__")           \
+    X(STDC_NO_VLA, "__STDC_NO_VLA__")                   \
+    X(STDC_VERSION, "__STDC_VERSION__")                 \
+    /* comments */                                      \
+    X(SINGLE_LINE_COMMENT, "//")                        \
+    X(MULTI_LINE_COMMENT_ENTRY, "/*")                   \
+    X(MULTI_LINE_COMMENT_EXIT, "*/")
 
-    // standard predefined identifier
-    FUNC,
+#define X(name, spelling) name,
+enum class token_type {
+    PREPROCESSOR_TOKEN_TYPES(X)
+};
+#undef X
 
-    // standard predefined macros
-    DATE,
-    TIME,
-    FILE,
-    LINE,
-    STDC,
-    STDC_HOSTED,
-    STDC_NO_ATOMICS,
-    STDC_NO_COMPLEX,
-    STDC_NO_THREADS,
-    STDC_NO_VLA,
-    STDC_VERSION,
+#define X(name, spelling) +1
+static constexpr inline std::size_t token_type_count = 0 PREPROCESSOR_TOKEN_TYPES(X);
+#undef X
 
-    // comments
-    SINGLE_LINE_COMMENT,
-    MULTI_LINE_COMMENT_ENTRY,
-    MULTI_LINE_COMMENT_EXIT
+// The name of every token type, indexed by the type.
+#define X(name, spelling) std::string_view{ #name },
+static constexpr inline std::array<std::string_view, token_type_count> token_type_names = {
+    PREPROCESSOR_TOKEN_TYPES(X)
 };
+#undef X
 
 inline std::string token_type_to_string(const token_type type) {
-    switch (type) {
-        case token_type::HASHTAG:                   return "HASHTAG";
-        case token_type::INCLUDE:                   return "INCLUDE";
-        case token_type::DEFINE:                    return "DEFINE";
-        case token_type::IF:                        return "IF";
-        case token_type::ELIF:                      return "ELIF";
-        case token_type::ELSE:                      return "ELSE";
-        case token_type::ENDIF:                     return "ENDIF";
-        case token_type::IFDEF:                     return "IFDEF";
-        case token_type::IFNDEF:                    return "IFNDEF";
-        case token_type::UNDEF:                     return "UNDEF";
-        case token_type::PRAGMA:                    return "PRAGMA";
-        case token_type::USING:                     return "USING";
-        case token_type::ERROR:                     return "ERROR";
-        case token_type::WARNING:                   return "WARNING";
-        case token_type::ELIFDEF:                   return "ELIFDEF";
-        case token_type::ELIFNDEF:                  return "ELIFNDEF";
-        case token_type::EMBED:                     return "EMBED";
-        case token_type::FUNC:                      return "FUNC";
-        case token_type::DATE:                      return "DATE";
-        case token_type::TIME:                      return "TIME";
-        case token_type::FILE:                      return "FILE";
-        case token_type::LINE:                      return "LINE";
-        case token_type::STDC:                      return "STDC";
-        case token_type::STDC_HOSTED:               return "STDC_HOSTED";
-        case token_type::STDC_NO_ATOMICS:           return "STDC_NO_ATOMICS";
-        case token_type::STDC_NO_COMPLEX:           return "STDC_NO_COMPLEX";
-        case token_type::STDC_NO_THREADS:           return "STDC_NO_THREADS";
-        case token_type::STDC_NO_VLA:               return "STDC_NO_VLA";
-        case token_type::STDC_VERSION:              return "STDC_VERSION";
-        case token_type::SINGLE_LINE_COMMENT:       return "SINGLE_LINE_COMMENT";
-        case token_type::MULTI_LINE_COMMENT_ENTRY:  return "MULTI_LINE_COMMENT_ENTRY";
-        case token_type::MULTI_LINE_COMMENT_EXIT:   return "MULTI_LINE_COMMENT_EXIT";
-
-        default:                                    return "UNKNOWN";
-    }
+    const auto index = static_cast<std::size_t>(type);
+    return std::string{ index < token_type_count ? token_type_names[index] : std::string_view{ "UNKNOWN" } };
 }
 
-
-
 PREPROCESSOR_API_END
 
 #endif // !PREPROCESSOR_LEXING_TOKEN_TYPE_HPP
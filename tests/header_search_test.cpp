@@ -0,0 +1,73 @@
+// Checks the order header_search looks in: next to the includer for "...", then the -I
+// directories, then the working directory. Runs in a scratch directory of its own.
+//
+// usage: header_search_test
+
+#include "preprocessor/header_search.hpp"
+#include "common/io.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void touch(const fs::path& path) {
+    if (path.has_parent_path()) {
+        fs::create_directories(path.parent_path());
+    }
+    std::ofstream{ path } << "// " << path.string() << '\n';
+}
+
+static void expect(std::string_view what, const std::optional<std::string>& found, std::string_view expected) {
+    const auto actual = found ? fs::path(*found).lexically_normal() : fs::path{};
+    if (actual != fs::path(expected).lexically_normal()) {
+        eprintln("FAIL: {}: found `{}`, expected `{}`", what, found.value_or("(nothing)"), expected);
+        failures++;
+    }
+}
+
+int main() {
+    const auto scratch = fs::temp_directory_path() / "header_search_test";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    const auto previous = fs::current_path();
+    fs::current_path(scratch);
+
+    touch("x.h");
+    touch("inc/x.h");
+    touch("inc/only_inc.h");
+    touch("sub/x.h");
+    touch("only_cwd.h");
+
+    {
+        auto search = preprocessor::header_search{ { "inc" } };
+        // the includer is in the working directory, its own directory is "." and not "".
+        expect("\"x.h\" from m.c", search.find("m.c", "x.h", false), "x.h");
+        expect("<x.h> from m.c", search.find("m.c", "x.h", true), "inc/x.h");
+        expect("\"x.h\" from sub/m.c", search.find("sub/m.c", "x.h", false), "sub/x.h");
+        expect("\"only_inc.h\" from m.c", search.find("m.c", "only_inc.h", false), "inc/only_inc.h");
+        expect("<only_cwd.h> from m.c", search.find("m.c", "only_cwd.h", true), "only_cwd.h");
+        expect("\"missing.h\" from m.c", search.find("m.c", "missing.h", false), "");
+    }
+    {
+        // the same lookups again from a fresh search, in the other order, the caches mustn't
+        // carry an answer over from a different includer.
+        auto search = preprocessor::header_search{ { "inc" } };
+        expect("\"x.h\" from sub/m.c", search.find("sub/m.c", "x.h", false), "sub/x.h");
+        expect("\"x.h\" from m.c", search.find("m.c", "x.h", false), "x.h");
+    }
+
+    fs::current_path(previous);
+    fs::remove_all(scratch);
+    if (failures != 0) {
+        eprintln("{} checks failed.", failures);
+        return 1;
+    }
+    println("all checks passed.");
+    return 0;
+}
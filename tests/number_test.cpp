@@ -0,0 +1,162 @@
+// Lexes numeric literals at the edges of what the decoders handle (the eight digits at a time
+// path, Clinger's fast path, std::from_chars and the suffixes) and checks the value, or the
+// error, each one gets.
+//
+// usage: number_test
+
+#include "compiler/lexing/lexer.hpp"
+#include "common/io.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+using namespace compiler;
+
+static int failures = 0;
+
+// The literal's token, or the lexer's error if "source" doesn't lex.
+static result<numeric_value, error> lex_number(std::string_view source) {
+    auto lexer = compiler::lexer{ source_info::borrow("number_test.c", source) };
+    auto lex_result = lexer.lex_tokens();
+    if (lex_result.is_err()) {
+        return std::move(lex_result).err();
+    }
+    const auto& tokens = lexer.tokens();
+    if (tokens.empty() || (tokens.front().type() != token_type::INTEGER_LITERAL && tokens.front().type() != token_type::FLOATING_POINT_LITERAL)) {
+        return error("`{}` isn't lexed as a number", source);
+    }
+    return numeric_value{ tokens.front().number() };
+}
+
+static void expect_integer(std::string_view source, std::uint64_t value, bool is_unsigned = false, std::uint8_t long_count = 0) {
+    auto number = lex_number(source);
+    if (number.is_err()) {
+        eprintln("FAIL: `{}`: {}", source, number.get_err()->what());
+        failures++;
+        return;
+    }
+    const auto& n = *number.get();
+    if (n.is_floating() || n.integer() != value || n.is_unsigned() != is_unsigned || n.long_count() != long_count) {
+        eprintln("FAIL: `{}`: got {}, expected {}{}{}", source, n.to_string(), value, is_unsigned ? "u" : "", std::string(long_count, 'l'));
+        failures++;
+    }
+}
+
+static void expect_floating(std::string_view source, double value, bool is_float = false) {
+    auto number = lex_number(source);
+    if (number.is_err()) {
+        eprintln("FAIL: `{}`: {}", source, number.get_err()->what());
+        failures++;
+        return;
+    }
+    const auto& n = *number.get();
+    // compared bit for bit, the decoders have to be exact.
+    if (!n.is_floating() || n.bits() != std::bit_cast<std::uint64_t>(value) || n.is_float() != is_float) {
+        eprintln("FAIL: `{}`: got {}, expected {:a}{}", source, n.to_string(), value, is_float ? "f" : "");
+        failures++;
+    }
+}
+
+// "source" doesn't lex, and the error says "message".
+static void expect_error(std::string_view source, std::string_view message) {
+    auto number = lex_number(source);
+    if (number.is_okay()) {
+        eprintln("FAIL: `{}`: got {}, expected an error", source, number.get()->to_string());
+        failures++;
+    }
+    else if (std::string_view{ number.get_err()->what() }.find(message) == std::string_view::npos) {
+        eprintln("FAIL: `{}`: got `{}`, expected `{}`", source, number.get_err()->what(), message);
+        failures++;
+    }
+}
+
+int main() {
+    constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+
+    // decimal, eight digits at a time and the digits left over.
+    expect_integer("0", 0);
+    expect_integer("99999999", 99999999);
+    expect_integer("123456789", 123456789);
+    expect_integer("1234567812345678", 1234567812345678);
+    expect_integer("9999999999999999999", 9999999999999999999u);
+    expect_integer("10000000000000000000", 10000000000000000000u);
+    expect_integer("18446744073709551615", max);
+    expect_error("18446744073709551616", "too large");
+    expect_error("99999999999999999999", "too large");
+    expect_error("100000000000000000000", "too large");
+
+    // prefixes and octal.
+    expect_integer("0xFFFFFFFFFFFFFFFF", max);
+    expect_integer("0x00000000000000001", 1);
+    expect_error("0x10000000000000000", "too large");
+    expect_integer("0b1111111111111111111111111111111111111111111111111111111111111111", max);
+    expect_error("0b10000000000000000000000000000000000000000000000000000000000000000", "too large");
+    expect_error("0x", "no digits");
+    expect_error("0b", "no digits");
+    expect_error("0x;", "no digits");
+    expect_integer("07", 7);
+    expect_integer("010", 8);
+    expect_integer("01777777777777777777777", max);
+    expect_error("08", "invalid digit (8) in a base 8");
+    expect_error("0b102", "invalid digit (2) in a base 2");
+
+    // suffixes, "ll" and "LL" but never "lL".
+    expect_integer("1u", 1, true);
+    expect_integer("1U", 1, true);
+    expect_integer("1l", 1, false, 1);
+    expect_integer("1LL", 1, false, 2);
+    expect_integer("1ull", 1, true, 2);
+    expect_integer("1LLu", 1, true, 2);
+    expect_integer("1Ul", 1, true, 1);
+    expect_error("1lL", "suffix");
+    expect_error("1Ll", "suffix");
+    expect_error("1lll", "suffix");
+    expect_error("1uu", "suffix");
+    expect_error("1lul", "suffix");
+    expect_error("1f", "suffix");
+    expect_floating("1.0f", 1.0f, true);
+    expect_floating("1.0F", 1.0f, true);
+    expect_floating("1.0l", 1.0);
+    expect_error("1.0fl", "suffix");
+    expect_error("1.0u", "suffix");
+
+    // floating point, short ones take Clinger's fast path and the rest std::from_chars.
+    expect_floating(".5f", 0.5f, true);
+    expect_floating(".5", 0.5);
+    expect_floating("5.", 5.0);
+    expect_floating("0.1", 0.1);
+    expect_floating("0.1f", static_cast<double>(0.1f), true);
+    expect_floating("1e22", 1e22);
+    expect_floating("1e23", 1e23);
+    expect_floating("9007199254740993.0", 9007199254740993.0);
+    expect_floating("123456789012345678901234567890.0", 123456789012345678901234567890.0);
+    expect_floating("2.2250738585072014e-308", 2.2250738585072014e-308);
+    expect_floating("4.9e-324", 4.9e-324);
+    expect_floating("1e400", std::numeric_limits<double>::infinity());
+    expect_floating("1e-400", 0.0);
+    expect_floating("3.4028235e38f", static_cast<double>(3.4028235e38f), true);
+    expect_floating("1e39f", static_cast<double>(std::numeric_limits<float>::infinity()), true);
+    expect_error("1.5e", "exponent");
+    expect_error("1e+", "exponent");
+    expect_error("1.2.3", "only contain one \".\"");
+
+    // hexadecimal floating point.
+    expect_floating("0x1p-1074", 0x1p-1074);
+    expect_floating("0x1p-1075", 0.0);
+    expect_floating("0x1.fffffffffffffp1023", 0x1.fffffffffffffp1023);
+    expect_floating("0x1p1024", std::numeric_limits<double>::infinity());
+    expect_floating("0x1.8p1", 3.0);
+    expect_floating("0x.8p0", 0.5);
+    expect_floating("0x1p-149f", static_cast<double>(0x1p-149f), true);
+    expect_floating("0x1p-150f", 0.0, true);
+    expect_error("0x1.8", "exponent");
+
+    if (failures != 0) {
+        eprintln("{} checks failed.", failures);
+        return 1;
+    }
+    println("all checks passed.");
+    return 0;
+}
@@ -0,0 +1,75 @@
+int eight(int a, int b, int c, int d, int e, int f, int g, int h) {
+    if (h < 0) {
+        return eight(a, b, c, d, e, f, g, -h) + 1;
+    }
+    return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 + g * 7 + h * 8;
+}
+
+long mixed(char a, long b, short c, int d, unsigned char e, long f, int g, char h, long i, int j) {
+    if (j < 0) {
+        return mixed(a, b, c, d, e, f, g, h, i, -j) + 1;
+    }
+    return a - b + c * 10 - d + e * 100 - f + g * 1000 - h + i * 10000 - j;
+}
+
+int nested(int a, int b, int c, int d, int e, int f, int g, int h) {
+    if (a <= 0) {
+        return b + c + d + e + f + g + h;
+    }
+    return nested(a - 1, h, b, c, d, e, f, g) + a;
+}
+
+int clobber(int x) {
+    if (x < 0) {
+        return clobber(-x) + 1;
+    }
+    int a = x + 1;
+    int b = x * 2;
+    int c = x - 3;
+    int d = x ^ 5;
+    int e = x | 8;
+    int f = x & 12;
+    return a + b + c + d + e + f;
+}
+
+int across(int x, int y) {
+    int a = x + y;
+    int b = x - y;
+    int c = x * y;
+    int d = a ^ c;
+    long e = a;
+    e = e * 100000;
+    int r = clobber(a) + clobber(b - 20);
+    r = r + clobber(c);
+    int f = e / 1000;
+    return r + a + b + c + d + f;
+}
+
+int main(void) {
+    if (eight(1, 2, 3, 4, 5, 6, 7, 8) != 204) {
+        return 1;
+    }
+    if (eight(-1, 0, 0, 0, 0, 0, 0, -1) != 8) {
+        return 2;
+    }
+    if (mixed(1, 2, 3, 4, 5, 6, 7, 8, 9, 10) != 97501) {
+        return 3;
+    }
+    if (mixed(-1, -2, -3, -4, 255, -6, -7, -8, -9, -10) != -71520) {
+        return 4;
+    }
+    if (nested(3, 1, 2, 3, 4, 5, 6, 7) != 34) {
+        return 5;
+    }
+    if (across(7, 3) != 1376) {
+        return 6;
+    }
+    int sum = 0;
+    for (int i = 0; i < 10; i++) {
+        sum = sum + eight(i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7) - clobber(i);
+    }
+    if (sum != 2946) {
+        return 7;
+    }
+    return 0;
+}
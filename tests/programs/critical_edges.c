@@ -0,0 +1,82 @@
+int swap_loop(int x, int y, int n) {
+    while (n > 0) {
+        int t = x;
+        x = y;
+        y = t;
+        n--;
+    }
+    return x * 10 + y;
+}
+
+int rotate(int a, int b, int c, int n) {
+    for (int i = 0; i < n; i++) {
+        int t = a;
+        a = b;
+        b = c;
+        c = t;
+        if (a == 100) {
+            break;
+        }
+    }
+    return a * 100 + b * 10 + c;
+}
+
+int lost_copy(int n) {
+    int x = 1;
+    int y = 0;
+    while (x < n) {
+        y = x;
+        x = x + 3;
+    }
+    return y;
+}
+
+int early(int a, int b) {
+    int r = a;
+    if (a > b) {
+        r = b;
+    }
+    if (r < 0) {
+        r = 0;
+    }
+    return r;
+}
+
+int search(int n, int key) {
+    int found = -1;
+    int last = 0;
+    for (int i = 0; i < n; i++) {
+        last = i * 7 % 13;
+        if (last == key) {
+            found = i;
+            break;
+        }
+        if (last > 11) {
+            continue;
+        }
+        last = last + 1;
+    }
+    return found * 100 + last;
+}
+
+int main(void) {
+    if (swap_loop(1, 2, 0) != 12 || swap_loop(1, 2, 3) != 21 || swap_loop(1, 2, 4) != 12) {
+        return 1;
+    }
+    if (rotate(1, 2, 3, 1) != 231 || rotate(1, 2, 3, 2) != 312 || rotate(1, 2, 3, 5) != 312) {
+        return 2;
+    }
+    if (rotate(7, 100, 9, 10) != 10097) {
+        return 3;
+    }
+    if (lost_copy(0) != 0 || lost_copy(2) != 1 || lost_copy(11) != 10 || lost_copy(12) != 10) {
+        return 4;
+    }
+    if (early(3, 5) != 3 || early(5, 3) != 3 || early(-4, 2) != 0 || early(2, -4) != 0) {
+        return 5;
+    }
+    if (search(13, 5) != 1005 || search(13, 99) != -93 || search(0, 1) != -100) {
+        return 6;
+    }
+    return 0;
+}
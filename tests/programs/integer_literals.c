@@ -0,0 +1,41 @@
+int main(void) {
+    unsigned u = 5;
+    if (u > -1) {
+        return 1;
+    }
+    unsigned big = 4294967295u;
+    if (big != -1) {
+        return 2;
+    }
+    int x = 7;
+    long wide = x * -1;
+    if (wide != -7) {
+        return 3;
+    }
+    int i = 3;
+    int a = i++-1;
+    int b = i-- -1;
+    if (a != 2 || b != 3 || i != 3) {
+        return 4;
+    }
+    char c = 127;
+    int y = ++c;
+    if (y != -128 || c != -128) {
+        return 5;
+    }
+    unsigned char uc = 0;
+    int z = --uc;
+    if (z != 255) {
+        return 6;
+    }
+    char d = -128;
+    int w = d--;
+    if (w != -128 || d != 127) {
+        return 7;
+    }
+    int p = +5 - -3;
+    if (p != 8) {
+        return 8;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+void* malloc(unsigned long size);
+
+int reductions(int* p, int n) {
+    int s0 = 0;
+    int s1 = 0;
+    int s2 = 0;
+    int s3 = -1;
+    int s4 = 0;
+    int s5 = 0;
+    int s6 = 0;
+    int s7 = -1;
+    int s8 = 0;
+    int s9 = 0;
+    int s10 = 0;
+    int s11 = -1;
+    int s12 = 0;
+    int s13 = 0;
+    int s14 = 0;
+    int s15 = -1;
+    for (int i = 0; i < n; i++) {
+        s0 = s0 + (p[i] + 1);
+        s1 = s1 ^ (p[i] + 4);
+        s2 = s2 | (p[i] + 7);
+        s3 = s3 & (p[i] + 10);
+        s4 = s4 + (p[i] + 13);
+        s5 = s5 ^ (p[i] + 16);
+        s6 = s6 | (p[i] + 19);
+        s7 = s7 & (p[i] + 22);
+        s8 = s8 + (p[i] + 25);
+        s9 = s9 ^ (p[i] + 28);
+        s10 = s10 | (p[i] + 31);
+        s11 = s11 & (p[i] + 34);
+        s12 = s12 + (p[i] + 37);
+        s13 = s13 ^ (p[i] + 40);
+        s14 = s14 | (p[i] + 43);
+        s15 = s15 & (p[i] + 46);
+    }
+    return s0 + s1 + s2 + s3 + s4 + s5 + s6 + s7 + s8 + s9 + s10 + s11 + s12 + s13 + s14 + s15;
+}
+
+long mixed(long x, int n) {
+    long a = x + 1;
+    long b = x * 2;
+    long c = x - 3;
+    long d = x ^ 4;
+    long e = x + 5;
+    long f = x * 6;
+    long g = x - 7;
+    long h = x ^ 8;
+    long i = x + 9;
+    long j = x * 10;
+    long k = x - 11;
+    long l = x ^ 12;
+    long m = x + 13;
+    long o = x * 14;
+    long q = x - 15;
+    long r = x ^ 16;
+    for (int t = 0; t < n; t++) {
+        a = a + r;
+        b = b ^ a;
+        c = c + b;
+        d = d - c;
+        e = e + d;
+        f = f ^ e;
+        g = g + f;
+        h = h - g;
+        i = i + h;
+        j = j ^ i;
+        k = k + j;
+        l = l - k;
+        m = m + l;
+        o = o ^ m;
+        q = q + o;
+        r = r - q;
+    }
+    return a + b + c + d + e + f + g + h + i + j + k + l + m + o + q + r;
+}
+
+int main(void) {
+    int* p = malloc(64 * 4);
+    for (int i = 0; i < 64; i++) {
+        p[i] = i * 7 - 50;
+    }
+    if (reductions(p, 0) != -4) {
+        return 1;
+    }
+    if (reductions(p, 3) != -496) {
+        return 2;
+    }
+    if (reductions(p, 4) != -348) {
+        return 3;
+    }
+    if (reductions(p, 37) != 14296) {
+        return 4;
+    }
+    if (reductions(p, 64) != 48508) {
+        return 5;
+    }
+    if (mixed(3, 0) != 164 || mixed(3, 5) != -7986 || mixed(-100, 9) != -3986316) {
+        return 6;
+    }
+    return 0;
+}
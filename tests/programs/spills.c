@@ -0,0 +1,91 @@
+int id(int x) {
+    if (x < -1000000) {
+        return id(x + 1) - 1;
+    }
+    return x;
+}
+
+int pressure(int x, int n) {
+    int a = x + 1;
+    int b = x * 3;
+    int c = x - 7;
+    int d = x ^ 21;
+    int e = x * x;
+    int f = x + 100;
+    int g = x | 64;
+    int h = x - 1000;
+    int i = x * 17;
+    int j = x ^ 255;
+    int k = x + 12345;
+    int l = x * 5 - 2;
+    int m = x & 1023;
+    int o = x + x + x;
+    for (int t = 0; t < n; t++) {
+        a = a + b;
+        b = b ^ c;
+        c = c + id(d);
+        d = d - e;
+        e = e + f;
+        f = f ^ g;
+        g = g + id(h);
+        h = h - i;
+        i = i + j;
+        j = j ^ k;
+        k = k + l;
+        l = l - m;
+        m = m + o;
+        o = o ^ a;
+    }
+    return a + b + c + d + e + f + g + h + i + j + k + l + m + o;
+}
+
+long split(long x, int n) {
+    long a = x + 1;
+    long b = x + 2;
+    long c = x + 3;
+    long d = x + 4;
+    long e = x + 5;
+    long f = x + 6;
+    long g = x + 7;
+    long h = x + 8;
+    long i = x + 9;
+    long j = x + 10;
+    long k = x + 11;
+    long l = x + 12;
+    long total = 0;
+    for (int t = 0; t < n; t++) {
+        if (t % 3 == 0) {
+            total = total + id(t) * a + b;
+        }
+        else if (t % 3 == 1) {
+            total = total - c * d + id(e);
+        }
+        else {
+            total = total + f - g * id(h);
+        }
+        total = total ^ (i + j - k + l);
+    }
+    return total + a + b + c + d + e + f + g + h + i + j + k + l;
+}
+
+int main(void) {
+    if (pressure(3, 0) != 11889) {
+        return 1;
+    }
+    if (pressure(3, 5) != -28926) {
+        return 2;
+    }
+    if (pressure(-9, 11) != 125702) {
+        return 3;
+    }
+    if (split(5, 0) != 138) {
+        return 4;
+    }
+    if (split(5, 10) != -363) {
+        return 5;
+    }
+    if (split(-40, 7) != -337) {
+        return 6;
+    }
+    return 0;
+}
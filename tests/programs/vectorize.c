@@ -0,0 +1,80 @@
+void* malloc(unsigned long size);
+void free(void* p);
+
+void add(int* dst, int* src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = dst[i] + src[i];
+    }
+}
+
+void scale(char* dst, char* src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i] + src[i] + 3;
+    }
+}
+
+int sum(int* p, int n) {
+    int s = 0;
+    for (int i = 0; i < n; i++) {
+        s = s + p[i];
+    }
+    return s;
+}
+
+void fill(int* p, int n) {
+    for (int i = 0; i < n; i++) {
+        p[i] = i * 5 - 17;
+    }
+}
+
+unsigned check_add(int* p, int dst, int src, int n) {
+    fill(p, 64);
+    add(p + dst, p + src, n);
+    unsigned s = 0;
+    for (int i = 0; i < 64; i++) {
+        s = s * 31 + p[i];
+    }
+    return s;
+}
+
+int main(void) {
+    int* p = malloc(64 * 4);
+    int* q = malloc(64 * 4);
+    fill(p, 64);
+    fill(q, 64);
+    add(p, q, 39);
+    if (p[0] != -34 || p[38] != 346 || p[39] != 178) {
+        return 1;
+    }
+    if (sum(q, 0) != 0 || sum(q, 3) != -36 || sum(q, 37) != 2701) {
+        return 2;
+    }
+    if (check_add(p, 1, 0, 37) != 4136331563u) {
+        return 3;
+    }
+    if (check_add(p, 3, 0, 30) != 1669633893u) {
+        return 4;
+    }
+    if (check_add(p, 3, 8, 41) != 1370827931u) {
+        return 5;
+    }
+    if (check_add(p, 0, 0, 64) != 1781266752u) {
+        return 6;
+    }
+    char* c = malloc(64);
+    for (int i = 0; i < 64; i++) {
+        c[i] = i + 40;
+    }
+    scale(c + 2, c, 45);
+    unsigned cs = 0;
+    for (int i = 0; i < 64; i++) {
+        cs = cs * 7 + c[i];
+    }
+    if (cs != 2439139097u) {
+        return 7;
+    }
+    free(c);
+    free(q);
+    free(p);
+    return 0;
+}
@@ -0,0 +1,23 @@
+# Compiles SOURCE with COMPILER at OPT (-O0, -O2, ...), links the object with the system C
+# compiler CC and runs it. A program reports a failed check with a nonzero exit code, the
+# number of the check. (the compiler doesn't lex comments yet, the programs have none)
+#
+# cmake -DCOMPILER=... -DCC=... -DSOURCE=... -DOPT=... -DWORK=... -P run_program.cmake
+
+get_filename_component(name "${SOURCE}" NAME_WE)
+set(object "${WORK}/${name}${OPT}.o")
+set(program "${WORK}/${name}${OPT}")
+file(MAKE_DIRECTORY "${WORK}")
+
+execute_process(COMMAND "${COMPILER}" ${OPT} "${SOURCE}" -o "${object}" RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "${name}: failed to compile at ${OPT} (${result})")
+endif()
+execute_process(COMMAND "${CC}" "${object}" -o "${program}" RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "${name}: failed to link at ${OPT} (${result})")
+endif()
+execute_process(COMMAND "${program}" RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "${name}: check ${result} failed at ${OPT}")
+endif()
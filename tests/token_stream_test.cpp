@@ -0,0 +1,160 @@
+// Dumps the tokens of a source with every kind of token in it and reads them back, they have
+// to come back the same. A dump cut short anywhere, and one of an older format, are refused.
+//
+// usage: token_stream_test
+
+#include "compiler/lexing/lexer.hpp"
+#include "compiler/lexing/token_stream.hpp"
+#include "common/io.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace compiler;
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void fail(std::string_view what) {
+    eprintln("FAIL: {}", what);
+    failures++;
+}
+
+// identifiers, keywords, every kind of literal (joined strings, escapes, a NUL, the same
+// string twice, suffixes), punctuation and several lines with indentation.
+static constexpr std::string_view source =
+    "int main(void) {\n"
+    "    unsigned long big = 18446744073709551615ull;\n"
+    "    const char* s = \"a\\tb\" \"c\\0d\";\n"
+    "    const char* t = \"a\\tbc\\0d\";\n"
+    "    char c = '\\n';\n"
+    "    double d = 0x1p-1074 + .5f + 1e400L;\n"
+    "    if (big >= 0x10 && c != 'x') { return -1; } else { return s[0] + t[1]; }\n"
+    "}\n";
+
+static bool same_token(const token& a, const string_pool& a_strings, const token& b, const string_pool& b_strings) {
+    if (a.type() != b.type()
+        || a.span().begin != b.span().begin || a.span().end != b.span().end
+        || a.location().source_file() != b.location().source_file()
+        || a.location().line() != b.location().line() || a.location().column() != b.location().column()
+        || a.lexeme() != b.lexeme()) {
+        return false;
+    }
+    if (a.type() == token_type::INTEGER_LITERAL || a.type() == token_type::FLOATING_POINT_LITERAL) {
+        const auto& x = a.number();
+        const auto& y = b.number();
+        return x.bits() == y.bits() && x.is_floating() == y.is_floating() && x.is_unsigned() == y.is_unsigned()
+            && x.long_count() == y.long_count() && x.is_float() == y.is_float();
+    }
+    if (a.type() == token_type::STRING_LITERAL) {
+        // the ids can differ, the pools they're in don't have to start out the same.
+        return a_strings.get(a.string()) == b_strings.get(b.string());
+    }
+    return true;
+}
+
+static void expect_same(std::string_view what, const std::vector<token>& tokens, const string_pool& strings, const token_stream& stream, const string_pool& stream_strings) {
+    if (stream.file != "round_trip.c") {
+        fail(std::format("{}: the file is `{}`", what, stream.file));
+    }
+    if (stream.tokens.size() != tokens.size()) {
+        fail(std::format("{}: {} tokens came back, {} went in", what, stream.tokens.size(), tokens.size()));
+        return;
+    }
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        if (!same_token(tokens[i], strings, stream.tokens[i], stream_strings)) {
+            fail(std::format("{}: token {} is {}, it was {}", what, i, stream.tokens[i].to_string(), tokens[i].to_string()));
+            return;
+        }
+    }
+}
+
+static void expect_error(std::string_view what, const std::vector<std::uint8_t>& bytes, std::string_view message) {
+    string_pool strings;
+    auto decoded = decode_tokens(bytes, strings);
+    if (decoded.is_okay()) {
+        fail(std::format("{}: decoded without an error", what));
+    }
+    else if (std::string_view{ decoded.get_err()->what() }.find(message) == std::string_view::npos) {
+        fail(std::format("{}: got `{}`, expected `{}`", what, decoded.get_err()->what(), message));
+    }
+}
+
+int main() {
+    auto lexer = compiler::lexer{ source_info::borrow("round_trip.c", source) };
+    if (auto lex_result = lexer.lex_tokens(); lex_result.is_err()) {
+        fail(std::format("the source doesn't lex: {}", lex_result.get_err()->what()));
+        return 1;
+    }
+    const auto& tokens = lexer.tokens();
+    const auto& strings = lexer.strings();
+    const auto bytes = encode_tokens(tokens, strings, "round_trip.c");
+
+    {
+        string_pool decoded_strings;
+        auto decoded = decode_tokens(bytes, decoded_strings);
+        if (decoded.is_err()) {
+            fail(std::format("decode: {}", decoded.get_err()->what()));
+        }
+        else {
+            expect_same("decode", tokens, strings, *decoded.get(), decoded_strings);
+        }
+    }
+    {
+        // into a pool that already has strings of another file, the literals get new ids.
+        string_pool decoded_strings;
+        decoded_strings.intern("from another file");
+        decoded_strings.intern("c");
+        auto decoded = decode_tokens(bytes, decoded_strings);
+        if (decoded.is_err()) {
+            fail(std::format("decode into a used pool: {}", decoded.get_err()->what()));
+        }
+        else {
+            expect_same("decode into a used pool", tokens, strings, *decoded.get(), decoded_strings);
+        }
+    }
+    {
+        const auto path = (fs::temp_directory_path() / "token_stream_test.tokens").string();
+        if (auto written = write_tokens(tokens, strings, "round_trip.c", path); written.is_err()) {
+            fail(std::format("write_tokens: {}", written.get_err()->what()));
+        }
+        string_pool read_strings;
+        auto read = read_tokens(path, read_strings);
+        if (read.is_err()) {
+            fail(std::format("read_tokens: {}", read.get_err()->what()));
+        }
+        else {
+            expect_same("read_tokens", tokens, strings, *read.get(), read_strings);
+        }
+        fs::remove(path);
+    }
+
+    // cut short after every byte, none of them may decode.
+    for (std::size_t size = 0; size < bytes.size(); ++size) {
+        string_pool partial_strings;
+        const auto partial = std::span<const std::uint8_t>{ bytes.data(), size };
+        if (decode_tokens(partial, partial_strings).is_okay()) {
+            fail(std::format("a dump cut to {} of {} bytes decoded", size, bytes.size()));
+        }
+    }
+
+    // the version is the varint right after the 8 bytes of magic.
+    auto old_version = bytes;
+    old_version[8] = 1;
+    expect_error("a version 1 dump", old_version, std::format("(format 1, expected {})", token_stream_version));
+    auto not_a_dump = bytes;
+    not_a_dump[0] = 'X';
+    expect_error("a dump with the wrong magic", not_a_dump, "not a token dump");
+
+    if (failures != 0) {
+        eprintln("{} checks failed.", failures);
+        return 1;
+    }
+    println("all checks passed.");
+    return 0;
+}